@@ -155,6 +155,27 @@ typedef struct
     const astarte_interface_t **interfaces;
     /** @brief Number of elements in the interfaces array. */
     size_t interfaces_size;
+    /** @brief Capacity of each transmission queue held in RAM.
+     *
+     * @details Zero to use CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE. The queues are
+     * allocated on the heap when the device is created.
+     */
+    size_t transmission_queue_size;
+    /** @brief Maximum number of queued messages transmitted in a single burst.
+     *
+     * @details Zero to use CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_PACING_MAX_TOKENS.
+     */
+    uint32_t transmission_pacing_max_tokens;
+    /** @brief Period in milliseconds to earn the transmission of a queued message.
+     *
+     * @details Zero to use CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_PACING_TOKEN_PERIOD_MS.
+     */
+    uint32_t transmission_pacing_token_period_ms;
+    /** @brief Maximum number of QoS 1 and 2 messages waiting for an acknowledgement.
+     *
+     * @details Zero to use CONFIG_ASTARTE_DEVICE_SDK_MQTT_IN_FLIGHT_WINDOW.
+     */
+    uint32_t mqtt_in_flight_window;
 } astarte_device_config_t;
 
 #ifdef __cplusplus
@@ -184,6 +205,7 @@ astarte_result_t astarte_device_new(astarte_device_config_t *cfg, astarte_device
  *
  * @note The device handle will become invalid after this operation.
  * @note If the device is connected when calling this function it will be forcefully disconnected.
+ * @note The messages still queued for transmission are discarded, including the stored ones.
  *
  * @param[in] device Device instance to be destroyed.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
@@ -253,6 +275,18 @@ astarte_result_t astarte_device_disconnect(astarte_device_handle_t device, k_tim
  */
 astarte_result_t astarte_device_force_disconnect(astarte_device_handle_t device);
 
+/**
+ * @brief Write to flash the messages with stored retention still buffered in RAM.
+ *
+ * @details When transmission packing is enabled, small messages with stored retention are
+ * buffered and written to flash together. The buffer is written when full and when its timeout
+ * expires. Call this function before a planned power down to avoid losing the buffered messages.
+ *
+ * @param[in] device Handle to the device instance.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_device_flush(astarte_device_handle_t device);
+
 /**
  * @brief Send a value through the device connection.
  *
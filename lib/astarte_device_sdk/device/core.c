@@ -5,6 +5,8 @@
  */
 #include "astarte_device_sdk/device.h"
 
+#include <zephyr/sys/mutex.h>
+
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
 #include "storage/core.h"
 #include "storage/prop.h"
@@ -17,6 +19,7 @@
 #include "device/core.h"
 #include "device/dispatcher.h"
 #include "device/session_manager.h"
+#include "device/worker.h"
 #include "mqtt/pubsub.h"
 #include "object_private.h"
 #include "pairing/core.h"
@@ -24,20 +27,14 @@
 #include "log.h"
 ASTARTE_LOG_MODULE_REGISTER(astarte_device, CONFIG_ASTARTE_DEVICE_SDK_DEVICE_LOG_LEVEL);
 
-#define POLLING_ERROR_RETRY_DELAY_MS 50
-#define TRANSMISSION_PACING_MAX_TOKENS 10
-#define TRANSMISSION_PACING_TOKEN_VALUE_MS 20
-#define TRANSMISSION_EMPTY_QUEUE_WAITING_MS 100
-#define TRANSMISSION_EVENT_WAITING_MS 50
-#define TRANSMISSION_ERROR_RETRY_DELAY_MS 50
-
 /************************************************
  *         Static variables declaration         *
  ***********************************************/
 
 // NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
-static struct astarte_device device_instance = { 0 };
-static bool device_initialized = false;
+static struct astarte_device device_instances[CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES] = { 0 };
+static bool device_initialized[CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES] = { 0 };
+static SYS_MUTEX_DEFINE(device_instances_mutex);
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
 
 /************************************************
@@ -47,11 +44,28 @@ static bool device_initialized = false;
 static astarte_result_t initialize_introspection(
     astarte_device_handle_t device, const astarte_interface_t **interfaces, size_t interfaces_size);
 static astarte_result_t initialize_mqtt_topics(astarte_device_handle_t device);
-static void astarte_device_worker_thread_entry(void *par1, void * /*par2*/, void * /*par3*/);
-
-static void refill_transmission_tokens(uint32_t *tokens, int64_t *last_refill);
-static void process_transmission_queue(
-    struct astarte_device *device, uint32_t *tokens, int64_t last_refill);
+/**
+ * @brief Reserves a free device instance.
+ *
+ * @param[out] index Index of the reserved instance.
+ * @return The reserved instance, NULL if all the instances are in use.
+ */
+static struct astarte_device *reserve_device_instance(size_t *index);
+/**
+ * @brief Gets the index of an initialized device instance.
+ *
+ * @param[in] device Handle to the device instance.
+ * @param[out] index Index of the instance.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_INVALID_PARAM if the handle does not
+ * refer to an initialized instance.
+ */
+static astarte_result_t get_device_instance_index(astarte_device_handle_t device, size_t *index);
+/**
+ * @brief Releases a device instance, making it available for a new device.
+ *
+ * @param[in] index Index of the instance.
+ */
+static void release_device_instance(size_t index);
 
 // Helper to safely destroy a partially initialized device
 static void cleanup_device_creation(astarte_device_handle_t *handle_ptr)
@@ -71,7 +85,7 @@ static void cleanup_device_creation(astarte_device_handle_t *handle_ptr)
 #endif
     introspection_free(handle->introspection);
 
-    device_initialized = false;
+    release_device_instance(handle - device_instances);
 }
 
 ASTARTE_SCOPE_DEFER_DEFINE(cleanup_device_creation, astarte_device_handle_t *);
@@ -99,7 +113,7 @@ static astarte_result_t refresh_client_cert_handler(astarte_mqtt_t *astarte_mqtt
             ASTARTE_LOG_DBG("Previous certificate is still valid, no refresh required");
             return ares;
         }
-        ares = astarte_tls_credential_delete();
+        ares = astarte_tls_credential_delete(astarte_mqtt->client_cert_tag);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Can't delete the client TLS cert: %s", astarte_result_to_name(ares));
             return ares;
@@ -113,7 +127,7 @@ static astarte_result_t refresh_client_cert_handler(astarte_mqtt_t *astarte_mqtt
         return ares;
     }
 
-    ares = astarte_tls_credential_add(client_crt);
+    ares = astarte_tls_credential_add(astarte_mqtt->client_cert_tag, client_crt);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed adding the client TLS cert: %s", astarte_result_to_name(ares));
         return ares;
@@ -138,14 +152,13 @@ astarte_result_t astarte_device_new(astarte_device_config_t *cfg, astarte_device
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    if (device_initialized) {
-        ASTARTE_LOG_ERR("Device is already initialized. Only a single instance is allowed.");
+    size_t instance_index = 0;
+    astarte_device_handle_t handle = reserve_device_instance(&instance_index);
+    if (!handle) {
+        ASTARTE_LOG_ERR(
+            "All the %d device instances are in use.", CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES);
         return ASTARTE_RESULT_INVALID_PARAM;
     }
-
-    memset(&device_instance, 0, sizeof(struct astarte_device));
-
-    astarte_device_handle_t handle = &device_instance;
     scope_defer(cleanup_device_creation)(&handle);
 
     handle->http_timeout_ms = cfg->http_timeout_ms;
@@ -155,7 +168,7 @@ astarte_result_t astarte_device_new(astarte_device_config_t *cfg, astarte_device
     handle->synchronization_completed = false;
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-    ares = astarte_storage_init(&handle->caching);
+    ares = astarte_storage_init(&handle->caching, instance_index);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Storage initialization failure %s", astarte_result_to_name(ares));
         return ares;
@@ -189,6 +202,11 @@ astarte_result_t astarte_device_new(astarte_device_config_t *cfg, astarte_device
     astarte_mqtt_config.clean_session = false;
     astarte_mqtt_config.connection_timeout_ms = cfg->mqtt_connection_timeout_ms;
     astarte_mqtt_config.poll_timeout_ms = cfg->mqtt_poll_timeout_ms;
+    astarte_mqtt_config.client_cert_tag
+        = (sec_tag_t) (CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG + instance_index);
+    astarte_mqtt_config.in_flight_window = (cfg->mqtt_in_flight_window > 0)
+        ? cfg->mqtt_in_flight_window
+        : CONFIG_ASTARTE_DEVICE_SDK_MQTT_IN_FLIGHT_WINDOW;
     astarte_mqtt_config.refresh_client_cert_cbk = refresh_client_cert_handler;
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     astarte_mqtt_config.storage = &handle->caching;
@@ -231,10 +249,14 @@ astarte_result_t astarte_device_new(astarte_device_config_t *cfg, astarte_device
         CONFIG_ASTARTE_DEVICE_SDK_RECONNECTION_BACKOFF_CUTOFF_COEFF_MS);
 
     // Initialize the transmission queue
+    size_t transmission_queue_size = (cfg->transmission_queue_size > 0)
+        ? cfg->transmission_queue_size
+        : CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE;
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-    ares = astarte_transmission_queue_init(&handle->transmission_queue, &handle->caching);
+    ares = astarte_transmission_queue_init(
+        &handle->transmission_queue, &handle->caching, transmission_queue_size);
 #else
-    ares = astarte_transmission_queue_init(&handle->transmission_queue);
+    ares = astarte_transmission_queue_init(&handle->transmission_queue, transmission_queue_size);
 #endif
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR(
@@ -242,25 +264,32 @@ astarte_result_t astarte_device_new(astarte_device_config_t *cfg, astarte_device
         return ares;
     }
 
+    // Initialize the transmission pacing, starting with a full bucket
+    astarte_transmission_pacing_init(&handle->transmission_pacing,
+        (cfg->transmission_pacing_max_tokens > 0)
+            ? cfg->transmission_pacing_max_tokens
+            : CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_PACING_MAX_TOKENS,
+        (cfg->transmission_pacing_token_period_ms > 0)
+            ? cfg->transmission_pacing_token_period_ms
+            : CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_PACING_TOKEN_PERIOD_MS);
+
     // Initialize the error event queue
     k_msgq_init(&handle->event_queue, handle->event_queue_buffer, sizeof(astarte_device_event_t),
         CONFIG_ASTARTE_DEVICE_SDK_EVENT_QUEUE_SIZE);
 
-    ASTARTE_LOG_DBG("Initializing Astarte worker thread");
-
     k_event_init(&handle->events);
-    k_thread_create(&handle->worker_thread, handle->worker_thread_stack,
-        K_THREAD_STACK_SIZEOF(handle->worker_thread_stack),
-        (k_thread_entry_t) astarte_device_worker_thread_entry, handle, NULL, NULL,
-        K_PRIO_PREEMPT(CONFIG_ASTARTE_DEVICE_SDK_WORKER_THREAD_PRIORITY), 0, K_NO_WAIT);
+
+    ASTARTE_LOG_DBG("Registering the device with the Astarte worker thread");
+    ares = astarte_device_worker_add(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failure registering the device %s", astarte_result_to_name(ares));
+        return ares;
+    }
 
     // Transfer ownership and disarm
     *device = handle;
     handle = NULL;
 
-    // Device is now initialized
-    device_initialized = true;
-
     ASTARTE_LOG_DBG("Device instance creation completed");
 
     return ASTARTE_RESULT_OK;
@@ -276,39 +305,44 @@ astarte_result_t astarte_device_destroy(astarte_device_handle_t device)
         return ASTARTE_RESULT_OK;
     }
 
-    if (!device_initialized) {
+    size_t instance_index = 0;
+    if (get_device_instance_index(device, &instance_index) != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Device is not initialized. Cannot destroy it.");
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
+    // Stop serving the device, from now on the worker thread no longer accesses it
+    astarte_device_worker_remove(device);
+
     if (device->connection_state != DEVICE_DISCONNECTED) {
         ares = astarte_device_force_disconnect(device);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed disconnecting the device: %s", astarte_result_to_name(ares));
+            (void) astarte_device_worker_add(device);
             return ares;
         }
     }
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    // No longer served by the worker thread, the events left are handled here
+    astarte_mqtt_dispatch_events(&device->astarte_mqtt);
+#endif
 
     astarte_mqtt_clear_all_pending(&device->astarte_mqtt);
 
-    ares = astarte_tls_credential_delete();
+    ares = astarte_tls_credential_delete(device->astarte_mqtt.client_cert_tag);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed deleting the client TLS cert: %s", astarte_result_to_name(ares));
+        (void) astarte_device_worker_add(device);
         return ares;
     }
 
-    // Signal the transmission thread to exit and wait for it to cleanly terminate
-    ASTARTE_LOG_DBG("Stopping the Astarte worker thread");
-    k_event_post(&device->events, ASTARTE_DEVICE_DESTROY_EVENT_BIT);
-    k_thread_join(&device->worker_thread, K_FOREVER);
-
     astarte_transmission_queue_clear(&device->transmission_queue);
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     astarte_storage_destroy(&device->caching);
 #endif
     introspection_free(device->introspection);
 
-    device_initialized = false;
+    release_device_instance(instance_index);
 
     ASTARTE_LOG_DBG("Astarte device instance destroyed");
 
@@ -329,7 +363,12 @@ astarte_result_t astarte_device_add_interface(
     queue_msg.operation = ASTARTE_TRANSMISSION_OP_ADD_INTERFACE;
     queue_msg.interface = interface;
 
-    return astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
+    astarte_result_t ares
+        = astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
+    if (ares == ASTARTE_RESULT_OK) {
+        astarte_device_worker_wake();
+    }
+    return ares;
 }
 
 astarte_result_t astarte_device_remove_interface(
@@ -347,7 +386,22 @@ astarte_result_t astarte_device_remove_interface(
     queue_msg.operation = ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE;
     queue_msg.interface = interface;
 
-    return astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
+    astarte_result_t ares
+        = astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
+    if (ares == ASTARTE_RESULT_OK) {
+        astarte_device_worker_wake();
+    }
+    return ares;
+}
+
+astarte_result_t astarte_device_flush(astarte_device_handle_t device)
+{
+    if (!device) {
+        ASTARTE_LOG_ERR("Received NULL reference for device handle");
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    return astarte_transmission_queue_flush(&device->transmission_queue, true);
 }
 
 astarte_result_t astarte_device_get_event(
@@ -461,152 +515,45 @@ static astarte_result_t initialize_mqtt_topics(astarte_device_handle_t device)
     return ASTARTE_RESULT_OK;
 }
 
-static void astarte_device_worker_thread_entry(void *par1, void * /*par2*/, void * /*par3*/)
+static struct astarte_device *reserve_device_instance(size_t *index)
 {
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-    struct astarte_device *device = (struct astarte_device *) par1;
-
-    // Initialize token bucket state
-    uint32_t transmission_tokens = TRANSMISSION_PACING_MAX_TOKENS;
-    int64_t last_token_refill = k_uptime_get();
-
-    while (true) {
-        // Check if a destroy was requested before doing anything else
-        uint32_t events = k_event_test(&device->events, ASTARTE_DEVICE_DESTROY_EVENT_BIT);
-        if (events & ASTARTE_DEVICE_DESTROY_EVENT_BIT) {
-            break;
-        }
-
-        // Poll the state machine and MQTT client
-        ares = astarte_device_internal_poll(device);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Error polling the device: %s", astarte_result_to_name(ares));
-
-            astarte_device_error_event_t err_ev
-                = { .result = ares, .context = "astarte_device_internal_poll" };
-            k_msgq_put(&device->event_queue, &err_ev, K_NO_WAIT);
-
-            k_msleep(POLLING_ERROR_RETRY_DELAY_MS);
-            continue;
-        }
-
-        // Wait for connection
-        events = k_event_wait(&device->events,
-            ASTARTE_DEVICE_CONNECTION_EVENT_BIT | ASTARTE_DEVICE_DESTROY_EVENT_BIT, false,
-            K_MSEC(TRANSMISSION_EVENT_WAITING_MS));
-
-        // If the device is being destroyed, break the loop
-        if (events & ASTARTE_DEVICE_DESTROY_EVENT_BIT) {
+    struct astarte_device *device = NULL;
+
+    sys_mutex_lock(&device_instances_mutex, K_FOREVER);
+    for (size_t i = 0; i < CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES; i++) {
+        if (!device_initialized[i]) {
+            device_initialized[i] = true;
+            device = &device_instances[i];
+            memset(device, 0, sizeof(struct astarte_device));
+            *index = i;
             break;
         }
-
-        // If we timed out waiting for a connection, loop back and poll again
-        if (!(events & ASTARTE_DEVICE_CONNECTION_EVENT_BIT)) {
-            continue;
-        }
-
-        // Refill tokens and process the transmission queue
-        refill_transmission_tokens(&transmission_tokens, &last_token_refill);
-        process_transmission_queue(device, &transmission_tokens, last_token_refill);
     }
-}
+    sys_mutex_unlock(&device_instances_mutex);
 
-static void refill_transmission_tokens(uint32_t *tokens, int64_t *last_refill)
-{
-    int64_t now = k_uptime_get();
-    int64_t elapsed = now - *last_refill;
-
-    // Generate tokens based on elapsed time
-    if (elapsed >= TRANSMISSION_PACING_TOKEN_VALUE_MS) {
-        int64_t generated_tokens = elapsed / TRANSMISSION_PACING_TOKEN_VALUE_MS;
-        if (*tokens + generated_tokens > TRANSMISSION_PACING_MAX_TOKENS) {
-            *tokens = TRANSMISSION_PACING_MAX_TOKENS;
-        } else {
-            *tokens += (uint32_t) generated_tokens;
-        }
-
-        // No more widening warning: generated_tokens is already int64_t
-        *last_refill += generated_tokens * TRANSMISSION_PACING_TOKEN_VALUE_MS;
-    }
+    return device;
 }
 
-static void process_transmission_queue(
-    struct astarte_device *device, uint32_t *tokens, int64_t last_refill)
+static astarte_result_t get_device_instance_index(astarte_device_handle_t device, size_t *index)
 {
-    struct astarte_device_transmission_queue_msg msg = { 0 };
-    astarte_result_t ares = astarte_transmission_queue_peek(&device->transmission_queue, &msg);
-    if (ares != ASTARTE_RESULT_OK) {
-        // Prevent CPU starvation when the queue is empty
-        k_msleep(TRANSMISSION_EMPTY_QUEUE_WAITING_MS);
-        goto exit;
-    }
-
-    // Intercept interface updates before token/pacing checks
-    if (msg.operation == ASTARTE_TRANSMISSION_OP_ADD_INTERFACE
-        || msg.operation == ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE) {
-
-        if (msg.operation == ASTARTE_TRANSMISSION_OP_ADD_INTERFACE) {
-            ASTARTE_LOG_DBG("Processing add interface operation for %s", msg.interface->name);
+    astarte_result_t ares = ASTARTE_RESULT_INVALID_PARAM;
 
-            ares = introspection_update(&device->introspection, msg.interface);
-            if (ares != ASTARTE_RESULT_OK) {
-                ASTARTE_LOG_ERR("Failed updating introspection: %s", astarte_result_to_name(ares));
-            }
-        } else if (msg.operation == ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE) {
-            ASTARTE_LOG_DBG("Processing remove interface operation for %s", msg.interface->name);
-
-            ares = introspection_remove(&device->introspection, msg.interface->name);
-            if (ares != ASTARTE_RESULT_OK) {
-                ASTARTE_LOG_ERR(
-                    "Failed removing from introspection: %s", astarte_result_to_name(ares));
-            }
-        }
-
-        astarte_transmission_queue_discard_interface(&device->transmission_queue);
-        goto exit;
-    }
-
-    // Check if we have tokens to transmit
-    if (*tokens == 0) {
-        // Out of tokens: calculate exact time until the next token is ready and sleep
-        int64_t wait_ms = TRANSMISSION_PACING_TOKEN_VALUE_MS - (k_uptime_get() - last_refill);
-        if (wait_ms > 0) {
-            if (wait_ms > INT32_MAX) {
-                ASTARTE_LOG_ERR("Wait time exceeds maximum value for k_msleep");
-                wait_ms = INT32_MAX;
-            }
-            k_msleep((int32_t) wait_ms);
+    sys_mutex_lock(&device_instances_mutex, K_FOREVER);
+    for (size_t i = 0; i < CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES; i++) {
+        if ((device == &device_instances[i]) && device_initialized[i]) {
+            *index = i;
+            ares = ASTARTE_RESULT_OK;
+            break;
         }
-        goto exit;
     }
+    sys_mutex_unlock(&device_instances_mutex);
 
-    ASTARTE_LOG_DBG("Transmitting message for %s%s", msg.interface_name, msg.path);
-    ASTARTE_LOG_HEXDUMP_DBG(msg.payload, msg.payload_len, "Payload: ");
-
-    ares = astarte_device_dispatcher_publish_data(
-        device, msg.interface_name, msg.path, msg.payload, msg.payload_len, msg.qos);
-    if (ares == ASTARTE_RESULT_OK) {
-        ares = astarte_transmission_queue_discard_by_retention(
-            &device->transmission_queue, msg.retention);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR(
-                "Failed to remove message from queue: %s", astarte_result_to_name(ares));
-        }
-        // Consume a token for the successful transmission
-        (*tokens)--;
-
-    } else {
-        ASTARTE_LOG_ERR("Failed to transmit message: %s", astarte_result_to_name(ares));
-
-        astarte_device_error_event_t err_ev
-            = { .result = ares, .context = "process_transmission_queue" };
-        k_msgq_put(&device->event_queue, &err_ev, K_NO_WAIT);
-
-        // Message safely remains at the head of the queue
-        // Sleep for a short duration to back off before the loop retries.
-        k_msleep(TRANSMISSION_ERROR_RETRY_DELAY_MS);
-    }
+    return ares;
+}
 
-exit:
-    astarte_transmission_queue_msg_cleanup(&msg);
+static void release_device_instance(size_t index)
+{
+    sys_mutex_lock(&device_instances_mutex, K_FOREVER);
+    device_initialized[index] = false;
+    sys_mutex_unlock(&device_instances_mutex);
 }
@@ -11,6 +11,7 @@
 #include "data/deserialize.h"
 #include "data/serialize.h"
 #include "device/dispatcher.h"
+#include "device/worker.h"
 #include "interface_private.h"
 #include "object_private.h"
 #include "validation.h"
@@ -109,10 +110,13 @@ astarte_result_t astarte_device_send_individual(astarte_device_handle_t device,
         .payload_len = data_ser_len,
         .qos = qos,
         .retention = mapping->retention,
+        .expiry = mapping->expiry,
     };
     ares = astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed inserting message in transission queue");
+    } else {
+        astarte_device_worker_wake();
     }
 
 exit:
@@ -200,10 +204,13 @@ astarte_result_t astarte_device_send_object(astarte_device_handle_t device,
         .payload_len = len,
         .qos = qos,
         .retention = mapping->retention,
+        .expiry = mapping->expiry,
     };
     ares = astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed inserting message in transmission queue");
+    } else {
+        astarte_device_worker_wake();
     }
 
 exit:
@@ -12,6 +12,7 @@
 #include "data/serialize.h"
 #include "device/datastreams.h"
 #include "device/dispatcher.h"
+#include "device/worker.h"
 #include "mqtt/pubsub.h"
 #include "validation.h"
 
@@ -125,6 +126,7 @@ astarte_result_t astarte_device_set_property(astarte_device_handle_t device,
         ASTARTE_LOG_ERR("Failed inserting message in transmission queue");
         return ares;
     }
+    astarte_device_worker_wake();
 
     return ASTARTE_RESULT_OK;
 }
@@ -177,6 +179,8 @@ astarte_result_t astarte_device_unset_property(
     ares = astarte_transmission_queue_insert(&device->transmission_queue, &queue_msg);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed inserting unset message in transmission queue");
+    } else {
+        astarte_device_worker_wake();
     }
 
     return ares;
@@ -9,6 +9,7 @@
 #include "bson/serializer.h"
 #include "device/properties.h"
 #include "device/properties_storage.h"
+#include "device/worker.h"
 #include "mqtt/pubsub.h"
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
@@ -64,6 +65,7 @@ astarte_result_t astarte_device_connect(astarte_device_handle_t device)
     } else {
         ASTARTE_LOG_DBG("Device connection state -> MQTT_CONNECTING");
         device->connection_state = DEVICE_MQTT_CONNECTING;
+        astarte_device_worker_wake();
     }
     return ares;
 }
@@ -91,7 +93,9 @@ astarte_result_t astarte_device_disconnect(astarte_device_handle_t device, k_tim
         k_sleep(K_MSEC(100));
     }
 
-    return astarte_mqtt_disconnect(&device->astarte_mqtt);
+    astarte_result_t ares = astarte_mqtt_disconnect(&device->astarte_mqtt);
+    astarte_device_worker_wake();
+    return ares;
 }
 
 astarte_result_t astarte_device_force_disconnect(astarte_device_handle_t device)
@@ -107,16 +111,26 @@ astarte_result_t astarte_device_force_disconnect(astarte_device_handle_t device)
         return ASTARTE_RESULT_DEVICE_NOT_READY;
     }
 
-    return astarte_mqtt_disconnect(&device->astarte_mqtt);
+    astarte_result_t ares = astarte_mqtt_disconnect(&device->astarte_mqtt);
+    astarte_device_worker_wake();
+    return ares;
 }
 
-astarte_result_t astarte_device_internal_poll(astarte_device_handle_t device)
+astarte_result_t astarte_device_internal_poll_prepare(
+    astarte_device_handle_t device, struct zsock_pollfd *poll_fd, k_timepoint_t *deadline)
 {
-    if (!device) {
-        ASTARTE_LOG_ERR("Received NULL reference for device handle");
+    if (!device || !poll_fd || !deadline) {
+        ASTARTE_LOG_ERR("Received NULL reference for device handle, poll entry or deadline");
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    // Events read by the reception thread update the state machine from this thread only
+    astarte_mqtt_dispatch_events(&device->astarte_mqtt);
+#endif
+
+    enum connection_states previous_state = device->connection_state;
+
     switch (device->connection_state) {
         case DEVICE_DISCONNECTED:
         case DEVICE_MQTT_CONNECTING:
@@ -137,7 +151,33 @@ astarte_result_t astarte_device_internal_poll(astarte_device_handle_t device)
             break;
     }
 
-    return astarte_mqtt_poll(&device->astarte_mqtt);
+    if (device->connection_state != previous_state) {
+        // Run the next step of the state machine without waiting
+        *deadline = sys_timepoint_calc(K_NO_WAIT);
+    } else if ((device->connection_state == DEVICE_HANDSHAKE_ERROR)
+        && (sys_timepoint_cmp(device->reconnection_timepoint, *deadline) < 0)) {
+        *deadline = device->reconnection_timepoint;
+    }
+
+    astarte_mqtt_poll_prepare(&device->astarte_mqtt, poll_fd, deadline);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    // A connection timeout raises its disconnection event while preparing the poll
+    if (astarte_mqtt_dispatch_events(&device->astarte_mqtt)) {
+        *deadline = sys_timepoint_calc(K_NO_WAIT);
+    }
+#endif
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_device_internal_poll_process(
+    astarte_device_handle_t device, const struct zsock_pollfd *poll_fd)
+{
+    if (!device || !poll_fd) {
+        ASTARTE_LOG_ERR("Received NULL reference for device handle or poll entry");
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    return astarte_mqtt_poll_process(&device->astarte_mqtt, poll_fd);
 }
 
 /************************************************
@@ -0,0 +1,110 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "device/transmission_pacing.h"
+
+#include <zephyr/kernel.h>
+
+#include "mqtt/pubsub.h"
+
+#include "log.h"
+ASTARTE_LOG_MODULE_DECLARE(astarte_device, CONFIG_ASTARTE_DEVICE_SDK_DEVICE_LOG_LEVEL);
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+/**
+ * @brief Check if a message with the given QoS is paced by the in-flight window.
+ *
+ * @param[in] astarte_mqtt Handle to the MQTT client the message is transmitted with.
+ * @param[in] qos QoS of the message.
+ * @return True if the message is paced by the window, false if it is paced by the tokens.
+ */
+static bool is_windowed(astarte_mqtt_t *astarte_mqtt, int qos);
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+void astarte_transmission_pacing_init(struct astarte_device_transmission_pacing *pacing,
+    uint32_t max_tokens, uint32_t token_period_ms)
+{
+    pacing->max_tokens = max_tokens;
+    pacing->token_period_ms = token_period_ms;
+    pacing->tokens = max_tokens;
+    pacing->last_refill = k_uptime_get();
+}
+
+void astarte_transmission_pacing_refill(struct astarte_device_transmission_pacing *pacing)
+{
+    int64_t now = k_uptime_get();
+    int64_t elapsed = now - pacing->last_refill;
+
+    // Generate tokens based on elapsed time
+    if (elapsed >= pacing->token_period_ms) {
+        int64_t generated_tokens = elapsed / pacing->token_period_ms;
+        if (pacing->tokens + generated_tokens > pacing->max_tokens) {
+            pacing->tokens = pacing->max_tokens;
+        } else {
+            pacing->tokens += (uint32_t) generated_tokens;
+        }
+
+        // No more widening warning: generated_tokens is already int64_t
+        pacing->last_refill += generated_tokens * pacing->token_period_ms;
+    }
+}
+
+uint32_t astarte_transmission_pacing_get_burst(
+    const struct astarte_device_transmission_pacing *pacing, astarte_mqtt_t *astarte_mqtt)
+{
+    uint64_t burst = (uint64_t) pacing->max_tokens + astarte_mqtt->in_flight_window;
+    return (uint32_t) MIN(burst, UINT32_MAX);
+}
+
+int32_t astarte_transmission_pacing_admit(
+    struct astarte_device_transmission_pacing *pacing, astarte_mqtt_t *astarte_mqtt, int qos)
+{
+    if (is_windowed(astarte_mqtt, qos)) {
+        // Window full, the acknowledgements are received on the MQTT socket and wake up the worker
+        return astarte_mqtt_has_in_flight_capacity(astarte_mqtt) ? 0 : SYS_FOREVER_MS;
+    }
+
+    // A burst might have taken longer than a token period
+    if (pacing->tokens == 0) {
+        astarte_transmission_pacing_refill(pacing);
+    }
+    if (pacing->tokens > 0) {
+        return 0;
+    }
+
+    // Out of tokens: calculate exact time until the next token is ready
+    int64_t wait_ms = pacing->token_period_ms - (k_uptime_get() - pacing->last_refill);
+    if (wait_ms > INT32_MAX) {
+        ASTARTE_LOG_ERR("Wait time exceeds maximum value for k_msleep");
+        wait_ms = INT32_MAX;
+    }
+    // Zero would admit the message
+    return (int32_t) MAX(wait_ms, 1);
+}
+
+void astarte_transmission_pacing_consume(
+    struct astarte_device_transmission_pacing *pacing, astarte_mqtt_t *astarte_mqtt, int qos)
+{
+    // The window paces itself
+    if (!is_windowed(astarte_mqtt, qos) && (pacing->tokens > 0)) {
+        pacing->tokens--;
+    }
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static bool is_windowed(astarte_mqtt_t *astarte_mqtt, int qos)
+{
+    return (qos > 0) && (astarte_mqtt->in_flight_window > 0);
+}
@@ -21,11 +21,15 @@ ASTARTE_LOG_MODULE_DECLARE(astarte_device, CONFIG_ASTARTE_DEVICE_SDK_DEVICE_LOG_
 
 // January first 2026, simple reference time to validate system time.
 #define MIN_VALID_TIME_SEC 1767225600
+// Upper bound of the capacity, keeps the size of the queues block far from overflowing.
+#define MAX_CAPACITY UINT16_MAX
 
 /************************************************
  *         Static functions declaration         *
  ***********************************************/
 
+static void queue_lock(struct astarte_device_transmission_queue *handle);
+static void queue_unlock(struct astarte_device_transmission_queue *handle);
 static bool is_system_time_valid();
 static uint64_t get_system_timestamp(struct astarte_device_transmission_queue *handle);
 static astarte_result_t insert_volatile_msg(struct k_msgq *msgq,
@@ -34,12 +38,160 @@ static astarte_result_t insert_volatile_msg(struct k_msgq *msgq,
 static astarte_result_t insert_interface_msg(struct k_msgq *msgq,
     const struct astarte_device_transmission_queue_msg *msg, uint64_t timestamp_ms,
     uint64_t sequence_number);
+/**
+ * @brief Insert a volatile message in its queue, or in the storage when spilling a full queue.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] msg Message to insert.
+ * @param[in] timestamp_ms Timestamp of the message.
+ * @param[in] sequence_number Sequence number of the message.
+ * @param[out] lane Lane the message has been inserted in.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t insert_volatile_lane_msg(struct astarte_device_transmission_queue *handle,
+    const struct astarte_device_transmission_queue_msg *msg, uint64_t timestamp_ms,
+    uint64_t sequence_number, astarte_transmission_lane_t *lane);
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+/**
+ * @brief Push a message to the transmission storage.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] msg Message to insert.
+ * @param[in] timestamp_ms Timestamp of the message.
+ * @param[in] sequence_number Sequence number of the message.
+ * @param[in] evict Evict the oldest stored message when the storage is full.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
 static astarte_result_t insert_stored_msg(struct astarte_device_transmission_queue *handle,
     const struct astarte_device_transmission_queue_msg *msg, uint64_t timestamp_ms,
-    uint64_t sequence_number);
+    uint64_t sequence_number, bool evict);
+#endif
+/**
+ * @brief Peek at the next message in the transmission queue.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[out] msg Pointer to a message structure to populate.
+ * @param[in] borrow Point to the buffers of volatile and discard messages instead of copying them.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t peek_msg(struct astarte_device_transmission_queue *handle,
+    struct astarte_device_transmission_queue_msg *msg, bool borrow);
+/**
+ * @brief Peek at the head of a volatile message queue, the borrowed message if it belongs to it.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] msgq Message queue to peek.
+ * @param[in] retention Retention of the messages of the queue.
+ * @param[out] volatile_msg Head of the queue, its buffers are not copied.
+ * @return True if the queue holds a message, false otherwise.
+ */
+static bool peek_volatile_msg(struct astarte_device_transmission_queue *handle,
+    struct k_msgq *msgq, astarte_mapping_retention_t retention,
+    struct astarte_device_transmission_queue_volatile_msg *volatile_msg);
+/**
+ * @brief Take the head of a volatile message queue out of it, making it the borrowed message.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] msgq Message queue of the head.
+ * @param[in] retention Retention of the messages of the queue.
+ * @param[out] msg Message pointing to the buffers of the borrowed message.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t borrow_volatile_msg(struct astarte_device_transmission_queue *handle,
+    struct k_msgq *msgq, astarte_mapping_retention_t retention,
+    struct astarte_device_transmission_queue_msg *msg);
+/**
+ * @brief Discard the borrowed message if it has been taken from the queue with the given retention.
+ *
+ * @details The message is freed right away when it is not on loan, otherwise when its last loan
+ * ends. A message purged while on loan is discarded without touching the queue.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] retention Retention of the queue the message has been taken from.
+ * @return True if a message has been released, false otherwise.
+ */
+static bool release_borrowed_msg(
+    struct astarte_device_transmission_queue *handle, astarte_mapping_retention_t retention);
+/**
+ * @brief Purge the borrowed message if it has been taken from the queue with the given retention.
+ *
+ * @details A message on loan is only detached from the queue, and freed when its last loan ends.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] retention Retention of the queue the message has been taken from.
+ */
+static void purge_borrowed_msg(
+    struct astarte_device_transmission_queue *handle, astarte_mapping_retention_t retention);
+/**
+ * @brief Free the borrowed message and reset its state.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ */
+static void free_borrowed_msg(struct astarte_device_transmission_queue *handle);
+/**
+ * @brief End a loan of the borrowed message, freeing it if it was the last of a detached message.
+ *
+ * @param[in] handle Pointer to the transmission queue that lent the message.
+ */
+static void end_loan(struct astarte_device_transmission_queue *handle);
+/**
+ * @brief Peek at the head of the lane of a run, if it belongs to the run.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] run Run to peek.
+ * @param[out] msg Pointer to a message structure to populate.
+ * @param[in] borrow Point to the buffers of volatile and discard messages instead of copying them.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if the messages of the run
+ * have all been removed, otherwise an error code.
+ */
+static astarte_result_t peek_run(struct astarte_device_transmission_queue *handle,
+    const struct astarte_device_transmission_queue_run *run,
+    struct astarte_device_transmission_queue_msg *msg, bool borrow);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+static astarte_result_t peek_stored_run(struct astarte_device_transmission_queue *handle,
+    const struct astarte_device_transmission_queue_run *run,
+    struct astarte_device_transmission_queue_msg *msg);
 #endif
+/**
+ * @brief Get the sequence number of the head of a lane held in RAM.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] lane Lane to peek, not the stored one.
+ * @param[out] sequence_number Sequence number of the head of the lane.
+ * @return True if the lane holds a message, false otherwise.
+ */
+static bool peek_lane_sequence_number(struct astarte_device_transmission_queue *handle,
+    astarte_transmission_lane_t lane, uint64_t *sequence_number);
+/**
+ * @brief Append a message to the runs, extending the newest run when it belongs to the same lane.
+ *
+ * @details The runs are compacted when full, their size guarantees room for the new run.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] lane Lane the message has been inserted in.
+ * @param[in] sequence_number Sequence number of the message.
+ */
+static void append_run(struct astarte_device_transmission_queue *handle,
+    astarte_transmission_lane_t lane, uint64_t sequence_number);
+/**
+ * @brief Remove the runs of the lanes in RAM whose messages have been evicted.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ */
+static void compact_runs(struct astarte_device_transmission_queue *handle);
+static void pop_run(struct astarte_device_transmission_queue *handle);
+/**
+ * @brief Remove the oldest run if the discarded message was the last one of it.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] lane Lane the message has been discarded from.
+ */
+static void discarded_from_run(
+    struct astarte_device_transmission_queue *handle, astarte_transmission_lane_t lane);
 
+// NOLINTNEXTLINE(readability-identifier-length)
+SCOPE_GUARD_DEFINE(transmission_queue, struct astarte_device_transmission_queue *, queue_lock(_T),
+    queue_unlock(_T));
 ASTARTE_SCOPE_DEFER_DEFINE(astarte_transmission_queue_volatile_msg_cleanup,
     struct astarte_device_transmission_queue_volatile_msg *);
 ASTARTE_SCOPE_DEFER_DEFINE(
@@ -50,34 +202,58 @@ ASTARTE_SCOPE_DEFER_DEFINE(
  ***********************************************/
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-astarte_result_t astarte_transmission_queue_init(
-    struct astarte_device_transmission_queue *handle, astarte_storage_data_t *storage)
+astarte_result_t astarte_transmission_queue_init(struct astarte_device_transmission_queue *handle,
+    astarte_storage_data_t *storage, size_t capacity)
 {
     if (!handle || !storage) {
 #else
-astarte_result_t astarte_transmission_queue_init(struct astarte_device_transmission_queue *handle)
+astarte_result_t astarte_transmission_queue_init(
+    struct astarte_device_transmission_queue *handle, size_t capacity)
 {
     if (!handle) {
 #endif
         ASTARTE_LOG_ERR("NULL parameters provided");
         return ASTARTE_RESULT_INVALID_PARAM;
     }
+    if ((capacity == 0) || (capacity > MAX_CAPACITY)) {
+        ASTARTE_LOG_ERR("Invalid transmission queue capacity %zu", capacity);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
 
     ASTARTE_LOG_DBG("Initializing transmission queue");
 
     memset(handle, 0, sizeof(struct astarte_device_transmission_queue));
+    sys_mutex_init(&handle->mutex);
+
+    // A single block backs the message queues and the runs
+    const size_t volatile_size
+        = capacity * sizeof(struct astarte_device_transmission_queue_volatile_msg);
+    const size_t interface_size
+        = capacity * sizeof(struct astarte_device_transmission_queue_interface_msg);
+    const size_t runs_size = ASTARTE_TRANSMISSION_QUEUE_RUNS(capacity);
+    handle->buffer = astarte_calloc(
+        1, (2 * volatile_size) + interface_size + (runs_size * sizeof(*handle->runs)));
+    if (!handle->buffer) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    handle->capacity = capacity;
+
+    char *buffer = handle->buffer;
+    k_msgq_init(&handle->discard_msgq, buffer,
+        sizeof(struct astarte_device_transmission_queue_volatile_msg), capacity);
+    buffer += volatile_size;
 
-    k_msgq_init(&handle->discard_msgq, handle->discard_msgq_buffer,
-        sizeof(struct astarte_device_transmission_queue_volatile_msg),
-        CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE);
+    k_msgq_init(&handle->volatile_msgq, buffer,
+        sizeof(struct astarte_device_transmission_queue_volatile_msg), capacity);
+    buffer += volatile_size;
 
-    k_msgq_init(&handle->interface_msgq, handle->interface_msgq_buffer,
-        sizeof(struct astarte_device_transmission_queue_interface_msg),
-        CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE);
+    k_msgq_init(&handle->interface_msgq, buffer,
+        sizeof(struct astarte_device_transmission_queue_interface_msg), capacity);
+    buffer += interface_size;
 
-    k_msgq_init(&handle->volatile_msgq, handle->volatile_msgq_buffer,
-        sizeof(struct astarte_device_transmission_queue_volatile_msg),
-        CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE);
+    handle->runs = (struct astarte_device_transmission_queue_run *) buffer;
+    handle->runs_size = runs_size;
 
     handle->system_time_valid = is_system_time_valid();
     if (!handle->system_time_valid) {
@@ -90,6 +266,8 @@ astarte_result_t astarte_transmission_queue_init(struct astarte_device_transmiss
     astarte_result_t ares = astarte_storage_transmission_get_indexes(storage, &indexes);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_WRN("Failed in finding the head and tail from the transmission queue storage.");
+        astarte_free(handle->buffer);
+        handle->buffer = NULL;
         return ASTARTE_RESULT_INTERNAL_ERROR;
     }
 
@@ -102,7 +280,12 @@ astarte_result_t astarte_transmission_queue_init(struct astarte_device_transmiss
         // Resume counting from the next available number
         handle->next_sequence_number = last_seq + 1;
         ASTARTE_LOG_DBG("Recovered highest sequence number from storage: %llu", last_seq);
+        append_run(handle, ASTARTE_TRANSMISSION_LANE_STORED, last_seq);
     } else {
+        // Unreadable stored messages are sent before any new one
+        if (ares != ASTARTE_RESULT_NOT_FOUND) {
+            append_run(handle, ASTARTE_TRANSMISSION_LANE_STORED, UINT64_MAX);
+        }
         // Storage is empty or unreadable, safe to start at 0
         handle->next_sequence_number = 0;
     }
@@ -118,6 +301,12 @@ void astarte_transmission_queue_clear(struct astarte_device_transmission_queue *
     if (!handle) {
         return;
     }
+    scope_guard(transmission_queue)(handle);
+
+    purge_borrowed_msg(handle, ASTARTE_MAPPING_RETENTION_DISCARD);
+    purge_borrowed_msg(handle, ASTARTE_MAPPING_RETENTION_VOLATILE);
+    ASTARTE_LOG_COND_ERR(handle->borrowed_loans > 0,
+        "Transmission queue cleared with %zu borrowed messages on loan", handle->borrowed_loans);
     struct astarte_device_transmission_queue_volatile_msg msg;
     while (k_msgq_get(&handle->discard_msgq, &msg, K_NO_WAIT) == 0) {
         astarte_transmission_queue_volatile_msg_cleanup(&msg);
@@ -126,6 +315,13 @@ void astarte_transmission_queue_clear(struct astarte_device_transmission_queue *
         astarte_transmission_queue_volatile_msg_cleanup(&msg);
     }
     k_msgq_purge(&handle->interface_msgq);
+    handle->runs_head = 0;
+    handle->runs_count = 0;
+    handle->has_peeked = false;
+    astarte_free(handle->buffer);
+    handle->buffer = NULL;
+    handle->runs = NULL;
+    handle->runs_size = 0;
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     astarte_result_t ares = ASTARTE_RESULT_OK;
@@ -141,6 +337,9 @@ void astarte_transmission_queue_purge_discard(struct astarte_device_transmission
     if (!handle) {
         return;
     }
+    scope_guard(transmission_queue)(handle);
+
+    purge_borrowed_msg(handle, ASTARTE_MAPPING_RETENTION_DISCARD);
     struct astarte_device_transmission_queue_volatile_msg msg;
     while (k_msgq_get(&handle->discard_msgq, &msg, K_NO_WAIT) == 0) {
         astarte_transmission_queue_volatile_msg_cleanup(&msg);
@@ -176,20 +375,25 @@ astarte_result_t astarte_transmission_queue_insert(struct astarte_device_transmi
 
     ASTARTE_LOG_DBG("Insert into transmission queue");
 
+    scope_guard(transmission_queue)(handle);
+
     uint64_t timestamp_ms = get_system_timestamp(handle);
     uint64_t seq_num = handle->next_sequence_number++;
     astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_transmission_lane_t lane = ASTARTE_TRANSMISSION_LANE_INTERFACE;
 
     if (msg->operation == ASTARTE_TRANSMISSION_OP_ADD_INTERFACE
         || msg->operation == ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE) {
         ares = insert_interface_msg(&handle->interface_msgq, msg, timestamp_ms, seq_num);
     } else if (msg->retention == ASTARTE_MAPPING_RETENTION_DISCARD) {
+        lane = ASTARTE_TRANSMISSION_LANE_DISCARD;
         ares = insert_volatile_msg(&handle->discard_msgq, msg, timestamp_ms, seq_num);
     } else if (msg->retention == ASTARTE_MAPPING_RETENTION_VOLATILE) {
-        ares = insert_volatile_msg(&handle->volatile_msgq, msg, timestamp_ms, seq_num);
+        ares = insert_volatile_lane_msg(handle, msg, timestamp_ms, seq_num, &lane);
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     } else if (msg->retention == ASTARTE_MAPPING_RETENTION_STORED) {
-        ares = insert_stored_msg(handle, msg, timestamp_ms, seq_num);
+        lane = ASTARTE_TRANSMISSION_LANE_STORED;
+        ares = insert_stored_msg(handle, msg, timestamp_ms, seq_num, true);
 #endif
     } else {
         ASTARTE_LOG_ERR("Message with invalid retention");
@@ -197,6 +401,7 @@ astarte_result_t astarte_transmission_queue_insert(struct astarte_device_transmi
     }
 
     if (ares == ASTARTE_RESULT_OK) {
+        append_run(handle, lane, seq_num);
         if (msg->operation == ASTARTE_TRANSMISSION_OP_DATA) {
             ASTARTE_LOG_DBG("Message queued for %s%s", msg->interface_name, msg->path);
         } else {
@@ -212,111 +417,14 @@ astarte_result_t astarte_transmission_queue_insert(struct astarte_device_transmi
 astarte_result_t astarte_transmission_queue_peek(struct astarte_device_transmission_queue *handle,
     struct astarte_device_transmission_queue_msg *msg)
 {
-    if (!handle || !msg) {
-        ASTARTE_LOG_ERR("Received NULL reference for transmission queue or message");
-        return ASTARTE_RESULT_INVALID_PARAM;
-    }
-
-    astarte_result_t interface_ares = ASTARTE_RESULT_OK;
-    struct astarte_device_transmission_queue_interface_msg interface_msg = { 0 };
-    if (k_msgq_peek(&handle->interface_msgq, &interface_msg) != 0) {
-        interface_ares = ASTARTE_RESULT_NOT_FOUND;
-    }
-
-    astarte_result_t discard_ares = ASTARTE_RESULT_OK;
-    struct astarte_device_transmission_queue_volatile_msg discard_msg = { 0 };
-    if (k_msgq_peek(&handle->discard_msgq, &discard_msg) != 0) {
-        discard_ares = ASTARTE_RESULT_NOT_FOUND;
-    }
-
-    astarte_result_t volatile_ares = ASTARTE_RESULT_OK;
-    struct astarte_device_transmission_queue_volatile_msg volatile_msg = { 0 };
-    if (k_msgq_peek(&handle->volatile_msgq, &volatile_msg) != 0) {
-        volatile_ares = ASTARTE_RESULT_NOT_FOUND;
-    }
-
-#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-    astarte_result_t storage_ares = ASTARTE_RESULT_OK;
-    struct astarte_storage_transmission_msg storage_msg = { 0 };
-    storage_ares = astarte_storage_transmission_peek(
-        handle->storage, &handle->storage_indexes, &storage_msg);
-    if ((storage_ares != ASTARTE_RESULT_OK) && (storage_ares != ASTARTE_RESULT_NOT_FOUND)) {
-        ASTARTE_LOG_ERR("Failed peeking message from storage.");
-        return storage_ares;
-    }
-#endif
-
-    uint64_t volatile_seq
-        = (volatile_ares == ASTARTE_RESULT_OK) ? volatile_msg.sequence_number : UINT64_MAX;
-    uint64_t discard_seq
-        = (discard_ares == ASTARTE_RESULT_OK) ? discard_msg.sequence_number : UINT64_MAX;
-    uint64_t interface_seq
-        = (interface_ares == ASTARTE_RESULT_OK) ? interface_msg.sequence_number : UINT64_MAX;
-#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-    uint64_t storage_seq
-        = (storage_ares == ASTARTE_RESULT_OK) ? storage_msg.sequence_number : UINT64_MAX;
-#else
-    uint64_t storage_seq = UINT64_MAX;
-#endif
-
-    // Calculate the minimum sequence directly to avoid complex boolean chains
-    uint64_t min_seq = interface_seq;
-    if (volatile_seq < min_seq) {
-        min_seq = volatile_seq;
-    }
-    if (discard_seq < min_seq) {
-        min_seq = discard_seq;
-    }
-    if (storage_seq < min_seq) {
-        min_seq = storage_seq;
-    }
-
-    if (min_seq == UINT64_MAX) {
-        return ASTARTE_RESULT_NOT_FOUND;
-    }
-
-#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-    // Evaluate cleanup once.
-    if (min_seq != storage_seq && storage_ares == ASTARTE_RESULT_OK) {
-        astarte_storage_transmission_msg_cleanup(&storage_msg);
-    }
-#endif
-
-    // Interface is the oldest
-    if (min_seq == interface_seq) {
-        memset(msg, 0, sizeof(struct astarte_device_transmission_queue_msg));
-        msg->operation = interface_msg.operation;
-        msg->interface = interface_msg.interface;
-        return ASTARTE_RESULT_OK;
-    }
-
-    // Volatile is the oldest.
-    if (min_seq == volatile_seq) {
-        return astarte_transmission_queue_msg_from_volatile_msg_deep_cpy(msg, &volatile_msg);
-    }
-
-    // Discard is the oldest.
-    if (min_seq == discard_seq) {
-        astarte_result_t ares
-            = astarte_transmission_queue_msg_from_volatile_msg_deep_cpy(msg, &discard_msg);
-        if (ares == ASTARTE_RESULT_OK) {
-            msg->retention = ASTARTE_MAPPING_RETENTION_DISCARD;
-        }
-        return ares;
-    }
+    return peek_msg(handle, msg, false);
+}
 
-    // Storage is the oldest.
-#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
-    msg->interface_name = storage_msg.interface_name;
-    msg->path = storage_msg.path;
-    msg->payload = storage_msg.payload;
-    msg->payload_len = storage_msg.payload_len;
-    msg->qos = storage_msg.qos;
-    msg->retention = ASTARTE_MAPPING_RETENTION_STORED;
-    return ASTARTE_RESULT_OK;
-#else
-    return ASTARTE_RESULT_INTERNAL_ERROR;
-#endif
+astarte_result_t astarte_transmission_queue_peek_borrow(
+    struct astarte_device_transmission_queue *handle,
+    struct astarte_device_transmission_queue_msg *msg)
+{
+    return peek_msg(handle, msg, true);
 }
 
 astarte_result_t astarte_transmission_queue_discard_by_retention(
@@ -327,19 +435,25 @@ astarte_result_t astarte_transmission_queue_discard_by_retention(
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
+    scope_guard(transmission_queue)(handle);
+
     struct astarte_device_transmission_queue_volatile_msg volatile_msg = { 0 };
 
     if (retention == ASTARTE_MAPPING_RETENTION_VOLATILE) {
-        if (k_msgq_get(&handle->volatile_msgq, &volatile_msg, K_NO_WAIT) == 0) {
+        if (release_borrowed_msg(handle, retention)
+            || (k_msgq_get(&handle->volatile_msgq, &volatile_msg, K_NO_WAIT) == 0)) {
             astarte_transmission_queue_volatile_msg_cleanup(&volatile_msg);
+            discarded_from_run(handle, ASTARTE_TRANSMISSION_LANE_VOLATILE);
             return ASTARTE_RESULT_OK;
         }
         return ASTARTE_RESULT_NOT_FOUND;
     }
 
     if (retention == ASTARTE_MAPPING_RETENTION_DISCARD) {
-        if (k_msgq_get(&handle->discard_msgq, &volatile_msg, K_NO_WAIT) == 0) {
+        if (release_borrowed_msg(handle, retention)
+            || (k_msgq_get(&handle->discard_msgq, &volatile_msg, K_NO_WAIT) == 0)) {
             astarte_transmission_queue_volatile_msg_cleanup(&volatile_msg);
+            discarded_from_run(handle, ASTARTE_TRANSMISSION_LANE_DISCARD);
             return ASTARTE_RESULT_OK;
         }
         return ASTARTE_RESULT_NOT_FOUND;
@@ -347,7 +461,12 @@ astarte_result_t astarte_transmission_queue_discard_by_retention(
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     if (retention == ASTARTE_MAPPING_RETENTION_STORED) {
-        return astarte_storage_transmission_discard(handle->storage, &handle->storage_indexes);
+        astarte_result_t ares
+            = astarte_storage_transmission_discard(handle->storage, &handle->storage_indexes);
+        if (ares == ASTARTE_RESULT_OK) {
+            discarded_from_run(handle, ASTARTE_TRANSMISSION_LANE_STORED);
+        }
+        return ares;
     }
 #endif
 
@@ -363,20 +482,66 @@ astarte_result_t astarte_transmission_queue_discard_interface(
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
+    scope_guard(transmission_queue)(handle);
+
     struct astarte_device_transmission_queue_interface_msg interface_msg = { 0 };
 
     if (k_msgq_get(&handle->interface_msgq, &interface_msg, K_NO_WAIT) == 0) {
+        discarded_from_run(handle, ASTARTE_TRANSMISSION_LANE_INTERFACE);
         return ASTARTE_RESULT_OK;
     }
 
     return ASTARTE_RESULT_NOT_FOUND;
 }
 
+astarte_result_t astarte_transmission_queue_flush(
+    struct astarte_device_transmission_queue *handle, bool force)
+{
+    if (!handle) {
+        ASTARTE_LOG_ERR("Received NULL reference for transmission queue");
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+    scope_guard(transmission_queue)(handle);
+
+    return astarte_storage_transmission_flush(handle->storage, &handle->storage_indexes, force);
+#else
+    ARG_UNUSED(force);
+    return ASTARTE_RESULT_OK;
+#endif
+}
+
+k_timepoint_t astarte_transmission_queue_get_flush_deadline(
+    struct astarte_device_transmission_queue *handle)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+    if (handle) {
+        return astarte_storage_transmission_get_flush_deadline(handle->storage);
+    }
+#else
+    ARG_UNUSED(handle);
+#endif
+    return sys_timepoint_calc(K_FOREVER);
+}
+
 void astarte_transmission_queue_msg_cleanup(struct astarte_device_transmission_queue_msg *msg)
 {
     if (!msg) {
         return;
     }
+    if (msg->borrowed) {
+        struct astarte_device_transmission_queue *lender = msg->lender;
+        msg->interface_name = NULL;
+        msg->path = NULL;
+        msg->payload = NULL;
+        msg->borrowed = false;
+        msg->lender = NULL;
+        if (lender) {
+            end_loan(lender);
+        }
+        return;
+    }
     astarte_free(msg->interface_name);
     msg->interface_name = NULL;
     astarte_free(msg->path);
@@ -389,6 +554,20 @@ void astarte_transmission_queue_msg_cleanup(struct astarte_device_transmission_q
  *         Static functions definitions         *
  ***********************************************/
 
+static void queue_lock(struct astarte_device_transmission_queue *handle)
+{
+    int mutex_rc = sys_mutex_lock(&handle->mutex, K_FOREVER);
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission queue lock failed with %d", mutex_rc);
+    __ASSERT_NO_MSG(mutex_rc == 0);
+}
+
+static void queue_unlock(struct astarte_device_transmission_queue *handle)
+{
+    int mutex_rc = sys_mutex_unlock(&handle->mutex);
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission queue unlock failed with %d", mutex_rc);
+    __ASSERT_NO_MSG(mutex_rc == 0);
+}
+
 static bool is_system_time_valid()
 {
     struct timespec timespec;
@@ -477,10 +656,32 @@ static astarte_result_t insert_interface_msg(struct k_msgq *msgq,
     return ASTARTE_RESULT_OK;
 }
 
+static astarte_result_t insert_volatile_lane_msg(struct astarte_device_transmission_queue *handle,
+    const struct astarte_device_transmission_queue_msg *msg, uint64_t timestamp_ms,
+    uint64_t sequence_number, astarte_transmission_lane_t *lane)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_SPILL
+    // The run index keeps spilled messages in order with the ones still in RAM
+    if (k_msgq_num_free_get(&handle->volatile_msgq) == 0) {
+        astarte_result_t ares
+            = insert_stored_msg(handle, msg, timestamp_ms, sequence_number, false);
+        if (ares == ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_DBG("Volatile queue full, spilled %s%s to the storage",
+                msg->interface_name, msg->path);
+            *lane = ASTARTE_TRANSMISSION_LANE_STORED;
+            return ASTARTE_RESULT_OK;
+        }
+        ASTARTE_LOG_WRN("Spilling to the storage failed (%d), evicting a volatile message", ares);
+    }
+#endif
+    *lane = ASTARTE_TRANSMISSION_LANE_VOLATILE;
+    return insert_volatile_msg(&handle->volatile_msgq, msg, timestamp_ms, sequence_number);
+}
+
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
 static astarte_result_t insert_stored_msg(struct astarte_device_transmission_queue *handle,
     const struct astarte_device_transmission_queue_msg *msg, uint64_t timestamp_ms,
-    uint64_t sequence_number)
+    uint64_t sequence_number, bool evict)
 {
     struct astarte_storage_transmission_msg storage_msg = {
         .interface_name = msg->interface_name,
@@ -491,11 +692,15 @@ static astarte_result_t insert_stored_msg(struct astarte_device_transmission_que
         .timestamp = timestamp_ms,
         .sequence_number = sequence_number,
     };
+    // Without a valid system time the message is stamped with zero and never expires
+    if ((msg->expiry > 0) && (timestamp_ms > 0)) {
+        storage_msg.expiry_timestamp = timestamp_ms + ((uint64_t) msg->expiry * MSEC_PER_SEC);
+    }
 
     astarte_result_t ares = astarte_storage_transmission_push(
         handle->storage, &handle->storage_indexes, &storage_msg);
 
-    if (ares != ASTARTE_RESULT_OK) {
+    if ((ares != ASTARTE_RESULT_OK) && evict) {
         ASTARTE_LOG_WRN(
             "Transmission storage push failed (%d). Evicting oldest message to fit %s%s", ares,
             storage_msg.interface_name, storage_msg.path);
@@ -514,6 +719,337 @@ static astarte_result_t insert_stored_msg(struct astarte_device_transmission_que
             return ASTARTE_RESULT_MQTT_ERROR;
         }
     }
+    return ares;
+}
+#endif
+
+static astarte_result_t peek_msg(struct astarte_device_transmission_queue *handle,
+    struct astarte_device_transmission_queue_msg *msg, bool borrow)
+{
+    if (!handle || !msg) {
+        ASTARTE_LOG_ERR("Received NULL reference for transmission queue or message");
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    scope_guard(transmission_queue)(handle);
+
+    handle->has_peeked = false;
+    // Only the lane of the oldest run is read, runs emptied by evictions are skipped
+    while (handle->runs_count > 0) {
+        astarte_result_t ares = peek_run(handle, &handle->runs[handle->runs_head], msg, borrow);
+        if (ares != ASTARTE_RESULT_NOT_FOUND) {
+            return ares;
+        }
+        pop_run(handle);
+    }
+
+    return ASTARTE_RESULT_NOT_FOUND;
+}
+
+static astarte_result_t peek_run(struct astarte_device_transmission_queue *handle,
+    const struct astarte_device_transmission_queue_run *run,
+    struct astarte_device_transmission_queue_msg *msg, bool borrow)
+{
+    if (run->lane == ASTARTE_TRANSMISSION_LANE_INTERFACE) {
+        struct astarte_device_transmission_queue_interface_msg interface_msg = { 0 };
+        if ((k_msgq_peek(&handle->interface_msgq, &interface_msg) != 0)
+            || (interface_msg.sequence_number > run->last_sequence_number)) {
+            return ASTARTE_RESULT_NOT_FOUND;
+        }
+        handle->peeked_sequence_number = interface_msg.sequence_number;
+        handle->has_peeked = true;
+
+        memset(msg, 0, sizeof(struct astarte_device_transmission_queue_msg));
+        msg->operation = interface_msg.operation;
+        msg->interface = interface_msg.interface;
+        return ASTARTE_RESULT_OK;
+    }
+
+    if ((run->lane == ASTARTE_TRANSMISSION_LANE_DISCARD)
+        || (run->lane == ASTARTE_TRANSMISSION_LANE_VOLATILE)) {
+        bool discard = (run->lane == ASTARTE_TRANSMISSION_LANE_DISCARD);
+        struct k_msgq *msgq = discard ? &handle->discard_msgq : &handle->volatile_msgq;
+        astarte_mapping_retention_t retention
+            = discard ? ASTARTE_MAPPING_RETENTION_DISCARD : ASTARTE_MAPPING_RETENTION_VOLATILE;
+
+        struct astarte_device_transmission_queue_volatile_msg volatile_msg = { 0 };
+        if (!peek_volatile_msg(handle, msgq, retention, &volatile_msg)
+            || (volatile_msg.sequence_number > run->last_sequence_number)) {
+            return ASTARTE_RESULT_NOT_FOUND;
+        }
+        handle->peeked_sequence_number = volatile_msg.sequence_number;
+        handle->has_peeked = true;
+
+        if (borrow) {
+            return borrow_volatile_msg(handle, msgq, retention, msg);
+        }
+        astarte_result_t ares
+            = astarte_transmission_queue_msg_from_volatile_msg_deep_cpy(msg, &volatile_msg);
+        if (ares == ASTARTE_RESULT_OK) {
+            msg->retention = retention;
+        }
+        return ares;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+    return peek_stored_run(handle, run, msg);
+#else
+    ASTARTE_LOG_ERR("Run of stored messages without permanent storage");
+    return ASTARTE_RESULT_INTERNAL_ERROR;
+#endif
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+static astarte_result_t peek_stored_run(struct astarte_device_transmission_queue *handle,
+    const struct astarte_device_transmission_queue_run *run,
+    struct astarte_device_transmission_queue_msg *msg)
+{
+    // Expired stored messages would be thrown away by Astarte, they are dropped before sending
+    if (handle->system_time_valid) {
+        uint32_t dropped = 0;
+        astarte_result_t drop_ares = astarte_storage_transmission_drop_expired(handle->storage,
+            &handle->storage_indexes, get_system_timestamp(handle), &dropped);
+        // A failed drop leaves the expired messages to be sent
+        if ((drop_ares == ASTARTE_RESULT_OK) && (dropped > 0)) {
+            ASTARTE_LOG_DBG("Dropped %u expired stored records", dropped);
+        }
+    }
+
+    struct astarte_storage_transmission_msg storage_msg = { 0 };
+    astarte_result_t ares = astarte_storage_transmission_peek(
+        handle->storage, &handle->storage_indexes, &storage_msg);
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return ares;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed peeking message from storage.");
+        return ares;
+    }
+    // The stored messages of the run have been dropped or evicted
+    if (storage_msg.sequence_number > run->last_sequence_number) {
+        astarte_storage_transmission_msg_cleanup(&storage_msg);
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+    handle->peeked_sequence_number = storage_msg.sequence_number;
+    handle->has_peeked = true;
+
+    memset(msg, 0, sizeof(struct astarte_device_transmission_queue_msg));
+    msg->interface_name = storage_msg.interface_name;
+    msg->path = storage_msg.path;
+    msg->payload = storage_msg.payload;
+    msg->payload_len = storage_msg.payload_len;
+    msg->qos = storage_msg.qos;
+    msg->retention = ASTARTE_MAPPING_RETENTION_STORED;
     return ASTARTE_RESULT_OK;
 }
 #endif
+
+static bool peek_lane_sequence_number(struct astarte_device_transmission_queue *handle,
+    astarte_transmission_lane_t lane, uint64_t *sequence_number)
+{
+    if (lane == ASTARTE_TRANSMISSION_LANE_INTERFACE) {
+        struct astarte_device_transmission_queue_interface_msg interface_msg = { 0 };
+        if (k_msgq_peek(&handle->interface_msgq, &interface_msg) != 0) {
+            return false;
+        }
+        *sequence_number = interface_msg.sequence_number;
+        return true;
+    }
+
+    struct astarte_device_transmission_queue_volatile_msg volatile_msg = { 0 };
+    bool found = false;
+    if (lane == ASTARTE_TRANSMISSION_LANE_DISCARD) {
+        found = peek_volatile_msg(
+            handle, &handle->discard_msgq, ASTARTE_MAPPING_RETENTION_DISCARD, &volatile_msg);
+    } else {
+        found = peek_volatile_msg(
+            handle, &handle->volatile_msgq, ASTARTE_MAPPING_RETENTION_VOLATILE, &volatile_msg);
+    }
+    *sequence_number = volatile_msg.sequence_number;
+    return found;
+}
+
+static void append_run(struct astarte_device_transmission_queue *handle,
+    astarte_transmission_lane_t lane, uint64_t sequence_number)
+{
+    if (handle->runs_count > 0) {
+        struct astarte_device_transmission_queue_run *newest = &handle->runs[(
+            handle->runs_head + handle->runs_count - 1) % handle->runs_size];
+        if (newest->lane == lane) {
+            newest->last_sequence_number = MAX(newest->last_sequence_number, sequence_number);
+            return;
+        }
+    }
+
+    if (handle->runs_count == handle->runs_size) {
+        compact_runs(handle);
+    }
+    // Once compacted each run in RAM holds a message, ASTARTE_TRANSMISSION_QUEUE_RUNS leaves room
+    __ASSERT_NO_MSG(handle->runs_count < handle->runs_size);
+
+    struct astarte_device_transmission_queue_run *run = &handle->runs[(
+        handle->runs_head + handle->runs_count) % handle->runs_size];
+    run->lane = lane;
+    run->last_sequence_number = sequence_number;
+    handle->runs_count++;
+}
+
+static void compact_runs(struct astarte_device_transmission_queue *handle)
+{
+    // Runs are moved towards the oldest one, never over a run still to be read
+    size_t count = 0;
+    for (size_t i = 0; i < handle->runs_count; i++) {
+        struct astarte_device_transmission_queue_run run
+            = handle->runs[(handle->runs_head + i) % handle->runs_size];
+
+        // Lanes in RAM evict their oldest messages first, a run is empty when the head is newer
+        uint64_t head_sequence_number = 0;
+        if ((run.lane != ASTARTE_TRANSMISSION_LANE_STORED)
+            && (!peek_lane_sequence_number(handle, run.lane, &head_sequence_number)
+                || (head_sequence_number > run.last_sequence_number))) {
+            continue;
+        }
+
+        if (count > 0) {
+            struct astarte_device_transmission_queue_run *previous = &handle->runs[(
+                handle->runs_head + count - 1) % handle->runs_size];
+            if (previous->lane == run.lane) {
+                previous->last_sequence_number = run.last_sequence_number;
+                continue;
+            }
+        }
+        handle->runs[(handle->runs_head + count) % handle->runs_size] = run;
+        count++;
+    }
+
+    ASTARTE_LOG_DBG("Compacted transmission queue runs from %zu to %zu", handle->runs_count, count);
+    handle->runs_count = count;
+    handle->has_peeked = false;
+}
+
+static void pop_run(struct astarte_device_transmission_queue *handle)
+{
+    handle->runs_head = (handle->runs_head + 1) % handle->runs_size;
+    handle->runs_count--;
+}
+
+static void discarded_from_run(
+    struct astarte_device_transmission_queue *handle, astarte_transmission_lane_t lane)
+{
+    // Popping the run now spares reading the next stored message when it is not the head
+    if (handle->has_peeked && (handle->runs_count > 0)) {
+        const struct astarte_device_transmission_queue_run *oldest
+            = &handle->runs[handle->runs_head];
+        if ((oldest->lane == lane)
+            && (oldest->last_sequence_number == handle->peeked_sequence_number)) {
+            pop_run(handle);
+        }
+    }
+    handle->has_peeked = false;
+}
+
+static bool peek_volatile_msg(struct astarte_device_transmission_queue *handle,
+    struct k_msgq *msgq, astarte_mapping_retention_t retention,
+    struct astarte_device_transmission_queue_volatile_msg *volatile_msg)
+{
+    // The borrowed message has been taken out of its queue but it is still its head
+    if (handle->has_borrowed_msg && !handle->borrowed_detached
+        && (handle->borrowed_retention == retention)) {
+        *volatile_msg = handle->borrowed_msg;
+        return true;
+    }
+    return (k_msgq_peek(msgq, volatile_msg) == 0);
+}
+
+static astarte_result_t borrow_volatile_msg(struct astarte_device_transmission_queue *handle,
+    struct k_msgq *msgq, astarte_mapping_retention_t retention,
+    struct astarte_device_transmission_queue_msg *msg)
+{
+    if ((handle->borrowed_loans > 0) && (handle->borrower != k_current_get())) {
+        ASTARTE_LOG_ERR("The borrowed message is on loan to another thread");
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    if (handle->has_borrowed_msg
+        && (handle->borrowed_detached || (handle->borrowed_retention != retention))) {
+        ASTARTE_LOG_ERR("A message is already borrowed from another queue");
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    if (!handle->has_borrowed_msg) {
+        // An insertion could have evicted the peeked head, the current one is borrowed instead
+        if (k_msgq_get(msgq, &handle->borrowed_msg, K_NO_WAIT) != 0) {
+            return ASTARTE_RESULT_NOT_FOUND;
+        }
+        handle->borrowed_retention = retention;
+        handle->has_borrowed_msg = true;
+    }
+
+    memset(msg, 0, sizeof(struct astarte_device_transmission_queue_msg));
+    msg->interface_name = handle->borrowed_msg.interface_name;
+    msg->path = handle->borrowed_msg.path;
+    msg->payload = handle->borrowed_msg.payload;
+    msg->payload_len = handle->borrowed_msg.payload_len;
+    msg->qos = handle->borrowed_msg.qos;
+    msg->retention = retention;
+    msg->borrowed = true;
+    msg->lender = handle;
+    handle->borrowed_loans++;
+    handle->borrower = k_current_get();
+    return ASTARTE_RESULT_OK;
+}
+
+static bool release_borrowed_msg(
+    struct astarte_device_transmission_queue *handle, astarte_mapping_retention_t retention)
+{
+    if (!handle->has_borrowed_msg || (handle->borrowed_retention != retention)) {
+        return false;
+    }
+    if (handle->borrowed_detached) {
+        // Purged while being transmitted, the discard of its borrower refers to it
+        bool purged = handle->borrowed_purged;
+        handle->borrowed_purged = false;
+        return purged;
+    }
+    if (handle->borrowed_loans > 0) {
+        handle->borrowed_detached = true;
+        return true;
+    }
+    free_borrowed_msg(handle);
+    return true;
+}
+
+static void purge_borrowed_msg(
+    struct astarte_device_transmission_queue *handle, astarte_mapping_retention_t retention)
+{
+    if (!handle->has_borrowed_msg || handle->borrowed_detached
+        || (handle->borrowed_retention != retention)) {
+        return;
+    }
+    if (handle->borrowed_loans > 0) {
+        handle->borrowed_detached = true;
+        handle->borrowed_purged = true;
+        return;
+    }
+    free_borrowed_msg(handle);
+}
+
+static void free_borrowed_msg(struct astarte_device_transmission_queue *handle)
+{
+    astarte_transmission_queue_volatile_msg_cleanup(&handle->borrowed_msg);
+    handle->has_borrowed_msg = false;
+    handle->borrowed_detached = false;
+    handle->borrowed_purged = false;
+}
+
+static void end_loan(struct astarte_device_transmission_queue *handle)
+{
+    scope_guard(transmission_queue)(handle);
+
+    if (handle->borrowed_loans == 0) {
+        ASTARTE_LOG_ERR("No borrowed message is on loan");
+        return;
+    }
+    handle->borrowed_loans--;
+    if ((handle->borrowed_loans == 0) && handle->borrowed_detached) {
+        free_borrowed_msg(handle);
+    }
+}
@@ -8,15 +8,62 @@
 
 #include <string.h>
 
+#include <zephyr/kernel.h>
+
 #include "alloc.h"
 
 #include "log.h"
 ASTARTE_LOG_MODULE_DECLARE(astarte_device, CONFIG_ASTARTE_DEVICE_SDK_DEVICE_LOG_LEVEL);
 
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL
+// Alignment of the blocks of the slabs, the payload is copied bytewise
+#define MSG_POOL_ALIGN 4
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+K_MEM_SLAB_DEFINE_STATIC(msg_pool_small,
+    ROUND_UP(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL_SMALL_BLOCK_SIZE,
+        MSG_POOL_ALIGN),
+    CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL_SMALL_BLOCKS, MSG_POOL_ALIGN);
+K_MEM_SLAB_DEFINE_STATIC(msg_pool_medium,
+    ROUND_UP(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL_MEDIUM_BLOCK_SIZE,
+        MSG_POOL_ALIGN),
+    CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL_MEDIUM_BLOCKS, MSG_POOL_ALIGN);
+K_MEM_SLAB_DEFINE_STATIC(msg_pool_large,
+    ROUND_UP(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL_LARGE_BLOCK_SIZE,
+        MSG_POOL_ALIGN),
+    CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL_LARGE_BLOCKS, MSG_POOL_ALIGN);
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+// Ordered by block size, the first slab with a free block large enough is used
+static struct k_mem_slab *const msg_pools[] = {
+    &msg_pool_small,
+    &msg_pool_medium,
+    &msg_pool_large,
+};
+#endif
+
 /************************************************
  *         Static functions declaration         *
  ***********************************************/
 
+/**
+ * @brief Allocate the block holding the interface name, path and payload of a volatile message.
+ *
+ * @param[in] size Size of the block.
+ * @return Pointer to the block, NULL if out of memory.
+ */
+static void *msg_block_alloc(size_t size);
+/**
+ * @brief Free a block allocated with #msg_block_alloc.
+ *
+ * @param[in] block Pointer to the block, can be NULL.
+ */
+static void msg_block_free(void *block);
+
 ASTARTE_SCOPE_DEFER_DEFINE(astarte_transmission_queue_volatile_msg_cleanup,
     struct astarte_device_transmission_queue_volatile_msg *);
 ASTARTE_SCOPE_DEFER_DEFINE(
@@ -44,29 +91,26 @@ astarte_result_t astarte_transmission_queue_volatile_msg_init(
     local_volatile_msg.sequence_number = sequence_number;
     local_volatile_msg.payload_len = queue_msg->payload_len;
 
-    size_t interface_name_len = strlen(queue_msg->interface_name);
-    local_volatile_msg.interface_name = astarte_calloc(interface_name_len + 1, sizeof(char));
-    if (!local_volatile_msg.interface_name) {
-        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
-        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    // The interface name, path and payload share a single block starting with the name
+    size_t interface_name_size = strlen(queue_msg->interface_name) + 1;
+    size_t path_size = strlen(queue_msg->path) + 1;
+    size_t payload_size = 0;
+    if (queue_msg->payload_len > 0 && queue_msg->payload) {
+        payload_size = (size_t) queue_msg->payload_len;
     }
-    memcpy(local_volatile_msg.interface_name, queue_msg->interface_name, interface_name_len);
 
-    size_t path_len = strlen(queue_msg->path);
-    local_volatile_msg.path = astarte_calloc(path_len + 1, sizeof(char));
-    if (!local_volatile_msg.path) {
+    char *block = msg_block_alloc(interface_name_size + path_size + payload_size);
+    if (!block) {
         ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
-    memcpy(local_volatile_msg.path, queue_msg->path, path_len);
-
-    if (queue_msg->payload_len > 0 && queue_msg->payload) {
-        local_volatile_msg.payload = astarte_malloc(queue_msg->payload_len);
-        if (!local_volatile_msg.payload) {
-            ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
-            return ASTARTE_RESULT_OUT_OF_MEMORY;
-        }
-        memcpy(local_volatile_msg.payload, queue_msg->payload, queue_msg->payload_len);
+    local_volatile_msg.interface_name = block;
+    memcpy(local_volatile_msg.interface_name, queue_msg->interface_name, interface_name_size);
+    local_volatile_msg.path = block + interface_name_size;
+    memcpy(local_volatile_msg.path, queue_msg->path, path_size);
+    if (payload_size > 0) {
+        local_volatile_msg.payload = block + interface_name_size + path_size;
+        memcpy(local_volatile_msg.payload, queue_msg->payload, payload_size);
     }
 
     *volatile_msg = local_volatile_msg;
@@ -136,10 +180,44 @@ void astarte_transmission_queue_volatile_msg_cleanup(
     if (!msg) {
         return;
     }
-    astarte_free(msg->interface_name);
+    // The path and payload are part of the block of the interface name
+    msg_block_free(msg->interface_name);
     msg->interface_name = NULL;
-    astarte_free(msg->path);
     msg->path = NULL;
-    astarte_free(msg->payload);
     msg->payload = NULL;
 }
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static void *msg_block_alloc(size_t size)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL
+    for (size_t i = 0; i < ARRAY_SIZE(msg_pools); i++) {
+        void *block = NULL;
+        if ((size <= msg_pools[i]->info.block_size)
+            && (k_mem_slab_alloc(msg_pools[i], &block, K_NO_WAIT) == 0)) {
+            return block;
+        }
+    }
+    ASTARTE_LOG_DBG("No slab block for a %zu bytes message, allocating it on the heap", size);
+#endif
+    return astarte_malloc(size);
+}
+
+static void msg_block_free(void *block)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL
+    for (size_t i = 0; i < ARRAY_SIZE(msg_pools); i++) {
+        struct k_mem_slab *pool = msg_pools[i];
+        const char *start = pool->buffer;
+        const char *end = start + ((size_t) pool->info.num_blocks * pool->info.block_size);
+        if (((const char *) block >= start) && ((const char *) block < end)) {
+            k_mem_slab_free(pool, block);
+            return;
+        }
+    }
+#endif
+    astarte_free(block);
+}
@@ -0,0 +1,599 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "device/worker.h"
+
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/mutex.h>
+#include <zephyr/sys/slist.h>
+
+#if defined(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER)                               \
+    || defined(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX)
+#include <zephyr/zvfs/eventfd.h>
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+#include "storage/core.h"
+#endif
+
+#include "device/dispatcher.h"
+#include "device/session_manager.h"
+#include "mqtt/pubsub.h"
+
+#include "log.h"
+ASTARTE_LOG_MODULE_DECLARE(astarte_device, CONFIG_ASTARTE_DEVICE_SDK_DEVICE_LOG_LEVEL);
+
+#define POLLING_ERROR_RETRY_DELAY_MS 50
+#define TRANSMISSION_EMPTY_QUEUE_WAITING_MS 100
+#define TRANSMISSION_EVENT_WAITING_MS 50
+#define TRANSMISSION_ERROR_RETRY_DELAY_MS 50
+
+/************************************************
+ *         Static variables declaration         *
+ ***********************************************/
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+static K_KERNEL_STACK_DEFINE(
+    worker_thread_stack, CONFIG_ASTARTE_DEVICE_SDK_WORKER_THREAD_STACK_SIZE);
+static struct k_thread worker_thread;
+static SYS_MUTEX_DEFINE(worker_mutex);
+/** @brief Devices served by the worker thread, protected by #worker_mutex. */
+static sys_slist_t worker_devices = SYS_SLIST_STATIC_INIT(&worker_devices);
+/** @brief Set while the worker thread is serving devices, protected by #worker_mutex. */
+static bool worker_running = false;
+/** @brief Set once the worker thread has been created, protected by #worker_mutex. */
+static bool worker_started = false;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+/** @brief Event file descriptor waking up the worker thread while it waits for the sockets. */
+static int worker_wakeup_fd = -1;
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+static K_KERNEL_STACK_DEFINE(
+    rx_thread_stack, CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_RX_THREAD_STACK_SIZE);
+static struct k_thread rx_thread;
+static SYS_MUTEX_DEFINE(rx_mutex);
+/** @brief Devices served by the reception thread, protected by #rx_mutex. */
+static sys_slist_t rx_devices = SYS_SLIST_STATIC_INIT(&rx_devices);
+/** @brief Set while the reception thread is serving devices, protected by #rx_mutex. */
+static bool rx_running = false;
+/** @brief Set once the reception thread has been created, protected by #rx_mutex. */
+static bool rx_started = false;
+/** @brief Event file descriptor waking up the reception thread when the sockets change. */
+static int rx_wakeup_fd = -1;
+#endif
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static void worker_thread_entry(void * /*par1*/, void * /*par2*/, void * /*par3*/);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+static void rx_thread_entry(void * /*par1*/, void * /*par2*/, void * /*par3*/);
+/**
+ * @brief Hands the MQTT socket of a device to the reception thread.
+ *
+ * @details Also resumes the reception for the device if it has been throttled, to be called once
+ * the MQTT events of the device have been dispatched.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @param[in] fd MQTT socket to poll, negative if the socket should not be polled.
+ */
+static void update_rx(astarte_device_handle_t device, int fd);
+#endif
+/**
+ * @brief Runs a device and prepares the poll of its MQTT socket.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @param[out] poll_fd Poll entry for the MQTT socket of the device.
+ * @param[inout] deadline Latest time the worker should run the device again at.
+ */
+static void run_device(
+    astarte_device_handle_t device, struct zsock_pollfd *poll_fd, k_timepoint_t *deadline);
+/**
+ * @brief Processes the outcome of a successful poll of the MQTT socket of a device.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @param[in] poll_fd Poll entry for the MQTT socket of the device.
+ * @return True if the processing failed, false otherwise.
+ */
+static bool process_device_poll(astarte_device_handle_t device, const struct zsock_pollfd *poll_fd);
+/**
+ * @brief Waits for the MQTT sockets, a wakeup of the worker or the deadline.
+ *
+ * @param[inout] poll_fds Poll entries, may be empty.
+ * @param[in] poll_fds_count Number of poll entries.
+ * @param[in] deadline Latest time the wait returns at.
+ * @return Return code of the poll, zero when nothing has been polled.
+ */
+static int wait_for_work(struct zsock_pollfd *poll_fds, int poll_fds_count, k_timepoint_t deadline);
+/**
+ * @brief Processes the messages in the transmission queue in a single burst.
+ *
+ * @details Stops when the queue is empty, the pacing tokens are exhausted, the MQTT in-flight
+ * window is full or a transmission fails. A burst never exceeds a full bucket of tokens plus the
+ * in-flight window.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @return Milliseconds to wait before processing the queue again, SYS_FOREVER_MS if it is empty or
+ * waiting for an acknowledgement.
+ */
+static int32_t process_transmission_queue(struct astarte_device *device);
+/**
+ * @brief Processes the message at the head of the transmission queue, if any.
+ *
+ * @details QoS 1 and 2 messages are paced by the MQTT in-flight window when enabled, all the others
+ * by the transmission tokens.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @return Milliseconds to wait before processing the queue again, SYS_FOREVER_MS if it is empty or
+ * waiting for an acknowledgement.
+ */
+static int32_t process_transmission_queue_head(struct astarte_device *device);
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_device_worker_add(astarte_device_handle_t device)
+{
+    sys_mutex_lock(&worker_mutex, K_FOREVER);
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+    // Created once and kept for the lifetime of the application
+    if (worker_wakeup_fd < 0) {
+        worker_wakeup_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+        if (worker_wakeup_fd < 0) {
+            ASTARTE_LOG_ERR("Failed creating the worker wakeup event: %d", errno);
+            sys_mutex_unlock(&worker_mutex);
+            return ASTARTE_RESULT_INTERNAL_ERROR;
+        }
+    }
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    if (rx_wakeup_fd < 0) {
+        rx_wakeup_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+        if (rx_wakeup_fd < 0) {
+            ASTARTE_LOG_ERR("Failed creating the reception wakeup event: %d", errno);
+            sys_mutex_unlock(&worker_mutex);
+            return ASTARTE_RESULT_INTERNAL_ERROR;
+        }
+    }
+
+    sys_mutex_lock(&rx_mutex, K_FOREVER);
+    device->rx_fd = -1;
+    device->rx_poll_index = -1;
+    device->rx_throttled = false;
+    sys_slist_append(&rx_devices, &device->rx_node);
+    if (!rx_running) {
+        if (rx_started) {
+            k_thread_join(&rx_thread, K_FOREVER);
+        }
+
+        ASTARTE_LOG_DBG("Starting the Astarte reception thread");
+        k_thread_create(&rx_thread, rx_thread_stack, K_KERNEL_STACK_SIZEOF(rx_thread_stack),
+            rx_thread_entry, NULL, NULL, NULL,
+            K_PRIO_PREEMPT(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_RX_THREAD_PRIORITY), 0, K_NO_WAIT);
+        rx_started = true;
+        rx_running = true;
+    }
+    sys_mutex_unlock(&rx_mutex);
+#endif
+
+    device->worker_poll_index = -1;
+    sys_slist_append(&worker_devices, &device->worker_node);
+
+    if (!worker_running) {
+        // A previous worker thread might still be returning after serving its last device
+        if (worker_started) {
+            k_thread_join(&worker_thread, K_FOREVER);
+        }
+
+        ASTARTE_LOG_DBG("Starting the Astarte worker thread");
+        k_thread_create(&worker_thread, worker_thread_stack,
+            K_KERNEL_STACK_SIZEOF(worker_thread_stack), worker_thread_entry, NULL, NULL, NULL,
+            K_PRIO_PREEMPT(CONFIG_ASTARTE_DEVICE_SDK_WORKER_THREAD_PRIORITY), 0, K_NO_WAIT);
+        worker_started = true;
+        worker_running = true;
+    }
+
+    sys_mutex_unlock(&worker_mutex);
+
+    astarte_device_worker_wake();
+    return ASTARTE_RESULT_OK;
+}
+
+void astarte_device_worker_remove(astarte_device_handle_t device)
+{
+    // The worker thread holds the mutex whenever it accesses the devices
+    sys_mutex_lock(&worker_mutex, K_FOREVER);
+    sys_slist_find_and_remove(&worker_devices, &device->worker_node);
+    sys_mutex_unlock(&worker_mutex);
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    // The reception thread holds its own mutex while accessing the devices
+    sys_mutex_lock(&rx_mutex, K_FOREVER);
+    sys_slist_find_and_remove(&rx_devices, &device->rx_node);
+    sys_mutex_unlock(&rx_mutex);
+    (void) zvfs_eventfd_write(rx_wakeup_fd, 1);
+#endif
+
+    // Let the worker recompute its deadline or terminate if this was the last device
+    astarte_device_worker_wake();
+}
+
+void astarte_device_worker_wake(void)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+    if (worker_wakeup_fd >= 0) {
+        // The counter only needs to be non zero, overflowing it is not an issue
+        (void) zvfs_eventfd_write(worker_wakeup_fd, 1);
+    }
+#endif
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static void worker_thread_entry(void * /*par1*/, void * /*par2*/, void * /*par3*/)
+{
+    // One entry for each device socket plus the wakeup event
+    struct zsock_pollfd poll_fds[CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES + 1];
+    struct astarte_device *device = NULL;
+
+    while (true) {
+        int poll_fds_count = 0;
+        k_timepoint_t deadline = sys_timepoint_calc(K_FOREVER);
+
+        sys_mutex_lock(&worker_mutex, K_FOREVER);
+
+        if (sys_slist_is_empty(&worker_devices)) {
+            ASTARTE_LOG_DBG("Stopping the Astarte worker thread");
+            worker_running = false;
+            sys_mutex_unlock(&worker_mutex);
+            return;
+        }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+        poll_fds[poll_fds_count].fd = worker_wakeup_fd;
+        poll_fds[poll_fds_count].events = ZSOCK_POLLIN;
+        poll_fds_count++;
+#endif
+
+        SYS_SLIST_FOR_EACH_CONTAINER(&worker_devices, device, worker_node) {
+            struct zsock_pollfd poll_fd = { .fd = -1 };
+            run_device(device, &poll_fd, &deadline);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+            // The socket is polled by the reception thread, which wakes this thread on new data
+            update_rx(device, poll_fd.fd);
+#else
+            device->worker_poll_index = -1;
+            if (poll_fd.fd >= 0) {
+                device->worker_poll_index = poll_fds_count;
+                poll_fds[poll_fds_count] = poll_fd;
+                poll_fds_count++;
+            }
+#endif
+        }
+
+        sys_mutex_unlock(&worker_mutex);
+
+        // Wait without holding the mutex, so that devices can be added and removed
+        int poll_rc = wait_for_work(poll_fds, poll_fds_count, deadline);
+        if (poll_rc < 0) {
+            // The poll call failed as a whole, none of the sockets has been checked
+            ASTARTE_LOG_ERR("Worker poll error: %d", errno);
+            k_msleep(POLLING_ERROR_RETRY_DELAY_MS);
+            continue;
+        }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+        // Reset the wakeup signal, whatever has been signaled is handled by the next run
+        if (poll_fds[0].revents & ZSOCK_POLLIN) {
+            zvfs_eventfd_t wakeup_value = 0;
+            (void) zvfs_eventfd_read(worker_wakeup_fd, &wakeup_value);
+        }
+#endif
+
+        bool polling_failed = false;
+
+        sys_mutex_lock(&worker_mutex, K_FOREVER);
+
+        // Devices removed in the meantime are no longer in the list and are skipped
+        SYS_SLIST_FOR_EACH_CONTAINER(&worker_devices, device, worker_node) {
+            if (device->worker_poll_index < 0) {
+                continue;
+            }
+
+            if (process_device_poll(device, &poll_fds[device->worker_poll_index])) {
+                polling_failed = true;
+            }
+            device->worker_poll_index = -1;
+        }
+
+        sys_mutex_unlock(&worker_mutex);
+
+        if (polling_failed) {
+            k_msleep(POLLING_ERROR_RETRY_DELAY_MS);
+        }
+    }
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+static void rx_thread_entry(void * /*par1*/, void * /*par2*/, void * /*par3*/)
+{
+    // One entry for each device socket plus the wakeup event
+    struct zsock_pollfd poll_fds[CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES + 1];
+    struct astarte_device *device = NULL;
+
+    while (true) {
+        int poll_fds_count = 0;
+
+        sys_mutex_lock(&rx_mutex, K_FOREVER);
+
+        if (sys_slist_is_empty(&rx_devices)) {
+            ASTARTE_LOG_DBG("Stopping the Astarte reception thread");
+            rx_running = false;
+            sys_mutex_unlock(&rx_mutex);
+            return;
+        }
+
+        poll_fds[poll_fds_count].fd = rx_wakeup_fd;
+        poll_fds[poll_fds_count].events = ZSOCK_POLLIN;
+        poll_fds_count++;
+
+        SYS_SLIST_FOR_EACH_CONTAINER(&rx_devices, device, rx_node) {
+            device->rx_poll_index = -1;
+            // Stop reading while the worker has not dispatched the events of the device
+            device->rx_throttled = !astarte_mqtt_can_receive(&device->astarte_mqtt);
+            if ((device->rx_fd >= 0) && !device->rx_throttled) {
+                device->rx_poll_index = poll_fds_count;
+                poll_fds[poll_fds_count].fd = device->rx_fd;
+                poll_fds[poll_fds_count].events = ZSOCK_POLLIN;
+                poll_fds_count++;
+            }
+        }
+
+        sys_mutex_unlock(&rx_mutex);
+
+        // Timeouts are handled by the worker thread, this one only waits for data
+        int poll_rc = zsock_poll(poll_fds, poll_fds_count, SYS_FOREVER_MS);
+        if (poll_rc < 0) {
+            // The poll call failed as a whole, none of the sockets has been checked
+            ASTARTE_LOG_ERR("Reception poll error: %d", errno);
+            k_msleep(POLLING_ERROR_RETRY_DELAY_MS);
+            continue;
+        }
+
+        if (poll_fds[0].revents & ZSOCK_POLLIN) {
+            zvfs_eventfd_t wakeup_value = 0;
+            (void) zvfs_eventfd_read(rx_wakeup_fd, &wakeup_value);
+        }
+
+        bool polling_failed = false;
+        bool data_received = false;
+
+        sys_mutex_lock(&rx_mutex, K_FOREVER);
+
+        // Devices removed in the meantime are no longer in the list and are skipped
+        SYS_SLIST_FOR_EACH_CONTAINER(&rx_devices, device, rx_node) {
+            int poll_index = device->rx_poll_index;
+            device->rx_poll_index = -1;
+            // Skip sockets replaced while polling and sockets with nothing to read
+            if ((poll_index < 0) || (poll_fds[poll_index].fd != device->rx_fd)
+                || (poll_fds[poll_index].revents == 0)) {
+                continue;
+            }
+
+            data_received = true;
+            if (process_device_poll(device, &poll_fds[poll_index])) {
+                polling_failed = true;
+            }
+        }
+
+        sys_mutex_unlock(&rx_mutex);
+
+        // The received data might advance the state machine or acknowledge messages
+        if (data_received) {
+            astarte_device_worker_wake();
+        }
+        if (polling_failed) {
+            k_msleep(POLLING_ERROR_RETRY_DELAY_MS);
+        }
+    }
+}
+
+static void update_rx(astarte_device_handle_t device, int fd)
+{
+    sys_mutex_lock(&rx_mutex, K_FOREVER);
+    bool changed = (device->rx_fd != fd) || device->rx_throttled;
+    device->rx_fd = fd;
+    device->rx_throttled = false;
+    sys_mutex_unlock(&rx_mutex);
+
+    // Let the reception thread poll the new socket
+    if (changed) {
+        (void) zvfs_eventfd_write(rx_wakeup_fd, 1);
+    }
+}
+#endif
+
+static void run_device(
+    astarte_device_handle_t device, struct zsock_pollfd *poll_fd, k_timepoint_t *deadline)
+{
+    // Write to flash the stored messages that have been buffered for too long
+    astarte_result_t ares = astarte_transmission_queue_flush(&device->transmission_queue, false);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Failed flushing the transmission queue: %s", astarte_result_to_name(ares));
+    }
+
+    k_timeout_t transmission_timeout = K_FOREVER;
+    if (k_event_test(&device->events, ASTARTE_DEVICE_CONNECTION_EVENT_BIT)) {
+        int32_t delay_ms = process_transmission_queue(device);
+#ifndef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+        if (delay_ms == SYS_FOREVER_MS) {
+            // Prevent CPU starvation when the queue is empty
+            delay_ms = TRANSMISSION_EMPTY_QUEUE_WAITING_MS;
+        }
+#endif
+        if (delay_ms != SYS_FOREVER_MS) {
+            transmission_timeout = K_MSEC(delay_ms);
+        }
+    } else {
+#ifndef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+        // Check periodically for the connection to be established
+        transmission_timeout = K_MSEC(TRANSMISSION_EVENT_WAITING_MS);
+#endif
+    }
+
+    k_timepoint_t transmission_deadline = sys_timepoint_calc(transmission_timeout);
+    if (sys_timepoint_cmp(transmission_deadline, *deadline) < 0) {
+        *deadline = transmission_deadline;
+    }
+    k_timepoint_t flush_deadline
+        = astarte_transmission_queue_get_flush_deadline(&device->transmission_queue);
+    if (sys_timepoint_cmp(flush_deadline, *deadline) < 0) {
+        *deadline = flush_deadline;
+    }
+
+    // Run the state machine and the MQTT client
+    ares = astarte_device_internal_poll_prepare(device, poll_fd, deadline);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error polling the device: %s", astarte_result_to_name(ares));
+
+        astarte_device_error_event_t err_ev
+            = { .result = ares, .context = "astarte_device_internal_poll" };
+        k_msgq_put(&device->event_queue, &err_ev, K_NO_WAIT);
+    }
+}
+
+static bool process_device_poll(astarte_device_handle_t device, const struct zsock_pollfd *poll_fd)
+{
+    astarte_result_t ares = astarte_device_internal_poll_process(device, poll_fd);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error polling the device: %s", astarte_result_to_name(ares));
+
+        astarte_device_error_event_t err_ev
+            = { .result = ares, .context = "astarte_device_internal_poll" };
+        k_msgq_put(&device->event_queue, &err_ev, K_NO_WAIT);
+        return true;
+    }
+    return false;
+}
+
+static int wait_for_work(struct zsock_pollfd *poll_fds, int poll_fds_count, k_timepoint_t deadline)
+{
+    k_timeout_t timeout = sys_timepoint_timeout(deadline);
+    if (poll_fds_count == 0) {
+        k_sleep(timeout);
+        return 0;
+    }
+
+    int32_t timeout_ms = SYS_FOREVER_MS;
+    if (!K_TIMEOUT_EQ(timeout, K_FOREVER)) {
+        timeout_ms = (int32_t) MIN(k_ticks_to_ms_ceil64(timeout.ticks), INT32_MAX);
+    }
+    return zsock_poll(poll_fds, poll_fds_count, timeout_ms);
+}
+
+static int32_t process_transmission_queue(struct astarte_device *device)
+{
+    struct astarte_device_transmission_pacing *pacing = &device->transmission_pacing;
+    astarte_transmission_pacing_refill(pacing);
+
+    // Drain the queue as far as the tokens and the window allow, a burst is bounded so that the
+    // MQTT client is polled for incoming data in between
+    uint32_t burst = astarte_transmission_pacing_get_burst(pacing, &device->astarte_mqtt);
+    int32_t delay_ms = 0;
+    for (uint32_t i = 0; (i < burst) && (delay_ms == 0); i++) {
+        delay_ms = process_transmission_queue_head(device);
+    }
+    return delay_ms;
+}
+
+static int32_t process_transmission_queue_head(struct astarte_device *device)
+{
+    struct astarte_device_transmission_pacing *pacing = &device->transmission_pacing;
+    int32_t delay_ms = 0;
+    struct astarte_device_transmission_queue_msg msg = { 0 };
+    astarte_result_t ares
+        = astarte_transmission_queue_peek_borrow(&device->transmission_queue, &msg);
+    if (ares != ASTARTE_RESULT_OK) {
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+        // Use the idle time to compact the storage, keep going until there is nothing left
+        ares = astarte_storage_compact(&device->caching);
+        if (ares == ASTARTE_RESULT_OK) {
+            goto exit;
+        }
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Storage compaction failed: %s",
+            astarte_result_to_name(ares));
+#endif
+        // Nothing to do until a new message is queued
+        delay_ms = SYS_FOREVER_MS;
+        goto exit;
+    }
+
+    // Intercept interface updates before token/pacing checks
+    if (msg.operation == ASTARTE_TRANSMISSION_OP_ADD_INTERFACE
+        || msg.operation == ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE) {
+
+        if (msg.operation == ASTARTE_TRANSMISSION_OP_ADD_INTERFACE) {
+            ASTARTE_LOG_DBG("Processing add interface operation for %s", msg.interface->name);
+
+            ares = introspection_update(&device->introspection, msg.interface);
+            if (ares != ASTARTE_RESULT_OK) {
+                ASTARTE_LOG_ERR("Failed updating introspection: %s", astarte_result_to_name(ares));
+            }
+        } else if (msg.operation == ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE) {
+            ASTARTE_LOG_DBG("Processing remove interface operation for %s", msg.interface->name);
+
+            ares = introspection_remove(&device->introspection, msg.interface->name);
+            if (ares != ASTARTE_RESULT_OK) {
+                ASTARTE_LOG_ERR(
+                    "Failed removing from introspection: %s", astarte_result_to_name(ares));
+            }
+        }
+
+        astarte_transmission_queue_discard_interface(&device->transmission_queue);
+        goto exit;
+    }
+
+    // Wait for a token or for a slot of the in-flight window
+    delay_ms = astarte_transmission_pacing_admit(pacing, &device->astarte_mqtt, msg.qos);
+    if (delay_ms != 0) {
+        goto exit;
+    }
+
+    ASTARTE_LOG_DBG("Transmitting message for %s%s", msg.interface_name, msg.path);
+    ASTARTE_LOG_HEXDUMP_DBG(msg.payload, msg.payload_len, "Payload: ");
+
+    ares = astarte_device_dispatcher_publish_data(
+        device, msg.interface_name, msg.path, msg.payload, msg.payload_len, msg.qos);
+    if (ares == ASTARTE_RESULT_OK) {
+        ares = astarte_transmission_queue_discard_by_retention(
+            &device->transmission_queue, msg.retention);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR(
+                "Failed to remove message from queue: %s", astarte_result_to_name(ares));
+        }
+        astarte_transmission_pacing_consume(pacing, &device->astarte_mqtt, msg.qos);
+
+    } else {
+        ASTARTE_LOG_ERR("Failed to transmit message: %s", astarte_result_to_name(ares));
+
+        astarte_device_error_event_t err_ev
+            = { .result = ares, .context = "process_transmission_queue" };
+        k_msgq_put(&device->event_queue, &err_ev, K_NO_WAIT);
+
+        // Message safely remains at the head of the queue
+        // Wait for a short duration to back off before the loop retries.
+        delay_ms = TRANSMISSION_ERROR_RETRY_DELAY_MS;
+    }
+
+exit:
+    astarte_transmission_queue_msg_cleanup(&msg);
+    return delay_ms;
+}
@@ -17,11 +17,13 @@
 #include "astarte_device_sdk/result.h"
 
 #include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
 #include "storage/core.h"
 #endif
 #include "backoff.h"
+#include "device/transmission_pacing.h"
 #include "device/transmission_queue.h"
 #include "introspection.h"
 #include "mqtt/core.h"
@@ -73,8 +75,6 @@
 
 /** @brief Event bit used to signal a connection event. */
 #define ASTARTE_DEVICE_CONNECTION_EVENT_BIT BIT(0U)
-/** @brief Event bit used to signal the transmission thread to exit gracefully. */
-#define ASTARTE_DEVICE_DESTROY_EVENT_BIT BIT(1U)
 
 /** @brief Connection statuses for the Astarte device. */
 enum connection_states
@@ -142,12 +142,24 @@ struct astarte_device
 #endif
     /** @brief Transmission queue for the device. */
     struct astarte_device_transmission_queue transmission_queue;
+    /** @brief Pacing of the transmission queue, only used by the worker thread. */
+    struct astarte_device_transmission_pacing transmission_pacing;
     /** @brief Events handler for internal device events. */
     struct k_event events;
-    /** @brief Worker thread, handling the connection to Astarte and data transmission/reception. */
-    struct k_thread worker_thread;
-    /** @brief Stack for the worker thread. */
-    K_KERNEL_STACK_MEMBER(worker_thread_stack, CONFIG_ASTARTE_DEVICE_SDK_WORKER_THREAD_STACK_SIZE);
+    /** @brief Node in the list of devices served by the worker thread. */
+    sys_snode_t worker_node;
+    /** @brief Index of the MQTT socket in the poll of the worker thread, negative if not polled. */
+    int worker_poll_index;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    /** @brief Node in the list of devices served by the reception thread. */
+    sys_snode_t rx_node;
+    /** @brief MQTT socket polled by the reception thread, negative if not polled. */
+    int rx_fd;
+    /** @brief Index of the MQTT socket in the reception thread poll, negative if not polled. */
+    int rx_poll_index;
+    /** @brief Set while the MQTT socket is not polled, waiting for the events to be dispatched. */
+    bool rx_throttled;
+#endif
     /** @brief User-facing error event queue. */
     struct k_msgq event_queue;
     /** @brief Buffer backing the error event queue. */
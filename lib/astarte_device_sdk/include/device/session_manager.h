@@ -19,12 +19,29 @@ extern "C" {
 #endif
 
 /**
- * @brief Polls the internal device instance for updates.
+ * @brief Runs the device state machine and prepares the poll of its MQTT client.
  *
- * @param[in] device Handle to the device instance.
+ * @details The deadline is brought forward to the next time the device should be run again, right
+ * away when the connection state has changed.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @param[out] poll_fd Poll entry for the MQTT socket, the file descriptor is negative when the
+ * socket should not be polled.
+ * @param[inout] deadline Latest time the poll should return at.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_device_internal_poll_prepare(
+    astarte_device_handle_t device, struct zsock_pollfd *poll_fd, k_timepoint_t *deadline);
+
+/**
+ * @brief Processes the outcome of a successful poll of the device MQTT client.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @param[in] poll_fd Poll entry filled by #astarte_device_internal_poll_prepare.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_device_internal_poll(astarte_device_handle_t device);
+astarte_result_t astarte_device_internal_poll_process(
+    astarte_device_handle_t device, const struct zsock_pollfd *poll_fd);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,98 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DEVICE_TRANSMISSION_PACING_H
+#define DEVICE_TRANSMISSION_PACING_H
+
+/**
+ * @file device/transmission_pacing.h
+ * @brief Pacing of the transmission of queued messages.
+ *
+ * @details QoS 0 messages, and all the messages when the MQTT in-flight window is disabled, are
+ * paced by a token bucket. QoS 1 and 2 messages are paced by the in-flight window when enabled.
+ */
+
+#include <stdint.h>
+
+#include "mqtt/core.h"
+
+/** @brief Token bucket pacing the transmission of queued messages. */
+struct astarte_device_transmission_pacing
+{
+    /** @brief Maximum number of tokens, the largest burst of transmissions. */
+    uint32_t max_tokens;
+    /** @brief Time in milliseconds to generate a single token. */
+    uint32_t token_period_ms;
+    /** @brief Tokens currently available. */
+    uint32_t tokens;
+    /** @brief Uptime in milliseconds at which the last token has been generated. */
+    int64_t last_refill;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the transmission pacing, starting with a full bucket.
+ *
+ * @param[out] pacing Pacing to initialize.
+ * @param[in] max_tokens Maximum number of tokens.
+ * @param[in] token_period_ms Time in milliseconds to generate a single token.
+ */
+void astarte_transmission_pacing_init(struct astarte_device_transmission_pacing *pacing,
+    uint32_t max_tokens, uint32_t token_period_ms);
+
+/**
+ * @brief Generate the tokens accumulated since the last refill.
+ *
+ * @param[inout] pacing Pacing to refill.
+ */
+void astarte_transmission_pacing_refill(struct astarte_device_transmission_pacing *pacing);
+
+/**
+ * @brief Get the largest number of messages transmitted in a single burst.
+ *
+ * @details Each message of a burst is admitted either by a token or by a slot of the in-flight
+ * window, so a burst can fill both.
+ *
+ * @param[in] pacing Pacing of the transmissions.
+ * @param[in] astarte_mqtt Handle to the MQTT client the messages are transmitted with.
+ * @return The maximum number of transmissions of a burst.
+ */
+uint32_t astarte_transmission_pacing_get_burst(
+    const struct astarte_device_transmission_pacing *pacing, astarte_mqtt_t *astarte_mqtt);
+
+/**
+ * @brief Check if a message with the given QoS can be transmitted now.
+ *
+ * @param[inout] pacing Pacing of the transmissions, refilled if out of tokens.
+ * @param[in] astarte_mqtt Handle to the MQTT client the message is transmitted with.
+ * @param[in] qos QoS of the message.
+ * @return Zero if the message can be transmitted, SYS_FOREVER_MS if the in-flight window is full,
+ * otherwise the milliseconds to wait for the next token.
+ */
+int32_t astarte_transmission_pacing_admit(
+    struct astarte_device_transmission_pacing *pacing, astarte_mqtt_t *astarte_mqtt, int qos);
+
+/**
+ * @brief Account for the transmission of a message admitted by #astarte_transmission_pacing_admit.
+ *
+ * @details A token is consumed unless the message is paced by the in-flight window, which is
+ * freed by the acknowledgement of the message.
+ *
+ * @param[inout] pacing Pacing of the transmissions.
+ * @param[in] astarte_mqtt Handle to the MQTT client the message has been transmitted with.
+ * @param[in] qos QoS of the message.
+ */
+void astarte_transmission_pacing_consume(
+    struct astarte_device_transmission_pacing *pacing, astarte_mqtt_t *astarte_mqtt, int qos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEVICE_TRANSMISSION_PACING_H
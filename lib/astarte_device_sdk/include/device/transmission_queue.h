@@ -17,6 +17,7 @@
 #include "astarte_device_sdk/result.h"
 
 #include <zephyr/kernel.h>
+#include <zephyr/sys/mutex.h>
 
 #include "storage/core.h"
 #include "storage/trans.h"
@@ -32,6 +33,58 @@ typedef enum
     ASTARTE_TRANSMISSION_OP_REMOVE_INTERFACE,
 } astarte_transmission_operation_t;
 
+/** @brief Enumeration of the lanes of the transmission queue, each one ordered by sequence. */
+typedef enum
+{
+    /** @brief Interface operations. */
+    ASTARTE_TRANSMISSION_LANE_INTERFACE = 0,
+    /** @brief Messages with retention discard. */
+    ASTARTE_TRANSMISSION_LANE_DISCARD,
+    /** @brief Messages with retention volatile. */
+    ASTARTE_TRANSMISSION_LANE_VOLATILE,
+    /** @brief Messages with retention stored, kept in the permanent storage. */
+    ASTARTE_TRANSMISSION_LANE_STORED,
+} astarte_transmission_lane_t;
+
+/**
+ * @brief Maximum number of messages held in RAM, three lanes and a borrowed message.
+ *
+ * @param[in] capacity Capacity of each lane held in RAM.
+ */
+#define ASTARTE_TRANSMISSION_QUEUE_RAM_MSGS(capacity) ((3 * (capacity)) + 1)
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
+/**
+ * @brief Number of runs the order index of the transmission queue can hold.
+ *
+ * @details Each message held in RAM can make up a run, with stored runs in between them. One more
+ * run is needed by the insertion. Volatile messages spilled to the storage belong to stored runs.
+ *
+ * @param[in] capacity Capacity of each lane held in RAM.
+ */
+#define ASTARTE_TRANSMISSION_QUEUE_RUNS(capacity)                                                  \
+    ((2 * ASTARTE_TRANSMISSION_QUEUE_RAM_MSGS(capacity)) + 2)
+#else
+/**
+ * @brief Number of runs the order index of the transmission queue can hold.
+ *
+ * @details Each message held in RAM can make up a run. One more run is needed by the insertion.
+ *
+ * @param[in] capacity Capacity of each lane held in RAM.
+ */
+#define ASTARTE_TRANSMISSION_QUEUE_RUNS(capacity)                                                  \
+    (ASTARTE_TRANSMISSION_QUEUE_RAM_MSGS(capacity) + 1)
+#endif
+
+/** @brief Run of messages with consecutive sequence numbers inserted in the same lane. */
+struct astarte_device_transmission_queue_run
+{
+    /** @brief Sequence number of the newest message of the run. */
+    uint64_t last_sequence_number;
+    /** @brief Lane holding the messages of the run. */
+    astarte_transmission_lane_t lane;
+};
+
 /** @brief Message structure for the transmission storage. */
 struct astarte_device_transmission_queue_msg
 {
@@ -51,6 +104,12 @@ struct astarte_device_transmission_queue_msg
     int qos;
     /** @brief Retention policy for the message. */
     astarte_mapping_retention_t retention;
+    /** @brief Expiry of the mapping in seconds, zero if the message never expires. */
+    int32_t expiry;
+    /** @brief True if the name, path and payload are owned by the queue, not by the message. */
+    bool borrowed;
+    /** @brief Queue owning the buffers of a borrowed message, its loan ends on cleanup. */
+    struct astarte_device_transmission_queue *lender;
 };
 
 /** @brief Message structure for interface operations storage. */
@@ -69,11 +128,11 @@ struct astarte_device_transmission_queue_interface_msg
 /** @brief Message structure for the transmission storage. */
 struct astarte_device_transmission_queue_volatile_msg
 {
-    /** @brief Name of the Astarte interface. */
+    /** @brief Name of the Astarte interface, start of the block also holding path and payload. */
     char *interface_name;
-    /** @brief Path associated with the message. */
+    /** @brief Path associated with the message, stored after the interface name. */
     char *path;
-    /** @brief Pointer to the payload data. */
+    /** @brief Pointer to the payload data, stored after the path. */
     void *payload;
     /** @brief Length of the payload data in bytes. */
     int payload_len;
@@ -88,21 +147,44 @@ struct astarte_device_transmission_queue_volatile_msg
 /** @brief Transmission queue structure for managing outbound messages. */
 struct astarte_device_transmission_queue
 {
+    /** @brief Guards the queue from insertions and removals of different threads. */
+    struct sys_mutex mutex;
+    /** @brief Capacity of each message queue. */
+    size_t capacity;
+    /** @brief Heap block backing the message queues and #runs, sized on #capacity. */
+    char *buffer;
     /** @brief Message queue for discard messages. */
     struct k_msgq discard_msgq;
-    /** @brief Buffer backing the discard message queue. */
-    char discard_msgq_buffer[CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE
-        * sizeof(struct astarte_device_transmission_queue_volatile_msg)];
     /** @brief Message queue for interface operations. */
     struct k_msgq interface_msgq;
-    /** @brief Buffer backing the interface message queue. */
-    char interface_msgq_buffer[CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE
-        * sizeof(struct astarte_device_transmission_queue_interface_msg)];
     /** @brief Message queue for volatile messages. */
     struct k_msgq volatile_msgq;
-    /** @brief Buffer backing the volatile message queue. */
-    char volatile_msgq_buffer[CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE
-        * sizeof(struct astarte_device_transmission_queue_volatile_msg)];
+    /** @brief Volatile or discard message taken out of its queue while borrowed. */
+    struct astarte_device_transmission_queue_volatile_msg borrowed_msg;
+    /** @brief Retention of #borrowed_msg. */
+    astarte_mapping_retention_t borrowed_retention;
+    /** @brief True if #borrowed_msg holds a message. */
+    bool has_borrowed_msg;
+    /** @brief Number of borrowed messages pointing to #borrowed_msg not cleaned up yet. */
+    size_t borrowed_loans;
+    /** @brief Thread holding the loans of #borrowed_msg. */
+    k_tid_t borrower;
+    /** @brief True if #borrowed_msg left the queue while on loan, freed when the loans end. */
+    bool borrowed_detached;
+    /** @brief True if #borrowed_msg has been purged while on loan and not discarded yet. */
+    bool borrowed_purged;
+    /** @brief Ring of runs ordering the messages of the lanes, the oldest run holds the head. */
+    struct astarte_device_transmission_queue_run *runs;
+    /** @brief Number of runs #runs can hold. */
+    size_t runs_size;
+    /** @brief Index of the oldest run in #runs. */
+    size_t runs_head;
+    /** @brief Number of runs in #runs. */
+    size_t runs_count;
+    /** @brief Sequence number of the last message returned by a peek. */
+    uint64_t peeked_sequence_number;
+    /** @brief True if #peeked_sequence_number is the head of the oldest run. */
+    bool has_peeked;
     /** @brief Flag indicating if the system time is valid. */
     bool system_time_valid;
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
@@ -121,23 +203,28 @@ struct astarte_device_transmission_queue
  *
  * @param[in] handle Pointer to the transmission queue to initialize.
  * @param[in] storage Pointer to the persistent storage driver handle.
+ * @param[in] capacity Number of messages each queue held in RAM can contain.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_transmission_queue_init(
-    struct astarte_device_transmission_queue *handle, astarte_storage_data_t *storage);
+astarte_result_t astarte_transmission_queue_init(struct astarte_device_transmission_queue *handle,
+    astarte_storage_data_t *storage, size_t capacity);
 #else
 /**
  * @brief Initializes a new transmission queue.
  *
  * @param[in] handle Pointer to the transmission queue to initialize.
+ * @param[in] capacity Number of messages each queue held in RAM can contain.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_transmission_queue_init(struct astarte_device_transmission_queue *handle);
+astarte_result_t astarte_transmission_queue_init(
+    struct astarte_device_transmission_queue *handle, size_t capacity);
 #endif
 
 /**
  * @brief Destroys an existing transmission queue.
  *
+ * @note The messages with retention stored are removed from the storage.
+ *
  * @param[in] handle Pointer to the transmission queue to destroy.
  */
 void astarte_transmission_queue_clear(struct astarte_device_transmission_queue *handle);
@@ -169,6 +256,28 @@ astarte_result_t astarte_transmission_queue_insert(struct astarte_device_transmi
 astarte_result_t astarte_transmission_queue_peek(struct astarte_device_transmission_queue *handle,
     struct astarte_device_transmission_queue_msg *msg);
 
+/**
+ * @brief Peeks at the next message in the transmission queue without copying it.
+ *
+ * @details The interface name, path and payload of a volatile or discard message point to buffers
+ * owned by the queue, valid until the message is cleaned up. The message is taken out of its queue
+ * so that it can't be evicted by an insertion while borrowed. Messages from the storage are
+ * allocated as for #astarte_transmission_queue_peek.
+ *
+ * @note A borrowed message has a single owner: only one thread can hold loans at a time, and it
+ * must end each of them with #astarte_transmission_queue_msg_cleanup. Discarding, purging or
+ * clearing the queue while a message is on loan removes it from the queue, but its buffers are
+ * only freed when the last loan ends.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[out] msg Pointer to a message structure to populate, to be released with
+ * #astarte_transmission_queue_msg_cleanup.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_transmission_queue_peek_borrow(
+    struct astarte_device_transmission_queue *handle,
+    struct astarte_device_transmission_queue_msg *msg);
+
 /**
  * @brief Discards messages from the transmission queue based on their retention policy.
  *
@@ -188,9 +297,33 @@ astarte_result_t astarte_transmission_queue_discard_by_retention(
 astarte_result_t astarte_transmission_queue_discard_interface(
     struct astarte_device_transmission_queue *handle);
 
+/**
+ * @brief Writes to flash the stored messages still buffered in RAM.
+ *
+ * @note Messages are only buffered when transmission packing is enabled, otherwise this is a no-op.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @param[in] force When false only a buffer whose timeout has expired is written.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_transmission_queue_flush(
+    struct astarte_device_transmission_queue *handle, bool force);
+
+/**
+ * @brief Gets the time at which the stored messages buffered in RAM should be written to flash.
+ *
+ * @param[in] handle Pointer to the transmission queue.
+ * @return The deadline for the next call to #astarte_transmission_queue_flush, a never expiring
+ * timepoint when there is nothing to write.
+ */
+k_timepoint_t astarte_transmission_queue_get_flush_deadline(
+    struct astarte_device_transmission_queue *handle);
+
 /**
  * @brief Frees the memory allocated for a transmission queue message payload and paths.
  *
+ * @note The buffers of a borrowed message are left to the queue, and its loan is ended.
+ *
  * @param[in] msg Pointer to the message structure to clean up.
  */
 void astarte_transmission_queue_msg_cleanup(struct astarte_device_transmission_queue_msg *msg);
@@ -19,6 +19,10 @@
 /**
  * @brief Initialize a volatile message from a generic queue message.
  *
+ * @details The interface name, path and payload are copied in a single block. With
+ * CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_POOL the block is taken from the memory
+ * slabs of the transmission queue, falling back to the heap.
+ *
  * @param[out] volatile_msg Pointer to the volatile message structure to initialize.
  * @param[in] queue_msg Pointer to the generic queue message containing the source data.
  * @param[in] timestamp The timestamp (in milliseconds) to assign to the volatile message.
@@ -44,6 +48,8 @@ astarte_result_t astarte_transmission_queue_msg_from_volatile_msg_deep_cpy(
 /**
  * @brief Clean up memory allocated inside a volatile message.
  *
+ * @note Returns the block of the message to the slab it has been taken from, if any.
+ *
  * @param[in,out] msg Pointer to the volatile message structure to clean up.
  */
 void astarte_transmission_queue_volatile_msg_cleanup(
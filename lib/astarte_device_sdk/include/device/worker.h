@@ -0,0 +1,54 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DEVICE_WORKER_H
+#define DEVICE_WORKER_H
+
+/**
+ * @file device/worker.h
+ * @brief Worker thread shared by all the device instances.
+ *
+ * @details The worker thread runs the connection state machine, polls the MQTT client and
+ * transmits the queued messages of every registered device. It is started when the first device
+ * is registered and terminates once the last one has been unregistered.
+ */
+
+#include "device/core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Registers a device instance with the worker thread, starting the thread if required.
+ *
+ * @param[inout] device Handle to the device instance.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_device_worker_add(astarte_device_handle_t device);
+
+/**
+ * @brief Unregisters a device instance from the worker thread.
+ *
+ * @details Once this function returns the worker thread no longer accesses the device.
+ *
+ * @param[inout] device Handle to the device instance.
+ */
+void astarte_device_worker_remove(astarte_device_handle_t device);
+
+/**
+ * @brief Wakes up the worker thread, to be called after handing it new work.
+ *
+ * @details Does nothing unless CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER is set, as
+ * otherwise the worker thread periodically checks for new work on its own.
+ */
+void astarte_device_worker_wake(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEVICE_WORKER_H
@@ -0,0 +1,210 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KEY_VALUE_BACKEND_H
+#define KEY_VALUE_BACKEND_H
+
+/**
+ * @file key_value/backend.h
+ * @brief Record storage used by the key-value driver.
+ *
+ * @details The key-value driver stores each entry as a record identified by a 32 bits ID. A
+ * backend provides the primitives to read, write and delete such records through a table of
+ * operations. All the operations follow the ZMS conventions: they return the number of bytes
+ * transferred or zero on success, and a negative errno code on failure, -ENOENT if the record
+ * does not exist.
+ *
+ * Two backends are available:
+ * - The ZMS backend, storing the records in a flash partition.
+ * - The RAM backend, storing the records on the heap. Its content is lost when it is closed.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <zephyr/version.h>
+
+#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
+#include <zephyr/kvss/zms.h>
+#else
+#include <zephyr/fs/zms.h>
+#endif
+
+#include "astarte_device_sdk/result.h"
+
+/** @brief Storage backend of the key-value driver. */
+typedef struct astarte_key_value_backend astarte_key_value_backend_t;
+
+/** @brief Operations implemented by a key-value storage backend. */
+typedef struct
+{
+    /** @brief Read up to len bytes of a record, returns the number of bytes read. */
+    ssize_t (*read)(astarte_key_value_backend_t *backend, uint32_t id, void *data, size_t len);
+    /** @brief Write a whole record, replacing any previous content. A zero len deletes it. */
+    ssize_t (*write)(
+        astarte_key_value_backend_t *backend, uint32_t id, const void *data, size_t len);
+    /** @brief Delete a record. */
+    int (*remove)(astarte_key_value_backend_t *backend, uint32_t id);
+    /** @brief Get the size of a record. */
+    ssize_t (*get_data_length)(astarte_key_value_backend_t *backend, uint32_t id);
+    /** @brief Total number of bytes the backend can store. */
+    size_t (*capacity)(astarte_key_value_backend_t *backend);
+    /** @brief Release the resources of the backend, can be NULL. */
+    void (*close)(astarte_key_value_backend_t *backend);
+} astarte_key_value_backend_api_t;
+
+/** @brief A record of the RAM backend. */
+struct astarte_key_value_backend_ram_record
+{
+    /** @brief ID of the record. */
+    uint32_t id;
+    /** @brief Size of the record data. */
+    size_t len;
+    /** @brief Record data, allocated on the heap. */
+    uint8_t *data;
+};
+
+/** @brief State of the RAM backend. */
+struct astarte_key_value_backend_ram
+{
+    /** @brief Records sorted by ID. */
+    struct astarte_key_value_backend_ram_record *records;
+    /** @brief Number of stored records. */
+    size_t count;
+    /** @brief Number of records the records array can hold. */
+    size_t allocated;
+    /** @brief Bytes accounted to the stored records. */
+    size_t used_bytes;
+    /** @brief Maximum bytes accounted to the stored records. */
+    size_t max_bytes;
+};
+
+struct astarte_key_value_backend
+{
+    /** @brief Operations of the backend, NULL until the backend is opened. */
+    const astarte_key_value_backend_api_t *api;
+    /** @brief State of the backend, depending on its type. */
+    union
+    {
+        /** @brief State of the ZMS backend. */
+        struct zms_fs zms_fs;
+        /** @brief State of the RAM backend. */
+        struct astarte_key_value_backend_ram ram;
+    };
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Mount a ZMS partition as the backend.
+ *
+ * @param[out] backend Backend to initialize.
+ * @param[in] flash_device Flash device holding the partition.
+ * @param[in] flash_offset Offset of the partition.
+ * @param[in] flash_partition_size Full size of the partition.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_backend_zms_open(astarte_key_value_backend_t *backend,
+    const struct device *flash_device, off_t flash_offset, uint64_t flash_partition_size);
+
+/**
+ * @brief Initialize an empty RAM backend.
+ *
+ * @param[out] backend Backend to initialize.
+ * @param[in] max_bytes Maximum bytes used by the stored records, including their bookkeeping.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_backend_ram_open(
+    astarte_key_value_backend_t *backend, size_t max_bytes);
+
+/**
+ * @brief Read a record.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] id ID of the record.
+ * @param[out] data Buffer for the record data.
+ * @param[in] len Size of the buffer.
+ * @return The number of bytes read, or a negative errno code.
+ */
+static inline ssize_t astarte_key_value_backend_read(
+    astarte_key_value_backend_t *backend, uint32_t id, void *data, size_t len)
+{
+    return backend->api->read(backend, id, data, len);
+}
+
+/**
+ * @brief Write a record, replacing any previous content.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] id ID of the record.
+ * @param[in] data Record data.
+ * @param[in] len Size of the record data.
+ * @return The number of bytes written, zero if unchanged, or a negative errno code.
+ */
+static inline ssize_t astarte_key_value_backend_write(
+    astarte_key_value_backend_t *backend, uint32_t id, const void *data, size_t len)
+{
+    return backend->api->write(backend, id, data, len);
+}
+
+/**
+ * @brief Delete a record.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] id ID of the record.
+ * @return Zero on success, or a negative errno code.
+ */
+static inline int astarte_key_value_backend_delete(
+    astarte_key_value_backend_t *backend, uint32_t id)
+{
+    return backend->api->remove(backend, id);
+}
+
+/**
+ * @brief Get the size of a record.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] id ID of the record.
+ * @return The size of the record data, or a negative errno code.
+ */
+static inline ssize_t astarte_key_value_backend_get_data_length(
+    astarte_key_value_backend_t *backend, uint32_t id)
+{
+    return backend->api->get_data_length(backend, id);
+}
+
+/**
+ * @brief Get the total number of bytes a backend can store.
+ *
+ * @param[inout] backend Storage backend.
+ * @return The capacity in bytes.
+ */
+static inline size_t astarte_key_value_backend_capacity(astarte_key_value_backend_t *backend)
+{
+    return backend->api->capacity(backend);
+}
+
+/**
+ * @brief Release the resources held by a backend.
+ *
+ * @param[inout] backend Storage backend, it can be opened again afterwards.
+ */
+static inline void astarte_key_value_backend_close(astarte_key_value_backend_t *backend)
+{
+    if (backend->api && backend->api->close) {
+        backend->api->close(backend);
+    }
+    backend->api = NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KEY_VALUE_BACKEND_H
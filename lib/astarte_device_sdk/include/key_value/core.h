@@ -14,13 +14,14 @@
  * @details
  * Each namespaced key-value pair is stored as a single ZMS entry. The entry ID is generated via a
  * 32-bit hash of the concatenated namespace and key strings, with linear probing used to handle
- * collisions.
+ * collisions. Entries belonging to the same namespace are chained in a doubly linked list, the
+ * head and tail IDs of each namespace list are stored in a dedicated reserved ZMS entry.
  *
  * The payload of each ZMS entry is structured as follows:
  * - 2 bytes: Namespace string length (excluding null terminator)
  * - 2 bytes: Key string length (excluding null terminator)
- * - 4 bytes: Next entry ID in the linked list (0xFFFFFFFF if tail)
- * - 4 bytes: Previous entry ID in the linked list (0xFFFFFFFF if head)
+ * - 4 bytes: Next entry ID in the namespace linked list (0xFFFFFFFF if tail)
+ * - 4 bytes: Previous entry ID in the namespace linked list (0xFFFFFFFF if head)
  * - N bytes: Namespace string (no null terminator)
  * - K bytes: Key string (no null terminator)
  * - V bytes: Value data
@@ -30,29 +31,35 @@
  * - Fetching a value from a known key.
  * - Removing a key-value pair.
  * - Iterating through all the stored key-value pairs.
+ * - Applying a batch of insertions and deletions, sharing the write-ahead log record.
+ * - Reading a value in parts and writing a value provided in parts. Values larger than
+ *   CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_CHUNK_SIZE are stored in chunks, each in its own
+ *   ZMS entry, so that no buffer as large as the value is needed to access them.
+ * - Storing records at sequential positions in a ring of reserved ZMS IDs. A ring record is
+ *   accessed with a single ZMS operation, without hashing, probing or linked list updates.
+ *
+ * The entries can also be kept in RAM, see key_value/backend.h, for devices without a spare flash
+ * partition.
  */
 
 #include <zephyr/sys/util.h>
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
 
 #include "astarte_device_sdk/astarte.h"
 #include "astarte_device_sdk/result.h"
 
 #include "cleanup.h"
+#include "key_value/backend.h"
 
 /** @brief The current major version for the key-value storage. */
 #define ASTARTE_KEY_VALUE_FORMAT_VERSION_MAJOR 0
 /** @brief The current minor version for the key-value storage. */
-#define ASTARTE_KEY_VALUE_FORMAT_VERSION_MINOR 6
+#define ASTARTE_KEY_VALUE_FORMAT_VERSION_MINOR 9
 /** @brief The current patch version for the key-value storage. */
 #define ASTARTE_KEY_VALUE_FORMAT_VERSION_PATCH 0
 
+/** @brief Number of ZMS IDs reserved to the ring of positioned records. */
+#define ASTARTE_KEY_VALUE_RING_SLOTS 4096U
+
 /** @brief Version format structure for ZMS storage. */
 typedef struct
 {
@@ -80,14 +87,33 @@ typedef struct
 {
     /** @brief Namespace used for this key-value storage instance. */
     char *namespace;
-    /** @brief Persistent ZMS file system context */
-    struct zms_fs *zms_fs;
+    /** @brief Storage backend shared between all the instances */
+    astarte_key_value_backend_t *backend;
+    /** @brief Identifier of the linked list for the namespace, resolved on first use. */
+    uint32_t list_id;
+    /** @brief Hidden namespace holding the chunks of the large values of this instance. */
+    char *chunk_namespace;
+    /** @brief Identifier of the linked list for the chunks namespace, resolved on first use. */
+    uint32_t chunk_list_id;
     /** @brief Maximum quota in bytes for this key-value instance. */
     size_t max_quota_bytes;
     /** @brief Current usage in bytes for this key-value instance. */
     size_t current_usage_bytes;
 } astarte_key_value_t;
 
+/** @brief Positions and size of the records stored in the ring. */
+typedef struct
+{
+    /** @brief Number of records stored in the ring. */
+    uint32_t count;
+    /** @brief Position of the oldest record, meaningful only when count is not zero. */
+    uint32_t first;
+    /** @brief Position of the newest record, meaningful only when count is not zero. */
+    uint32_t last;
+    /** @brief Total size of the values stored in the ring. */
+    size_t bytes;
+} astarte_key_value_ring_bounds_t;
+
 /** @brief Iterator struct for the key-value pair storage. */
 typedef struct
 {
@@ -97,6 +123,49 @@ typedef struct
     uint32_t current_id;
 } astarte_key_value_iter_t;
 
+/** @brief Single operation recorded in a key-value batch. */
+typedef struct
+{
+    /** @brief Key of the operation. */
+    char *key;
+    /** @brief Value to insert, NULL for deletions. */
+    void *value;
+    /** @brief Size of the value to insert. */
+    size_t value_size;
+    /** @brief True if the operation is a deletion. */
+    bool is_delete;
+} astarte_key_value_batch_op_t;
+
+/** @brief Batch of operations to apply to a key-value storage instance. */
+typedef struct
+{
+    /** @brief Reference to the storage instance the batch is applied to. */
+    astarte_key_value_t *kv_storage;
+    /** @brief Recorded operations, in order. */
+    astarte_key_value_batch_op_t *ops;
+    /** @brief Number of recorded operations. */
+    size_t ops_count;
+    /** @brief Number of operations that fit in @p ops. */
+    size_t ops_capacity;
+} astarte_key_value_batch_t;
+
+/** @brief Writer of a value provided in multiple parts. */
+typedef struct
+{
+    /** @brief Reference to the storage instance the value is written to. */
+    astarte_key_value_t *kv_storage;
+    /** @brief Key of the value. */
+    char *key;
+    /** @brief Size of the whole value. */
+    size_t value_size;
+    /** @brief Number of bytes of the value appended so far. */
+    size_t written;
+    /** @brief Generation of the chunks written for the value. */
+    uint8_t generation;
+    /** @brief Descriptor of the value followed by the chunk being filled. */
+    uint8_t *buffer;
+} astarte_key_value_writer_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -104,20 +173,20 @@ extern "C" {
 /**
  * @brief Insert or update a value at a specific 16-bit key.
  *
- * @param[in,out] zms_fs The ZMS file system context to open.
+ * @param[in,out] backend The storage backend to use.
  * @param[in] alternate Alternate option for the entry.
  * @param[in] key The 16-bit key.
  * @param[in] value Value to store.
  * @param[in] value_size Size of the value to store.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_key_value_direct_insert(
-    struct zms_fs *zms_fs, bool alternate, uint16_t key, const void *value, size_t value_size);
+astarte_result_t astarte_key_value_direct_insert(astarte_key_value_backend_t *backend,
+    bool alternate, uint16_t key, const void *value, size_t value_size);
 
 /**
  * @brief Read a value from a specific 16-bit key.
  *
- * @param[in,out] zms_fs The ZMS file system context to open.
+ * @param[in,out] backend The storage backend to use.
  * @param[in] alternate Alternate option for the entry.
  * @param[in] key The 16-bit key.
  * @param[out] value Buffer where to store the value, can be NULL to just query the size.
@@ -125,19 +194,72 @@ astarte_result_t astarte_key_value_direct_insert(
  * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if not found, otherwise an
  * error code.
  */
-astarte_result_t astarte_key_value_direct_find(
-    struct zms_fs *zms_fs, bool alternate, uint16_t key, void *value, size_t *value_size);
+astarte_result_t astarte_key_value_direct_find(astarte_key_value_backend_t *backend,
+    bool alternate, uint16_t key, void *value, size_t *value_size);
 
 /**
  * @brief Remove the value associated with a specific 16-bit key.
  *
- * @param[in,out] zms_fs The ZMS file system context to open.
+ * @param[in,out] backend The storage backend to use.
  * @param[in] alternate Alternate option for the entry.
  * @param[in] key The 16-bit key to remove.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
 astarte_result_t astarte_key_value_direct_delete(
-    struct zms_fs *zms_fs, bool alternate, uint16_t key);
+    astarte_key_value_backend_t *backend, bool alternate, uint16_t key);
+
+/**
+ * @brief Store a record at a position of the ring.
+ *
+ * @details Each position is stored in the slot at its value modulo ASTARTE_KEY_VALUE_RING_SLOTS,
+ * replacing the record of any other position sharing the same slot. The caller is responsible of
+ * keeping at most ASTARTE_KEY_VALUE_RING_SLOTS consecutive positions in the ring.
+ *
+ * @param[in,out] backend The storage backend to use.
+ * @param[in] position Position of the record.
+ * @param[in] value Value to store, can be NULL if value_size is zero.
+ * @param[in] value_size Size of the value to store, an empty value is a valid record.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_ring_insert(astarte_key_value_backend_t *backend,
+    uint32_t position, const void *value, size_t value_size);
+
+/**
+ * @brief Read the record stored at a position of the ring.
+ *
+ * @param[in,out] backend The storage backend to use.
+ * @param[in] position Position of the record.
+ * @param[out] value Buffer where to store the value, can be NULL to just query the size.
+ * @param[inout] value_size Size of the provided buffer. Will be updated to the actual data size.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if no record is stored at the
+ * position, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_ring_find(astarte_key_value_backend_t *backend,
+    uint32_t position, void *value, size_t *value_size);
+
+/**
+ * @brief Remove the record stored at a position of the ring.
+ *
+ * @param[in,out] backend The storage backend to use.
+ * @param[in] position Position of the record.
+ * @param[out] value_size Size of the removed value, can be NULL.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if no record is stored at the
+ * position, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_ring_delete(
+    astarte_key_value_backend_t *backend, uint32_t position, size_t *value_size);
+
+/**
+ * @brief Find the oldest and newest positions stored in the ring.
+ *
+ * @note This function reads every slot of the ring, it is meant to be used once at startup.
+ *
+ * @param[in,out] backend The storage backend to use.
+ * @param[out] bounds Positions and size of the stored records.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_ring_bounds(
+    astarte_key_value_backend_t *backend, astarte_key_value_ring_bounds_t *bounds);
 
 /**
  * @brief Initialize a ZMS partition for use with the key-value driver.
@@ -146,10 +268,33 @@ astarte_result_t astarte_key_value_direct_delete(
  * once for each ZMS partition.
  *
  * @param[in] config Configuration struct for the ZMS partition.
- * @param[in,out] zms_fs The ZMS file system context to open.
+ * @param[out] backend The storage backend to open on the ZMS partition.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_open(
+    astarte_key_value_cfg_t config, astarte_key_value_backend_t *backend);
+
+/**
+ * @brief Initialize an empty RAM storage for use with the key-value driver.
+ *
+ * @details The stored key-value pairs are kept on the heap and are lost when the storage is closed.
+ *
+ * @note After being used the storage should be closed with #astarte_key_value_close.
+ *
+ * @param[in] max_bytes Maximum number of bytes used by the stored entries.
+ * @param[out] backend The storage backend to open in RAM.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_key_value_open(astarte_key_value_cfg_t config, struct zms_fs *zms_fs);
+astarte_result_t astarte_key_value_open_ram(size_t max_bytes, astarte_key_value_backend_t *backend);
+
+/**
+ * @brief Close a storage opened with #astarte_key_value_open or #astarte_key_value_open_ram.
+ *
+ * @note All the key-value storage instances using the storage should be destroyed beforehand.
+ *
+ * @param[inout] backend The storage backend to close.
+ */
+void astarte_key_value_close(astarte_key_value_backend_t *backend);
 
 /**
  * @brief Create a new instance of the key-value pairs storage driver for a specific namespace.
@@ -157,14 +302,14 @@ astarte_result_t astarte_key_value_open(astarte_key_value_cfg_t config, struct z
  * @note After being used the key-value storage instance should be destroyed with
  * #astarte_key_value_destroy.
  *
- * @param[in,out] zms_fs The ZMS file system context to use. This should have been opened previously
- * using #astarte_key_value_open
+ * @param[in,out] backend The storage backend to use. This should have been opened previously
+ * using #astarte_key_value_open or #astarte_key_value_open_ram
  * @param[in] namespace The namespace to be used for this storage instance.
  * @param[in] max_quota_pct The maximum quota percentage allowed for this namespace.
  * @param[out] kv_storage Data struct for the key-value storage instance to initialize.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_key_value_new(struct zms_fs *zms_fs, const char *namespace,
+astarte_result_t astarte_key_value_new(astarte_key_value_backend_t *backend, const char *namespace,
     uint8_t max_quota_pct, astarte_key_value_t *kv_storage);
 
 /**
@@ -203,6 +348,25 @@ astarte_result_t astarte_key_value_insert(
 astarte_result_t astarte_key_value_find(
     astarte_key_value_t *kv_storage, const char *key, void *value, size_t *value_size);
 
+/**
+ * @brief Read part of the value of the key-value pair matching the @p key in storage.
+ *
+ * @details Only the storage entries holding the requested part are read, the memory used does
+ * not depend on the size of the whole value.
+ *
+ * @param[inout] kv_storage Data struct for the instance of the driver.
+ * @param[in] key Key to use for the search.
+ * @param[in] offset Offset in the value of the first byte to read.
+ * @param[out] value Buffer where to store the read part of the value.
+ * @param[inout] value_size Size of the @p value buffer. Upon success it will be set to the number
+ * of bytes read, fewer than the buffer size when the value ends before.
+ * @param[out] total_size Upon success it will be set to the size of the whole value, can be NULL.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if not found,
+ * ASTARTE_RESULT_INVALID_PARAM if @p offset is past the end of the value, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_read(astarte_key_value_t *kv_storage, const char *key,
+    size_t offset, void *value, size_t *value_size, size_t *total_size);
+
 /**
  * @brief Delete an existing key-value pair from storage.
  *
@@ -256,6 +420,136 @@ astarte_result_t astarte_key_value_iterator_get(
  */
 astarte_result_t astarte_key_value_iterator_delete(astarte_key_value_iter_t *iter);
 
+/**
+ * @brief Start a new batch of operations for a key-value storage instance.
+ *
+ * @details Operations are recorded in RAM and applied by #astarte_key_value_batch_commit.
+ * Consecutive insertions are applied under a single write-ahead log record and appended to the
+ * namespace list with a single write, while updates of existing keys are written in place.
+ * Deletions are applied one at a time, as they may relocate other entries.
+ *
+ * @note After being used the batch should be committed with #astarte_key_value_batch_commit or
+ * released with #astarte_key_value_batch_destroy.
+ *
+ * @param[in] kv_storage Data struct for the instance of the driver.
+ * @param[out] batch Batch instance to initialize.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_batch_begin(
+    astarte_key_value_t *kv_storage, astarte_key_value_batch_t *batch);
+
+/**
+ * @brief Record the insertion or update of a key-value pair in a batch.
+ *
+ * @param[inout] batch Batch instance.
+ * @param[in] key Key to the value to store, copied in the batch.
+ * @param[in] value Value to store, copied in the batch.
+ * @param[in] value_size Size of the value to store.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_batch_insert(
+    astarte_key_value_batch_t *batch, const char *key, const void *value, size_t value_size);
+
+/**
+ * @brief Record the deletion of a key-value pair in a batch.
+ *
+ * @note Deleting a key not present in storage is not an error when the batch is committed.
+ *
+ * @param[inout] batch Batch instance.
+ * @param[in] key Key of the key-value pair to delete, copied in the batch.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_batch_delete(astarte_key_value_batch_t *batch, const char *key);
+
+/**
+ * @brief Apply all the operations recorded in a batch, in order, and release the batch.
+ *
+ * @details A power loss while applying a group of insertions rolls back all the new keys of the
+ * group, keys updated in place keep their new value.
+ * When an operation fails, the operations preceding it remain applied.
+ *
+ * @param[inout] batch Batch instance, released by this function.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_batch_commit(astarte_key_value_batch_t *batch);
+
+/**
+ * @brief Release a batch without applying its operations.
+ *
+ * @param[inout] batch Batch instance to release.
+ */
+void astarte_key_value_batch_destroy(astarte_key_value_batch_t *batch);
+
+/** @cond INTERNAL_HIDDEN */
+ASTARTE_SCOPE_DEFER_DEFINE(astarte_key_value_batch_destroy, astarte_key_value_batch_t *);
+/** @endcond */
+
+/**
+ * @brief Start writing a value provided in multiple parts.
+ *
+ * @details The value is stored one chunk at a time as it is appended, the writer only buffers a
+ * single chunk. The new value replaces the stored one only once committed, the old value remains
+ * readable until then.
+ *
+ * @note After being used the writer should be committed with #astarte_key_value_writer_commit or
+ * released with #astarte_key_value_writer_destroy.
+ *
+ * @param[in] kv_storage Data struct for the instance of the driver.
+ * @param[in] key Key to the value to store, copied in the writer.
+ * @param[in] value_size Size of the whole value.
+ * @param[out] writer Writer instance to initialize.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_OUT_OF_SPACE if the value would exceed
+ * the namespace quota, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_writer_begin(astarte_key_value_t *kv_storage, const char *key,
+    size_t value_size, astarte_key_value_writer_t *writer);
+
+/**
+ * @brief Append the next part of a value to a writer.
+ *
+ * @param[inout] writer Writer instance.
+ * @param[in] data Part of the value to append.
+ * @param[in] size Size of the part, it must not exceed the remaining size of the value.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_writer_append(
+    astarte_key_value_writer_t *writer, const void *data, size_t size);
+
+/**
+ * @brief Store the value appended to a writer, replacing any previous value, and release it.
+ *
+ * @param[inout] writer Writer instance, released by this function.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_INVALID_PARAM if the whole value has
+ * not been appended, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_writer_commit(astarte_key_value_writer_t *writer);
+
+/**
+ * @brief Release a writer, discarding the parts of the value stored so far.
+ *
+ * @param[inout] writer Writer instance to release.
+ */
+void astarte_key_value_writer_destroy(astarte_key_value_writer_t *writer);
+
+/** @cond INTERNAL_HIDDEN */
+ASTARTE_SCOPE_DEFER_DEFINE(astarte_key_value_writer_destroy, astarte_key_value_writer_t *);
+/** @endcond */
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+/**
+ * @brief Perform a bounded step of compaction, physically removing deleted key-value pairs.
+ *
+ * @details With tombstones enabled a deletion only marks the entry as deleted. This function
+ * removes at most one of the marked entries, relocating the entries that collided with it.
+ * It is meant to be called repeatedly while the device is idle.
+ *
+ * @param[inout] backend Storage backend the key-value storage is opened on.
+ * @return ASTARTE_RESULT_OK if a step has been performed, ASTARTE_RESULT_NOT_FOUND if there is
+ * nothing left to compact, otherwise an error code.
+ */
+astarte_result_t astarte_key_value_compact(astarte_key_value_backend_t *backend);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
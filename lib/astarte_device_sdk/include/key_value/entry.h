@@ -17,13 +17,10 @@
 
 #include "astarte_device_sdk/result.h"
 
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
+#include "key_value/backend.h"
+#include "key_value/core.h"
+#include "key_value/entry_header.h"
+#include "key_value/entry_list.h"
 
 /** @brief Special identifier representing a null/invalid pointer in the linked list. */
 #define ASTARTE_KEY_VALUE_ENTRY_NULL_ID UINT32_MAX
@@ -31,14 +28,35 @@
 /** @brief Reserved specialized ZMS ID to store the format version. */
 #define ASTARTE_KEY_VALUE_ENTRY_VERSION_ID (ASTARTE_KEY_VALUE_ENTRY_NULL_ID - 1)
 
-/** @brief Specialized ZMS ID reserved to store the head and tail pointers of the linked list. */
-#define ASTARTE_KEY_VALUE_ENTRY_HEAD_AND_TAIL_ID (ASTARTE_KEY_VALUE_ENTRY_VERSION_ID - 1)
-
 /** @brief Reserved specialized ZMS ID to store the Intent Block. */
-#define ASTARTE_KEY_VALUE_ENTRY_INTENT_ID (ASTARTE_KEY_VALUE_ENTRY_HEAD_AND_TAIL_ID - 1)
+#define ASTARTE_KEY_VALUE_ENTRY_INTENT_ID (ASTARTE_KEY_VALUE_ENTRY_VERSION_ID - 1)
+
+/** @brief Maximum number of namespaces, each namespace owns a separate linked list. */
+#define ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES 64U
+
+/** @brief First of the ZMS IDs reserved to store the head and tail pointers of each list. */
+#define ASTARTE_KEY_VALUE_ENTRY_LIST_HEAD_AND_TAIL_BASE_ID                                         \
+    (ASTARTE_KEY_VALUE_ENTRY_INTENT_ID - ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES)
+
+/** @brief First of the ZMS IDs reserved to store the namespace string owning each list. */
+#define ASTARTE_KEY_VALUE_ENTRY_LIST_NAMESPACE_BASE_ID                                             \
+    (ASTARTE_KEY_VALUE_ENTRY_LIST_HEAD_AND_TAIL_BASE_ID                                            \
+        - ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES)
+
+/** @brief First of the ZMS IDs reserved to the slots of the ring of positioned records. */
+#define ASTARTE_KEY_VALUE_ENTRY_RING_BASE_ID                                                       \
+    (ASTARTE_KEY_VALUE_ENTRY_LIST_NAMESPACE_BASE_ID - ASTARTE_KEY_VALUE_RING_SLOTS)
 
 /** @brief The maximum ZMS ID allowable for normal key-value entries. */
-#define ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID (ASTARTE_KEY_VALUE_ENTRY_INTENT_ID - 1)
+#define ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID (ASTARTE_KEY_VALUE_ENTRY_RING_BASE_ID - 1)
+
+/**
+ * @brief The maximum ZMS ID the hash of an entry can map to.
+ *
+ * @details The hash keeps the range it had before the ring slots were reserved, so that the
+ * entries stored by older formats are found at the same IDs.
+ */
+#define ASTARTE_KEY_VALUE_ENTRY_MAX_HASHED_ID (ASTARTE_KEY_VALUE_ENTRY_LIST_NAMESPACE_BASE_ID - 1)
 
 /** @brief The minimum allowable ZMS ID to reserve the first block of entries. */
 #define ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID ((uint32_t) 0x1FFFF + 1)
@@ -47,8 +65,9 @@
  * @brief Finds an existing ZMS ID via hash and probing, or allocates an available one.
  *
  * @note This function may return ASTARTE_RESULT_NOT_FOUND only when @p allocate is set to false.
+ * A tombstone left by a deleted key is not found, but it is the ID allocated for that same key.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] namespace Target namespace string.
  * @param[in] key Target key string.
  * @param[out] idx Returns the matched or allocated ID.
@@ -59,29 +78,46 @@
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  * @retval ASTARTE_RESULT_KEY_VALUE_FULL When the storage is full and no match has occurred.
  */
-astarte_result_t astarte_key_value_entry_find_or_alloc(
-    struct zms_fs *zms_fs, const char *namespace, const char *key, uint32_t *idx, bool allocate);
+astarte_result_t astarte_key_value_entry_find_or_alloc(astarte_key_value_backend_t *backend,
+    const char *namespace, const char *key, uint32_t *idx, bool allocate);
+
+/**
+ * @brief Serializes an entry, header followed by the value, into a newly allocated buffer.
+ *
+ * @param[in] header Header of the entry, its namespace and key must not be NULL.
+ * @param[in] value Value of the entry, can be NULL when @p value_size is zero.
+ * @param[in] value_size Size of the value.
+ * @param[out] serialized_entry_size Size of the serialized entry.
+ * @return The serialized entry, to be freed by the caller, or NULL when out of memory.
+ */
+uint8_t *astarte_key_value_entry_serialize(struct astarte_key_value_entry_header header,
+    const void *value, size_t value_size, size_t *serialized_entry_size);
 
 /**
  * @brief Writes an atomic combined payload to the specified ID.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the namespace list the entry belongs to.
  * @param[in] idx Base ZMS ID.
  * @param[in] namespace Target namespace string.
  * @param[in] key Target key string.
  * @param[in] value Target value block.
  * @param[in] value_size Target value block size.
+ * @param[in] chunked True when @p value is the descriptor and last segment of a chunked value.
+ * @param[in] usage Usage of the list with this key pending, NULL if the usage is not tracked. It is
+ * stored with the list tail for a new entry, or before writing an existing one.
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
  */
-astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t idx,
-    const char *namespace, const char *key, const void *value, size_t value_size);
+astarte_result_t astarte_key_value_entry_write(astarte_key_value_backend_t *backend,
+    uint32_t list_id, uint32_t idx, const char *namespace, const char *key, const void *value,
+    size_t value_size, bool chunked, const struct astarte_key_value_entry_list_usage *usage);
 
 /**
  * @brief Retrieves a previously stored value from a combined record payload.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Valid ZMS ID.
  * @param[out] value Preallocated memory to store the retrieved data. Can be NULL to query size.
  * @param[inout] value_size Pass size of value block, returns data stored.
@@ -93,43 +129,69 @@ astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t i
  * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
  */
 astarte_result_t astarte_key_value_entry_read_value(
-    struct zms_fs *zms_fs, uint32_t idx, void *value, size_t *value_size);
+    astarte_key_value_backend_t *backend, uint32_t idx, void *value, size_t *value_size);
 
 /**
- * @brief Retrieves a previously stored key string from a combined record payload.
+ * @brief Retrieves a portion of a previously stored value from a combined record payload.
+ *
+ * @details Only the requested portion is copied, the payload is read up to its end.
+ * The stored value is returned as is, the descriptor of a chunked value included.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Valid ZMS ID.
- * @param[out] key Preallocated memory to store the retrieved string. Can be NULL to query size.
- * @param[inout] key_size Pass size of key block, returns length stored (+1 for null terminator).
+ * @param[in] offset Offset in the stored value of the first byte to read.
+ * @param[out] value Preallocated memory to store the retrieved data.
+ * @param[inout] value_size Pass size of value block, returns data read. Fewer bytes than the
+ * passed size are read when the stored value ends before.
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
- * @retval ASTARTE_RESULT_INVALID_PARAM One of the provided parameters is invalid.
+ * @retval ASTARTE_RESULT_INVALID_PARAM The offset is past the end of the stored value.
+ * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR The stored entry is malformed.
  * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ */
+astarte_result_t astarte_key_value_entry_read_value_range(astarte_key_value_backend_t *backend,
+    uint32_t idx, size_t offset, void *value, size_t *value_size);
+
+/**
+ * @brief Retrieves the size of a previously stored value.
+ *
+ * @details For a chunked value this is the size of the whole value, as stored in its descriptor.
+ * Tombstones have no value and report a size of zero.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] idx Valid ZMS ID.
+ * @param[out] value_size Size of the value.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
  * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR The stored entry is malformed.
  */
-astarte_result_t astarte_key_value_entry_read_key(
-    struct zms_fs *zms_fs, uint32_t idx, char *key, size_t *key_size);
+astarte_result_t astarte_key_value_entry_read_value_size(
+    astarte_key_value_backend_t *backend, uint32_t idx, size_t *value_size);
 
 /**
- * @brief Evaluates whether a certain ZMS ID belongs to a given namespace.
+ * @brief Retrieves a previously stored key string from a combined record payload.
  *
- * @param[inout] zms_fs ZMS file system.
- * @param[in] idx Valid ZMS ID to evaluate.
- * @param[in] namespace Namespace to match against.
- * @param[out] matches Evaluated to true if it matches, else false.
+ * @param[inout] backend Storage backend.
+ * @param[in] idx Valid ZMS ID.
+ * @param[out] key Preallocated memory to store the retrieved string. Can be NULL to query size.
+ * @param[inout] key_size Pass size of key block, returns length stored (+1 for null terminator).
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
  * @retval ASTARTE_RESULT_INVALID_PARAM One of the provided parameters is invalid.
  * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
-astarte_result_t astarte_key_value_entry_check_namespace(
-    struct zms_fs *zms_fs, uint32_t idx, const char *namespace, bool *matches);
+astarte_result_t astarte_key_value_entry_read_key(
+    astarte_key_value_backend_t *backend, uint32_t idx, char *key, size_t *key_size);
 
 /**
  * @brief Retrieves the next ID in the linked list of entries.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the namespace list, only used when @p idx is
+ * ASTARTE_KEY_VALUE_ENTRY_NULL_ID.
  * @param[in] idx Valid ZMS ID of the current entry, or ASTARTE_KEY_VALUE_ENTRY_NULL_ID to retrieve
  * the head ID.
  * @param[out] next_id Pointer to store the retrieved next ID.
@@ -138,12 +200,12 @@ astarte_result_t astarte_key_value_entry_check_namespace(
  * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
  */
 astarte_result_t astarte_key_value_entry_get_next_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t *next_id);
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx, uint32_t *next_id);
 
 /**
  * @brief Retrieves the previous ID in the linked list of entries.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Valid ZMS ID of the current entry, if set to ASTARTE_KEY_VALUE_ENTRY_NULL_ID the
  * function returns ASTARTE_KEY_VALUE_ENTRY_NULL_ID.
  * @param[out] prev_id Pointer to store the retrieved previous ID.
@@ -152,6 +214,6 @@ astarte_result_t astarte_key_value_entry_get_next_id(
  * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
  */
 astarte_result_t astarte_key_value_entry_get_prev_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t *prev_id);
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t *prev_id);
 
 #endif // KEY_VALUE_ENTRY_H
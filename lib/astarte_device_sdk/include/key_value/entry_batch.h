@@ -0,0 +1,148 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KEY_VALUE_ENTRY_BATCH_H
+#define KEY_VALUE_ENTRY_BATCH_H
+
+/**
+ * @file key_value/entry_batch.h
+ * @brief Batched writes of entries sharing a single intent block.
+ *
+ * @details A batch writes a group of entries of the same namespace list. New entries are chained
+ * to each other while being written and appended to the list with a single update of its head and
+ * tail, which is the commit point of the batch. A single intent block covers all the new entries,
+ * an interrupted batch is rolled back removing all of them. Updates of existing entries are single
+ * ZMS writes and are applied immediately.
+ *
+ * Each new entry is kept in RAM until the ID of the following one is known, so it can be written
+ * already linked to it.
+ * When the usage of the list is tracked, the stored usage is removed before the first update of an
+ * existing entry and the final usage is stored on completion, together with the new tail if any.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "astarte_device_sdk/result.h"
+#include "key_value/backend.h"
+#include "key_value/entry_list.h"
+
+/** @brief Data struct for an in progress batch of writes. */
+struct astarte_key_value_entry_batch
+{
+    /** @brief ZMS file system. */
+    astarte_key_value_backend_t *backend;
+    /** @brief Identifier of the namespace list the entries belong to. */
+    uint32_t list_id;
+    /** @brief Namespace of the entries. */
+    const char *namespace;
+    /** @brief Head of the list when the batch started. */
+    uint32_t head_id;
+    /** @brief Tail of the list when the batch started. */
+    uint32_t old_tail_id;
+    /** @brief Last new entry of the batch, or the list tail if no entry has been added. */
+    uint32_t tail_id;
+    /** @brief First new entry of the batch, also used as target of the intent block. */
+    uint32_t first_id;
+    /** @brief ZMS ID of the new entry not yet written. */
+    uint32_t pending_id;
+    /** @brief Serialized new entry not yet written. */
+    uint8_t *pending_entry;
+    /** @brief Size of the serialized new entry not yet written. */
+    size_t pending_entry_size;
+    /** @brief Fingerprint of the new entry not yet written. */
+    uint32_t pending_fingerprint;
+    /** @brief True if the usage of the list is stored and must be kept updated. */
+    bool track_usage;
+    /** @brief True if the stored usage has been removed by an update of an existing entry. */
+    bool usage_removed;
+};
+
+/**
+ * @brief Starts a new batch of writes for a namespace list.
+ *
+ * @param[out] batch Batch to initialize.
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the namespace list.
+ * @param[in] namespace Namespace of the entries, must outlive the batch.
+ * @param[in] track_usage True if the usage of the list is stored and must be kept updated.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ */
+astarte_result_t astarte_key_value_entry_batch_begin(struct astarte_key_value_entry_batch *batch,
+    astarte_key_value_backend_t *backend, uint32_t list_id, const char *namespace,
+    bool track_usage);
+
+/**
+ * @brief Finds an existing ZMS ID for a key, or allocates an available one.
+ *
+ * @details Equivalent to #astarte_key_value_entry_find_or_alloc, but also accounts for the new
+ * entry of the batch not yet written.
+ *
+ * @param[inout] batch Batch in progress.
+ * @param[in] key Target key string.
+ * @param[out] idx Returns the matched or allocated ID.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_KEY_VALUE_FULL When the storage is full and no match has occurred.
+ */
+astarte_result_t astarte_key_value_entry_batch_find_or_alloc(
+    struct astarte_key_value_entry_batch *batch, const char *key, uint32_t *idx);
+
+/**
+ * @brief Adds the write of an entry to the batch.
+ *
+ * @param[inout] batch Batch in progress.
+ * @param[in] idx ZMS ID returned by #astarte_key_value_entry_batch_find_or_alloc for @p key.
+ * @param[in] key Target key string.
+ * @param[in] value Target value block.
+ * @param[in] value_size Target value block size.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ */
+astarte_result_t astarte_key_value_entry_batch_write(struct astarte_key_value_entry_batch *batch,
+    uint32_t idx, const char *key, const void *value, size_t value_size);
+
+/**
+ * @brief Writes the last new entry and appends all the new entries to the namespace list.
+ *
+ * @param[inout] batch Batch in progress, released by this function.
+ * @param[in] usage Usage of the list once the batch is complete, ignored if not tracked.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ */
+astarte_result_t astarte_key_value_entry_batch_end(struct astarte_key_value_entry_batch *batch,
+    const struct astarte_key_value_entry_list_usage *usage);
+
+/**
+ * @brief Releases a batch without completing it.
+ *
+ * @note New entries already written are removed when the intent block is resolved.
+ *
+ * @param[inout] batch Batch to release.
+ */
+void astarte_key_value_entry_batch_discard(struct astarte_key_value_entry_batch *batch);
+
+/**
+ * @brief Rolls back an interrupted batch, removing all its new entries.
+ *
+ * @note The caller is responsible for checking the batch has not been committed.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] first_id First new entry of the batch.
+ * @param[in] old_tail_id Tail of the list when the batch started.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ */
+astarte_result_t astarte_key_value_entry_batch_rollback(
+    astarte_key_value_backend_t *backend, uint32_t first_id, uint32_t old_tail_id);
+
+#endif // KEY_VALUE_ENTRY_BATCH_H
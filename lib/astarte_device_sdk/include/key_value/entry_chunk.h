@@ -0,0 +1,110 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KEY_VALUE_ENTRY_CHUNK_H
+#define KEY_VALUE_ENTRY_CHUNK_H
+
+/**
+ * @file key_value/entry_chunk.h
+ * @brief Helpers to store values larger than a chunk across multiple entries.
+ *
+ * @details A value larger than #ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE is split in chunks of that
+ * size. All the chunks but the last are stored as ordinary entries of a hidden namespace derived
+ * from the one of the value, each with a key derived from the key of the value.
+ * The entry of the value itself is flagged as chunked and stores a descriptor followed by the last
+ * chunk. Writing the entry of the value is what makes a new chunked value visible.
+ *
+ * Chunks carry a generation, alternating between two values at each rewrite of the value, so that
+ * the chunks of the old value remain valid until the entry of the new value is written.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "astarte_device_sdk/result.h"
+
+#include "key_value/backend.h"
+
+/** @brief Size in bytes of each chunk of a chunked value. */
+#define ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_CHUNK_SIZE
+
+/** @brief Size in bytes of the descriptor at the start of the value of a chunked entry. */
+#define ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES 5
+
+/** @brief Number of chunk generations, the generation of a rewritten value alternates. */
+#define ASTARTE_KEY_VALUE_ENTRY_CHUNK_GENERATIONS 2
+
+/** @brief Descriptor of a chunked value. */
+struct astarte_key_value_entry_chunk_descriptor
+{
+    /** @brief Size of the whole value. */
+    uint32_t value_size;
+    /** @brief Generation of the chunks holding the value. */
+    uint8_t generation;
+};
+
+/**
+ * @brief Computes the number of chunks stored outside of the entry of a value.
+ *
+ * @param[in] value_size Size of the whole value.
+ * @return The number of chunks, zero for a value stored in a single entry.
+ */
+size_t astarte_key_value_entry_chunk_count(size_t value_size);
+
+/**
+ * @brief Builds the namespace holding the chunks of the values of a namespace.
+ *
+ * @param[in] namespace Namespace of the values.
+ * @return The chunks namespace, to be freed by the caller, or NULL when out of memory.
+ */
+char *astarte_key_value_entry_chunk_namespace(const char *namespace);
+
+/**
+ * @brief Builds the key of a chunk of a value.
+ *
+ * @param[in] key Key of the value.
+ * @param[in] generation Generation of the chunk.
+ * @param[in] index Position of the chunk in the value.
+ * @return The chunk key, to be freed by the caller, or NULL when out of memory.
+ */
+char *astarte_key_value_entry_chunk_key(const char *key, uint8_t generation, size_t index);
+
+/**
+ * @brief Encodes a chunked value descriptor.
+ *
+ * @param[in] descriptor Descriptor to encode.
+ * @param[out] raw Buffer of #ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES bytes.
+ */
+void astarte_key_value_entry_chunk_descriptor_encode(
+    const struct astarte_key_value_entry_chunk_descriptor *descriptor, uint8_t *raw);
+
+/**
+ * @brief Decodes a chunked value descriptor.
+ *
+ * @param[in] raw Buffer of #ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES bytes.
+ * @param[out] descriptor Decoded descriptor.
+ */
+void astarte_key_value_entry_chunk_descriptor_decode(
+    const uint8_t *raw, struct astarte_key_value_entry_chunk_descriptor *descriptor);
+
+/**
+ * @brief Reads the descriptor of the value stored at an ID.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] idx Valid ZMS ID.
+ * @param[out] chunked Set to true if the value is chunked.
+ * @param[out] descriptor Descriptor of the value. For a value stored in a single entry only its
+ * size is set.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR The stored entry is malformed.
+ */
+astarte_result_t astarte_key_value_entry_chunk_read_descriptor(astarte_key_value_backend_t *backend,
+    uint32_t idx, bool *chunked, struct astarte_key_value_entry_chunk_descriptor *descriptor);
+
+#endif // KEY_VALUE_ENTRY_CHUNK_H
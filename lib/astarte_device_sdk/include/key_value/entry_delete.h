@@ -16,31 +16,77 @@
 
 #include "astarte_device_sdk/result.h"
 
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
+#include "key_value/backend.h"
 
 /**
  * @brief Deletes a specific key-value entry and repairs the linked list integrity.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the namespace list the entry belongs to.
  * @param[in] idx Valid ZMS ID of the entry to delete.
  * @return ASTARTE_RESULT_OK or error code.
  */
-astarte_result_t astarte_key_value_entry_delete(struct zms_fs *zms_fs, uint32_t idx);
+astarte_result_t astarte_key_value_entry_delete(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx);
 
 /**
  * @brief Resumes a shift operation starting from a known hole ID.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] hole_id The ZMS ID of the newly deleted entry (the hole).
  * @return ASTARTE_RESULT_OK or error code.
  */
 astarte_result_t astarte_key_value_entry_delete_resume_shift(
-    struct zms_fs *zms_fs, uint32_t hole_id);
+    astarte_key_value_backend_t *backend, uint32_t hole_id);
+
+/**
+ * @brief Moves an entry to a free ID, keeping its position in the namespace list.
+ *
+ * @details The neighbors of the entry, or the list head and tail, are linked to the new ID before
+ * the entry is deleted from its old ID.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] source_id Valid ZMS ID of the entry to move.
+ * @param[in] target_id Free ZMS ID where the entry is moved.
+ * @return ASTARTE_RESULT_OK or error code, ASTARTE_RESULT_NOT_FOUND if there is no entry to move.
+ */
+astarte_result_t astarte_key_value_entry_delete_move(
+    astarte_key_value_backend_t *backend, uint32_t source_id, uint32_t target_id);
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+/**
+ * @brief Deletes an entry by replacing it with a tombstone.
+ *
+ * @details The tombstone keeps the ID, the key and the list position of the entry, so a single
+ * write is required. Tombstones are physically removed by astarte_key_value_entry_delete_compact.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the namespace list the entry belongs to.
+ * @param[in] idx Valid ZMS ID of the entry to delete.
+ * @return ASTARTE_RESULT_OK or error code.
+ */
+astarte_result_t astarte_key_value_entry_delete_tombstone(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx);
+
+/**
+ * @brief Performs a bounded step of the tombstones compaction.
+ *
+ * @details Scans at most CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES_SCAN_BUDGET
+ * entries and physically deletes the first tombstone found.
+ *
+ * @param[inout] backend Storage backend.
+ * @retval ASTARTE_RESULT_OK The step has been performed, more tombstones could be left.
+ * @retval ASTARTE_RESULT_NOT_FOUND There are no tombstones left to compact.
+ * @return Any other error code on failure.
+ */
+astarte_result_t astarte_key_value_entry_delete_compact(astarte_key_value_backend_t *backend);
+
+/**
+ * @brief Forgets the compaction progress, all the lists will be scanned again.
+ *
+ * @note To be called when a new partition is mounted.
+ */
+void astarte_key_value_entry_delete_compact_forget(void);
+#endif
 
 #endif // KEY_VALUE_ENTRY_DELETE_H
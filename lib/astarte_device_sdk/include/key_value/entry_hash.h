@@ -23,4 +23,17 @@
  */
 uint32_t astarte_key_value_entry_hash_generate(const char *namespace, const char *key);
 
+/**
+ * @brief Generate a fingerprint of the namespace and key.
+ *
+ * @details The fingerprint is computed with an hash function independent from the one used by
+ * #astarte_key_value_entry_hash_generate, so that entries colliding on the same ZMS ID are very
+ * unlikely to share the same fingerprint.
+ *
+ * @param[in] namespace Used for generation of the fingerprint.
+ * @param[in] key Used for generation of the fingerprint.
+ * @return The generated fingerprint.
+ */
+uint32_t astarte_key_value_entry_hash_fingerprint(const char *namespace, const char *key);
+
 #endif // KEY_VALUE_ENTRY_HASH_H
@@ -19,15 +19,9 @@
 #include "astarte_device_sdk/result.h"
 
 #include <zephyr/sys/util.h>
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
 
 #include "cleanup.h"
+#include "key_value/backend.h"
 
 /** @brief Size in bytes of the namespace string length field. */
 #define ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES 2
@@ -41,12 +35,22 @@
 /** @brief Size in bytes of the previous entry ID field. */
 #define ASTARTE_KEY_VALUE_ENTRY_HEADER_PREV_ID_BYTES 4
 
+/** @brief Size in bytes of the namespace and key fingerprint field. */
+#define ASTARTE_KEY_VALUE_ENTRY_HEADER_FINGERPRINT_BYTES 4
+
+/** @brief Flag stored in the namespace length field of tombstone entries. */
+#define ASTARTE_KEY_VALUE_ENTRY_HEADER_TOMBSTONE_FLAG 0x8000U
+
+/** @brief Flag stored in the key length field of entries holding a chunked value. */
+#define ASTARTE_KEY_VALUE_ENTRY_HEADER_CHUNKED_FLAG 0x8000U
+
 /** @brief Total size in bytes of the fixed portion of the entry header. */
 #define ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES                                          \
     (ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES                                            \
         + ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES                                             \
         + ASTARTE_KEY_VALUE_ENTRY_HEADER_NEXT_ID_BYTES                                             \
-        + ASTARTE_KEY_VALUE_ENTRY_HEADER_PREV_ID_BYTES)
+        + ASTARTE_KEY_VALUE_ENTRY_HEADER_PREV_ID_BYTES                                             \
+        + ASTARTE_KEY_VALUE_ENTRY_HEADER_FINGERPRINT_BYTES)
 
 /**
  * @brief Represents the fixed-size structure at the start of a ZMS entry payload.
@@ -61,6 +65,12 @@ struct astarte_key_value_entry_header_fixed
     uint32_t next_id;
     /** @brief Previous entry ID in the linked list. */
     uint32_t prev_id;
+    /** @brief Fingerprint of the namespace and key of the entry. */
+    uint32_t fingerprint;
+    /** @brief True for a deleted entry that still holds its ID and its place in the list. */
+    bool tombstone;
+    /** @brief True for an entry whose value continues in separately stored chunks. */
+    bool chunked;
 };
 
 /**
@@ -81,7 +91,7 @@ struct astarte_key_value_entry_header
 /**
  * @brief Reads and parses a complete entry header from ZMS.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Valid ZMS ID to read from.
  * @param[out] header Struct to populate with the header data.
  * @param[out] raw_size Evaluated size of the read payload block.
@@ -90,8 +100,8 @@ struct astarte_key_value_entry_header
  * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
-astarte_result_t astarte_key_value_entry_header_read(struct zms_fs *zms_fs, uint32_t idx,
-    struct astarte_key_value_entry_header *header, size_t *raw_size);
+astarte_result_t astarte_key_value_entry_header_read(astarte_key_value_backend_t *backend,
+    uint32_t idx, struct astarte_key_value_entry_header *header, size_t *raw_size);
 
 /**
  * @brief Frees dynamically allocated strings within an entry header.
@@ -108,7 +118,7 @@ ASTARTE_SCOPE_DEFER_DEFINE(
 /**
  * @brief Reads only the fixed portion of an entry header from ZMS.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Valid ZMS ID to read from.
  * @param[out] fixed_header Struct to populate with the fixed header data.
  * @param[out] raw_size Evaluated size of the read payload block.
@@ -116,7 +126,7 @@ ASTARTE_SCOPE_DEFER_DEFINE(
  * @retval ASTARTE_RESULT_NOT_FOUND The specified index was not found in ZMS.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
-astarte_result_t astarte_key_value_entry_header_read_fixed(struct zms_fs *zms_fs, uint32_t idx,
-    struct astarte_key_value_entry_header_fixed *fixed_header, size_t *raw_size);
+astarte_result_t astarte_key_value_entry_header_read_fixed(astarte_key_value_backend_t *backend,
+    uint32_t idx, struct astarte_key_value_entry_header_fixed *fixed_header, size_t *raw_size);
 
 #endif // KEY_VALUE_ENTRY_HEADER_H
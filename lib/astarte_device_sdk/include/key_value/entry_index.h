@@ -0,0 +1,97 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KEY_VALUE_ENTRY_INDEX_H
+#define KEY_VALUE_ENTRY_INDEX_H
+
+/**
+ * @file key_value/entry_index.h
+ * @brief RAM index of the entries stored in the key-value persistent storage.
+ *
+ * @details The index is an open addressing hash table mapping each occupied ZMS ID to the
+ * fingerprint of the namespace and key stored in it. It allows probing the ZMS IDs without reading
+ * the entries headers from flash.
+ * A single index exists and it is bound to the ZMS file system it has been built for. The index
+ * is only valid when it tracks all the stored entries, when its memory budget is exceeded it gets
+ * invalidated and all operations fall back to reading from flash.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "astarte_device_sdk/result.h"
+
+#include "key_value/backend.h"
+
+/**
+ * @brief Builds the index walking the linked lists of all the namespaces.
+ *
+ * @note When the entries do not fit in the memory budget of the index the index is left invalid
+ * and this function still returns ASTARTE_RESULT_OK.
+ *
+ * @param[inout] backend ZMS file system the index will be bound to.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ */
+astarte_result_t astarte_key_value_entry_index_build(astarte_key_value_backend_t *backend);
+
+/**
+ * @brief Invalidates the index, all subsequent operations will fall back to reading from flash.
+ */
+void astarte_key_value_entry_index_invalidate(void);
+
+/**
+ * @brief Checks if the index is valid for the specified ZMS file system.
+ *
+ * @param[in] backend Storage backend.
+ * @return True if the index is valid and bound to @p backend, false otherwise.
+ */
+bool astarte_key_value_entry_index_is_valid(astarte_key_value_backend_t *backend);
+
+/**
+ * @brief Looks up the fingerprint of the entry stored at a ZMS ID.
+ *
+ * @note Only meaningful when #astarte_key_value_entry_index_is_valid returns true.
+ *
+ * @param[in] backend Storage backend.
+ * @param[in] idx ZMS ID to look up.
+ * @param[out] fingerprint Fingerprint of the namespace and key of the entry stored at @p idx.
+ * @retval ASTARTE_RESULT_OK The ZMS ID is occupied by an entry.
+ * @retval ASTARTE_RESULT_NOT_FOUND The ZMS ID is free.
+ */
+astarte_result_t astarte_key_value_entry_index_lookup(
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t *fingerprint);
+
+/**
+ * @brief Tracks a new entry stored at a ZMS ID.
+ *
+ * @param[in] backend Storage backend.
+ * @param[in] idx ZMS ID of the new entry.
+ * @param[in] fingerprint Fingerprint of the namespace and key of the new entry.
+ */
+void astarte_key_value_entry_index_add(
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t fingerprint);
+
+/**
+ * @brief Stops tracking the entry stored at a ZMS ID.
+ *
+ * @param[in] backend Storage backend.
+ * @param[in] idx ZMS ID of the deleted entry.
+ */
+void astarte_key_value_entry_index_remove(astarte_key_value_backend_t *backend, uint32_t idx);
+
+/**
+ * @brief Tracks the relocation of an entry between two ZMS IDs.
+ *
+ * @param[in] backend Storage backend.
+ * @param[in] source_id ZMS ID the entry has been moved from.
+ * @param[in] destination_id ZMS ID the entry has been moved to.
+ */
+void astarte_key_value_entry_index_move(
+    astarte_key_value_backend_t *backend, uint32_t source_id, uint32_t destination_id);
+
+#endif // KEY_VALUE_ENTRY_INDEX_H
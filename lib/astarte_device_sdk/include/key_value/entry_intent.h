@@ -10,18 +10,16 @@
 /**
  * @file key_value/entry_intent.h
  * @brief Intent block (write-ahead log) definitions to prevent corruption during power loss.
+ *
+ * @details The state of the intent block is cached in RAM. Once the block is known to be clear,
+ * either because it has been read or because it has been cleared by this driver, resolving the
+ * intents does not access the flash until a new intent is written.
  */
 
 #include "astarte_device_sdk/result.h"
 #include <stdint.h>
 
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
+#include "key_value/backend.h"
 
 /** @brief Enum defining the current in-flight multi-step operation. */
 typedef enum
@@ -35,7 +33,11 @@ typedef enum
     /** @brief Delete operation failed. */
     ASTARTE_KEY_VALUE_ENTRY_INTENT_DELETING = 3,
     /** @brief Shift operation failed. */
-    ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING = 4
+    ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING = 4,
+    /** @brief Batch of insert operations failed. */
+    ASTARTE_KEY_VALUE_ENTRY_INTENT_BATCH_INSERTING = 5,
+    /** @brief Move of an entry out of the reserved IDs failed, resumed by the format migration. */
+    ASTARTE_KEY_VALUE_ENTRY_INTENT_RELOCATING = 6
 } astarte_key_value_entry_intent_state_t;
 
 /** @brief Data structure representing an in-flight ZMS operation. */
@@ -43,6 +45,8 @@ struct astarte_key_value_entry_intent
 {
     /** @brief The type of operation in progress. */
     uint8_t state;
+    /** @brief Identifier of the namespace list affected by the operation. */
+    uint32_t list_id;
     /** @brief The primary ZMS ID being modified (e.g., the new entry ID). */
     uint32_t target_id;
     /** @brief Auxiliary ID 1 (e.g., prev_id). */
@@ -54,31 +58,41 @@ struct astarte_key_value_entry_intent
 /**
  * @brief Writes an intent block to ZMS before beginning a multi-step operation.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] state The operation state.
+ * @param[in] list_id Identifier of the namespace list affected by the operation.
  * @param[in] target_id Primary ID involved in the operation.
  * @param[in] affected_id_1 First auxiliary ID.
  * @param[in] affected_id_2 Second auxiliary ID.
  * @return ASTARTE_RESULT_OK or error code.
  */
-astarte_result_t astarte_key_value_entry_intent_write(struct zms_fs *zms_fs,
-    astarte_key_value_entry_intent_state_t state, uint32_t target_id, uint32_t affected_id_1,
-    uint32_t affected_id_2);
+astarte_result_t astarte_key_value_entry_intent_write(astarte_key_value_backend_t *backend,
+    astarte_key_value_entry_intent_state_t state, uint32_t list_id, uint32_t target_id,
+    uint32_t affected_id_1, uint32_t affected_id_2);
 
 /**
  * @brief Clears the current intent block, marking the operation as successful.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @return ASTARTE_RESULT_OK or error code.
  */
-astarte_result_t astarte_key_value_entry_intent_clear(struct zms_fs *zms_fs);
+astarte_result_t astarte_key_value_entry_intent_clear(astarte_key_value_backend_t *backend);
+
+/**
+ * @brief Discards the cached intent block state, the next resolution will read it from flash.
+ *
+ * @note Should be called whenever the ZMS file system is mounted or modified outside this driver.
+ */
+void astarte_key_value_entry_intent_forget(void);
 
 /**
  * @brief Checks for and resolves any pending intents from a previous interrupted operation.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @note Only reads the intent block from flash if it's not already known to be clear.
+ *
+ * @param[inout] backend Storage backend.
  * @return ASTARTE_RESULT_OK or error code.
  */
-astarte_result_t astarte_key_value_entry_intent_resolve(struct zms_fs *zms_fs);
+astarte_result_t astarte_key_value_entry_intent_resolve(astarte_key_value_backend_t *backend);
 
 #endif // KEY_VALUE_ENTRY_INTENT_H
@@ -13,22 +13,57 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "astarte_device_sdk/result.h"
 
-#include <zephyr/version.h>
+#include "key_value/backend.h"
 
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
+/**
+ * @brief Space used by the values of a list, stored along with its head and tail IDs.
+ *
+ * @details The pending key is the one written or deleted by the operation storing the usage. Its
+ * value is looked up when the usage is read, so the usage is correct whether the operation has
+ * completed or not.
+ */
+struct astarte_key_value_entry_list_usage
+{
+    /** @brief Bytes used by the values of the list, excluding the value of the pending key. */
+    uint32_t bytes;
+    /** @brief ZMS ID hashed from the pending key, ASTARTE_KEY_VALUE_ENTRY_NULL_ID if none. */
+    uint32_t pending_hash_id;
+    /** @brief Fingerprint of the pending key. */
+    uint32_t pending_fingerprint;
+};
+
+/**
+ * @brief Finds the identifier of the linked list owned by a namespace, or allocates a new one.
+ *
+ * @details Each namespace owns a separate linked list of entries. The list identifier is obtained
+ * hashing the namespace string, with linear probing used to handle collisions. Once allocated, a
+ * list identifier is never released.
+ *
+ * @note This function may return ASTARTE_RESULT_NOT_FOUND only when @p allocate is set to false.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] namespace Target namespace string.
+ * @param[in] allocate True if a new list should be allocated upon not finding the namespace.
+ * @param[out] list_id Returns the matched or allocated list identifier.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_NOT_FOUND No list exists for the specified namespace.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_KEY_VALUE_FULL When the maximum number of namespaces has been reached.
+ */
+astarte_result_t astarte_key_value_entry_list_find_id(
+    astarte_key_value_backend_t *backend, const char *namespace, bool allocate, uint32_t *list_id);
 
 /**
  * @brief Computes or retrieves the next and previous IDs for an entry based on list state.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the list the entry belongs to.
  * @param[in] idx ZMS ID to compute relative connectivity for.
  * @param[out] next_id Pointer to store the evaluated next ID.
  * @param[out] prev_id Pointer to store the evaluated previous ID.
@@ -37,36 +72,86 @@
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
 astarte_result_t astarte_key_value_entry_list_compute_next_and_prev_ids(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t *next_id, uint32_t *prev_id);
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx, uint32_t *next_id,
+    uint32_t *prev_id);
 
 /**
  * @brief Reads the current head and tail IDs for the linked list from storage.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the list.
  * @param[out] head_id Pointer to store the retrieved head ID.
  * @param[out] tail_id Pointer to store the retrieved tail ID.
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
 astarte_result_t astarte_key_value_entry_list_read_head_and_tail_ids(
-    struct zms_fs *zms_fs, uint32_t *head_id, uint32_t *tail_id);
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t *head_id, uint32_t *tail_id);
 
 /**
  * @brief Writes updated head and tail IDs to storage.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @note The usage stored for the list, if any, is left unchanged.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the list.
  * @param[in] head_id The new head ID to store.
  * @param[in] tail_id The new tail ID to store.
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
 astarte_result_t astarte_key_value_entry_list_write_head_and_tail_ids(
-    struct zms_fs *zms_fs, uint32_t head_id, uint32_t tail_id);
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t head_id, uint32_t tail_id);
+
+/**
+ * @brief Writes updated head and tail IDs to storage together with the usage of the list.
+ *
+ * @details Head, tail and usage are stored in a single ZMS write, so they are updated atomically.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the list.
+ * @param[in] head_id The new head ID to store.
+ * @param[in] tail_id The new tail ID to store.
+ * @param[in] usage The new usage to store, NULL to remove the stored usage.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ */
+astarte_result_t astarte_key_value_entry_list_write_head_tail_and_usage(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t head_id, uint32_t tail_id,
+    const struct astarte_key_value_entry_list_usage *usage);
+
+/**
+ * @brief Reads the usage stored for the list.
+ *
+ * @details The value of the pending key, if still stored, is added to the stored bytes. A list that
+ * has never been written is empty and uses zero bytes.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the list.
+ * @param[out] bytes Bytes used by the values of the list.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_NOT_FOUND No usage is stored for the list.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ */
+astarte_result_t astarte_key_value_entry_list_read_usage(
+    astarte_key_value_backend_t *backend, uint32_t list_id, size_t *bytes);
+
+/**
+ * @brief Writes the usage of the list, leaving its head and tail IDs unchanged.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] list_id Identifier of the list.
+ * @param[in] usage The new usage to store, NULL to remove the stored usage.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ */
+astarte_result_t astarte_key_value_entry_list_write_usage(astarte_key_value_backend_t *backend,
+    uint32_t list_id, const struct astarte_key_value_entry_list_usage *usage);
 
 /**
  * @brief Updates the next ID pointer of a specific list entry.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Target valid ZMS ID to update.
  * @param[in] new_next The new next ID for this entry.
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
@@ -74,12 +159,12 @@ astarte_result_t astarte_key_value_entry_list_write_head_and_tail_ids(
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
 astarte_result_t astarte_key_value_entry_list_update_next_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t new_next);
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t new_next);
 
 /**
  * @brief Updates the previous ID pointer of a specific list entry.
  *
- * @param[inout] zms_fs ZMS file system.
+ * @param[inout] backend Storage backend.
  * @param[in] idx Target valid ZMS ID to update.
  * @param[in] new_prev The new previous ID for this entry.
  * @retval ASTARTE_RESULT_OK The operation was performed correctly.
@@ -87,6 +172,6 @@ astarte_result_t astarte_key_value_entry_list_update_next_id(
  * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
  */
 astarte_result_t astarte_key_value_entry_list_update_prev_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t new_prev);
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t new_prev);
 
 #endif // KEY_VALUE_ENTRY_LIST_H
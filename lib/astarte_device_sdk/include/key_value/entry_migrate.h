@@ -0,0 +1,36 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KEY_VALUE_ENTRY_MIGRATE_H
+#define KEY_VALUE_ENTRY_MIGRATE_H
+
+/**
+ * @file key_value/entry_migrate.h
+ * @brief Migration of the stored entries between format versions.
+ */
+
+#include "astarte_device_sdk/result.h"
+
+#include "key_value/core.h"
+
+/**
+ * @brief Migrates all the stored entries from a previous format version to the current one.
+ *
+ * @details The migration is performed in place and can be safely restarted if interrupted.
+ * The caller is responsible for storing the current format version once the migration succeeds.
+ *
+ * @param[inout] backend Storage backend.
+ * @param[in] stored_version Format version found in the storage.
+ * @retval ASTARTE_RESULT_OK The operation was performed correctly.
+ * @retval ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION The stored version can't be migrated.
+ * @retval ASTARTE_RESULT_OUT_OF_MEMORY Dynamic allocation failure due to a lack of memory.
+ * @retval ASTARTE_RESULT_ZMS_ERROR An underlying ZMS file system error occurred.
+ * @retval ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR A stored entry is malformed.
+ */
+astarte_result_t astarte_key_value_entry_migrate(
+    astarte_key_value_backend_t *backend, astarte_key_value_version_t stored_version);
+
+#endif // KEY_VALUE_ENTRY_MIGRATE_H
@@ -15,6 +15,7 @@
 #include "astarte_device_sdk/astarte.h"
 #include "astarte_device_sdk/result.h"
 
+#include <zephyr/kernel.h>
 #include <zephyr/sys/hash_map.h>
 
 #include "storage/core.h"
@@ -29,6 +30,8 @@ typedef struct
     struct sys_hashmap_data map_data;
     /** @brief Main struct for the hashmap used to cache MQTT messages. */
     struct sys_hashmap map;
+    /** @brief Number of cached messages of type PUBLISH. */
+    size_t publish_count;
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     /** @brief Handle to the permanent storage. */
     astarte_storage_data_t *storage;
@@ -84,6 +87,14 @@ void astarte_mqtt_caching_insert_message(
  */
 bool astarte_mqtt_caching_find_message(astarte_mqtt_caching_t *caching, uint16_t message_id);
 
+/**
+ * @brief Count the PUBLISH messages in the cache.
+ *
+ * @param[in] caching The caching structure to use for the operation.
+ * @return The number of cached PUBLISH messages.
+ */
+size_t astarte_mqtt_caching_count_publishes(astarte_mqtt_caching_t *caching);
+
 /**
  * @brief Check if any message has timed out. For any timeout call the retransmission callback.
  *
@@ -93,6 +104,14 @@ bool astarte_mqtt_caching_find_message(astarte_mqtt_caching_t *caching, uint16_t
 void astarte_mqtt_caching_check_message_expiry(
     astarte_mqtt_caching_t *caching, astarte_mqtt_caching_retransmit_cbk_t retransmit_cbk);
 
+/**
+ * @brief Get the earliest expiration time among the cached messages.
+ *
+ * @param[in] caching The caching structure to use for the operation.
+ * @return The earliest expiration time, a timepoint that never expires when the cache is empty.
+ */
+k_timepoint_t astarte_mqtt_caching_get_next_expiry(astarte_mqtt_caching_t *caching);
+
 /**
  * @brief Reset a message expiration time.
  *
@@ -15,7 +15,9 @@
 #include "astarte_device_sdk/result.h"
 
 #include <zephyr/net/mqtt.h>
+#include <zephyr/net/socket.h>
 #include <zephyr/sys/hash_map.h>
+#include <zephyr/sys/slist.h>
 
 #include "astarte_device_sdk/device_id.h"
 
@@ -87,6 +89,10 @@ typedef struct
     char broker_port[ASTARTE_MQTT_MAX_BROKER_PORT_LEN + 1];
     /** @brief Client ID */
     char client_id[ASTARTE_MQTT_CLIENT_ID_LEN + 1];
+    /** @brief Security tag of the client certificate and private key. */
+    sec_tag_t client_cert_tag;
+    /** @brief Maximum number of unacknowledged outgoing publishes, zero for no limit. */
+    uint32_t in_flight_window;
     /** @brief Callback used to check if the client certificate is valid. */
     astarte_mqtt_refresh_client_cert_cbk_t refresh_client_cert_cbk;
     /** @brief Callback used to check if transmitted publish have been delivered. */
@@ -105,6 +111,60 @@ typedef struct
 #endif
 } astarte_mqtt_config_t;
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+/** @brief Received message waiting to be dispatched once the client has been unlocked. */
+struct astarte_mqtt_incoming_msg
+{
+    /** @brief Node in the list of received messages. */
+    sys_snode_t node;
+    /** @brief Size in chars of the topic. */
+    size_t topic_len;
+    /** @brief Payload of the message, stored after the topic. */
+    char *data;
+    /** @brief Size of the payload. */
+    size_t data_len;
+    /** @brief NULL terminated topic of the message. */
+    char topic[];
+};
+
+/** @brief Types of the events passed to the callbacks once the client has been unlocked. */
+typedef enum
+{
+    /** @brief The connection has been established, see #astarte_mqtt_on_connected_cbk_t. */
+    ASTARTE_MQTT_EVENT_CONNECTED = 0U,
+    /** @brief The connection has been terminated, see #astarte_mqtt_on_disconnected_cbk_t. */
+    ASTARTE_MQTT_EVENT_DISCONNECTED,
+    /** @brief A subscription has been acknowledged, see #astarte_mqtt_on_subscribed_cbk_t. */
+    ASTARTE_MQTT_EVENT_SUBSCRIBED,
+    /** @brief A publish has been delivered, see #astarte_mqtt_on_delivered_cbk_t. */
+    ASTARTE_MQTT_EVENT_DELIVERED,
+} astarte_mqtt_event_type_t;
+
+/** @brief Event waiting to be passed to its callback once the client has been unlocked. */
+struct astarte_mqtt_event
+{
+    /** @brief Type of the event. */
+    astarte_mqtt_event_type_t type;
+    /** @brief Parameters of the CONNACK, for #ASTARTE_MQTT_EVENT_CONNECTED. */
+    struct mqtt_connack_param connack;
+    /** @brief Message ID, for #ASTARTE_MQTT_EVENT_SUBSCRIBED and #ASTARTE_MQTT_EVENT_DELIVERED. */
+    uint16_t message_id;
+    /** @brief Return code of the SUBACK, for #ASTARTE_MQTT_EVENT_SUBSCRIBED. */
+    enum mqtt_suback_return_code return_code;
+};
+
+/**
+ * @brief Free event slots needed to read a packet.
+ *
+ * @details A packet raises at most one event, plus a disconnection if reading it fails. One more
+ * slot is kept for a disconnection raised by a transmission of the worker thread.
+ */
+#define ASTARTE_MQTT_EVENTS_INPUT_SLOTS 3U
+/** @brief Number of event slots of a client. */
+#define ASTARTE_MQTT_EVENTS_SIZE                                                                   \
+    (CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_RX_EVENTS_SIZE + ASTARTE_MQTT_EVENTS_INPUT_SLOTS)
+#endif
+
 /**
  * @brief Contains all the data related to a single MQTT client.
  */
@@ -132,6 +192,10 @@ struct astarte_mqtt
     char broker_port[ASTARTE_MQTT_MAX_BROKER_PORT_LEN + 1];
     /** @brief Client ID */
     char client_id[ASTARTE_MQTT_CLIENT_ID_LEN + 1];
+    /** @brief Security tag of the client certificate and private key. */
+    sec_tag_t client_cert_tag;
+    /** @brief Maximum number of unacknowledged outgoing publishes, zero for no limit. */
+    uint32_t in_flight_window;
     /** @brief Backoff context for the MQTT reconnection */
     struct backoff_context backoff_ctx;
     /** @brief Reconnection timepoint. */
@@ -154,6 +218,14 @@ struct astarte_mqtt
     astarte_mqtt_on_disconnected_cbk_t on_disconnected_cbk;
     /** @brief Callback used to notify the user that an MQTT message has been received. */
     astarte_mqtt_on_incoming_cbk_t on_incoming_cbk;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    /** @brief Received messages not yet passed to #on_incoming_cbk, protected by #mutex. */
+    sys_slist_t incoming_msgs;
+    /** @brief Events not yet passed to their callbacks. */
+    struct k_msgq events;
+    /** @brief Slots backing the events queue. */
+    struct astarte_mqtt_event events_buffer[ASTARTE_MQTT_EVENTS_SIZE];
+#endif
 };
 
 #ifdef __cplusplus
@@ -201,15 +273,60 @@ bool astarte_mqtt_is_connected(astarte_mqtt_t *astarte_mqtt);
 astarte_result_t astarte_mqtt_disconnect(astarte_mqtt_t *astarte_mqtt);
 
 /**
- * @brief Poll the MQTT client.
+ * @brief Prepare the MQTT client for a poll of its socket.
+ *
+ * @details Handles the connection timeout, the reconnection attempts, the retransmission of
+ * unacknowledged messages and the keepalive. The deadline is brought forward to the next of these
+ * events. Unless CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER is set the deadline is also
+ * bounded by the polling timeout of the client.
+ *
+ * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @param[out] poll_fd Poll entry for the client socket, the file descriptor is negative when the
+ * socket should not be polled.
+ * @param[inout] deadline Latest time the poll should return at.
+ */
+void astarte_mqtt_poll_prepare(
+    astarte_mqtt_t *astarte_mqtt, struct zsock_pollfd *poll_fd, k_timepoint_t *deadline);
+
+/**
+ * @brief Process the outcome of a successful poll of the MQTT client socket.
  *
- * @note This function will also take care of keeping the connection active in case of a long period
- * with no data transmission.
+ * @details With CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX the client is only locked while
+ * reading from the socket, the received messages are passed to the incoming callback afterwards.
+ * Only the events returned for this socket are checked, a failure of the poll call itself should
+ * be retried by the caller.
  *
  * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @param[in] poll_fd Poll entry filled by #astarte_mqtt_poll_prepare.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_mqtt_poll(astarte_mqtt_t *astarte_mqtt);
+astarte_result_t astarte_mqtt_poll_process(
+    astarte_mqtt_t *astarte_mqtt, const struct zsock_pollfd *poll_fd);
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+/**
+ * @brief Pass the connection, subscription and delivery events to their callbacks.
+ *
+ * @details The events are queued by the client instead of calling the callbacks, so that they are
+ * handled by the thread running the device state machine rather than by the reception thread.
+ * The client is not locked while the callbacks run.
+ *
+ * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @return True if at least one event has been dispatched, false otherwise.
+ */
+bool astarte_mqtt_dispatch_events(astarte_mqtt_t *astarte_mqtt);
+
+/**
+ * @brief Check if the client has room for the events raised by reading a packet.
+ *
+ * @details Each call to #astarte_mqtt_poll_process reads a single packet. While this function
+ * returns false the socket should not be read, the events are dispatched first.
+ *
+ * @param[in] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @return True if a packet can be read, false otherwise.
+ */
+bool astarte_mqtt_can_receive(astarte_mqtt_t *astarte_mqtt);
+#endif
 
 /** @cond INTERNAL_HIDDEN */
 // Helper to lock and assert
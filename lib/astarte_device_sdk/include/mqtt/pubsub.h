@@ -53,6 +53,17 @@ void astarte_mqtt_publish(astarte_mqtt_t *astarte_mqtt, const char *topic, void
  */
 bool astarte_mqtt_has_pending_outgoing(astarte_mqtt_t *astarte_mqtt);
 
+/**
+ * @brief Check if the in-flight window of the MQTT client can take another QoS > 0 message.
+ *
+ * @details Only the outgoing publishes count towards the window: QoS 1 ones until their PUBACK,
+ * QoS 2 ones until their PUBCOMP. Subscriptions waiting for a SUBACK are not counted.
+ *
+ * @param[in] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @return True if the window is disabled or not yet full, false otherwise.
+ */
+bool astarte_mqtt_has_in_flight_capacity(astarte_mqtt_t *astarte_mqtt);
+
 /**
  * @brief Clear all MQTT messages that are waiting to be acknoledged.
  *
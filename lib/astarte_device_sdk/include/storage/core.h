@@ -17,14 +17,81 @@
 
 #include "key_value/core.h"
 
+#if defined(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING)                               \
+    || defined(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD)
+#include <zephyr/kernel.h>
+#include <zephyr/sys/mutex.h>
+#endif
+
+/** @brief State of the transmission queue stored to skip the scan of its ring at startup. */
+typedef struct
+{
+    /** @brief Position of the oldest stored message. */
+    uint32_t head;
+    /** @brief Position of the newest stored message. */
+    uint32_t tail;
+    /** @brief Sequence number of the message at the tail. */
+    uint64_t sequence_number;
+    /** @brief Bytes of the messages stored in the ring. */
+    uint32_t ring_usage_bytes;
+    /** @brief Messages already discarded from the record at the head. */
+    uint32_t head_offset;
+} astarte_storage_transmission_checkpoint_t;
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+/** @brief Small transmission messages buffered in RAM, written to flash as a single ring record. */
+typedef struct
+{
+    /** @brief Serialized messages, one after the other. */
+    uint8_t buffer[CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACK_SIZE];
+    /** @brief Bytes of the buffer in use. */
+    size_t size;
+    /** @brief Number of messages in the buffer. */
+    uint32_t count;
+    /** @brief Sequence number of the newest message in the buffer. */
+    uint64_t sequence_number;
+    /** @brief Latest expiry of the messages in the buffer. */
+    uint64_t expiry_timestamp;
+    /** @brief Time at which the buffer has to be written to flash. */
+    k_timepoint_t deadline;
+    /** @brief Guards the buffer from pushes, reads and writes of different threads. */
+    struct sys_mutex mutex;
+} astarte_storage_transmission_pack_t;
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+/** @brief Ring record of the transmission queue read from flash before reaching the head. */
+typedef struct
+{
+    /** @brief Position of the record. */
+    uint32_t position;
+    /** @brief Decompressed content of the record, NULL if the entry is unused. */
+    uint8_t *record;
+    /** @brief Size of the decompressed content. */
+    size_t size;
+    /** @brief Size of the record in flash, as accounted in the ring usage. */
+    size_t stored_size;
+} astarte_storage_transmission_read_ahead_entry_t;
+
+/** @brief Ring records following the head of the transmission queue, kept in RAM. */
+typedef struct
+{
+    /** @brief Records, each one in the entry of its position modulo the number of entries. */
+    astarte_storage_transmission_read_ahead_entry_t
+        entries[CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD_RECORDS];
+    /** @brief Guards the entries from reads and discards of different threads. */
+    struct sys_mutex mutex;
+} astarte_storage_transmission_read_ahead_t;
+#endif
+
 /**
  * @brief Handle containing the persistent state for device storage.
  * @details This struct holds the context for the three ZMS namespaces used by the storage.
  */
 typedef struct
 {
-    /** @brief ZMS file system handle shared between all storages */
-    struct zms_fs zms_fs;
+    /** @brief Storage backend shared between all storages */
+    astarte_key_value_backend_t backend;
     /** @brief Key value storage handle for synchronization state */
     astarte_key_value_t sync_storage;
     /** @brief Key value storage handle for introspection data */
@@ -33,6 +100,36 @@ typedef struct
     astarte_key_value_t prop_storage;
     /** @brief Key value storage handle for transmission data */
     astarte_key_value_t trans_storage;
+    /** @brief Serializes the transmission functions called by different threads.
+     *
+     * @details Held by every transmission function, guards the ring usage, the checkpoint and the
+     * expiry index along with the indexes of the queue passed to the functions.
+     */
+    struct sys_mutex trans_mutex;
+    /** @brief Bytes of the transmission messages stored in the ring, guarded by #trans_mutex */
+    size_t trans_ring_usage_bytes;
+    /** @brief Latest checkpoint of the transmission queue, guarded by #trans_mutex */
+    astarte_storage_transmission_checkpoint_t trans_checkpoint;
+    /** @brief Sequence number of the newest transmission message, guarded by #trans_mutex */
+    uint64_t trans_tail_sequence_number;
+    /** @brief Pushes and discards since the checkpoint was stored, guarded by #trans_mutex */
+    uint32_t trans_checkpoint_pending;
+    /** @brief Latest expiry of the messages in the expiry bucket of the tail, not yet stored */
+    uint64_t trans_expiry_tail;
+    /** @brief Latest expiry of the messages in a closed expiry bucket, read from flash */
+    uint64_t trans_expiry_cached;
+    /** @brief Expiry bucket of #trans_expiry_cached */
+    uint32_t trans_expiry_cached_bucket;
+    /** @brief True if #trans_expiry_cached is valid */
+    bool trans_expiry_has_cached;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    /** @brief Transmission messages not yet written to flash */
+    astarte_storage_transmission_pack_t trans_pack;
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    /** @brief Transmission records read from flash ahead of the head */
+    astarte_storage_transmission_read_ahead_t trans_read_ahead;
+#endif
     /** @brief Flag to ensure we don't double-init or use uninitialized handles */
     bool initialized;
 } astarte_storage_data_t;
@@ -43,10 +140,14 @@ extern "C" {
 
 /**
  * @brief Initialize the device storage and open all required ZMS namespaces.
+ * @details Each device instance owns a separate area of the flash partition, holding all of its
+ * namespaces, MQTT session and transmission ring.
  * @param[in,out] handle Pointer to the handle structure to initialize.
+ * @param[in] instance Index of the device instance owning the storage, lower than
+ * CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES.
  * @return ASTARTE_RESULT_OK if successful.
  */
-astarte_result_t astarte_storage_init(astarte_storage_data_t *handle);
+astarte_result_t astarte_storage_init(astarte_storage_data_t *handle, size_t instance);
 
 /**
  * @brief Close and clean up the device storage.
@@ -54,6 +155,16 @@ astarte_result_t astarte_storage_init(astarte_storage_data_t *handle);
  */
 void astarte_storage_destroy(astarte_storage_data_t *handle);
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+/**
+ * @brief Perform a bounded step of compaction of the deleted entries in the device storage.
+ * @param[in,out] handle Pointer to an initialized handle structure.
+ * @return ASTARTE_RESULT_OK if a step has been performed, ASTARTE_RESULT_NOT_FOUND if there is
+ * nothing left to compact, otherwise an error code.
+ */
+astarte_result_t astarte_storage_compact(astarte_storage_data_t *handle);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,13 @@ struct astarte_storage_transmission_msg
     uint64_t timestamp;
     /** @brief Global sequence identifier for cross-queue ordering. */
     uint64_t sequence_number;
+    /**
+     * @brief Time in milliseconds since the epoch after which the message can be dropped.
+     *
+     * @details Zero if the message never expires. It is recorded in the expiry index of the queue
+     * on push and it is not filled by peek.
+     */
+    uint64_t expiry_timestamp;
 };
 
 /** @brief Indexes tracking the head and tail of the transmission storage queue. */
@@ -44,7 +51,8 @@ typedef struct
     uint32_t head;
     /** @brief Tail index of the transmission queue. */
     uint32_t tail;
-
+    /** @brief Messages already discarded from the record at the head, when it packs several. */
+    uint32_t head_offset;
 } astarte_storage_transmission_indexes_t;
 
 #ifdef __cplusplus
@@ -118,6 +126,54 @@ astarte_result_t astarte_storage_transmission_get(astarte_storage_data_t *handle
 astarte_result_t astarte_storage_transmission_discard(
     astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes);
 
+/**
+ * @brief Drops the stored messages at the head of the queue whose expiry has passed.
+ *
+ * @details Messages are indexed by their expiry in groups of consecutive ring records. A group is
+ * dropped without reading its records once all of its messages have expired. Groups holding a
+ * message that never expires, or pushed before a restart and not yet complete, are never dropped.
+ *
+ * @param[in] handle Pointer to the storage handle.
+ * @param[in,out] indexes Pointer to the transmission indexes, updated upon drop.
+ * @param[in] now_ms Current time in milliseconds since the epoch.
+ * @param[out] dropped Number of dropped ring records, can be NULL.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+astarte_result_t astarte_storage_transmission_drop_expired(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, uint64_t now_ms, uint32_t *dropped);
+
+/**
+ * @brief Writes the small messages buffered in RAM to flash as a single ring record.
+ *
+ * @details Does nothing unless CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING is set.
+ *
+ * @param[in] handle Pointer to the storage handle.
+ * @param[in,out] indexes Pointer to the transmission indexes, updated upon successful write.
+ * @param[in] force Write the buffered messages even if the oldest has not reached the timeout.
+ * @return ASTARTE_RESULT_OK if successful or if there is nothing to write, otherwise an error code.
+ */
+astarte_result_t astarte_storage_transmission_flush(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, bool force);
+
+/**
+ * @brief Gets the time at which the messages buffered in RAM should be written to flash.
+ *
+ * @param[in] handle Pointer to the storage handle.
+ * @return The deadline of the oldest buffered message, a never expiring timepoint when there
+ * is nothing buffered or CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING is not set.
+ */
+k_timepoint_t astarte_storage_transmission_get_flush_deadline(astarte_storage_data_t *handle);
+
+/**
+ * @brief Frees the transmission messages kept in RAM ahead of the head of the queue.
+ *
+ * @details Does nothing unless CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD is set.
+ * The messages are read again from flash when needed.
+ *
+ * @param[in] handle Pointer to the storage handle.
+ */
+void astarte_storage_transmission_release(astarte_storage_data_t *handle);
+
 /**
  * @brief Frees the memory allocated for a transmission storage message payload and paths.
  *
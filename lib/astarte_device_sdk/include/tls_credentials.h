@@ -14,6 +14,8 @@
 
 #include <psa/crypto.h>
 
+#include <zephyr/net/tls_credentials.h>
+
 #include "astarte_device_sdk/astarte.h"
 #include "astarte_device_sdk/result.h"
 
@@ -45,17 +47,20 @@ extern "C" {
 /**
  * @brief Add client TLS credentials for mutual authentication.
  *
+ * @param[in] sec_tag Security tag to add the credentials to.
  * @param[in] client_crt Private key and client certificate to add.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_tls_credential_add(astarte_tls_credentials_client_crt_t *client_crt);
+astarte_result_t astarte_tls_credential_add(
+    sec_tag_t sec_tag, astarte_tls_credentials_client_crt_t *client_crt);
 
 /**
  * @brief Remove client TLS credentials for mutual authentication.
  *
+ * @param[in] sec_tag Security tag holding the credentials.
  * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
  */
-astarte_result_t astarte_tls_credential_delete(void);
+astarte_result_t astarte_tls_credential_delete(sec_tag_t sec_tag);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,213 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/backend.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+
+#include "alloc.h"
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+/** @brief Initial number of records the records array can hold. */
+#define RAM_INITIAL_RECORDS 16
+/** @brief Bytes accounted to a record, its data and its bookkeeping. */
+#define RAM_RECORD_COST(len) ((len) + sizeof(struct astarte_key_value_backend_ram_record))
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static ssize_t ram_backend_read(
+    astarte_key_value_backend_t *backend, uint32_t id, void *data, size_t len);
+static ssize_t ram_backend_write(
+    astarte_key_value_backend_t *backend, uint32_t id, const void *data, size_t len);
+static int ram_backend_remove(astarte_key_value_backend_t *backend, uint32_t id);
+static ssize_t ram_backend_get_data_length(astarte_key_value_backend_t *backend, uint32_t id);
+static size_t ram_backend_capacity(astarte_key_value_backend_t *backend);
+static void ram_backend_close(astarte_key_value_backend_t *backend);
+/**
+ * @brief Find the position of a record in the sorted records array.
+ *
+ * @param[in] ram State of the RAM backend.
+ * @param[in] id ID of the record.
+ * @param[out] position Position of the record, or where it should be inserted if not found.
+ * @return True if the record has been found, false otherwise.
+ */
+static bool ram_find(
+    const struct astarte_key_value_backend_ram *ram, uint32_t id, size_t *position);
+static int ram_grow(struct astarte_key_value_backend_ram *ram);
+
+/************************************************
+ *         Static variables declaration         *
+ ***********************************************/
+
+static const astarte_key_value_backend_api_t ram_backend_api = {
+    .read = ram_backend_read,
+    .write = ram_backend_write,
+    .remove = ram_backend_remove,
+    .get_data_length = ram_backend_get_data_length,
+    .capacity = ram_backend_capacity,
+    .close = ram_backend_close,
+};
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_key_value_backend_ram_open(
+    astarte_key_value_backend_t *backend, size_t max_bytes)
+{
+    if (!backend || (max_bytes == 0)) {
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    memset(backend, 0, sizeof(astarte_key_value_backend_t));
+    backend->ram.max_bytes = max_bytes;
+    backend->api = &ram_backend_api;
+    return ASTARTE_RESULT_OK;
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static ssize_t ram_backend_read(
+    astarte_key_value_backend_t *backend, uint32_t id, void *data, size_t len)
+{
+    size_t position = 0;
+    if (!ram_find(&backend->ram, id, &position)) {
+        return -ENOENT;
+    }
+
+    const struct astarte_key_value_backend_ram_record *record = &backend->ram.records[position];
+    size_t read_len = MIN(len, record->len);
+    memcpy(data, record->data, read_len);
+    return (ssize_t) read_len;
+}
+
+static ssize_t ram_backend_write(
+    astarte_key_value_backend_t *backend, uint32_t id, const void *data, size_t len)
+{
+    struct astarte_key_value_backend_ram *ram = &backend->ram;
+
+    // As for ZMS, writing an empty record deletes it
+    if (len == 0) {
+        int ret = ram_backend_remove(backend, id);
+        return (ret == -ENOENT) ? 0 : ret;
+    }
+
+    size_t position = 0;
+    bool found = ram_find(ram, id, &position);
+    size_t old_cost = found ? RAM_RECORD_COST(ram->records[position].len) : 0;
+    if (ram->used_bytes - old_cost + RAM_RECORD_COST(len) > ram->max_bytes) {
+        return -ENOSPC;
+    }
+
+    uint8_t *record_data = astarte_malloc(len);
+    if (!record_data) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return -ENOMEM;
+    }
+    memcpy(record_data, data, len);
+
+    if (!found) {
+        if ((ram->count == ram->allocated) && (ram_grow(ram) != 0)) {
+            astarte_free(record_data);
+            return -ENOMEM;
+        }
+        memmove(&ram->records[position + 1], &ram->records[position],
+            (ram->count - position) * sizeof(struct astarte_key_value_backend_ram_record));
+        ram->count++;
+    } else {
+        astarte_free(ram->records[position].data);
+    }
+
+    ram->records[position].id = id;
+    ram->records[position].len = len;
+    ram->records[position].data = record_data;
+    ram->used_bytes = ram->used_bytes - old_cost + RAM_RECORD_COST(len);
+    return (ssize_t) len;
+}
+
+static int ram_backend_remove(astarte_key_value_backend_t *backend, uint32_t id)
+{
+    struct astarte_key_value_backend_ram *ram = &backend->ram;
+
+    size_t position = 0;
+    if (!ram_find(ram, id, &position)) {
+        return -ENOENT;
+    }
+
+    ram->used_bytes -= RAM_RECORD_COST(ram->records[position].len);
+    astarte_free(ram->records[position].data);
+    memmove(&ram->records[position], &ram->records[position + 1],
+        (ram->count - position - 1) * sizeof(struct astarte_key_value_backend_ram_record));
+    ram->count--;
+    return 0;
+}
+
+static ssize_t ram_backend_get_data_length(astarte_key_value_backend_t *backend, uint32_t id)
+{
+    size_t position = 0;
+    if (!ram_find(&backend->ram, id, &position)) {
+        return -ENOENT;
+    }
+    return (ssize_t) backend->ram.records[position].len;
+}
+
+static size_t ram_backend_capacity(astarte_key_value_backend_t *backend)
+{
+    return backend->ram.max_bytes;
+}
+
+static void ram_backend_close(astarte_key_value_backend_t *backend)
+{
+    struct astarte_key_value_backend_ram *ram = &backend->ram;
+    for (size_t i = 0; i < ram->count; i++) {
+        astarte_free(ram->records[i].data);
+    }
+    astarte_free(ram->records);
+    memset(ram, 0, sizeof(struct astarte_key_value_backend_ram));
+}
+
+static bool ram_find(const struct astarte_key_value_backend_ram *ram, uint32_t id, size_t *position)
+{
+    size_t low = 0;
+    size_t high = ram->count;
+    while (low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if (ram->records[mid].id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *position = low;
+    return (low < ram->count) && (ram->records[low].id == id);
+}
+
+static int ram_grow(struct astarte_key_value_backend_ram *ram)
+{
+    size_t allocated = (ram->allocated == 0) ? RAM_INITIAL_RECORDS : ram->allocated * 2;
+    struct astarte_key_value_backend_ram_record *records = astarte_realloc(
+        ram->records, allocated * sizeof(struct astarte_key_value_backend_ram_record));
+    if (!records) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return -ENOMEM;
+    }
+    ram->records = records;
+    ram->allocated = allocated;
+    return 0;
+}
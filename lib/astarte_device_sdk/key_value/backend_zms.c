@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/backend.h"
+
+#include <string.h>
+
+#include <zephyr/drivers/flash.h>
+
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static ssize_t zms_backend_read(
+    astarte_key_value_backend_t *backend, uint32_t id, void *data, size_t len);
+static ssize_t zms_backend_write(
+    astarte_key_value_backend_t *backend, uint32_t id, const void *data, size_t len);
+static int zms_backend_remove(astarte_key_value_backend_t *backend, uint32_t id);
+static ssize_t zms_backend_get_data_length(astarte_key_value_backend_t *backend, uint32_t id);
+static size_t zms_backend_capacity(astarte_key_value_backend_t *backend);
+
+/************************************************
+ *         Static variables declaration         *
+ ***********************************************/
+
+static const astarte_key_value_backend_api_t zms_backend_api = {
+    .read = zms_backend_read,
+    .write = zms_backend_write,
+    .remove = zms_backend_remove,
+    .get_data_length = zms_backend_get_data_length,
+    .capacity = zms_backend_capacity,
+    .close = NULL,
+};
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_key_value_backend_zms_open(astarte_key_value_backend_t *backend,
+    const struct device *flash_device, off_t flash_offset, uint64_t flash_partition_size)
+{
+    struct flash_pages_info fp_info = { 0 };
+
+    if (!device_is_ready(flash_device)) {
+        ASTARTE_LOG_ERR("Flash device %s not ready.", flash_device->name);
+        return ASTARTE_RESULT_DEVICE_NOT_READY;
+    }
+
+    int flash_rc = flash_get_page_info_by_offs(flash_device, flash_offset, &fp_info);
+    if (flash_rc) {
+        ASTARTE_LOG_ERR("Unable to get flash page info: %d.", flash_rc);
+        return ASTARTE_RESULT_INVALID_CONFIGURATION;
+    }
+
+    uint16_t flash_sector_count = (uint16_t) (flash_partition_size / fp_info.size);
+
+    memset(backend, 0, sizeof(astarte_key_value_backend_t));
+    backend->zms_fs.flash_device = flash_device;
+    backend->zms_fs.offset = flash_offset;
+    backend->zms_fs.sector_size = fp_info.size;
+    backend->zms_fs.sector_count = flash_sector_count;
+
+#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
+    int zms_rc = zms_mount_force(&backend->zms_fs);
+#else
+    int zms_rc = zms_mount(&backend->zms_fs);
+#endif
+    if (zms_rc != 0) {
+        ASTARTE_LOG_ERR("ZMS mount error: %s (%d).", strerror(-zms_rc), zms_rc);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    backend->api = &zms_backend_api;
+    return ASTARTE_RESULT_OK;
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static ssize_t zms_backend_read(
+    astarte_key_value_backend_t *backend, uint32_t id, void *data, size_t len)
+{
+    return zms_read(&backend->zms_fs, id, data, len);
+}
+
+static ssize_t zms_backend_write(
+    astarte_key_value_backend_t *backend, uint32_t id, const void *data, size_t len)
+{
+    return zms_write(&backend->zms_fs, id, data, len);
+}
+
+static int zms_backend_remove(astarte_key_value_backend_t *backend, uint32_t id)
+{
+    return zms_delete(&backend->zms_fs, id);
+}
+
+static ssize_t zms_backend_get_data_length(astarte_key_value_backend_t *backend, uint32_t id)
+{
+    return zms_get_data_length(&backend->zms_fs, id);
+}
+
+static size_t zms_backend_capacity(astarte_key_value_backend_t *backend)
+{
+    return (size_t) backend->zms_fs.sector_size * backend->zms_fs.sector_count;
+}
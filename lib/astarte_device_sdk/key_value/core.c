@@ -9,23 +9,21 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <zephyr/drivers/flash.h>
 #include <zephyr/kernel.h>
-#include <zephyr/storage/flash_map.h>
 #include <zephyr/sys/mutex.h>
 #include <zephyr/sys/util.h>
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
 
 #include "alloc.h"
+#include "key_value/backend.h"
 #include "key_value/entry.h"
+#include "key_value/entry_batch.h"
+#include "key_value/entry_chunk.h"
 #include "key_value/entry_delete.h"
+#include "key_value/entry_hash.h"
+#include "key_value/entry_index.h"
 #include "key_value/entry_intent.h"
+#include "key_value/entry_list.h"
+#include "key_value/entry_migrate.h"
 #include "key_value/mutex.h"
 #include "log.h"
 
@@ -38,6 +36,8 @@ ASTARTE_LOG_MODULE_REGISTER(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VAL
 #define FULL_KEY(alternate, key) ((alternate) ? ((1U << 16U) + (uint32_t) (key)) : (uint32_t) (key))
 
 ASTARTE_SCOPE_DEFER_DEFINE(astarte_key_value_mutex_unlock);
+ASTARTE_SCOPE_DEFER_DEFINE(
+    astarte_key_value_entry_batch_discard, struct astarte_key_value_entry_batch *);
 
 static inline void free_char_ptr(char **ptr)
 {
@@ -53,99 +53,85 @@ ASTARTE_SCOPE_DEFER_DEFINE(free_char_ptr, char **);
  *         Static functions declaration         *
  ***********************************************/
 
-static astarte_result_t find_next_matching_id(
-    astarte_key_value_iter_t *iter, uint32_t *next_id, bool *has_next);
-static astarte_result_t read_next_key(
-    astarte_key_value_iter_t *iter, uint32_t next_id, char **next_key);
+static astarte_result_t open_backend(astarte_key_value_backend_t *backend);
+static astarte_result_t resolve_list_id(astarte_key_value_t *kv_storage, bool allocate);
+static astarte_result_t resolve_chunk_list_id(astarte_key_value_t *kv_storage, bool allocate);
+static astarte_result_t insert_value(
+    astarte_key_value_t *kv_storage, const char *key, const void *value, size_t value_size);
+static astarte_result_t write_value_entry(astarte_key_value_t *kv_storage, const char *key,
+    const void *raw_value, size_t raw_value_size, size_t value_size, bool chunked,
+    uint8_t generation);
+static astarte_result_t read_value(astarte_key_value_t *kv_storage, uint32_t entry_id,
+    const char *key, size_t offset, void *value, size_t *value_size, size_t *total_size);
+static astarte_result_t prepare_chunks(
+    astarte_key_value_t *kv_storage, const char *key, size_t value_size, uint8_t *generation);
+static astarte_result_t find_chunk(astarte_key_value_t *kv_storage, const char *key,
+    uint8_t generation, size_t index, bool allocate, uint32_t *chunk_id);
+static astarte_result_t write_chunk(astarte_key_value_t *kv_storage, const char *key,
+    uint8_t generation, size_t index, const void *data);
+static astarte_result_t delete_chunks(
+    astarte_key_value_t *kv_storage, const char *key, uint8_t generation, size_t first_index);
+static void discard_writer_chunks(astarte_key_value_writer_t *writer);
+static astarte_result_t check_quota(astarte_key_value_t *kv_storage, uint32_t entry_id,
+    size_t value_size, size_t *old_value_size);
+static astarte_result_t load_usage(astarte_key_value_t *kv_storage);
+static astarte_result_t drop_usage(astarte_key_value_t *kv_storage);
+static void pending_usage(astarte_key_value_t *kv_storage, const char *key, size_t old_value_size,
+    struct astarte_key_value_entry_list_usage *usage);
+static astarte_result_t delete_key(astarte_key_value_t *kv_storage, const char *key);
+static astarte_result_t remove_entry(
+    astarte_key_value_t *kv_storage, uint32_t entry_id, const char *key);
+static astarte_result_t read_entry_key(
+    astarte_key_value_t *kv_storage, uint32_t entry_id, char **key);
+static astarte_result_t next_live_id(
+    astarte_key_value_t *kv_storage, uint32_t idx, uint32_t *next_id);
+static astarte_result_t batch_append_op(astarte_key_value_batch_t *batch, const char *key,
+    const void *value, size_t value_size, bool is_delete);
+static astarte_result_t batch_apply_inserts(astarte_key_value_batch_t *batch, size_t *op_idx);
+#ifndef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
 static astarte_result_t heal_iterator_post_delete(
     astarte_key_value_iter_t *iter, const char *next_key);
+#endif
 
 /************************************************
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_key_value_open(astarte_key_value_cfg_t config, struct zms_fs *zms_fs)
+#ifdef CONFIG_ZMS
+astarte_result_t astarte_key_value_open(
+    astarte_key_value_cfg_t config, astarte_key_value_backend_t *backend)
 {
-    struct flash_pages_info fp_info = { 0 };
-
-    if (!device_is_ready(config.flash_device)) {
-        ASTARTE_LOG_ERR("Flash device %s not ready.", config.flash_device->name);
-        return ASTARTE_RESULT_DEVICE_NOT_READY;
-    }
-
-    int flash_rc = flash_get_page_info_by_offs(config.flash_device, config.flash_offset, &fp_info);
-    if (flash_rc) {
-        ASTARTE_LOG_ERR("Unable to get flash page info: %d.", flash_rc);
-        return ASTARTE_RESULT_INVALID_CONFIGURATION;
+    astarte_result_t ares = astarte_key_value_backend_zms_open(
+        backend, config.flash_device, config.flash_offset, config.flash_partition_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
     }
-
-    uint16_t flash_sector_count = (uint16_t) (config.flash_partition_size / fp_info.size);
-
-    memset(zms_fs, 0, sizeof(struct zms_fs));
-    zms_fs->flash_device = config.flash_device;
-    zms_fs->offset = config.flash_offset;
-    zms_fs->sector_size = fp_info.size;
-    zms_fs->sector_count = flash_sector_count;
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-    int zms_rc = zms_mount_force(zms_fs);
-#else
-    int zms_rc = zms_mount(zms_fs);
+    return open_backend(backend);
+}
 #endif
-    if (zms_rc != 0) {
-        ASTARTE_LOG_ERR("ZMS mount error: %s (%d).", strerror(-zms_rc), zms_rc);
-        return ASTARTE_RESULT_ZMS_ERROR;
-    }
-
-    astarte_key_value_version_t current_version = { .major = ASTARTE_KEY_VALUE_FORMAT_VERSION_MAJOR,
-        .minor = ASTARTE_KEY_VALUE_FORMAT_VERSION_MINOR,
-        .patch = ASTARTE_KEY_VALUE_FORMAT_VERSION_PATCH };
-    astarte_key_value_version_t stored_version = { 0 };
-
-    ssize_t ver_rc = zms_read(
-        zms_fs, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID, &stored_version, sizeof(stored_version));
-
-    if (ver_rc == -ENOENT) {
-        // Version not found, assuming empty ZMS. Write the current format version.
-        ver_rc = zms_write(
-            zms_fs, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID, &current_version, sizeof(current_version));
-        if (ver_rc < 0) {
-            ASTARTE_LOG_ERR("Failed to initialize ZMS format version: %d", (int) ver_rc);
-            return ASTARTE_RESULT_ZMS_ERROR;
-        }
-        ASTARTE_LOG_INF("Initialized ZMS with format version %d.%d.%d", current_version.major,
-            current_version.minor, current_version.patch);
-    } else if (ver_rc != sizeof(current_version)) {
-        ASTARTE_LOG_ERR("Failed to read ZMS format version: %d", (int) ver_rc);
-        return ASTARTE_RESULT_ZMS_ERROR;
-    } else if (stored_version.major != current_version.major
-        || stored_version.minor != current_version.minor
-        || stored_version.patch != current_version.patch) {
-
-        // A version mismatch indicates the partition was written by an older/newer driver
-        ASTARTE_LOG_ERR("ZMS format version mismatch! Expected %d.%d.%d, found %d.%d.%d. Migration "
-                        "or wipe required.",
-            current_version.major, current_version.minor, current_version.patch,
-            stored_version.major, stored_version.minor, stored_version.patch);
-        return ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION;
-    }
 
-    astarte_result_t ares = astarte_key_value_entry_intent_resolve(zms_fs);
-    // Explicitly handle the fatal corruption scenario
-    if (ares == ASTARTE_RESULT_KEY_VALUE_RECOVERY_FAILED) {
-        ASTARTE_LOG_ERR("Unrecoverable ZMS corruption detected during mount check.");
+astarte_result_t astarte_key_value_open_ram(size_t max_bytes, astarte_key_value_backend_t *backend)
+{
+    astarte_result_t ares = astarte_key_value_backend_ram_open(backend, max_bytes);
+    if (ares != ASTARTE_RESULT_OK) {
         return ares;
     }
+    ares = open_backend(backend);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Failed to resolve leftover intents during initialization: %s",
-            astarte_result_to_name(ares));
-        return ares;
+        astarte_key_value_backend_close(backend);
     }
+    return ares;
+}
 
-    return ASTARTE_RESULT_OK;
+void astarte_key_value_close(astarte_key_value_backend_t *backend)
+{
+    if (!backend) {
+        return;
+    }
+    astarte_key_value_backend_close(backend);
 }
 
-astarte_result_t astarte_key_value_new(struct zms_fs *zms_fs, const char *namespace,
+astarte_result_t astarte_key_value_new(astarte_key_value_backend_t *backend, const char *namespace,
     uint8_t max_quota_pct, astarte_key_value_t *kv_storage)
 {
     size_t namespace_cpy_size = strlen(namespace) + 1;
@@ -157,42 +143,47 @@ astarte_result_t astarte_key_value_new(struct zms_fs *zms_fs, const char *namesp
     }
     strncpy(namespace_cpy, namespace, namespace_cpy_size);
 
+    scope_var_init(
+        scoped_char, chunk_namespace, astarte_key_value_entry_chunk_namespace(namespace));
+    if (!chunk_namespace) {
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
     kv_storage->namespace = namespace_cpy;
-    kv_storage->zms_fs = zms_fs;
+    kv_storage->backend = backend;
+    kv_storage->list_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    kv_storage->chunk_namespace = chunk_namespace;
+    kv_storage->chunk_list_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
 
-    size_t total_partition_bytes = zms_fs->sector_size * zms_fs->sector_count;
+    size_t total_partition_bytes = astarte_key_value_backend_capacity(backend);
     const size_t one_hundred_prc = 100;
     size_t calculated_max_bytes = (total_partition_bytes * max_quota_pct) / one_hundred_prc;
     kv_storage->max_quota_bytes = calculated_max_bytes;
     kv_storage->current_usage_bytes = 0;
 
-    // If a quota is set, calculate current usage immediately
-    if (calculated_max_bytes > 0) {
-        astarte_result_t ares = astarte_key_value_mutex_lock();
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Failed to lock mutex");
-            return ares;
-        }
-        scope_defer(astarte_key_value_mutex_unlock)();
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to lock mutex");
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
 
-        astarte_key_value_iter_t iter;
-        astarte_result_t iter_res = astarte_key_value_iterator_init(kv_storage, &iter);
-        while (iter_res == ASTARTE_RESULT_OK) {
-            size_t entry_size = 0;
-            astarte_result_t read_res = astarte_key_value_entry_read_value(
-                kv_storage->zms_fs, iter.current_id, NULL, &entry_size);
-            if (read_res == ASTARTE_RESULT_OK) {
-                kv_storage->current_usage_bytes += entry_size;
-            } else {
-                ASTARTE_LOG_WRN("Failed to read size for ID %d during quota init", iter.current_id);
-            }
+    ares = astarte_key_value_entry_intent_resolve(backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
 
-            iter_res = astarte_key_value_iterator_next(&iter);
-        }
+    // The usage is stored only for namespaces with a quota, where it is kept updated
+    ares = (calculated_max_bytes > 0) ? load_usage(kv_storage) : drop_usage(kv_storage);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Namespace usage initialization failed: %s", astarte_result_to_name(ares));
+        return ares;
     }
 
     // Leave the memory intact for kv_storage
     namespace_cpy = NULL;
+    chunk_namespace = NULL;
 
     return ASTARTE_RESULT_OK;
 }
@@ -203,15 +194,14 @@ void astarte_key_value_destroy(astarte_key_value_t *kv_storage)
     if (kv_storage) {
         astarte_free(kv_storage->namespace);
         kv_storage->namespace = NULL;
+        astarte_free(kv_storage->chunk_namespace);
+        kv_storage->chunk_namespace = NULL;
     }
 }
 
 astarte_result_t astarte_key_value_insert(
     astarte_key_value_t *kv_storage, const char *key, const void *value, size_t value_size)
 {
-    uint32_t entry_id = 0;
-    size_t old_value_size = 0;
-
     astarte_result_t ares = astarte_key_value_mutex_lock();
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed to lock mutex");
@@ -219,54 +209,13 @@ astarte_result_t astarte_key_value_insert(
     }
     scope_defer(astarte_key_value_mutex_unlock)();
 
-    ares = astarte_key_value_entry_intent_resolve(kv_storage->zms_fs);
+    ares = astarte_key_value_entry_intent_resolve(kv_storage->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
         return ares;
     }
 
-    ares = astarte_key_value_entry_find_or_alloc(
-        kv_storage->zms_fs, kv_storage->namespace, key, &entry_id, true);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Key finding/allocation failed %s.", astarte_result_to_name(ares));
-        return ares;
-    }
-
-    // Check if this is an update and extract the old size if a quota is active
-    if (kv_storage->max_quota_bytes > 0) {
-        ares = astarte_key_value_entry_read_value(
-            kv_storage->zms_fs, entry_id, NULL, &old_value_size);
-        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
-            ASTARTE_LOG_ERR("Read failed %s.", astarte_result_to_name(ares));
-            return ares;
-        }
-
-        // Check if the size has been desyncronized
-        if (kv_storage->current_usage_bytes < old_value_size) {
-            // At least old_value_size bytes are used
-            kv_storage->current_usage_bytes = old_value_size;
-        }
-
-        size_t projected_size = (kv_storage->current_usage_bytes + value_size) - old_value_size;
-        if (projected_size > kv_storage->max_quota_bytes) {
-            ASTARTE_LOG_WRN("Namespace %s quota exceeded.", kv_storage->namespace);
-            return ASTARTE_RESULT_OUT_OF_SPACE;
-        }
-    }
-
-    ares = astarte_key_value_entry_write(
-        kv_storage->zms_fs, entry_id, kv_storage->namespace, key, value, value_size);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Insert failed %s.", astarte_result_to_name(ares));
-        return ares;
-    }
-
-    // Safely update the RAM counter post-write
-    if (kv_storage->max_quota_bytes > 0) {
-        kv_storage->current_usage_bytes
-            = (kv_storage->current_usage_bytes + value_size) - old_value_size;
-    }
-    return ASTARTE_RESULT_OK;
+    return insert_value(kv_storage, key, value, value_size);
 }
 
 astarte_result_t astarte_key_value_find(
@@ -281,32 +230,40 @@ astarte_result_t astarte_key_value_find(
     }
     scope_defer(astarte_key_value_mutex_unlock)();
 
-    ares = astarte_key_value_entry_intent_resolve(kv_storage->zms_fs);
+    ares = astarte_key_value_entry_intent_resolve(kv_storage->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
         return ares;
     }
 
     ares = astarte_key_value_entry_find_or_alloc(
-        kv_storage->zms_fs, kv_storage->namespace, key, &entry_id, false);
+        kv_storage->backend, kv_storage->namespace, key, &entry_id, false);
     if (ares != ASTARTE_RESULT_OK) {
         // No error logs as this could be a not found case, which is not necessarily an error
         return ares;
     }
 
-    ares = astarte_key_value_entry_read_value(kv_storage->zms_fs, entry_id, value, value_size);
+    // Without an output buffer nothing is read, only the size of the value is returned
+    size_t read_size = value ? *value_size : 0;
+    size_t total_size = 0;
+    ares = read_value(kv_storage, entry_id, key, 0, value, &read_size, &total_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Get value of key-value storage failed %s.", astarte_result_to_name(ares));
         return ares;
     }
+    if (value && (read_size < total_size)) {
+        ASTARTE_LOG_ERR("Value buffer too small for key %s", key);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
 
+    *value_size = total_size;
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_delete(astarte_key_value_t *kv_storage, const char *key)
+astarte_result_t astarte_key_value_read(astarte_key_value_t *kv_storage, const char *key,
+    size_t offset, void *value, size_t *value_size, size_t *total_size)
 {
     uint32_t entry_id = 0;
-    size_t deleted_value_size = 0;
 
     astarte_result_t ares = astarte_key_value_mutex_lock();
     if (ares != ASTARTE_RESULT_OK) {
@@ -315,45 +272,49 @@ astarte_result_t astarte_key_value_delete(astarte_key_value_t *kv_storage, const
     }
     scope_defer(astarte_key_value_mutex_unlock)();
 
-    ares = astarte_key_value_entry_intent_resolve(kv_storage->zms_fs);
+    ares = astarte_key_value_entry_intent_resolve(kv_storage->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
         return ares;
     }
 
     ares = astarte_key_value_entry_find_or_alloc(
-        kv_storage->zms_fs, kv_storage->namespace, key, &entry_id, false);
+        kv_storage->backend, kv_storage->namespace, key, &entry_id, false);
     if (ares != ASTARTE_RESULT_OK) {
         // No error logs as this could be a not found case, which is not necessarily an error
         return ares;
     }
 
-    // If a quota is active, grab the size of the entry before wiping it
-    if (kv_storage->max_quota_bytes > 0) {
-        astarte_result_t size_check_res = astarte_key_value_entry_read_value(
-            kv_storage->zms_fs, entry_id, NULL, &deleted_value_size);
-        if (size_check_res != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_WRN("Failed to read size for ID %d prior to deletion", entry_id);
-            deleted_value_size = 0;
-        }
+    size_t value_total_size = 0;
+    ares = read_value(kv_storage, entry_id, key, offset, value, value_size, &value_total_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Partial read of key-value storage failed %s.",
+            astarte_result_to_name(ares));
+        return ares;
+    }
+
+    if (total_size) {
+        *total_size = value_total_size;
     }
+    return ASTARTE_RESULT_OK;
+}
 
-    ares = astarte_key_value_entry_delete(kv_storage->zms_fs, entry_id);
+astarte_result_t astarte_key_value_delete(astarte_key_value_t *kv_storage, const char *key)
+{
+    astarte_result_t ares = astarte_key_value_mutex_lock();
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("ZMS Delete Error: %s.", astarte_result_to_name(ares));
+        ASTARTE_LOG_ERR("Failed to lock mutex");
         return ares;
     }
+    scope_defer(astarte_key_value_mutex_unlock)();
 
-    // Safely update the RAM counter post-deletion
-    if (kv_storage->max_quota_bytes > 0 && deleted_value_size > 0) {
-        if (kv_storage->current_usage_bytes >= deleted_value_size) {
-            kv_storage->current_usage_bytes -= deleted_value_size;
-        } else {
-            kv_storage->current_usage_bytes = 0;
-        }
+    ares = astarte_key_value_entry_intent_resolve(kv_storage->backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+        return ares;
     }
 
-    return ASTARTE_RESULT_OK;
+    return delete_key(kv_storage, key);
 }
 
 astarte_result_t astarte_key_value_iterator_init(
@@ -367,8 +328,6 @@ astarte_result_t astarte_key_value_iterator_init(
 
 astarte_result_t astarte_key_value_iterator_next(astarte_key_value_iter_t *iter)
 {
-    bool matches = false;
-
     astarte_result_t ares = astarte_key_value_mutex_lock();
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed to lock mutex");
@@ -376,35 +335,30 @@ astarte_result_t astarte_key_value_iterator_next(astarte_key_value_iter_t *iter)
     }
     scope_defer(astarte_key_value_mutex_unlock)();
 
-    ares = astarte_key_value_entry_intent_resolve(iter->kv_storage->zms_fs);
+    ares = astarte_key_value_entry_intent_resolve(iter->kv_storage->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
         return ares;
     }
 
-    uint32_t curr_id = iter->current_id;
-
-    while (true) {
-        uint32_t next_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-        ares = astarte_key_value_entry_get_next_id(iter->kv_storage->zms_fs, curr_id, &next_id);
-
-        if (ares != ASTARTE_RESULT_OK || next_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-            ASTARTE_LOG_DBG("Iterator reached the end.");
-            return ASTARTE_RESULT_NOT_FOUND;
-        }
-
-        ares = astarte_key_value_entry_check_namespace(
-            iter->kv_storage->zms_fs, next_id, iter->kv_storage->namespace, &matches);
-
-        if (ares == ASTARTE_RESULT_OK && matches) {
-            iter->current_id = next_id;
-            return ASTARTE_RESULT_OK;
-        }
+    // A namespace without a list has never been written to, so it contains no entries
+    ares = resolve_list_id(iter->kv_storage, false);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Namespace list lookup failed: %s",
+            astarte_result_to_name(ares));
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
 
-        curr_id = next_id;
+    // The list only links entries of this namespace, no need to check the namespace of each entry
+    uint32_t next_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    ares = next_live_id(iter->kv_storage, iter->current_id, &next_id);
+    if (ares != ASTARTE_RESULT_OK || next_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ASTARTE_LOG_DBG("Iterator reached the end.");
+        return ASTARTE_RESULT_NOT_FOUND;
     }
 
-    return ASTARTE_RESULT_NOT_FOUND;
+    iter->current_id = next_id;
+    return ASTARTE_RESULT_OK;
 }
 
 astarte_result_t astarte_key_value_iterator_get(
@@ -417,14 +371,14 @@ astarte_result_t astarte_key_value_iterator_get(
     }
     scope_defer(astarte_key_value_mutex_unlock)();
 
-    ares = astarte_key_value_entry_intent_resolve(iter->kv_storage->zms_fs);
+    ares = astarte_key_value_entry_intent_resolve(iter->kv_storage->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
         return ares;
     }
 
     ares = astarte_key_value_entry_read_key(
-        iter->kv_storage->zms_fs, iter->current_id, (char *) key, key_size);
+        iter->kv_storage->backend, iter->current_id, (char *) key, key_size);
 
     return ares;
 }
@@ -432,7 +386,6 @@ astarte_result_t astarte_key_value_iterator_get(
 astarte_result_t astarte_key_value_iterator_delete(astarte_key_value_iter_t *iter)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
-    size_t deleted_value_size = 0;
 
     if (!iter || iter->current_id == 0) {
         ASTARTE_LOG_ERR("Invalid iterator for deletion operation");
@@ -446,60 +399,50 @@ astarte_result_t astarte_key_value_iterator_delete(astarte_key_value_iter_t *ite
     }
     scope_defer(astarte_key_value_mutex_unlock)();
 
-    char *next_key = NULL;
-    scope_defer(free_char_ptr)(&next_key);
-
-    ares = astarte_key_value_entry_intent_resolve(iter->kv_storage->zms_fs);
+    ares = astarte_key_value_entry_intent_resolve(iter->kv_storage->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
         return ares;
     }
 
-    // Peek ahead to find the next matching element in the same namespace
+    ares = resolve_list_id(iter->kv_storage, false);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Namespace list not found: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    // The tombstone keeps its position in the list, the iteration continues from it
+    return remove_entry(iter->kv_storage, iter->current_id, NULL);
+#else
+    char *next_key = NULL;
+    scope_defer(free_char_ptr)(&next_key);
+
+    // Peek ahead to find the next element in the same namespace
     uint32_t next_matching_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    bool has_next = false;
-    ares = find_next_matching_id(iter, &next_matching_id, &has_next);
+    ares = next_live_id(iter->kv_storage, iter->current_id, &next_matching_id);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("List advancement failure: %s", astarte_result_to_name(ares));
         return ares;
     }
+    bool has_next = (next_matching_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
 
     // Get the key of the next matching element so we can re-find it if it shifts
     if (has_next) {
-        ares = read_next_key(iter, next_matching_id, &next_key);
+        ares = read_entry_key(iter->kv_storage, next_matching_id, &next_key);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed in reading the next key: %s", astarte_result_to_name(ares));
             return ares;
         }
     }
 
-    // If a quota is active, grab the size of the entry before wiping it
-    if (iter->kv_storage->max_quota_bytes > 0) {
-        astarte_result_t size_check_res = astarte_key_value_entry_read_value(
-            iter->kv_storage->zms_fs, iter->current_id, NULL, &deleted_value_size);
-        if (size_check_res != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_WRN(
-                "Failed to read size for ID %d prior to iterator deletion", iter->current_id);
-            deleted_value_size = 0;
-        }
-    }
-
-    // Physically delete the current entry and heal the ZMS global linked-list
-    ares = astarte_key_value_entry_delete(iter->kv_storage->zms_fs, iter->current_id);
+    // Physically delete the current entry and heal the namespace linked-list
+    ares = remove_entry(iter->kv_storage, iter->current_id, NULL);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Iterator delete error: %s.", astarte_result_to_name(ares));
         return ares;
     }
 
-    // Safely update the RAM counter post-deletion
-    if (iter->kv_storage->max_quota_bytes > 0 && deleted_value_size > 0) {
-        if (iter->kv_storage->current_usage_bytes >= deleted_value_size) {
-            iter->kv_storage->current_usage_bytes -= deleted_value_size;
-        } else {
-            iter->kv_storage->current_usage_bytes = 0;
-        }
-    }
-
     // We just deleted the very last element in this namespace.
     if (!has_next) {
         iter->current_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
@@ -507,100 +450,1158 @@ astarte_result_t astarte_key_value_iterator_delete(astarte_key_value_iter_t *ite
     }
 
     return heal_iterator_post_delete(iter, next_key);
+#endif
 }
 
-/************************************************
- *         Static functions definitions         *
- ***********************************************/
+astarte_result_t astarte_key_value_batch_begin(
+    astarte_key_value_t *kv_storage, astarte_key_value_batch_t *batch)
+{
+    batch->kv_storage = kv_storage;
+    batch->ops = NULL;
+    batch->ops_count = 0;
+    batch->ops_capacity = 0;
+    return ASTARTE_RESULT_OK;
+}
 
-static astarte_result_t find_next_matching_id(
-    astarte_key_value_iter_t *iter, uint32_t *next_id, bool *has_next)
+astarte_result_t astarte_key_value_batch_insert(
+    astarte_key_value_batch_t *batch, const char *key, const void *value, size_t value_size)
 {
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-    uint32_t peek_curr_id = iter->current_id;
-    *has_next = false;
-    *next_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-
-    while (true) {
-        uint32_t idx = 0;
-        ares = astarte_key_value_entry_get_next_id(iter->kv_storage->zms_fs, peek_curr_id, &idx);
-        if (ares != ASTARTE_RESULT_OK || idx == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-            break;
-        }
+    return batch_append_op(batch, key, value, value_size, false);
+}
 
-        bool matches = false;
-        ares = astarte_key_value_entry_check_namespace(
-            iter->kv_storage->zms_fs, idx, iter->kv_storage->namespace, &matches);
-        if (ares != ASTARTE_RESULT_OK) {
-            break;
+astarte_result_t astarte_key_value_batch_delete(astarte_key_value_batch_t *batch, const char *key)
+{
+    return batch_append_op(batch, key, NULL, 0, true);
+}
+
+astarte_result_t astarte_key_value_batch_commit(astarte_key_value_batch_t *batch)
+{
+    scope_defer(astarte_key_value_batch_destroy)(batch);
+
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to lock mutex");
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    ares = astarte_key_value_entry_intent_resolve(batch->kv_storage->backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    size_t op_idx = 0;
+    while (op_idx < batch->ops_count) {
+        if (batch->ops[op_idx].is_delete) {
+            ares = delete_key(batch->kv_storage, batch->ops[op_idx].key);
+            if (ares == ASTARTE_RESULT_NOT_FOUND) {
+                ares = ASTARTE_RESULT_OK;
+            }
+            op_idx++;
+        } else {
+            ares = batch_apply_inserts(batch, &op_idx);
         }
-        if (matches) {
-            *next_id = idx;
-            *has_next = true;
-            break;
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Batch operation %zu failed: %s", op_idx, astarte_result_to_name(ares));
+            return ares;
         }
-
-        peek_curr_id = idx;
     }
 
-    return ares;
+    return ASTARTE_RESULT_OK;
 }
 
-static astarte_result_t read_next_key(
-    astarte_key_value_iter_t *iter, uint32_t next_id, char **next_key)
+// Used as scope-based exit function
+void astarte_key_value_batch_destroy(astarte_key_value_batch_t *batch)
 {
-    size_t next_key_size = 0;
-    astarte_result_t ares
-        = astarte_key_value_entry_read_key(iter->kv_storage->zms_fs, next_id, NULL, &next_key_size);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Key size reading failure: %s", astarte_result_to_name(ares));
-        return ares;
+    if (!batch) {
+        return;
     }
+    for (size_t i = 0; i < batch->ops_count; i++) {
+        astarte_free(batch->ops[i].key);
+        astarte_free(batch->ops[i].value);
+    }
+    astarte_free(batch->ops);
+    batch->ops = NULL;
+    batch->ops_count = 0;
+    batch->ops_capacity = 0;
+}
 
-    char *local_next_key = NULL;
-    scope_defer(free_char_ptr)(&local_next_key);
+astarte_result_t astarte_key_value_writer_begin(astarte_key_value_t *kv_storage, const char *key,
+    size_t value_size, astarte_key_value_writer_t *writer)
+{
+    if (value_size > UINT32_MAX) {
+        ASTARTE_LOG_ERR("Value of %zu bytes is too large", value_size);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
 
-    local_next_key = astarte_calloc(next_key_size, sizeof(char));
-    if (!local_next_key) {
+    size_t key_size = strlen(key) + 1;
+    scope_var(scoped_char, key_cpy)(key_size);
+    if (!key_cpy) {
         ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
+    memcpy(key_cpy, key, key_size);
 
-    ares = astarte_key_value_entry_read_key(
-        iter->kv_storage->zms_fs, next_id, local_next_key, &next_key_size);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Key reading failure: %s", astarte_result_to_name(ares));
-        return ares;
+    // Only the chunk that is being filled is kept in memory
+    size_t buffer_size = ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES
+        + MIN(value_size, ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE);
+    scope_var(scoped_uint8, buffer)(buffer_size);
+    if (!buffer) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
 
-    *next_key = local_next_key;
+    uint8_t generation = 0;
+    if (astarte_key_value_entry_chunk_count(value_size) > 0) {
+        astarte_result_t ares = astarte_key_value_mutex_lock();
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed to lock mutex");
+            return ares;
+        }
+        scope_defer(astarte_key_value_mutex_unlock)();
 
-    // Disarm the auto-cleanup
-    local_next_key = NULL;
+        ares = astarte_key_value_entry_intent_resolve(kv_storage->backend);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR(
+                "Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+
+        ares = prepare_chunks(kv_storage, key, value_size, &generation);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+    }
+
+    writer->kv_storage = kv_storage;
+    writer->key = key_cpy;
+    writer->value_size = value_size;
+    writer->written = 0;
+    writer->generation = generation;
+    writer->buffer = buffer;
+
+    // Leave the memory intact for the writer
+    key_cpy = NULL;
+    buffer = NULL;
 
     return ASTARTE_RESULT_OK;
 }
 
-static astarte_result_t heal_iterator_post_delete(
-    astarte_key_value_iter_t *iter, const char *next_key)
+astarte_result_t astarte_key_value_writer_append(
+    astarte_key_value_writer_t *writer, const void *data, size_t size)
 {
-    // Find the post-shift valid ZMS ID of the next matching element
-    uint32_t valid_next_matching_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(iter->kv_storage->zms_fs,
-        iter->kv_storage->namespace, next_key, &valid_next_matching_id, false);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Could not find post-shift entry: %s.", astarte_result_to_name(ares));
-        return ares;
+    if (size > writer->value_size - writer->written) {
+        ASTARTE_LOG_ERR("Appending %zu bytes exceeds the value size", size);
+        return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    // Find the post-shift ZMS ID of the next element previous element
-    uint32_t new_prev_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    ares = astarte_key_value_entry_get_prev_id(
-        iter->kv_storage->zms_fs, valid_next_matching_id, &new_prev_id);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Could not find post-shift prev id: %s.", astarte_result_to_name(ares));
-        return ares;
-    }
-    iter->current_id = new_prev_id;
-    return ASTARTE_RESULT_OK;
+    size_t chunk_count = astarte_key_value_entry_chunk_count(writer->value_size);
+    const uint8_t *part = (const uint8_t *) data;
+    while (size > 0) {
+        size_t chunk_index = writer->written / ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE;
+        size_t chunk_offset = writer->written % ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE;
+        size_t part_size = MIN(size, ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE - chunk_offset);
+        memcpy(writer->buffer + ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES + chunk_offset,
+            part, part_size);
+        writer->written += part_size;
+        part += part_size;
+        size -= part_size;
+
+        // Full chunks are stored right away, the last one is stored with the descriptor
+        bool chunk_full = (chunk_offset + part_size == ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE);
+        if (!chunk_full || (chunk_index >= chunk_count)) {
+            continue;
+        }
+
+        astarte_result_t ares = astarte_key_value_mutex_lock();
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed to lock mutex");
+            return ares;
+        }
+        ares = astarte_key_value_entry_intent_resolve(writer->kv_storage->backend);
+        if (ares == ASTARTE_RESULT_OK) {
+            ares = write_chunk(writer->kv_storage, writer->key, writer->generation, chunk_index,
+                writer->buffer + ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES);
+        }
+        astarte_key_value_mutex_unlock();
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed storing chunk %zu: %s", chunk_index,
+                astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_writer_commit(astarte_key_value_writer_t *writer)
+{
+    scope_defer(astarte_key_value_writer_destroy)(writer);
+
+    if (writer->written != writer->value_size) {
+        ASTARTE_LOG_ERR("Only %zu bytes out of %zu have been appended", writer->written,
+            writer->value_size);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to lock mutex");
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    ares = astarte_key_value_entry_intent_resolve(writer->kv_storage->backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    size_t chunk_count = astarte_key_value_entry_chunk_count(writer->value_size);
+    if (chunk_count == 0) {
+        ares = write_value_entry(writer->kv_storage, writer->key,
+            writer->buffer + ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES, writer->value_size,
+            writer->value_size, false, 0);
+    } else {
+        struct astarte_key_value_entry_chunk_descriptor descriptor = {
+            .value_size = (uint32_t) writer->value_size,
+            .generation = writer->generation,
+        };
+        astarte_key_value_entry_chunk_descriptor_encode(&descriptor, writer->buffer);
+        size_t last_chunk_size
+            = writer->value_size - (chunk_count * ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE);
+        ares = write_value_entry(writer->kv_storage, writer->key, writer->buffer,
+            ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES + last_chunk_size, writer->value_size,
+            true, writer->generation);
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Writer commit failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // The stored chunks now belong to the value
+    writer->written = 0;
+    return ASTARTE_RESULT_OK;
+}
+
+// Used as scope-based exit function
+void astarte_key_value_writer_destroy(astarte_key_value_writer_t *writer)
+{
+    if (!writer) {
+        return;
+    }
+    if (writer->buffer) {
+        discard_writer_chunks(writer);
+    }
+    astarte_free(writer->key);
+    writer->key = NULL;
+    astarte_free(writer->buffer);
+    writer->buffer = NULL;
+    writer->value_size = 0;
+    writer->written = 0;
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+astarte_result_t astarte_key_value_compact(astarte_key_value_backend_t *backend)
+{
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to lock mutex");
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    ares = astarte_key_value_entry_intent_resolve(backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    return astarte_key_value_entry_delete_compact(backend);
+}
+#endif
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t open_backend(astarte_key_value_backend_t *backend)
+{
+    // The intent block is read again from the opened backend
+    astarte_key_value_entry_intent_forget();
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    // Any list of the opened backend could contain tombstones
+    astarte_key_value_entry_delete_compact_forget();
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    // The backend content could have changed since the index was built
+    astarte_key_value_entry_index_invalidate();
+#endif
+
+    astarte_key_value_version_t current_version = { .major = ASTARTE_KEY_VALUE_FORMAT_VERSION_MAJOR,
+        .minor = ASTARTE_KEY_VALUE_FORMAT_VERSION_MINOR,
+        .patch = ASTARTE_KEY_VALUE_FORMAT_VERSION_PATCH };
+    astarte_key_value_version_t stored_version = { 0 };
+
+    ssize_t ver_rc = astarte_key_value_backend_read(
+        backend, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID, &stored_version, sizeof(stored_version));
+
+    if (ver_rc == -ENOENT) {
+        // Version not found, assuming empty storage. Write the current format version.
+        ver_rc = astarte_key_value_backend_write(
+            backend, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID, &current_version, sizeof(current_version));
+        if (ver_rc < 0) {
+            ASTARTE_LOG_ERR("Failed to initialize storage format version: %d", (int) ver_rc);
+            return ASTARTE_RESULT_ZMS_ERROR;
+        }
+        ASTARTE_LOG_INF("Initialized storage with format version %d.%d.%d", current_version.major,
+            current_version.minor, current_version.patch);
+    } else if (ver_rc != sizeof(current_version)) {
+        ASTARTE_LOG_ERR("Failed to read storage format version: %d", (int) ver_rc);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    } else if (stored_version.major != current_version.major
+        || stored_version.minor != current_version.minor
+        || stored_version.patch != current_version.patch) {
+
+        // A version mismatch indicates the partition was written by an older/newer driver
+        astarte_result_t mig_res = astarte_key_value_entry_migrate(backend, stored_version);
+        if (mig_res != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("ZMS format version mismatch! Expected %d.%d.%d, found %d.%d.%d. "
+                            "Migration failed (%s), wipe required.",
+                current_version.major, current_version.minor, current_version.patch,
+                stored_version.major, stored_version.minor, stored_version.patch,
+                astarte_result_to_name(mig_res));
+            return ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION;
+        }
+
+        // Store the new version only once all the entries have been migrated
+        ver_rc = astarte_key_value_backend_write(
+            backend, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID, &current_version, sizeof(current_version));
+        if (ver_rc < 0) {
+            ASTARTE_LOG_ERR("Failed to update storage format version: %d", (int) ver_rc);
+            return ASTARTE_RESULT_ZMS_ERROR;
+        }
+        ASTARTE_LOG_INF("Migrated ZMS from format version %d.%d.%d to %d.%d.%d",
+            stored_version.major, stored_version.minor, stored_version.patch,
+            current_version.major, current_version.minor, current_version.patch);
+    }
+
+    astarte_result_t ares = astarte_key_value_entry_intent_resolve(backend);
+    // Explicitly handle the fatal corruption scenario
+    if (ares == ASTARTE_RESULT_KEY_VALUE_RECOVERY_FAILED) {
+        ASTARTE_LOG_ERR("Unrecoverable storage corruption detected during mount check.");
+        return ares;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to resolve leftover intents during initialization: %s",
+            astarte_result_to_name(ares));
+        return ares;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    ares = astarte_key_value_entry_index_build(backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to build the key-value index: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+#endif
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t resolve_list_id(astarte_key_value_t *kv_storage, bool allocate)
+{
+    if (kv_storage->list_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        return ASTARTE_RESULT_OK;
+    }
+    return astarte_key_value_entry_list_find_id(
+        kv_storage->backend, kv_storage->namespace, allocate, &kv_storage->list_id);
+}
+
+static astarte_result_t resolve_chunk_list_id(astarte_key_value_t *kv_storage, bool allocate)
+{
+    if (kv_storage->chunk_list_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        return ASTARTE_RESULT_OK;
+    }
+    return astarte_key_value_entry_list_find_id(
+        kv_storage->backend, kv_storage->chunk_namespace, allocate, &kv_storage->chunk_list_id);
+}
+
+static astarte_result_t next_live_id(
+    astarte_key_value_t *kv_storage, uint32_t idx, uint32_t *next_id)
+{
+    astarte_result_t ares = astarte_key_value_entry_get_next_id(
+        kv_storage->backend, kv_storage->list_id, idx, next_id);
+
+    // Tombstones stay linked until they are compacted, they are not visible to the user
+    while ((ares == ASTARTE_RESULT_OK) && (*next_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID)) {
+        struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+        size_t raw_size = 0;
+        ares = astarte_key_value_entry_header_read_fixed(
+            kv_storage->backend, *next_id, &fixed_header, &raw_size);
+        if ((ares != ASTARTE_RESULT_OK) || !fixed_header.tombstone) {
+            break;
+        }
+        *next_id = fixed_header.next_id;
+    }
+    return ares;
+}
+
+static astarte_result_t read_entry_key(
+    astarte_key_value_t *kv_storage, uint32_t entry_id, char **key)
+{
+    size_t key_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_read_key(kv_storage->backend, entry_id, NULL, &key_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Key size reading failure: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    char *local_key = NULL;
+    scope_defer(free_char_ptr)(&local_key);
+
+    local_key = astarte_calloc(key_size, sizeof(char));
+    if (!local_key) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    ares = astarte_key_value_entry_read_key(kv_storage->backend, entry_id, local_key, &key_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Key reading failure: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    *key = local_key;
+
+    // Disarm the auto-cleanup
+    local_key = NULL;
+
+    return ASTARTE_RESULT_OK;
+}
+
+#ifndef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+static astarte_result_t heal_iterator_post_delete(
+    astarte_key_value_iter_t *iter, const char *next_key)
+{
+    // Find the post-shift valid ZMS ID of the next matching element
+    uint32_t valid_next_matching_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(iter->kv_storage->backend,
+        iter->kv_storage->namespace, next_key, &valid_next_matching_id, false);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Could not find post-shift entry: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Find the post-shift ZMS ID of the next element previous element
+    uint32_t new_prev_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    ares = astarte_key_value_entry_get_prev_id(
+        iter->kv_storage->backend, valid_next_matching_id, &new_prev_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Could not find post-shift prev id: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+    iter->current_id = new_prev_id;
+    return ASTARTE_RESULT_OK;
+}
+#endif
+
+static astarte_result_t load_usage(astarte_key_value_t *kv_storage)
+{
+    // A namespace without a list has never been written to
+    astarte_result_t ares = resolve_list_id(kv_storage, false);
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return ASTARTE_RESULT_OK;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    size_t stored_bytes = 0;
+    ares = astarte_key_value_entry_list_read_usage(
+        kv_storage->backend, kv_storage->list_id, &stored_bytes);
+    if (ares == ASTARTE_RESULT_OK) {
+        kv_storage->current_usage_bytes = stored_bytes;
+        return ASTARTE_RESULT_OK;
+    }
+    if (ares != ASTARTE_RESULT_NOT_FOUND) {
+        return ares;
+    }
+
+    // The usage has never been stored or an interrupted batch removed it, compute it once
+    ASTARTE_LOG_INF("Computing usage of namespace %s.", kv_storage->namespace);
+    astarte_key_value_iter_t iter;
+    astarte_result_t iter_res = astarte_key_value_iterator_init(kv_storage, &iter);
+    while (iter_res == ASTARTE_RESULT_OK) {
+        size_t entry_size = 0;
+        astarte_result_t read_res = astarte_key_value_entry_read_value_size(
+            kv_storage->backend, iter.current_id, &entry_size);
+        if (read_res == ASTARTE_RESULT_OK) {
+            kv_storage->current_usage_bytes += entry_size;
+        } else {
+            ASTARTE_LOG_WRN("Failed to read size for ID %d during quota init", iter.current_id);
+        }
+
+        iter_res = astarte_key_value_iterator_next(&iter);
+    }
+
+    struct astarte_key_value_entry_list_usage usage = {
+        .bytes = (uint32_t) kv_storage->current_usage_bytes,
+        .pending_hash_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
+    };
+    return astarte_key_value_entry_list_write_usage(
+        kv_storage->backend, kv_storage->list_id, &usage);
+}
+
+static astarte_result_t drop_usage(astarte_key_value_t *kv_storage)
+{
+    astarte_result_t ares = resolve_list_id(kv_storage, false);
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return ASTARTE_RESULT_OK;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // A usage stored while the namespace had a quota would not be kept updated
+    return astarte_key_value_entry_list_write_usage(kv_storage->backend, kv_storage->list_id, NULL);
+}
+
+static void pending_usage(astarte_key_value_t *kv_storage, const char *key, size_t old_value_size,
+    struct astarte_key_value_entry_list_usage *usage)
+{
+    size_t other_bytes = 0;
+    if (kv_storage->current_usage_bytes > old_value_size) {
+        other_bytes = kv_storage->current_usage_bytes - old_value_size;
+    }
+    usage->bytes = (uint32_t) other_bytes;
+    usage->pending_hash_id = astarte_key_value_entry_hash_generate(kv_storage->namespace, key);
+    usage->pending_fingerprint
+        = astarte_key_value_entry_hash_fingerprint(kv_storage->namespace, key);
+}
+
+static astarte_result_t check_quota(astarte_key_value_t *kv_storage, uint32_t entry_id,
+    size_t value_size, size_t *old_value_size)
+{
+    if (kv_storage->max_quota_bytes == 0) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    // Check if this is an update and extract the old size
+    astarte_result_t ares
+        = astarte_key_value_entry_read_value_size(kv_storage->backend, entry_id, old_value_size);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        ASTARTE_LOG_ERR("Read failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Check if the size has been desyncronized
+    if (kv_storage->current_usage_bytes < *old_value_size) {
+        // At least old_value_size bytes are used
+        kv_storage->current_usage_bytes = *old_value_size;
+    }
+
+    size_t projected_size = (kv_storage->current_usage_bytes + value_size) - *old_value_size;
+    if (projected_size > kv_storage->max_quota_bytes) {
+        ASTARTE_LOG_WRN("Namespace %s quota exceeded.", kv_storage->namespace);
+        return ASTARTE_RESULT_OUT_OF_SPACE;
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t delete_key(astarte_key_value_t *kv_storage, const char *key)
+{
+    uint32_t entry_id = 0;
+
+    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(
+        kv_storage->backend, kv_storage->namespace, key, &entry_id, false);
+    if (ares != ASTARTE_RESULT_OK) {
+        // No error logs as this could be a not found case, which is not necessarily an error
+        return ares;
+    }
+
+    // An entry has been found, so the namespace list must exist
+    ares = resolve_list_id(kv_storage, false);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Namespace list not found %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    return remove_entry(kv_storage, entry_id, key);
+}
+
+static astarte_result_t remove_entry(
+    astarte_key_value_t *kv_storage, uint32_t entry_id, const char *key)
+{
+    bool chunked = false;
+    struct astarte_key_value_entry_chunk_descriptor descriptor = { 0 };
+    astarte_result_t desc_res = astarte_key_value_entry_chunk_read_descriptor(
+        kv_storage->backend, entry_id, &chunked, &descriptor);
+    if (desc_res != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Failed to read size for ID %d prior to deletion", entry_id);
+        chunked = false;
+        descriptor.value_size = 0;
+    }
+    size_t deleted_value_size = descriptor.value_size;
+
+    // Once the namespace holds chunks, also a plain value can have the leftovers of an interrupted
+    // chunked write of the same key
+    bool sweep_chunks = chunked || (resolve_chunk_list_id(kv_storage, false) == ASTARTE_RESULT_OK);
+
+    // The key is needed to store the usage and to find the chunks of the value
+    char *entry_key = NULL;
+    scope_defer(free_char_ptr)(&entry_key);
+    if (!key && ((kv_storage->max_quota_bytes > 0) || sweep_chunks)) {
+        astarte_result_t key_res = read_entry_key(kv_storage, entry_id, &entry_key);
+        if (key_res != ASTARTE_RESULT_OK) {
+            return key_res;
+        }
+        key = entry_key;
+    }
+
+    // If a quota is active, store the usage before wiping the entry
+    if (kv_storage->max_quota_bytes > 0) {
+        struct astarte_key_value_entry_list_usage usage = { 0 };
+        pending_usage(kv_storage, key, deleted_value_size, &usage);
+        astarte_result_t usage_res = astarte_key_value_entry_list_write_usage(
+            kv_storage->backend, kv_storage->list_id, &usage);
+        if (usage_res != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed writing list usage: %s", astarte_result_to_name(usage_res));
+            return usage_res;
+        }
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    astarte_result_t ares = astarte_key_value_entry_delete_tombstone(
+        kv_storage->backend, kv_storage->list_id, entry_id);
+#else
+    astarte_result_t ares
+        = astarte_key_value_entry_delete(kv_storage->backend, kv_storage->list_id, entry_id);
+#endif
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("ZMS Delete Error: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Safely update the RAM counter post-deletion
+    if (kv_storage->max_quota_bytes > 0 && deleted_value_size > 0) {
+        if (kv_storage->current_usage_bytes >= deleted_value_size) {
+            kv_storage->current_usage_bytes -= deleted_value_size;
+        } else {
+            kv_storage->current_usage_bytes = 0;
+        }
+    }
+
+    if (!sweep_chunks) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    // The chunks of the key are unreachable once its entry is gone, including the leftovers of
+    // an interrupted write
+    for (uint8_t generation = 0; generation < ASTARTE_KEY_VALUE_ENTRY_CHUNK_GENERATIONS;
+         generation++) {
+        ares = delete_chunks(kv_storage, key, generation, 0);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t batch_append_op(astarte_key_value_batch_t *batch, const char *key,
+    const void *value, size_t value_size, bool is_delete)
+{
+    if (batch->ops_count == batch->ops_capacity) {
+        size_t new_capacity = (batch->ops_capacity == 0) ? 4 : batch->ops_capacity * 2;
+        astarte_key_value_batch_op_t *new_ops
+            = astarte_realloc(batch->ops, new_capacity * sizeof(astarte_key_value_batch_op_t));
+        if (!new_ops) {
+            ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+            return ASTARTE_RESULT_OUT_OF_MEMORY;
+        }
+        batch->ops = new_ops;
+        batch->ops_capacity = new_capacity;
+    }
+
+    size_t key_size = strlen(key) + 1;
+    scope_var(scoped_char, key_cpy)(key_size);
+    if (!key_cpy) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    memcpy(key_cpy, key, key_size);
+
+    scope_var(scoped_uint8, value_cpy)(value_size);
+    if ((value_size > 0) && !value_cpy) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    if (value_size > 0) {
+        memcpy(value_cpy, value, value_size);
+    }
+
+    batch->ops[batch->ops_count] = (astarte_key_value_batch_op_t) {
+        .key = key_cpy,
+        .value = value_cpy,
+        .value_size = value_size,
+        .is_delete = is_delete,
+    };
+    batch->ops_count++;
+
+    // Leave the memory intact for the batch
+    key_cpy = NULL;
+    value_cpy = NULL;
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t batch_apply_inserts(astarte_key_value_batch_t *batch, size_t *op_idx)
+{
+    astarte_key_value_t *kv_storage = batch->kv_storage;
+
+    astarte_result_t ares = resolve_list_id(kv_storage, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Namespace list allocation failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    struct astarte_key_value_entry_batch entry_batch = { 0 };
+    scope_defer(astarte_key_value_entry_batch_discard)(&entry_batch);
+    ares = astarte_key_value_entry_batch_begin(&entry_batch, kv_storage->backend,
+        kv_storage->list_id, kv_storage->namespace, kv_storage->max_quota_bytes > 0);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // Apply all the consecutive insertions, stopping at the first deletion or chunked value
+    bool chunked_op = false;
+    for (; (*op_idx < batch->ops_count) && !batch->ops[*op_idx].is_delete; (*op_idx)++) {
+        astarte_key_value_batch_op_t *operation = &batch->ops[*op_idx];
+        if (astarte_key_value_entry_chunk_count(operation->value_size) > 0) {
+            chunked_op = true;
+            break;
+        }
+
+        uint32_t entry_id = 0;
+        ares = astarte_key_value_entry_batch_find_or_alloc(&entry_batch, operation->key, &entry_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Key finding/allocation failed %s.", astarte_result_to_name(ares));
+            return ares;
+        }
+
+        // Replacing a chunked value also deletes its chunks, which can relocate other entries
+        bool chunked = false;
+        struct astarte_key_value_entry_chunk_descriptor descriptor = { 0 };
+        ares = astarte_key_value_entry_chunk_read_descriptor(
+            kv_storage->backend, entry_id, &chunked, &descriptor);
+        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+            return ares;
+        }
+        if (chunked) {
+            chunked_op = true;
+            break;
+        }
+
+        size_t old_value_size = 0;
+        ares = check_quota(kv_storage, entry_id, operation->value_size, &old_value_size);
+        if (ares == ASTARTE_RESULT_OUT_OF_SPACE) {
+            // Keep the operations applied so far consistent with the returned error
+            break;
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+
+        ares = astarte_key_value_entry_batch_write(&entry_batch, entry_id, operation->key,
+            operation->value, operation->value_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Batch insert failed %s.", astarte_result_to_name(ares));
+            return ares;
+        }
+
+        // Safely update the RAM counter post-write
+        if (kv_storage->max_quota_bytes > 0) {
+            kv_storage->current_usage_bytes
+                = (kv_storage->current_usage_bytes + operation->value_size) - old_value_size;
+        }
+    }
+
+    struct astarte_key_value_entry_list_usage usage = {
+        .bytes = (uint32_t) kv_storage->current_usage_bytes,
+        .pending_hash_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
+    };
+    astarte_result_t end_ares = astarte_key_value_entry_batch_end(&entry_batch, &usage);
+    if (end_ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Batch completion failed %s.", astarte_result_to_name(end_ares));
+        return end_ares;
+    }
+    if (!chunked_op) {
+        return ares;
+    }
+
+    // Chunked values span several entries, they are written on their own
+    astarte_key_value_batch_op_t *operation = &batch->ops[*op_idx];
+    ares = insert_value(kv_storage, operation->key, operation->value, operation->value_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    (*op_idx)++;
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t insert_value(
+    astarte_key_value_t *kv_storage, const char *key, const void *value, size_t value_size)
+{
+    size_t chunk_count = astarte_key_value_entry_chunk_count(value_size);
+    if (chunk_count == 0) {
+        return write_value_entry(kv_storage, key, value, value_size, value_size, false, 0);
+    }
+    if (value_size > UINT32_MAX) {
+        ASTARTE_LOG_ERR("Value of %zu bytes is too large", value_size);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    uint8_t generation = 0;
+    astarte_result_t ares = prepare_chunks(kv_storage, key, value_size, &generation);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    const uint8_t *data = (const uint8_t *) value;
+    for (size_t index = 0; index < chunk_count; index++) {
+        ares = write_chunk(kv_storage, key, generation, index,
+            data + (index * ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE));
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed storing chunk %zu: %s", index, astarte_result_to_name(ares));
+            // Best effort, the stored value is still the old one
+            (void) delete_chunks(kv_storage, key, generation, 0);
+            return ares;
+        }
+    }
+
+    // The last chunk is stored with the descriptor, in the entry of the value
+    size_t last_chunk_size = value_size - (chunk_count * ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE);
+    size_t raw_value_size = ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES + last_chunk_size;
+    scope_var(scoped_uint8, raw_value)(raw_value_size);
+    if (!raw_value) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    struct astarte_key_value_entry_chunk_descriptor descriptor = {
+        .value_size = (uint32_t) value_size,
+        .generation = generation,
+    };
+    astarte_key_value_entry_chunk_descriptor_encode(&descriptor, raw_value);
+    memcpy(raw_value + ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES,
+        data + (chunk_count * ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE), last_chunk_size);
+
+    return write_value_entry(
+        kv_storage, key, raw_value, raw_value_size, value_size, true, generation);
+}
+
+static astarte_result_t write_value_entry(astarte_key_value_t *kv_storage, const char *key,
+    const void *raw_value, size_t raw_value_size, size_t value_size, bool chunked,
+    uint8_t generation)
+{
+    uint32_t entry_id = 0;
+    size_t old_value_size = 0;
+
+    astarte_result_t ares = resolve_list_id(kv_storage, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Namespace list allocation failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    ares = astarte_key_value_entry_find_or_alloc(
+        kv_storage->backend, kv_storage->namespace, key, &entry_id, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Key finding/allocation failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    bool old_chunked = false;
+    struct astarte_key_value_entry_chunk_descriptor old_descriptor = { 0 };
+    ares = astarte_key_value_entry_chunk_read_descriptor(
+        kv_storage->backend, entry_id, &old_chunked, &old_descriptor);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
+    }
+
+    ares = check_quota(kv_storage, entry_id, value_size, &old_value_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    struct astarte_key_value_entry_list_usage usage = { 0 };
+    if (kv_storage->max_quota_bytes > 0) {
+        pending_usage(kv_storage, key, old_value_size, &usage);
+    }
+
+    // Writing the entry replaces the old value, chunks included
+    ares = astarte_key_value_entry_write(kv_storage->backend, kv_storage->list_id, entry_id,
+        kv_storage->namespace, key, raw_value, raw_value_size, chunked,
+        (kv_storage->max_quota_bytes > 0) ? &usage : NULL);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Insert failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Safely update the RAM counter post-write
+    if (kv_storage->max_quota_bytes > 0) {
+        kv_storage->current_usage_bytes
+            = (kv_storage->current_usage_bytes + value_size) - old_value_size;
+    }
+
+    // Drop the chunks no longer referenced, the new value is stored even if this fails
+    astarte_result_t clean_res = ASTARTE_RESULT_OK;
+    if (chunked) {
+        // Chunks of the same generation past the end are leftovers of an interrupted write
+        clean_res = delete_chunks(
+            kv_storage, key, generation, astarte_key_value_entry_chunk_count(value_size));
+        if (clean_res == ASTARTE_RESULT_OK) {
+            clean_res = delete_chunks(kv_storage, key, generation ^ 1U, 0);
+        }
+    } else if (old_chunked) {
+        clean_res = delete_chunks(kv_storage, key, old_descriptor.generation, 0);
+    }
+    if (clean_res != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Failed deleting old chunks of key %s: %s", key,
+            astarte_result_to_name(clean_res));
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t read_value(astarte_key_value_t *kv_storage, uint32_t entry_id,
+    const char *key, size_t offset, void *value, size_t *value_size, size_t *total_size)
+{
+    bool chunked = false;
+    struct astarte_key_value_entry_chunk_descriptor descriptor = { 0 };
+    astarte_result_t ares = astarte_key_value_entry_chunk_read_descriptor(
+        kv_storage->backend, entry_id, &chunked, &descriptor);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    *total_size = descriptor.value_size;
+    if (offset > descriptor.value_size) {
+        ASTARTE_LOG_ERR("Offset %zu past the end of the value of key %s", offset, key);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+    size_t read_size = MIN(*value_size, descriptor.value_size - offset);
+    if (!chunked) {
+        *value_size = read_size;
+        if (read_size == 0) {
+            return ASTARTE_RESULT_OK;
+        }
+        return astarte_key_value_entry_read_value_range(
+            kv_storage->backend, entry_id, offset, value, value_size);
+    }
+
+    // Read from each chunk the requested part, the last chunk follows the descriptor
+    size_t chunk_count = astarte_key_value_entry_chunk_count(descriptor.value_size);
+    uint8_t *out = (uint8_t *) value;
+    size_t done = 0;
+    while (done < read_size) {
+        size_t position = offset + done;
+        size_t chunk_index = position / ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE;
+        size_t chunk_offset = position % ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE;
+        size_t part_size = MIN(read_size - done, ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE - chunk_offset);
+
+        uint32_t read_id = entry_id;
+        size_t read_offset = ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES + chunk_offset;
+        if (chunk_index < chunk_count) {
+            ares = find_chunk(
+                kv_storage, key, descriptor.generation, chunk_index, false, &read_id);
+            if (ares == ASTARTE_RESULT_NOT_FOUND) {
+                ASTARTE_LOG_ERR("Missing chunk %zu of key %s", chunk_index, key);
+                return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+            }
+            if (ares != ASTARTE_RESULT_OK) {
+                return ares;
+            }
+            read_offset = chunk_offset;
+        }
+
+        size_t expected_size = part_size;
+        ares = astarte_key_value_entry_read_value_range(
+            kv_storage->backend, read_id, read_offset, out + done, &part_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        if (part_size != expected_size) {
+            ASTARTE_LOG_ERR("Truncated chunk %zu of key %s", chunk_index, key);
+            return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+        }
+        done += part_size;
+    }
+
+    *value_size = read_size;
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t prepare_chunks(
+    astarte_key_value_t *kv_storage, const char *key, size_t value_size, uint8_t *generation)
+{
+    uint32_t entry_id = 0;
+    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(
+        kv_storage->backend, kv_storage->namespace, key, &entry_id, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Key finding/allocation failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // The chunks of the stored value must survive until the new value is committed
+    bool chunked = false;
+    struct astarte_key_value_entry_chunk_descriptor descriptor = { 0 };
+    ares = astarte_key_value_entry_chunk_read_descriptor(
+        kv_storage->backend, entry_id, &chunked, &descriptor);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
+    }
+    *generation = chunked ? (descriptor.generation ^ 1U) : 0;
+
+    // Fail before storing any chunk of a value that would exceed the quota
+    size_t old_value_size = 0;
+    ares = check_quota(kv_storage, entry_id, value_size, &old_value_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    ares = resolve_chunk_list_id(kv_storage, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Chunks list allocation failed %s.", astarte_result_to_name(ares));
+    }
+    return ares;
+}
+
+static astarte_result_t find_chunk(astarte_key_value_t *kv_storage, const char *key,
+    uint8_t generation, size_t index, bool allocate, uint32_t *chunk_id)
+{
+    char *chunk_key = astarte_key_value_entry_chunk_key(key, generation, index);
+    scope_defer(free_char_ptr)(&chunk_key);
+    if (!chunk_key) {
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    return astarte_key_value_entry_find_or_alloc(
+        kv_storage->backend, kv_storage->chunk_namespace, chunk_key, chunk_id, allocate);
+}
+
+static astarte_result_t write_chunk(astarte_key_value_t *kv_storage, const char *key,
+    uint8_t generation, size_t index, const void *data)
+{
+    char *chunk_key = astarte_key_value_entry_chunk_key(key, generation, index);
+    scope_defer(free_char_ptr)(&chunk_key);
+    if (!chunk_key) {
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    uint32_t chunk_id = 0;
+    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(
+        kv_storage->backend, kv_storage->chunk_namespace, chunk_key, &chunk_id, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Chunk finding/allocation failed %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Chunks are accounted with the value they belong to, they don't track any usage
+    return astarte_key_value_entry_write(kv_storage->backend, kv_storage->chunk_list_id, chunk_id,
+        kv_storage->chunk_namespace, chunk_key, data, ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE, false,
+        NULL);
+}
+
+static astarte_result_t delete_chunks(
+    astarte_key_value_t *kv_storage, const char *key, uint8_t generation, size_t first_index)
+{
+    // No chunk has ever been stored for this namespace
+    astarte_result_t ares = resolve_chunk_list_id(kv_storage, false);
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return ASTARTE_RESULT_OK;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // Chunks are written in order, so the stored ones are consecutive
+    size_t end_index = first_index;
+    uint32_t chunk_id = 0;
+    ares = find_chunk(kv_storage, key, generation, end_index, false, &chunk_id);
+    while (ares == ASTARTE_RESULT_OK) {
+        end_index++;
+        ares = find_chunk(kv_storage, key, generation, end_index, false, &chunk_id);
+    }
+    if (ares != ASTARTE_RESULT_NOT_FOUND) {
+        return ares;
+    }
+
+    // Delete starting from the end, so an interrupted deletion still finds the remaining chunks.
+    // Deletions can relocate the other chunks, each one is looked up again.
+    while (end_index > first_index) {
+        end_index--;
+        ares = find_chunk(kv_storage, key, generation, end_index, false, &chunk_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+        ares = astarte_key_value_entry_delete_tombstone(
+            kv_storage->backend, kv_storage->chunk_list_id, chunk_id);
+#else
+        ares = astarte_key_value_entry_delete(
+            kv_storage->backend, kv_storage->chunk_list_id, chunk_id);
+#endif
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed deleting chunk %zu: %s", end_index,
+                astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static void discard_writer_chunks(astarte_key_value_writer_t *writer)
+{
+    size_t stored_chunks = MIN(writer->written / ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE,
+        astarte_key_value_entry_chunk_count(writer->value_size));
+    if (stored_chunks == 0) {
+        return;
+    }
+
+    astarte_key_value_t *kv_storage = writer->kv_storage;
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed to lock mutex");
+        return;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    ares = astarte_key_value_entry_intent_resolve(kv_storage->backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Pre-operation integrity check failed: %s", astarte_result_to_name(ares));
+        return;
+    }
+
+    // Keep the chunks if a failed commit still managed to store the value
+    uint32_t entry_id = 0;
+    bool chunked = false;
+    struct astarte_key_value_entry_chunk_descriptor descriptor = { 0 };
+    ares = astarte_key_value_entry_find_or_alloc(
+        kv_storage->backend, kv_storage->namespace, writer->key, &entry_id, false);
+    if (ares == ASTARTE_RESULT_OK) {
+        ares = astarte_key_value_entry_chunk_read_descriptor(
+            kv_storage->backend, entry_id, &chunked, &descriptor);
+    }
+    if ((ares == ASTARTE_RESULT_OK) && chunked && (descriptor.generation == writer->generation)) {
+        return;
+    }
+
+    ares = delete_chunks(kv_storage, writer->key, writer->generation, 0);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Failed discarding the chunks of key %s: %s", writer->key,
+            astarte_result_to_name(ares));
+    }
 }
@@ -9,14 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <zephyr/version.h>
-
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
-#endif
-
+#include "key_value/backend.h"
 #include "key_value/mutex.h"
 #include "log.h"
 
@@ -34,8 +27,8 @@ ASTARTE_SCOPE_DEFER_DEFINE(astarte_key_value_mutex_unlock);
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_key_value_direct_insert(
-    struct zms_fs *zms_fs, bool alternate, uint16_t key, const void *value, size_t value_size)
+astarte_result_t astarte_key_value_direct_insert(astarte_key_value_backend_t *backend,
+    bool alternate, uint16_t key, const void *value, size_t value_size)
 {
     if (!value || value_size == 0) {
         return ASTARTE_RESULT_INVALID_PARAM;
@@ -49,7 +42,7 @@ astarte_result_t astarte_key_value_direct_insert(
 
     uint32_t full_key = FULL_KEY(alternate, key);
 
-    ssize_t ret = zms_write(zms_fs, full_key, value, value_size);
+    ssize_t ret = astarte_key_value_backend_write(backend, full_key, value, value_size);
     if (ret < 0) {
         ASTARTE_LOG_ERR("Failed to insert direct key %d: %d", full_key, (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -58,8 +51,8 @@ astarte_result_t astarte_key_value_direct_insert(
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_direct_find(
-    struct zms_fs *zms_fs, bool alternate, uint16_t key, void *value, size_t *value_size)
+astarte_result_t astarte_key_value_direct_find(astarte_key_value_backend_t *backend, bool alternate,
+    uint16_t key, void *value, size_t *value_size)
 {
     if (!value_size) {
         return ASTARTE_RESULT_INVALID_PARAM;
@@ -73,7 +66,7 @@ astarte_result_t astarte_key_value_direct_find(
 
     uint32_t full_key = FULL_KEY(alternate, key);
 
-    ssize_t data_len = zms_get_data_length(zms_fs, full_key);
+    ssize_t data_len = astarte_key_value_backend_get_data_length(backend, full_key);
 
     if (data_len == -ENOENT) {
         return ASTARTE_RESULT_NOT_FOUND;
@@ -95,7 +88,7 @@ astarte_result_t astarte_key_value_direct_find(
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    ssize_t ret = zms_read(zms_fs, full_key, value, *value_size);
+    ssize_t ret = astarte_key_value_backend_read(backend, full_key, value, *value_size);
     if (ret != data_len) {
         ASTARTE_LOG_ERR("Failed to read direct key %d: %d", key, (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -107,7 +100,7 @@ astarte_result_t astarte_key_value_direct_find(
 }
 
 astarte_result_t astarte_key_value_direct_delete(
-    struct zms_fs *zms_fs, bool alternate, uint16_t key)
+    astarte_key_value_backend_t *backend, bool alternate, uint16_t key)
 {
     astarte_result_t ares = astarte_key_value_mutex_lock();
     if (ares != ASTARTE_RESULT_OK) {
@@ -117,7 +110,7 @@ astarte_result_t astarte_key_value_direct_delete(
 
     uint32_t full_key = FULL_KEY(alternate, key);
 
-    ssize_t ret = zms_delete(zms_fs, full_key);
+    ssize_t ret = astarte_key_value_backend_delete(backend, full_key);
 
     // -ENOENT means it was already deleted, which is a successful state
     if (ret < 0 && ret != -ENOENT) {
@@ -13,8 +13,10 @@
 #include <zephyr/sys/crc.h>
 
 #include "alloc.h"
+#include "key_value/entry_chunk.h"
 #include "key_value/entry_hash.h"
 #include "key_value/entry_header.h"
+#include "key_value/entry_index.h"
 #include "key_value/entry_intent.h"
 #include "key_value/entry_list.h"
 #include "log.h"
@@ -25,25 +27,35 @@ ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALU
  *         Static functions declaration         *
  ***********************************************/
 
-static astarte_result_t update_list_tail(struct zms_fs *zms_fs, uint32_t new_tail_id);
-static uint8_t *serialize_entry(struct astarte_key_value_entry_header header, const void *value,
-    size_t value_size, size_t *serialized_entry_size);
-static astarte_result_t check_entry_match(
-    struct zms_fs *zms_fs, uint32_t idx, const char *namespace, const char *key);
+static astarte_result_t update_list_tail(astarte_key_value_backend_t *backend, uint32_t list_id,
+    uint32_t new_tail_id, const struct astarte_key_value_entry_list_usage *usage);
+static astarte_result_t check_entry_match(astarte_key_value_backend_t *backend, uint32_t idx,
+    const char *namespace, const char *key, bool *tombstone);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+static astarte_result_t find_or_alloc_indexed(astarte_key_value_backend_t *backend,
+    const char *namespace, const char *key, uint32_t *idx, bool allocate);
+#endif
 
 /************************************************
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_key_value_entry_find_or_alloc(
-    struct zms_fs *zms_fs, const char *namespace, const char *key, uint32_t *idx, bool allocate)
+astarte_result_t astarte_key_value_entry_find_or_alloc(astarte_key_value_backend_t *backend,
+    const char *namespace, const char *key, uint32_t *idx, bool allocate)
 {
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    if (astarte_key_value_entry_index_is_valid(backend)) {
+        return find_or_alloc_indexed(backend, namespace, key, idx, allocate);
+    }
+#endif
+
     uint32_t start_id = astarte_key_value_entry_hash_generate(namespace, key);
     uint32_t curr_id = start_id;
 
     do {
         // Check if the namespace and key match the stored values
-        astarte_result_t ares = check_entry_match(zms_fs, curr_id, namespace, key);
+        bool tombstone = false;
+        astarte_result_t ares = check_entry_match(backend, curr_id, namespace, key, &tombstone);
         if (ares == ASTARTE_RESULT_NOT_FOUND) {
             if (!allocate) {
                 return ares;
@@ -52,6 +64,10 @@ astarte_result_t astarte_key_value_entry_find_or_alloc(
             return ASTARTE_RESULT_OK;
         }
         if (ares == ASTARTE_RESULT_OK) {
+            // The tombstone of the key is the ID where the key gets inserted again
+            if (tombstone && !allocate) {
+                return ASTARTE_RESULT_NOT_FOUND;
+            }
             *idx = curr_id;
             return ASTARTE_RESULT_OK;
         }
@@ -71,8 +87,9 @@ astarte_result_t astarte_key_value_entry_find_or_alloc(
     return ASTARTE_RESULT_KEY_VALUE_FULL;
 }
 
-astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t idx,
-    const char *namespace, const char *key, const void *value, size_t value_size)
+astarte_result_t astarte_key_value_entry_write(astarte_key_value_backend_t *backend,
+    uint32_t list_id, uint32_t idx, const char *namespace, const char *key, const void *value,
+    size_t value_size, bool chunked, const struct astarte_key_value_entry_list_usage *usage)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
     size_t raw_entry_size = 0;
@@ -80,7 +97,8 @@ astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t i
     bool is_end_of_list = false;
     uint32_t prev_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
     uint32_t next_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    ares = astarte_key_value_entry_list_compute_next_and_prev_ids(zms_fs, idx, &next_id, &prev_id);
+    ares = astarte_key_value_entry_list_compute_next_and_prev_ids(
+        backend, list_id, idx, &next_id, &prev_id);
     if (ares == ASTARTE_RESULT_NOT_FOUND) {
         is_end_of_list = true;
     } else if (ares != ASTARTE_RESULT_OK) {
@@ -96,14 +114,16 @@ astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t i
             .key_len = strlen(key),
             .next_id = next_id,
             .prev_id = prev_id,
+            .fingerprint = astarte_key_value_entry_hash_fingerprint(namespace, key),
+            .chunked = chunked,
         },
         .namespace = (char *) namespace,
         .key = (char *) key,
         .dynamically_allocated = false,
     };
 
-    scope_var_init(
-        scoped_uint8, raw_entry, serialize_entry(header, value, value_size, &raw_entry_size));
+    scope_var_init(scoped_uint8, raw_entry,
+        astarte_key_value_entry_serialize(header, value, value_size, &raw_entry_size));
 
     if (!raw_entry) {
         ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
@@ -114,22 +134,38 @@ astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t i
     astarte_key_value_entry_intent_state_t intent_state = is_end_of_list
         ? ASTARTE_KEY_VALUE_ENTRY_INTENT_INSERTING
         : ASTARTE_KEY_VALUE_ENTRY_INTENT_UPDATING;
-    ares = astarte_key_value_entry_intent_write(zms_fs, intent_state, idx, prev_id, next_id);
+    ares = astarte_key_value_entry_intent_write(
+        backend, intent_state, list_id, idx, prev_id, next_id);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed writing intent: %s", astarte_result_to_name(ares));
         return ares;
     }
 
+    // An update has no list write to carry the usage, store it before the entry changes
+    if (!is_end_of_list && usage) {
+        ares = astarte_key_value_entry_list_write_usage(backend, list_id, usage);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed writing list usage: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
     // Write the serialized entry to ZMS
-    ssize_t ret = zms_write(zms_fs, idx, raw_entry, raw_entry_size);
+    ssize_t ret = astarte_key_value_backend_write(backend, idx, raw_entry, raw_entry_size);
     if (ret < 0) {
         ASTARTE_LOG_ERR("Error writing to ZMS at ID %d, error: %d", idx, ret);
         return ASTARTE_RESULT_ZMS_ERROR;
     }
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    if (is_end_of_list) {
+        astarte_key_value_entry_index_add(backend, idx, header.fixed_header.fingerprint);
+    }
+#endif
+
     // Update the previous tail to point to the new entry and update the head/tail IDs if needed
     if (is_end_of_list) {
-        ares = update_list_tail(zms_fs, idx);
+        ares = update_list_tail(backend, list_id, idx, usage);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Error updating tail %d, error: %s", idx, astarte_result_to_name(ares));
             return ares;
@@ -137,18 +173,18 @@ astarte_result_t astarte_key_value_entry_write(struct zms_fs *zms_fs, uint32_t i
     }
 
     // Clear intent block to signal successful multi-step transaction
-    return astarte_key_value_entry_intent_clear(zms_fs);
+    return astarte_key_value_entry_intent_clear(backend);
 }
 
 astarte_result_t astarte_key_value_entry_read_value(
-    struct zms_fs *zms_fs, uint32_t idx, void *value, size_t *value_size)
+    astarte_key_value_backend_t *backend, uint32_t idx, void *value, size_t *value_size)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
     size_t raw_entry_size = 0;
 
     // Read the fixed header
     struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
-    ares = astarte_key_value_entry_header_read_fixed(zms_fs, idx, &fixed_header, &raw_entry_size);
+    ares = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Failed reading fixed header: %s.",
             astarte_result_to_name(ares));
@@ -180,7 +216,7 @@ astarte_result_t astarte_key_value_entry_read_value(
         ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
-    ssize_t ret = zms_read(zms_fs, idx, raw_entry, raw_entry_size);
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, raw_entry, raw_entry_size);
     if (ret != raw_entry_size) {
         ASTARTE_LOG_ERR("Error reading full payload from ZMS at ID %d, error: %d", idx, ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -195,68 +231,95 @@ astarte_result_t astarte_key_value_entry_read_value(
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_entry_read_key(
-    struct zms_fs *zms_fs, uint32_t idx, char *key, size_t *key_size)
+astarte_result_t astarte_key_value_entry_read_value_range(astarte_key_value_backend_t *backend,
+    uint32_t idx, size_t offset, void *value, size_t *value_size)
 {
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-    struct astarte_key_value_entry_header header = { 0 };
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_entry_size = 0;
-
-    ares = astarte_key_value_entry_header_read(zms_fs, idx, &header, &raw_entry_size);
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
-        goto exit;
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Failed reading fixed header: %s.",
+            astarte_result_to_name(ares));
+        return ares;
     }
 
-    if (!key) {
-        // +1 includes room for termination
-        *key_size = header.fixed_header.key_len + 1;
-        goto exit;
+    size_t header_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES
+        + fixed_header.namespace_len + fixed_header.key_len;
+    if (header_size > raw_entry_size) {
+        ASTARTE_LOG_ERR("Incomplete header at ID %d", idx);
+        return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
     }
-    if (*key_size < header.fixed_header.key_len + 1) {
-        ASTARTE_LOG_ERR("Key buffer too small at ID %d", idx);
-        ares = ASTARTE_RESULT_INVALID_PARAM;
-        goto exit;
+
+    size_t stored_value_size = raw_entry_size - header_size;
+    if (offset > stored_value_size) {
+        ASTARTE_LOG_ERR("Offset %zu past the value end at ID %d", offset, idx);
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+    size_t read_size = MIN(*value_size, stored_value_size - offset);
+    if (read_size == 0) {
+        *value_size = 0;
+        return ASTARTE_RESULT_OK;
     }
 
-    memcpy(key, header.key, header.fixed_header.key_len);
-    key[header.fixed_header.key_len] = '\0';
-    *key_size = header.fixed_header.key_len + 1;
+    // ZMS reads always start from the beginning of the entry, skip what precedes the range
+    size_t prefix_size = header_size + offset + read_size;
+    scope_var(scoped_uint8, raw_prefix)(prefix_size);
+    if (!raw_prefix) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, raw_prefix, prefix_size);
+    if (ret != prefix_size) {
+        ASTARTE_LOG_ERR("Error reading payload from ZMS at ID %d, error: %d", idx, ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
 
-exit:
-    astarte_key_value_entry_header_free(&header);
-    return ares;
+    memcpy(value, raw_prefix + header_size + offset, read_size);
+    *value_size = read_size;
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_entry_read_value_size(
+    astarte_key_value_backend_t *backend, uint32_t idx, size_t *value_size)
+{
+    bool chunked = false;
+    struct astarte_key_value_entry_chunk_descriptor descriptor = { 0 };
+    astarte_result_t ares
+        = astarte_key_value_entry_chunk_read_descriptor(backend, idx, &chunked, &descriptor);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    *value_size = descriptor.value_size;
+    return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_entry_check_namespace(
-    struct zms_fs *zms_fs, uint32_t idx, const char *namespace, bool *matches)
+astarte_result_t astarte_key_value_entry_read_key(
+    astarte_key_value_backend_t *backend, uint32_t idx, char *key, size_t *key_size)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
     struct astarte_key_value_entry_header header = { 0 };
     size_t raw_entry_size = 0;
 
-    if (!namespace || !matches) {
-        ASTARTE_LOG_ERR("Trying to check namespace at ID %d passing null pointers", idx);
-        ares = ASTARTE_RESULT_INVALID_PARAM;
+    ares = astarte_key_value_entry_header_read(backend, idx, &header, &raw_entry_size);
+    if (ares != ASTARTE_RESULT_OK) {
         goto exit;
     }
 
-    ares = astarte_key_value_entry_header_read(zms_fs, idx, &header, &raw_entry_size);
-    if (ares == ASTARTE_RESULT_NOT_FOUND) {
-        ares = ASTARTE_RESULT_OK;
-        *matches = false;
-        goto exit;
-    }
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Failed reading key value entry header: %s", astarte_result_to_name(ares));
+    if (!key) {
+        // +1 includes room for termination
+        *key_size = header.fixed_header.key_len + 1;
         goto exit;
     }
-
-    if (header.fixed_header.namespace_len != strlen(namespace)) {
-        *matches = false;
+    if (*key_size < header.fixed_header.key_len + 1) {
+        ASTARTE_LOG_ERR("Key buffer too small at ID %d", idx);
+        ares = ASTARTE_RESULT_INVALID_PARAM;
         goto exit;
     }
 
-    *matches = strncmp(header.namespace, namespace, header.fixed_header.namespace_len) == 0;
+    memcpy(key, header.key, header.fixed_header.key_len);
+    key[header.fixed_header.key_len] = '\0';
+    *key_size = header.fixed_header.key_len + 1;
 
 exit:
     astarte_key_value_entry_header_free(&header);
@@ -264,14 +327,14 @@ exit:
 }
 
 astarte_result_t astarte_key_value_entry_get_next_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t *next_id)
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx, uint32_t *next_id)
 {
     // Calling this function with the NULL ID will make it return the ID of the head
     if (idx == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
         uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
         uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-        astarte_result_t rd_res
-            = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
+        astarte_result_t rd_res = astarte_key_value_entry_list_read_head_and_tail_ids(
+            backend, list_id, &head_id, &tail_id);
         if (rd_res != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Can't read head and tail IDs: %s", astarte_result_to_name(rd_res));
             return rd_res;
@@ -283,7 +346,7 @@ astarte_result_t astarte_key_value_entry_get_next_id(
     struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_entry_size = 0;
     astarte_result_t ares
-        = astarte_key_value_entry_header_read_fixed(zms_fs, idx, &fixed_header, &raw_entry_size);
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Can't read fixed header at ID %d: %s", idx, astarte_result_to_name(ares));
         return ares;
@@ -294,7 +357,7 @@ astarte_result_t astarte_key_value_entry_get_next_id(
 }
 
 astarte_result_t astarte_key_value_entry_get_prev_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t *prev_id)
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t *prev_id)
 {
     // Calling this function with NULL ID will make it return the NULL ID
     if (idx == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
@@ -305,7 +368,7 @@ astarte_result_t astarte_key_value_entry_get_prev_id(
     struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_entry_size = 0;
     astarte_result_t ares
-        = astarte_key_value_entry_header_read_fixed(zms_fs, idx, &fixed_header, &raw_entry_size);
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Can't read fixed header at ID %d: %s", idx, astarte_result_to_name(ares));
         return ares;
@@ -315,36 +378,8 @@ astarte_result_t astarte_key_value_entry_get_prev_id(
     return ASTARTE_RESULT_OK;
 }
 
-/************************************************
- *         Static functions definitions         *
- ***********************************************/
-
-static astarte_result_t update_list_tail(struct zms_fs *zms_fs, uint32_t new_tail_id)
-{
-    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    astarte_result_t ares
-        = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Can't read head and tail IDs: %s", astarte_result_to_name(ares));
-        return ares;
-    }
-
-    if (tail_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-        ares = astarte_key_value_entry_list_update_next_id(zms_fs, tail_id, new_tail_id);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Can't update next ID: %s", astarte_result_to_name(ares));
-            return ares;
-        }
-    } else {
-        head_id = new_tail_id;
-    }
-    tail_id = new_tail_id;
-    return astarte_key_value_entry_list_write_head_and_tail_ids(zms_fs, head_id, tail_id);
-}
-
-static uint8_t *serialize_entry(struct astarte_key_value_entry_header header, const void *value,
-    size_t value_size, size_t *serialized_entry_size)
+uint8_t *astarte_key_value_entry_serialize(struct astarte_key_value_entry_header header,
+    const void *value, size_t value_size, size_t *serialized_entry_size)
 {
     // Allocate enough memory to store the full raw entry (header + namespace + key + value)
     uint16_t nsp_len = header.fixed_header.namespace_len;
@@ -357,13 +392,24 @@ static uint8_t *serialize_entry(struct astarte_key_value_entry_header header, co
         return NULL;
     }
 
+    // Tombstones are flagged in the namespace length field, no valid namespace is that long
+    uint16_t raw_nsp_len = nsp_len;
+    if (header.fixed_header.tombstone) {
+        raw_nsp_len |= ASTARTE_KEY_VALUE_ENTRY_HEADER_TOMBSTONE_FLAG;
+    }
+    // Same for chunked values in the key length field
+    uint16_t raw_key_len = key_len;
+    if (header.fixed_header.chunked) {
+        raw_key_len |= ASTARTE_KEY_VALUE_ENTRY_HEADER_CHUNKED_FLAG;
+    }
+
     // NOLINTBEGIN(bugprone-not-null-terminated-result)
     size_t write_offset = 0;
     size_t write_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES;
-    memcpy(entry + write_offset, &header.fixed_header.namespace_len, write_size);
+    memcpy(entry + write_offset, &raw_nsp_len, write_size);
     write_offset += write_size;
     write_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES;
-    memcpy(entry + write_offset, &header.fixed_header.key_len, write_size);
+    memcpy(entry + write_offset, &raw_key_len, write_size);
     write_offset += write_size;
     write_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_NEXT_ID_BYTES;
     memcpy(entry + write_offset, &header.fixed_header.next_id, write_size);
@@ -371,6 +417,9 @@ static uint8_t *serialize_entry(struct astarte_key_value_entry_header header, co
     write_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_PREV_ID_BYTES;
     memcpy(entry + write_offset, &header.fixed_header.prev_id, write_size);
     write_offset += write_size;
+    write_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_FINGERPRINT_BYTES;
+    memcpy(entry + write_offset, &header.fixed_header.fingerprint, write_size);
+    write_offset += write_size;
     write_size = header.fixed_header.namespace_len;
     memcpy(entry + write_offset, header.namespace, write_size);
     write_offset += write_size;
@@ -387,33 +436,133 @@ static uint8_t *serialize_entry(struct astarte_key_value_entry_header header, co
     return entry;
 }
 
-static astarte_result_t check_entry_match(
-    struct zms_fs *zms_fs, uint32_t idx, const char *namespace, const char *key)
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t update_list_tail(astarte_key_value_backend_t *backend, uint32_t list_id,
+    uint32_t new_tail_id, const struct astarte_key_value_entry_list_usage *usage)
 {
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-    struct astarte_key_value_entry_header header = { 0 };
+    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    astarte_result_t ares
+        = astarte_key_value_entry_list_read_head_and_tail_ids(backend, list_id, &head_id, &tail_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Can't read head and tail IDs: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    if (tail_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ares = astarte_key_value_entry_list_update_next_id(backend, tail_id, new_tail_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Can't update next ID: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+    } else {
+        head_id = new_tail_id;
+    }
+    tail_id = new_tail_id;
+
+    // The usage is committed together with the new tail
+    if (usage) {
+        return astarte_key_value_entry_list_write_head_tail_and_usage(
+            backend, list_id, head_id, tail_id, usage);
+    }
+    return astarte_key_value_entry_list_write_head_and_tail_ids(backend, list_id, head_id, tail_id);
+}
+
+static astarte_result_t check_entry_match(astarte_key_value_backend_t *backend, uint32_t idx,
+    const char *namespace, const char *key, bool *tombstone)
+{
+    size_t nsp_len = strlen(namespace);
+    size_t key_len = strlen(key);
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_size = 0;
 
-    ares = astarte_key_value_entry_header_read(zms_fs, idx, &header, &raw_size);
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Can't read header (ID %d): %s", idx,
             astarte_result_to_name(ares));
-        goto exit;
+        return ares;
     }
 
-    struct astarte_key_value_entry_header_fixed fixed_header = header.fixed_header;
-    if (fixed_header.namespace_len != strlen(namespace) || fixed_header.key_len != strlen(key)) {
-        ares = ASTARTE_RESULT_MISMATCH;
-        goto exit;
+    // Most collisions are rejected by the fixed header alone, without reading any string
+    if ((fixed_header.namespace_len != nsp_len) || (fixed_header.key_len != key_len)
+        || (fixed_header.fingerprint != astarte_key_value_entry_hash_fingerprint(namespace, key))) {
+        return ASTARTE_RESULT_MISMATCH;
     }
-    int nsp_cmp = strncmp(header.namespace, namespace, fixed_header.namespace_len);
-    int key_cmp = strncmp(header.key, key, fixed_header.key_len);
-    if (nsp_cmp != 0 || key_cmp != 0) {
-        ares = ASTARTE_RESULT_MISMATCH;
-        goto exit;
+
+    // Equal fingerprints do not guarantee equal strings, compare them directly
+    size_t raw_header_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES + nsp_len + key_len;
+    if (raw_header_size > raw_size) {
+        ASTARTE_LOG_ERR("Incomplete header at ID %d", idx);
+        return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+    }
+    scope_var(scoped_uint8, raw_header)(raw_header_size);
+    if (!raw_header) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, raw_header, raw_header_size);
+    if (ret != raw_header_size) {
+        ASTARTE_LOG_ERR("Error reading header from ZMS at ID %d, error: %d", idx, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
     }
 
-exit:
-    astarte_key_value_entry_header_free(&header);
-    return ares;
+    const uint8_t *stored_nsp = raw_header + ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES;
+    const uint8_t *stored_key = stored_nsp + nsp_len;
+    if ((memcmp(stored_nsp, namespace, nsp_len) != 0) || (memcmp(stored_key, key, key_len) != 0)) {
+        return ASTARTE_RESULT_MISMATCH;
+    }
+
+    *tombstone = fixed_header.tombstone;
+    return ASTARTE_RESULT_OK;
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+static astarte_result_t find_or_alloc_indexed(astarte_key_value_backend_t *backend,
+    const char *namespace, const char *key, uint32_t *idx, bool allocate)
+{
+    uint32_t fingerprint = astarte_key_value_entry_hash_fingerprint(namespace, key);
+    uint32_t start_id = astarte_key_value_entry_hash_generate(namespace, key);
+    uint32_t curr_id = start_id;
+
+    do {
+        // The index tracks all the occupied IDs, a missing ID is a free one
+        uint32_t stored_fingerprint = 0;
+        astarte_result_t ares
+            = astarte_key_value_entry_index_lookup(backend, curr_id, &stored_fingerprint);
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            if (!allocate) {
+                return ares;
+            }
+            *idx = curr_id;
+            return ASTARTE_RESULT_OK;
+        }
+        // Different fingerprints are a sure collision, equal ones are confirmed from flash
+        if (stored_fingerprint == fingerprint) {
+            bool tombstone = false;
+            ares = check_entry_match(backend, curr_id, namespace, key, &tombstone);
+            if (ares == ASTARTE_RESULT_OK) {
+                if (tombstone && !allocate) {
+                    return ASTARTE_RESULT_NOT_FOUND;
+                }
+                *idx = curr_id;
+                return ASTARTE_RESULT_OK;
+            }
+            if (ares != ASTARTE_RESULT_MISMATCH) {
+                ASTARTE_LOG_ERR("Error while matching namespace and key at ID: %d", curr_id);
+                return ares;
+            }
+        }
+        curr_id++;
+        if (curr_id > ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID) {
+            curr_id = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID;
+        }
+    } while (curr_id != start_id);
+
+    ASTARTE_LOG_ERR("Key-value storage is full");
+    return ASTARTE_RESULT_KEY_VALUE_FULL;
 }
+#endif
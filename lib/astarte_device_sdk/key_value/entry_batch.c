@@ -0,0 +1,348 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/entry_batch.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "key_value/entry.h"
+#include "key_value/entry_hash.h"
+#include "key_value/entry_header.h"
+#include "key_value/entry_index.h"
+#include "key_value/entry_intent.h"
+#include "key_value/entry_list.h"
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+/* Offset of the next ID in a serialized entry */
+#define NEXT_ID_OFFSET                                                                             \
+    (ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES                                            \
+        + ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES)
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static astarte_result_t write_existing(struct astarte_key_value_entry_batch *batch, uint32_t idx,
+    struct astarte_key_value_entry_header_fixed *fixed_header, const char *key, const void *value,
+    size_t value_size);
+static astarte_result_t append_new(struct astarte_key_value_entry_batch *batch, uint32_t idx,
+    const char *key, const void *value, size_t value_size);
+static astarte_result_t flush_pending(
+    struct astarte_key_value_entry_batch *batch, uint32_t next_id);
+static astarte_result_t find_chain_end(astarte_key_value_backend_t *backend, uint32_t first_id,
+    uint32_t old_tail_id, uint32_t *last_id);
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_key_value_entry_batch_begin(struct astarte_key_value_entry_batch *batch,
+    astarte_key_value_backend_t *backend, uint32_t list_id, const char *namespace, bool track_usage)
+{
+    memset(batch, 0, sizeof(struct astarte_key_value_entry_batch));
+    batch->backend = backend;
+    batch->list_id = list_id;
+    batch->namespace = namespace;
+    batch->first_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    batch->pending_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    batch->track_usage = track_usage;
+
+    astarte_result_t ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+        backend, list_id, &batch->head_id, &batch->old_tail_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed reading head and tail IDs: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+    batch->tail_id = batch->old_tail_id;
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_entry_batch_find_or_alloc(
+    struct astarte_key_value_entry_batch *batch, const char *key, uint32_t *idx)
+{
+    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(
+        batch->backend, batch->namespace, key, idx, true);
+    if ((ares != ASTARTE_RESULT_OK) || (*idx != batch->pending_id)) {
+        return ares;
+    }
+
+    // The pending entry occupies the returned ID, or it has the same key. Write it unlinked, its
+    // next ID will be updated in flash if another entry gets appended.
+    ares = flush_pending(batch, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    return astarte_key_value_entry_find_or_alloc(batch->backend, batch->namespace, key, idx, true);
+}
+
+astarte_result_t astarte_key_value_entry_batch_write(struct astarte_key_value_entry_batch *batch,
+    uint32_t idx, const char *key, const void *value, size_t value_size)
+{
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+    size_t raw_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read_fixed(batch->backend, idx, &fixed_header, &raw_size);
+    if (ares == ASTARTE_RESULT_OK) {
+        return write_existing(batch, idx, &fixed_header, key, value, value_size);
+    }
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return append_new(batch, idx, key, value, value_size);
+    }
+    ASTARTE_LOG_ERR("Failed reading fixed header: %s.", astarte_result_to_name(ares));
+    return ares;
+}
+
+astarte_result_t astarte_key_value_entry_batch_end(struct astarte_key_value_entry_batch *batch,
+    const struct astarte_key_value_entry_list_usage *usage)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    if (batch->pending_entry) {
+        ares = flush_pending(batch, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+    }
+
+    if (!batch->track_usage) {
+        usage = NULL;
+    }
+
+    // Only updates have been performed, no intent has been written
+    if (batch->first_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        if (usage && batch->usage_removed) {
+            return astarte_key_value_entry_list_write_usage(batch->backend, batch->list_id, usage);
+        }
+        return ASTARTE_RESULT_OK;
+    }
+
+    // Writing the new tail commits the batch, along with the usage of the list
+    uint32_t head_id = batch->head_id;
+    if (head_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        head_id = batch->first_id;
+    }
+    if (usage) {
+        ares = astarte_key_value_entry_list_write_head_tail_and_usage(
+            batch->backend, batch->list_id, head_id, batch->tail_id, usage);
+    } else {
+        ares = astarte_key_value_entry_list_write_head_and_tail_ids(
+            batch->backend, batch->list_id, head_id, batch->tail_id);
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed committing batch: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    return astarte_key_value_entry_intent_clear(batch->backend);
+}
+
+void astarte_key_value_entry_batch_discard(struct astarte_key_value_entry_batch *batch)
+{
+    if (batch) {
+        astarte_free(batch->pending_entry);
+        batch->pending_entry = NULL;
+        batch->pending_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    }
+}
+
+astarte_result_t astarte_key_value_entry_batch_rollback(
+    astarte_key_value_backend_t *backend, uint32_t first_id, uint32_t old_tail_id)
+{
+    // Detach the new entries from the list first, the old tail could point to any of them
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    if (old_tail_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ares = astarte_key_value_entry_list_update_next_id(
+            backend, old_tail_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed to repair previous tail pointer %d", old_tail_id);
+            return ares;
+        }
+    }
+
+    uint32_t curr_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    ares = find_chain_end(backend, first_id, old_tail_id, &curr_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // Delete starting from the end, so an interrupted rollback still finds the remaining entries
+    while ((curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) && (curr_id != old_tail_id)) {
+        uint32_t prev_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        ares = astarte_key_value_entry_get_prev_id(backend, curr_id, &prev_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        ssize_t del_ret = astarte_key_value_backend_delete(backend, curr_id);
+        if (del_ret < 0) {
+            ASTARTE_LOG_ERR("Failed to clean up orphaned entry %d", curr_id);
+            return ASTARTE_RESULT_ZMS_ERROR;
+        }
+        curr_id = prev_id;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t write_existing(struct astarte_key_value_entry_batch *batch, uint32_t idx,
+    struct astarte_key_value_entry_header_fixed *fixed_header, const char *key, const void *value,
+    size_t value_size)
+{
+    // Updates do not touch the list, a single ZMS write is atomic and needs no intent
+    struct astarte_key_value_entry_header header = {
+        .fixed_header = *fixed_header,
+        .namespace = (char *) batch->namespace,
+        .key = (char *) key,
+        .dynamically_allocated = false,
+    };
+    // Writing over the tombstone of the key brings the entry back to life in its old position
+    header.fixed_header.tombstone = false;
+    header.fixed_header.chunked = false;
+    size_t raw_entry_size = 0;
+    scope_var_init(scoped_uint8, raw_entry,
+        astarte_key_value_entry_serialize(header, value, value_size, &raw_entry_size));
+    if (!raw_entry) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    // The stored usage would not account for this update if the batch gets interrupted
+    if (batch->track_usage && !batch->usage_removed) {
+        astarte_result_t ares
+            = astarte_key_value_entry_list_write_usage(batch->backend, batch->list_id, NULL);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed removing list usage: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+        batch->usage_removed = true;
+    }
+
+    ssize_t ret = astarte_key_value_backend_write(batch->backend, idx, raw_entry, raw_entry_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Error writing to ZMS at ID %d, error: %d", idx, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t append_new(struct astarte_key_value_entry_batch *batch, uint32_t idx,
+    const char *key, const void *value, size_t value_size)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    struct astarte_key_value_entry_header header = {
+        .fixed_header = {
+            .namespace_len = strlen(batch->namespace),
+            .key_len = strlen(key),
+            .next_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
+            .prev_id = batch->tail_id,
+            .fingerprint = astarte_key_value_entry_hash_fingerprint(batch->namespace, key),
+        },
+        .namespace = (char *) batch->namespace,
+        .key = (char *) key,
+        .dynamically_allocated = false,
+    };
+    size_t raw_entry_size = 0;
+    uint8_t *raw_entry
+        = astarte_key_value_entry_serialize(header, value, value_size, &raw_entry_size);
+    if (!raw_entry) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    // A single intent covers all the new entries, log it before the first physical write
+    if (batch->first_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ares = astarte_key_value_entry_intent_write(batch->backend,
+            ASTARTE_KEY_VALUE_ENTRY_INTENT_BATCH_INSERTING, batch->list_id, idx,
+            batch->old_tail_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed writing intent: %s", astarte_result_to_name(ares));
+            astarte_free(raw_entry);
+            return ares;
+        }
+        batch->first_id = idx;
+    }
+
+    // Link the previous entry to this one, writing it directly linked when still pending
+    if (batch->pending_entry) {
+        ares = flush_pending(batch, idx);
+    } else if (batch->tail_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ares = astarte_key_value_entry_list_update_next_id(batch->backend, batch->tail_id, idx);
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed linking entry %d: %s", idx, astarte_result_to_name(ares));
+        astarte_free(raw_entry);
+        return ares;
+    }
+
+    batch->pending_id = idx;
+    batch->pending_entry = raw_entry;
+    batch->pending_entry_size = raw_entry_size;
+    batch->pending_fingerprint = header.fixed_header.fingerprint;
+    batch->tail_id = idx;
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t flush_pending(
+    struct astarte_key_value_entry_batch *batch, uint32_t next_id)
+{
+    memcpy(batch->pending_entry + NEXT_ID_OFFSET, &next_id, sizeof(next_id));
+    ssize_t ret = astarte_key_value_backend_write(
+        batch->backend, batch->pending_id, batch->pending_entry, batch->pending_entry_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Error writing to ZMS at ID %d, error: %d", batch->pending_id, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    astarte_key_value_entry_index_add(
+        batch->backend, batch->pending_id, batch->pending_fingerprint);
+#endif
+
+    astarte_key_value_entry_batch_discard(batch);
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t find_chain_end(astarte_key_value_backend_t *backend, uint32_t first_id,
+    uint32_t old_tail_id, uint32_t *last_id)
+{
+    // The last written entry could point to an entry that has never been written
+    uint32_t prev_id = old_tail_id;
+    uint32_t curr_id = first_id;
+    *last_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    while (curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+        size_t raw_size = 0;
+        astarte_result_t ares
+            = astarte_key_value_entry_header_read_fixed(backend, curr_id, &fixed_header, &raw_size);
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            break;
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed reading fixed header: %s.", astarte_result_to_name(ares));
+            return ares;
+        }
+        if (fixed_header.prev_id != prev_id) {
+            ASTARTE_LOG_WRN("Entry %d does not belong to the interrupted batch.", curr_id);
+            break;
+        }
+        *last_id = curr_id;
+        prev_id = curr_id;
+        curr_id = fixed_header.next_id;
+    }
+    return ASTARTE_RESULT_OK;
+}
@@ -0,0 +1,126 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/entry_chunk.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "key_value/entry.h"
+#include "key_value/entry_header.h"
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+// Separator for the derived strings, it can't be part of the namespaces and keys of the users
+#define CHUNK_SEPARATOR "\x1f"
+#define CHUNK_NAMESPACE_SUFFIX CHUNK_SEPARATOR "chunks"
+
+#define OFFSET_VALUE_SIZE 0
+#define OFFSET_GENERATION (OFFSET_VALUE_SIZE + sizeof(uint32_t))
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+size_t astarte_key_value_entry_chunk_count(size_t value_size)
+{
+    if (value_size <= ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE) {
+        return 0;
+    }
+    // The last chunk, even when full, is stored with the descriptor
+    return (value_size - 1) / ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE;
+}
+
+char *astarte_key_value_entry_chunk_namespace(const char *namespace)
+{
+    size_t chunk_namespace_size = strlen(namespace) + sizeof(CHUNK_NAMESPACE_SUFFIX);
+    char *chunk_namespace = astarte_calloc(chunk_namespace_size, sizeof(char));
+    if (!chunk_namespace) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return NULL;
+    }
+    snprintf(chunk_namespace, chunk_namespace_size, "%s" CHUNK_NAMESPACE_SUFFIX, namespace);
+    return chunk_namespace;
+}
+
+char *astarte_key_value_entry_chunk_key(const char *key, uint8_t generation, size_t index)
+{
+    // Room for the separators, a single digit generation and the index
+    const size_t suffix_size = sizeof(CHUNK_SEPARATOR "0" CHUNK_SEPARATOR "4294967295");
+    size_t chunk_key_size = strlen(key) + suffix_size;
+    char *chunk_key = astarte_calloc(chunk_key_size, sizeof(char));
+    if (!chunk_key) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return NULL;
+    }
+    snprintf(chunk_key, chunk_key_size, "%s" CHUNK_SEPARATOR "%u" CHUNK_SEPARATOR "%u", key,
+        (unsigned int) generation, (unsigned int) index);
+    return chunk_key;
+}
+
+void astarte_key_value_entry_chunk_descriptor_encode(
+    const struct astarte_key_value_entry_chunk_descriptor *descriptor, uint8_t *raw)
+{
+    memcpy(raw + OFFSET_VALUE_SIZE, &descriptor->value_size, sizeof(uint32_t));
+    raw[OFFSET_GENERATION] = descriptor->generation;
+}
+
+void astarte_key_value_entry_chunk_descriptor_decode(
+    const uint8_t *raw, struct astarte_key_value_entry_chunk_descriptor *descriptor)
+{
+    memcpy(&descriptor->value_size, raw + OFFSET_VALUE_SIZE, sizeof(uint32_t));
+    descriptor->generation = raw[OFFSET_GENERATION];
+}
+
+astarte_result_t astarte_key_value_entry_chunk_read_descriptor(astarte_key_value_backend_t *backend,
+    uint32_t idx, bool *chunked, struct astarte_key_value_entry_chunk_descriptor *descriptor)
+{
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+    size_t raw_entry_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Failed reading fixed header: %s.",
+            astarte_result_to_name(ares));
+        return ares;
+    }
+
+    size_t header_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES
+        + fixed_header.namespace_len + fixed_header.key_len;
+    if (header_size > raw_entry_size) {
+        ASTARTE_LOG_ERR("Incomplete header at ID %d", idx);
+        return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+    }
+
+    *chunked = fixed_header.chunked;
+    if (!fixed_header.chunked) {
+        // A value stored in a single entry is described by its size only
+        descriptor->value_size = (uint32_t) (raw_entry_size - header_size);
+        descriptor->generation = 0;
+        return ASTARTE_RESULT_OK;
+    }
+
+    uint8_t raw_descriptor[ASTARTE_KEY_VALUE_ENTRY_CHUNK_DESCRIPTOR_BYTES] = { 0 };
+    size_t descriptor_size = sizeof(raw_descriptor);
+    ares = astarte_key_value_entry_read_value_range(
+        backend, idx, 0, raw_descriptor, &descriptor_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    if (descriptor_size != sizeof(raw_descriptor)) {
+        ASTARTE_LOG_ERR("Incomplete chunked value descriptor at ID %d", idx);
+        return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+    }
+
+    astarte_key_value_entry_chunk_descriptor_decode(raw_descriptor, descriptor);
+    return ASTARTE_RESULT_OK;
+}
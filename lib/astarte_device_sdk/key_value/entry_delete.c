@@ -14,6 +14,7 @@
 #include "key_value/entry.h"
 #include "key_value/entry_hash.h"
 #include "key_value/entry_header.h"
+#include "key_value/entry_index.h"
 #include "key_value/entry_intent.h"
 #include "key_value/entry_list.h"
 #include "log.h"
@@ -24,23 +25,63 @@ ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALU
 // entry header and storing it in the colliding entry. This increases the occupied space but
 // reduces the worst case O(N) shift penality
 
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+BUILD_ASSERT(ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES <= 64U,
+    "The compaction tracks the namespace lists in a 64 bits bitmap");
+
+/** @brief Progress of the incremental compaction of the tombstones. */
+struct compaction_state
+{
+    /** @brief Bitmap of the namespace lists that could contain tombstones. */
+    uint64_t pending_lists;
+    /** @brief Namespace list being scanned. */
+    uint32_t list_id;
+    /** @brief Last live entry scanned, ASTARTE_KEY_VALUE_ENTRY_NULL_ID to start from the head. */
+    uint32_t resume_id;
+};
+
+/************************************************
+ *         Static variables declaration         *
+ ***********************************************/
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static struct compaction_state compaction = {
+    .pending_lists = UINT64_MAX,
+    .list_id = 0,
+    .resume_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
+};
+#endif
+
 /************************************************
  *         Static functions declaration         *
  ***********************************************/
 
 static astarte_result_t shift_back_single_entry(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t hole_id, bool *shift_performed);
-static astarte_result_t update_shifted_entry_neighbors(
-    struct zms_fs *zms_fs, const struct astarte_key_value_entry_header *header, uint32_t hole_id);
-static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, uint32_t idx);
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t hole_id, bool *shift_performed);
+static astarte_result_t move_entry(astarte_key_value_backend_t *backend,
+    const struct astarte_key_value_entry_header *header, size_t raw_entry_size,
+    uint32_t source_id, uint32_t target_id);
+static astarte_result_t update_shifted_entry_neighbors(astarte_key_value_backend_t *backend,
+    const struct astarte_key_value_entry_header *header, uint32_t hole_id);
+static astarte_result_t delete_and_unlink_single_entry(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+static astarte_result_t compaction_first_id(
+    astarte_key_value_backend_t *backend, uint32_t *first_id);
+#endif
 
 /************************************************
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_key_value_entry_delete(struct zms_fs *zms_fs, uint32_t idx)
+astarte_result_t astarte_key_value_entry_delete(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx)
 {
-    astarte_result_t ares = delete_and_unlink_single_entry(zms_fs, idx);
+    astarte_result_t ares = delete_and_unlink_single_entry(backend, list_id, idx);
     if (ares == ASTARTE_RESULT_NOT_FOUND) {
         return ASTARTE_RESULT_OK;
     }
@@ -50,36 +91,41 @@ astarte_result_t astarte_key_value_entry_delete(struct zms_fs *zms_fs, uint32_t
     }
 
     // The entry is safely unlinked and deleted. We now transition to SHIFTING to fill the hole.
-    ares = astarte_key_value_entry_intent_write(zms_fs, ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING,
-        idx, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+    ares = astarte_key_value_entry_intent_write(backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING,
+        list_id, idx, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed writing intent: %s", astarte_result_to_name(ares));
         return ares;
     }
 
-    ares = astarte_key_value_entry_delete_resume_shift(zms_fs, idx);
+    ares = astarte_key_value_entry_delete_resume_shift(backend, idx);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed resuming the delete shifting: %s", astarte_result_to_name(ares));
         return ares;
     }
 
     // Clear intent block once the shift loop has fully repaired the hash map
-    return astarte_key_value_entry_intent_clear(zms_fs);
+    return astarte_key_value_entry_intent_clear(backend);
 }
 
 astarte_result_t astarte_key_value_entry_delete_resume_shift(
-    struct zms_fs *zms_fs, uint32_t hole_id)
+    astarte_key_value_backend_t *backend, uint32_t hole_id)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
     uint32_t curr_id = hole_id + 1;
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    // Shifted entries change ID, the entry the compaction would resume from could be one of them
+    compaction.resume_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+#endif
+
     if (curr_id > ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID) {
         curr_id = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID;
     }
 
     while (curr_id != hole_id) {
         bool shift_performed = false;
-        ares = shift_back_single_entry(zms_fs, curr_id, hole_id, &shift_performed);
+        ares = shift_back_single_entry(backend, curr_id, hole_id, &shift_performed);
         if (ares == ASTARTE_RESULT_NOT_FOUND) {
             // No more entries to shift back
             break;
@@ -94,9 +140,9 @@ astarte_result_t astarte_key_value_entry_delete_resume_shift(
             hole_id = curr_id;
 
             // Update the intent block so recovery knows the hole has moved
-            ares = astarte_key_value_entry_intent_write(zms_fs,
-                ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING, hole_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
-                ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+            ares = astarte_key_value_entry_intent_write(backend,
+                ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, hole_id,
+                ASTARTE_KEY_VALUE_ENTRY_NULL_ID, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
             if (ares != ASTARTE_RESULT_OK) {
                 ASTARTE_LOG_ERR("Failed to update shift intent for new hole %d", hole_id);
                 return ares;
@@ -112,12 +158,130 @@ astarte_result_t astarte_key_value_entry_delete_resume_shift(
     return ASTARTE_RESULT_OK;
 }
 
+astarte_result_t astarte_key_value_entry_delete_move(
+    astarte_key_value_backend_t *backend, uint32_t source_id, uint32_t target_id)
+{
+    struct astarte_key_value_entry_header header = { 0 };
+    scope_defer(astarte_key_value_entry_header_free)(&header);
+
+    size_t raw_entry_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read(backend, source_id, &header, &raw_entry_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND,
+            "Failed in reading header for entry with ID %d", source_id);
+        return ares;
+    }
+
+    return move_entry(backend, &header, raw_entry_size, source_id, target_id);
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+astarte_result_t astarte_key_value_entry_delete_tombstone(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx)
+{
+    struct astarte_key_value_entry_header header = { 0 };
+    scope_defer(astarte_key_value_entry_header_free)(&header);
+
+    size_t raw_entry_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read(backend, idx, &header, &raw_entry_size);
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return ASTARTE_RESULT_OK;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed reading header for entry with ID %d", idx);
+        return ares;
+    }
+
+    // Drop the value but keep the links and the key, the entry still occupies its probing slot
+    header.fixed_header.tombstone = true;
+    header.fixed_header.chunked = false;
+    scope_var_init(scoped_uint8, raw_tombstone,
+        astarte_key_value_entry_serialize(header, NULL, 0, &raw_entry_size));
+    if (!raw_tombstone) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    // A single ZMS write is atomic, no intent is required
+    ssize_t ret = astarte_key_value_backend_write(backend, idx, raw_tombstone, raw_entry_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Error writing tombstone at ID %d, error: %d", idx, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    // The compaction could have already scanned past this entry
+    compaction.pending_lists |= BIT64(list_id);
+    if (compaction.list_id == list_id) {
+        compaction.resume_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_entry_delete_compact(astarte_key_value_backend_t *backend)
+{
+    uint32_t curr_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    astarte_result_t ares = compaction_first_id(backend, &curr_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    for (size_t scanned = 0;
+        scanned < CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES_SCAN_BUDGET; scanned++) {
+        // The end of the list has been reached, move to the next list with tombstones
+        if (curr_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+            compaction.pending_lists &= ~BIT64(compaction.list_id);
+            compaction.resume_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+            ares = compaction_first_id(backend, &curr_id);
+            if (ares != ASTARTE_RESULT_OK) {
+                return ares;
+            }
+            continue;
+        }
+
+        struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+        size_t raw_size = 0;
+        ares = astarte_key_value_entry_header_read_fixed(
+            backend, curr_id, &fixed_header, &raw_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Can't read fixed header at ID %d: %s", curr_id,
+                astarte_result_to_name(ares));
+            return ares;
+        }
+
+        // Remove a single tombstone for each step, its shift can rewrite several entries
+        if (fixed_header.tombstone) {
+            ares = astarte_key_value_entry_delete(backend, compaction.list_id, curr_id);
+            if (ares != ASTARTE_RESULT_OK) {
+                ASTARTE_LOG_ERR("Failed removing tombstone at ID %d: %s", curr_id,
+                    astarte_result_to_name(ares));
+            }
+            return ares;
+        }
+
+        compaction.resume_id = curr_id;
+        curr_id = fixed_header.next_id;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+void astarte_key_value_entry_delete_compact_forget(void)
+{
+    compaction.pending_lists = UINT64_MAX;
+    compaction.list_id = 0;
+    compaction.resume_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+}
+#endif
+
 /************************************************
  *         Static functions definitions         *
  ***********************************************/
 
 static astarte_result_t shift_back_single_entry(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t hole_id, bool *shift_performed)
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t hole_id, bool *shift_performed)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
 
@@ -134,7 +298,7 @@ static astarte_result_t shift_back_single_entry(
     ssize_t raw_entry_size = 0;
 
     // Read the source entry to be shifted back
-    ares = astarte_key_value_entry_header_read(zms_fs, source_id, &header, &raw_entry_size);
+    ares = astarte_key_value_entry_header_read(backend, source_id, &header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
         if (ares != ASTARTE_RESULT_NOT_FOUND) {
             ASTARTE_LOG_ERR("Failed in reading header for entry with ID %d", idx);
@@ -142,18 +306,6 @@ static astarte_result_t shift_back_single_entry(
         return ares;
     }
 
-    scope_var(scoped_uint8, raw_entry)(raw_entry_size);
-    if (!raw_entry) {
-        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
-        return ASTARTE_RESULT_OUT_OF_MEMORY;
-    }
-
-    ssize_t ret = zms_read(zms_fs, source_id, raw_entry, raw_entry_size);
-    if (ret != raw_entry_size) {
-        ASTARTE_LOG_ERR("Failed in reading entry with ID %d", idx);
-        return ASTARTE_RESULT_ZMS_ERROR;
-    }
-
     // Calculate the natural hash for the entry to be shifted back
     // And the cyclic absolute distances from the natural_hash
     uint32_t natural_hash = astarte_key_value_entry_hash_generate(header.namespace, header.key);
@@ -167,26 +319,10 @@ static astarte_result_t shift_back_single_entry(
     // If the hole is closer to the natural hash than the current element's distance
     if (d_hole < d_curr) {
         // Shift the current entry to the hole's position
-        ret = zms_write(zms_fs, hole_id, raw_entry, raw_entry_size);
-        if (ret < 0) {
-            ASTARTE_LOG_ERR("Failed in writing entry with ID %d", idx);
-            return ASTARTE_RESULT_ZMS_ERROR;
-        }
-
-        // Update linked list pointers of the physically moved entry's neighbors
-        ares = update_shifted_entry_neighbors(zms_fs, &header, hole_id);
+        ares = move_entry(backend, &header, raw_entry_size, source_id, hole_id);
         if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Failed updating shifted entry neighbors");
             return ares;
         }
-
-        // Clean up the entry from its old position
-        ret = zms_delete(zms_fs, source_id);
-        if (ret < 0) {
-            ASTARTE_LOG_ERR("Failed in deleting entry with ID %d", source_id);
-            return ASTARTE_RESULT_ZMS_ERROR;
-        }
-
         *shift_performed = true;
     } else {
         *shift_performed = false;
@@ -195,66 +331,119 @@ static astarte_result_t shift_back_single_entry(
     return ASTARTE_RESULT_OK;
 }
 
-static astarte_result_t update_shifted_entry_neighbors(
-    struct zms_fs *zms_fs, const struct astarte_key_value_entry_header *header, uint32_t hole_id)
+static astarte_result_t move_entry(astarte_key_value_backend_t *backend,
+    const struct astarte_key_value_entry_header *header, size_t raw_entry_size,
+    uint32_t source_id, uint32_t target_id)
+{
+    scope_var(scoped_uint8, raw_entry)(raw_entry_size);
+    if (!raw_entry) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    ssize_t ret = astarte_key_value_backend_read(backend, source_id, raw_entry, raw_entry_size);
+    if (ret != (ssize_t) raw_entry_size) {
+        ASTARTE_LOG_ERR("Failed in reading entry with ID %d", source_id);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    ret = astarte_key_value_backend_write(backend, target_id, raw_entry, raw_entry_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Failed in writing entry with ID %d", target_id);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    // Update linked list pointers of the physically moved entry's neighbors
+    astarte_result_t ares = update_shifted_entry_neighbors(backend, header, target_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed updating shifted entry neighbors");
+        return ares;
+    }
+
+    // Clean up the entry from its old position
+    ret = astarte_key_value_backend_delete(backend, source_id);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Failed in deleting entry with ID %d", source_id);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    astarte_key_value_entry_index_move(backend, source_id, target_id);
+#endif
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t update_shifted_entry_neighbors(astarte_key_value_backend_t *backend,
+    const struct astarte_key_value_entry_header *header, uint32_t hole_id)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
-    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    uint32_t prev_id = header->fixed_header.prev_id;
+    uint32_t next_id = header->fixed_header.next_id;
 
-    // Update previous neighbor or Head
-    if (header->fixed_header.prev_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-        ares = astarte_key_value_entry_list_update_next_id(
-            zms_fs, header->fixed_header.prev_id, hole_id);
+    // Update previous neighbor
+    if (prev_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ares = astarte_key_value_entry_list_update_next_id(backend, prev_id, hole_id);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed in updating next ID for prev entry");
             return ares;
         }
-    } else {
-        ares = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Failed in reading head and tail IDs");
-            return ares;
-        }
-        ares = astarte_key_value_entry_list_write_head_and_tail_ids(zms_fs, hole_id, tail_id);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Failed in writing head and tail IDs");
-            return ares;
-        }
     }
 
-    // Update next neighbor or Tail
-    if (header->fixed_header.next_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-        ares = astarte_key_value_entry_list_update_prev_id(
-            zms_fs, header->fixed_header.next_id, hole_id);
+    // Update next neighbor
+    if (next_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        ares = astarte_key_value_entry_list_update_prev_id(backend, next_id, hole_id);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed in updating prev ID for next entry");
             return ares;
         }
-    } else {
-        ares = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Failed in reading head and tail IDs");
-            return ares;
-        }
-        ares = astarte_key_value_entry_list_write_head_and_tail_ids(zms_fs, head_id, hole_id);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Failed in writing head and tail IDs");
-            return ares;
-        }
+    }
+
+    if ((prev_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID)
+        && (next_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID)) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    // The moved entry is the head or the tail of the list owned by its namespace
+    uint32_t list_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    ares = astarte_key_value_entry_list_find_id(backend, header->namespace, false, &list_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed in finding the list for namespace %s", header->namespace);
+        return ares;
+    }
+
+    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+        backend, list_id, &head_id, &tail_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed in reading head and tail IDs");
+        return ares;
+    }
+    if (prev_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        head_id = hole_id;
+    }
+    if (next_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        tail_id = hole_id;
+    }
+    ares = astarte_key_value_entry_list_write_head_and_tail_ids(backend, list_id, head_id, tail_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed in writing head and tail IDs");
+        return ares;
     }
 
     return ASTARTE_RESULT_OK;
 }
 
-static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, uint32_t idx)
+static astarte_result_t delete_and_unlink_single_entry(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
 
     // Fetch next and previous entries as well as head and tail
     struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_entry_size = 0;
-    ares = astarte_key_value_entry_header_read_fixed(zms_fs, idx, &fixed_header, &raw_entry_size);
+    ares = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
         return ares;
     }
@@ -263,7 +452,7 @@ static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, ui
 
     // Log the intent before modifying any linked list pointers
     ares = astarte_key_value_entry_intent_write(
-        zms_fs, ASTARTE_KEY_VALUE_ENTRY_INTENT_DELETING, idx, prev_id, next_id);
+        backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_DELETING, list_id, idx, prev_id, next_id);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed in writing intent: %s", astarte_result_to_name(ares));
         return ares;
@@ -272,7 +461,8 @@ static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, ui
     bool update_head_tail_ids = false;
     uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
     uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    ares = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
+    ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+        backend, list_id, &head_id, &tail_id);
     if (ares != ASTARTE_RESULT_OK) {
         return ares;
     }
@@ -280,7 +470,7 @@ static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, ui
     // Update the previous entry next id to the next one of the entry to delete
     // Or if this entry is the head set the head to the next entry
     if (prev_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-        ares = astarte_key_value_entry_list_update_next_id(zms_fs, prev_id, next_id);
+        ares = astarte_key_value_entry_list_update_next_id(backend, prev_id, next_id);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed updating next ID for entry with ID %d", prev_id);
             return ares;
@@ -293,7 +483,7 @@ static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, ui
     // Update the next entry previous id to the previous one of the entry to delete
     // Or if this node is the tail set the tail to the previous entry
     if (next_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-        ares = astarte_key_value_entry_list_update_prev_id(zms_fs, next_id, prev_id);
+        ares = astarte_key_value_entry_list_update_prev_id(backend, next_id, prev_id);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed updating previous ID for entry with ID %d", next_id);
             return ares;
@@ -305,7 +495,8 @@ static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, ui
 
     // Update head and tail to the new values
     if (update_head_tail_ids) {
-        ares = astarte_key_value_entry_list_write_head_and_tail_ids(zms_fs, head_id, tail_id);
+        ares = astarte_key_value_entry_list_write_head_and_tail_ids(
+            backend, list_id, head_id, tail_id);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed updating head and tail IDs");
             return ares;
@@ -313,11 +504,41 @@ static astarte_result_t delete_and_unlink_single_entry(struct zms_fs *zms_fs, ui
     }
 
     // Delete the entry
-    ssize_t ret = zms_delete(zms_fs, idx);
+    ssize_t ret = astarte_key_value_backend_delete(backend, idx);
     if (ret < 0) {
         ASTARTE_LOG_ERR("Failed deleting entry with ID %d", idx);
         return ASTARTE_RESULT_ZMS_ERROR;
     }
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    astarte_key_value_entry_index_remove(backend, idx);
+#endif
+
     return ASTARTE_RESULT_OK;
 }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+static astarte_result_t compaction_first_id(
+    astarte_key_value_backend_t *backend, uint32_t *first_id)
+{
+    if (compaction.pending_lists == 0) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    // Resume from the last scanned entry, if it is still there
+    if (compaction.resume_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        astarte_result_t ares = astarte_key_value_entry_get_next_id(
+            backend, compaction.list_id, compaction.resume_id, first_id);
+        if (ares != ASTARTE_RESULT_NOT_FOUND) {
+            return ares;
+        }
+        compaction.resume_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    }
+
+    while (!(compaction.pending_lists & BIT64(compaction.list_id))) {
+        compaction.list_id = (compaction.list_id + 1) % ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES;
+    }
+    return astarte_key_value_entry_get_next_id(
+        backend, compaction.list_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, first_id);
+}
+#endif
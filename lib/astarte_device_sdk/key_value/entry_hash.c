@@ -28,8 +28,18 @@
 /* Bit width constraint used to extract the upper 32 bits during Lemire's range reduction method */
 #define LEMIRE_SHIFT 32U
 
+/* 32 bits FNV-1a parameters used for the entries fingerprint */
+#define FNV1A_OFFSET_BASIS 0x811c9dc5U
+#define FNV1A_PRIME 0x01000193U
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static uint32_t fnv1a_append(uint32_t hash, const uint8_t *data, size_t len);
+
 /************************************************
- * Global functions definitions         *
+ *         Global functions definitions         *
  ***********************************************/
 
 uint32_t astarte_key_value_entry_hash_generate(const char *namespace, const char *key)
@@ -45,8 +55,35 @@ uint32_t astarte_key_value_entry_hash_generate(const char *namespace, const char
 
     // Lemire's Multiply-and-Shift Method for fast, unbiased range mapping
     uint32_t range
-        = ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID - ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID + 1;
+        = ASTARTE_KEY_VALUE_ENTRY_MAX_HASHED_ID - ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID + 1;
     uint32_t offset = (uint32_t) (((uint64_t) hash * (uint64_t) range) >> LEMIRE_SHIFT);
+    uint32_t idx = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID + offset;
+
+    // IDs reserved to the ring slots are skipped as the probing wraps past the last usable ID
+    if (idx > ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID) {
+        idx = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID;
+    }
+
+    return idx;
+}
 
-    return ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID + offset;
+uint32_t astarte_key_value_entry_hash_fingerprint(const char *namespace, const char *key)
+{
+    // The terminator of the namespace separates it from the key, avoiding ambiguous concatenations
+    uint32_t hash = fnv1a_append(
+        FNV1A_OFFSET_BASIS, (const uint8_t *) namespace, strlen(namespace) + 1);
+    return fnv1a_append(hash, (const uint8_t *) key, strlen(key));
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static uint32_t fnv1a_append(uint32_t hash, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
 }
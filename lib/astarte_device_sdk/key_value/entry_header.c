@@ -22,6 +22,7 @@ ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALU
 #define OFFSET_KEY_LEN (OFFSET_NAMESPACE_LEN + ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES)
 #define OFFSET_NEXT_ID (OFFSET_KEY_LEN + ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES)
 #define OFFSET_PREV_ID (OFFSET_NEXT_ID + ASTARTE_KEY_VALUE_ENTRY_HEADER_NEXT_ID_BYTES)
+#define OFFSET_FINGERPRINT (OFFSET_PREV_ID + ASTARTE_KEY_VALUE_ENTRY_HEADER_PREV_ID_BYTES)
 
 /** @brief Context to hold the temporary variables during the key_value read operation. */
 typedef struct
@@ -58,8 +59,8 @@ ASTARTE_SCOPE_DEFER_DEFINE(cleanup_kv_read, kv_read_cleanup_ctx_t *);
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_key_value_entry_header_read(struct zms_fs *zms_fs, uint32_t idx,
-    struct astarte_key_value_entry_header *header, size_t *raw_size)
+astarte_result_t astarte_key_value_entry_header_read(astarte_key_value_backend_t *backend,
+    uint32_t idx, struct astarte_key_value_entry_header *header, size_t *raw_size)
 {
     struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_entry_size = 0;
@@ -68,7 +69,7 @@ astarte_result_t astarte_key_value_entry_header_read(struct zms_fs *zms_fs, uint
     scope_defer(cleanup_kv_read)(&ctx);
 
     astarte_result_t ares
-        = astarte_key_value_entry_header_read_fixed(zms_fs, idx, &fixed_header, &raw_entry_size);
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_entry_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Failed reading fixed header: %s.",
             astarte_result_to_name(ares));
@@ -84,7 +85,7 @@ astarte_result_t astarte_key_value_entry_header_read(struct zms_fs *zms_fs, uint
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
 
-    ssize_t ret = zms_read(zms_fs, idx, ctx.raw_header, raw_header_size);
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, ctx.raw_header, raw_header_size);
     if (ret != raw_header_size) {
         ASTARTE_LOG_ERR("Failed reading raw header.");
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -137,12 +138,12 @@ void astarte_key_value_entry_header_free(struct astarte_key_value_entry_header *
     header->key = NULL;
 }
 
-astarte_result_t astarte_key_value_entry_header_read_fixed(struct zms_fs *zms_fs, uint32_t idx,
-    struct astarte_key_value_entry_header_fixed *fixed_header, size_t *raw_size)
+astarte_result_t astarte_key_value_entry_header_read_fixed(astarte_key_value_backend_t *backend,
+    uint32_t idx, struct astarte_key_value_entry_header_fixed *fixed_header, size_t *raw_size)
 {
     uint8_t raw_fixed_header[ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES] = { 0 };
-    ssize_t ret = zms_read(
-        zms_fs, idx, raw_fixed_header, ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES);
+    ssize_t ret = astarte_key_value_backend_read(
+        backend, idx, raw_fixed_header, ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES);
     if (ret == -ENOENT) {
         return ASTARTE_RESULT_NOT_FOUND;
     }
@@ -151,20 +152,30 @@ astarte_result_t astarte_key_value_entry_header_read_fixed(struct zms_fs *zms_fs
         return ASTARTE_RESULT_ZMS_ERROR;
     }
 
-    ret = zms_get_data_length(zms_fs, idx);
+    ret = astarte_key_value_backend_get_data_length(backend, idx);
     if (ret < 0) {
         ASTARTE_LOG_ERR("Error reading full entry length from ZMS at ID %d, error: %d", idx, ret);
         return ASTARTE_RESULT_ZMS_ERROR;
     }
 
-    memcpy(&fixed_header->namespace_len, &raw_fixed_header[OFFSET_NAMESPACE_LEN],
+    uint16_t raw_namespace_len = 0;
+    memcpy(&raw_namespace_len, &raw_fixed_header[OFFSET_NAMESPACE_LEN],
         ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES);
-    memcpy(&fixed_header->key_len, &raw_fixed_header[OFFSET_KEY_LEN],
+    fixed_header->namespace_len
+        = (uint16_t) (raw_namespace_len & ~ASTARTE_KEY_VALUE_ENTRY_HEADER_TOMBSTONE_FLAG);
+    fixed_header->tombstone
+        = ((raw_namespace_len & ASTARTE_KEY_VALUE_ENTRY_HEADER_TOMBSTONE_FLAG) != 0U);
+    uint16_t raw_key_len = 0;
+    memcpy(&raw_key_len, &raw_fixed_header[OFFSET_KEY_LEN],
         ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES);
+    fixed_header->key_len = (uint16_t) (raw_key_len & ~ASTARTE_KEY_VALUE_ENTRY_HEADER_CHUNKED_FLAG);
+    fixed_header->chunked = ((raw_key_len & ASTARTE_KEY_VALUE_ENTRY_HEADER_CHUNKED_FLAG) != 0U);
     memcpy(&fixed_header->next_id, &raw_fixed_header[OFFSET_NEXT_ID],
         ASTARTE_KEY_VALUE_ENTRY_HEADER_NEXT_ID_BYTES);
     memcpy(&fixed_header->prev_id, &raw_fixed_header[OFFSET_PREV_ID],
         ASTARTE_KEY_VALUE_ENTRY_HEADER_PREV_ID_BYTES);
+    memcpy(&fixed_header->fingerprint, &raw_fixed_header[OFFSET_FINGERPRINT],
+        ASTARTE_KEY_VALUE_ENTRY_HEADER_FINGERPRINT_BYTES);
 
     *raw_size = ret;
     return ASTARTE_RESULT_OK;
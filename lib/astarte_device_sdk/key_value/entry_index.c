@@ -0,0 +1,264 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/entry_index.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+
+#include "key_value/entry.h"
+#include "key_value/entry_header.h"
+#include "key_value/entry_list.h"
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+/** @brief Single slot of the index, free slots have the ZMS ID set to the NULL ID. */
+struct index_slot
+{
+    /** @brief ZMS ID of the entry. */
+    uint32_t zms_id;
+    /** @brief Fingerprint of the namespace and key of the entry. */
+    uint32_t fingerprint;
+};
+
+#define INDEX_CAPACITY                                                                             \
+    (CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX_SIZE / sizeof(struct index_slot))
+
+/* The index is kept at most three quarters full to keep the probing sequences short */
+#define INDEX_MAX_LOAD ((INDEX_CAPACITY * 3U) / 4U)
+
+/* Knuth multiplicative constant, spreads clusters of consecutive ZMS IDs over the table */
+#define INDEX_HASH_MAGIC 0x9e3779b1U
+
+BUILD_ASSERT(INDEX_MAX_LOAD > 0, "The key-value RAM index budget is too small");
+
+/** @brief The index is shared by all instances of this driver, as is the driver mutex. */
+struct entry_index
+{
+    /** @brief ZMS file system the index has been built for. */
+    astarte_key_value_backend_t *backend;
+    /** @brief Set when the index tracks all the entries stored in @p backend. */
+    bool valid;
+    /** @brief Number of occupied slots. */
+    size_t count;
+    /** @brief Open addressing table of slots. */
+    struct index_slot slots[INDEX_CAPACITY];
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static struct entry_index entry_index;
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static void clear_slots(void);
+static size_t home_slot(uint32_t zms_id);
+static bool find_slot(uint32_t zms_id, size_t *slot);
+static void insert_slot(uint32_t zms_id, uint32_t fingerprint);
+static void remove_slot(size_t slot);
+static astarte_result_t index_list(astarte_key_value_backend_t *backend, uint32_t list_id);
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_key_value_entry_index_build(astarte_key_value_backend_t *backend)
+{
+    clear_slots();
+    entry_index.backend = backend;
+    entry_index.valid = true;
+
+    for (uint32_t list_id = 0; list_id < ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES; list_id++) {
+        astarte_result_t ares = index_list(backend, list_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed indexing list %d: %s", list_id, astarte_result_to_name(ares));
+            astarte_key_value_entry_index_invalidate();
+            return ares;
+        }
+        if (!entry_index.valid) {
+            return ASTARTE_RESULT_OK;
+        }
+    }
+
+    ASTARTE_LOG_DBG("Key-value RAM index built with %zu entries.", entry_index.count);
+    return ASTARTE_RESULT_OK;
+}
+
+void astarte_key_value_entry_index_invalidate(void)
+{
+    entry_index.backend = NULL;
+    entry_index.valid = false;
+}
+
+bool astarte_key_value_entry_index_is_valid(astarte_key_value_backend_t *backend)
+{
+    return entry_index.valid && (entry_index.backend == backend);
+}
+
+astarte_result_t astarte_key_value_entry_index_lookup(
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t *fingerprint)
+{
+    size_t slot = 0;
+    if (!astarte_key_value_entry_index_is_valid(backend) || !find_slot(idx, &slot)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+    *fingerprint = entry_index.slots[slot].fingerprint;
+    return ASTARTE_RESULT_OK;
+}
+
+void astarte_key_value_entry_index_add(
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t fingerprint)
+{
+    if (!astarte_key_value_entry_index_is_valid(backend)) {
+        return;
+    }
+
+    size_t slot = 0;
+    if (find_slot(idx, &slot)) {
+        entry_index.slots[slot].fingerprint = fingerprint;
+        return;
+    }
+    if (entry_index.count >= INDEX_MAX_LOAD) {
+        ASTARTE_LOG_WRN("Key-value RAM index budget exceeded, falling back to flash lookups.");
+        astarte_key_value_entry_index_invalidate();
+        return;
+    }
+    insert_slot(idx, fingerprint);
+}
+
+void astarte_key_value_entry_index_remove(astarte_key_value_backend_t *backend, uint32_t idx)
+{
+    size_t slot = 0;
+    if (astarte_key_value_entry_index_is_valid(backend) && find_slot(idx, &slot)) {
+        remove_slot(slot);
+    }
+}
+
+void astarte_key_value_entry_index_move(
+    astarte_key_value_backend_t *backend, uint32_t source_id, uint32_t destination_id)
+{
+    size_t slot = 0;
+    if (!astarte_key_value_entry_index_is_valid(backend) || !find_slot(source_id, &slot)) {
+        return;
+    }
+    uint32_t fingerprint = entry_index.slots[slot].fingerprint;
+    remove_slot(slot);
+    insert_slot(destination_id, fingerprint);
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static void clear_slots(void)
+{
+    for (size_t i = 0; i < INDEX_CAPACITY; i++) {
+        entry_index.slots[i].zms_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        entry_index.slots[i].fingerprint = 0;
+    }
+    entry_index.count = 0;
+}
+
+static size_t home_slot(uint32_t zms_id)
+{
+    return (size_t) ((uint32_t) (zms_id * INDEX_HASH_MAGIC) % INDEX_CAPACITY);
+}
+
+static bool find_slot(uint32_t zms_id, size_t *slot)
+{
+    size_t curr = home_slot(zms_id);
+    // The load limit guarantees at least one free slot terminating the probing sequence
+    while (entry_index.slots[curr].zms_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        if (entry_index.slots[curr].zms_id == zms_id) {
+            *slot = curr;
+            return true;
+        }
+        curr = (curr + 1) % INDEX_CAPACITY;
+    }
+    return false;
+}
+
+static void insert_slot(uint32_t zms_id, uint32_t fingerprint)
+{
+    size_t curr = home_slot(zms_id);
+    while (entry_index.slots[curr].zms_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        curr = (curr + 1) % INDEX_CAPACITY;
+    }
+    entry_index.slots[curr].zms_id = zms_id;
+    entry_index.slots[curr].fingerprint = fingerprint;
+    entry_index.count++;
+}
+
+static void remove_slot(size_t slot)
+{
+    // Backward shift deletion, keeps the probing sequences unbroken without tombstones
+    size_t hole = slot;
+    size_t curr = slot;
+    while (true) {
+        curr = (curr + 1) % INDEX_CAPACITY;
+        if (entry_index.slots[curr].zms_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+            break;
+        }
+        // Move the slot in the hole only when the hole lies between its home and its position
+        size_t home = home_slot(entry_index.slots[curr].zms_id);
+        size_t d_curr = (curr + INDEX_CAPACITY - home) % INDEX_CAPACITY;
+        size_t d_hole = (hole + INDEX_CAPACITY - home) % INDEX_CAPACITY;
+        if (d_hole < d_curr) {
+            entry_index.slots[hole] = entry_index.slots[curr];
+            hole = curr;
+        }
+    }
+    entry_index.slots[hole].zms_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    entry_index.slots[hole].fingerprint = 0;
+    entry_index.count--;
+}
+
+static astarte_result_t index_list(astarte_key_value_backend_t *backend, uint32_t list_id)
+{
+    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    astarte_result_t ares
+        = astarte_key_value_entry_list_read_head_and_tail_ids(backend, list_id, &head_id, &tail_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    uint32_t curr_id = head_id;
+    while (curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        // The fingerprint is stored in the fixed header, no need to read the strings
+        struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+        size_t raw_size = 0;
+        ares = astarte_key_value_entry_header_read_fixed(
+            backend, curr_id, &fixed_header, &raw_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Can't read header (ID %d): %s", curr_id, astarte_result_to_name(ares));
+            return ares;
+        }
+
+        // A list looping over itself can't be indexed, lookups will rely on flash
+        size_t slot = 0;
+        if (find_slot(curr_id, &slot)) {
+            ASTARTE_LOG_WRN("Entry with ID %d is linked more than once, skipping index.", curr_id);
+            astarte_key_value_entry_index_invalidate();
+            return ASTARTE_RESULT_OK;
+        }
+        astarte_key_value_entry_index_add(backend, curr_id, fixed_header.fingerprint);
+        if (!entry_index.valid) {
+            return ASTARTE_RESULT_OK;
+        }
+        curr_id = fixed_header.next_id;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
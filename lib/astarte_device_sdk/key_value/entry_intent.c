@@ -6,39 +6,77 @@
 
 #include "key_value/entry_intent.h"
 
+#include <string.h>
+
 #include "key_value/entry.h"
+#include "key_value/entry_batch.h"
 #include "key_value/entry_delete.h"
 #include "key_value/entry_header.h"
+#include "key_value/entry_index.h"
 #include "key_value/entry_list.h"
 #include "log.h"
 
 ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
 
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+/** @brief RAM copy of the intent block state, shared by all instances as is the driver mutex. */
+struct intent_cache
+{
+    /** @brief ZMS file system known to contain no pending intent, NULL if unknown. */
+    astarte_key_value_backend_t *clean_backend;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static struct intent_cache intent_cache;
+
 /************************************************
  *         Static functions declaration         *
  ***********************************************/
 
 static astarte_result_t resolve_insert_intent(
-    struct zms_fs *zms_fs, struct astarte_key_value_entry_intent *intent);
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent);
 static astarte_result_t resolve_delete_intent(
-    struct zms_fs *zms_fs, struct astarte_key_value_entry_intent *intent);
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent);
 static astarte_result_t resolve_shift_intent(
-    struct zms_fs *zms_fs, struct astarte_key_value_entry_intent *intent);
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent);
+static astarte_result_t resolve_batch_intent(
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent);
+/**
+ * @brief Find the source of a move into the hole interrupted before the source was deleted.
+ *
+ * @param[in,out] backend Storage backend.
+ * @param[in] hole_id ID of the hole recorded by the shift intent.
+ * @param[out] source_id ID of the stale copy of the entry stored in the hole.
+ * @return ASTARTE_RESULT_OK if a stale copy has been found, ASTARTE_RESULT_NOT_FOUND if the hole
+ * is empty or its entry is not duplicated in the cluster, otherwise an error code.
+ */
+static astarte_result_t find_interrupted_move(
+    astarte_key_value_backend_t *backend, uint32_t hole_id, uint32_t *source_id);
+static astarte_result_t is_same_entry(astarte_key_value_backend_t *backend, uint32_t idx,
+    const struct astarte_key_value_entry_header *header, bool *same);
 
 /************************************************
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_key_value_entry_intent_write(struct zms_fs *zms_fs,
-    astarte_key_value_entry_intent_state_t state, uint32_t target_id, uint32_t affected_id_1,
-    uint32_t affected_id_2)
+astarte_result_t astarte_key_value_entry_intent_write(astarte_key_value_backend_t *backend,
+    astarte_key_value_entry_intent_state_t state, uint32_t list_id, uint32_t target_id,
+    uint32_t affected_id_1, uint32_t affected_id_2)
 {
     struct astarte_key_value_entry_intent intent = { .state = (uint8_t) state,
+        .list_id = list_id,
         .target_id = target_id,
         .affected_id_1 = affected_id_1,
         .affected_id_2 = affected_id_2 };
 
-    ssize_t ret = zms_write(zms_fs, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
+    // Mark as dirty before writing, a failed write could still have reached the flash
+    intent_cache.clean_backend = NULL;
+
+    ssize_t ret = astarte_key_value_backend_write(
+        backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
     if (ret < 0) {
         ASTARTE_LOG_ERR("Failed to write intent block: %d", (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -47,29 +85,43 @@ astarte_result_t astarte_key_value_entry_intent_write(struct zms_fs *zms_fs,
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_entry_intent_clear(struct zms_fs *zms_fs)
+astarte_result_t astarte_key_value_entry_intent_clear(astarte_key_value_backend_t *backend)
 {
     // Writing an empty block with ASTARTE_KEY_VALUE_ENTRY_INTENT_NONE effectively clears it
     struct astarte_key_value_entry_intent intent = { 0 };
     intent.state = ASTARTE_KEY_VALUE_ENTRY_INTENT_NONE;
 
-    ssize_t ret = zms_write(zms_fs, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
+    ssize_t ret = astarte_key_value_backend_write(
+        backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
     if (ret < 0) {
         ASTARTE_LOG_ERR("Failed to clear intent block: %d", (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
     }
 
+    intent_cache.clean_backend = backend;
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_entry_intent_resolve(struct zms_fs *zms_fs)
+void astarte_key_value_entry_intent_forget(void)
 {
+    intent_cache.clean_backend = NULL;
+}
+
+astarte_result_t astarte_key_value_entry_intent_resolve(astarte_key_value_backend_t *backend)
+{
+    // Every multi-step operation completed since the last check, nothing to read from flash
+    if (intent_cache.clean_backend == backend) {
+        return ASTARTE_RESULT_OK;
+    }
+
     struct astarte_key_value_entry_intent intent = { 0 };
     astarte_result_t ares = ASTARTE_RESULT_OK;
-    ssize_t ret = zms_read(zms_fs, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
+    ssize_t ret = astarte_key_value_backend_read(
+        backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
 
     // If the block is empty or explicitly clear, the system is healthy.
     if (ret == -ENOENT || intent.state == ASTARTE_KEY_VALUE_ENTRY_INTENT_NONE) {
+        intent_cache.clean_backend = backend;
         return ASTARTE_RESULT_OK;
     }
     if (ret != sizeof(intent)) {
@@ -79,12 +131,20 @@ astarte_result_t astarte_key_value_entry_intent_resolve(struct zms_fs *zms_fs)
 
     ASTARTE_LOG_WRN("Found interrupted operation (state %d). Initiating recovery...", intent.state);
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    // Recovery does not keep the RAM index updated, it will be rebuilt once recovery completes
+    bool rebuild_index = astarte_key_value_entry_index_is_valid(backend);
+    astarte_key_value_entry_index_invalidate();
+#endif
+
     if (intent.state == ASTARTE_KEY_VALUE_ENTRY_INTENT_INSERTING) {
-        ares = resolve_insert_intent(zms_fs, &intent);
+        ares = resolve_insert_intent(backend, &intent);
     } else if (intent.state == ASTARTE_KEY_VALUE_ENTRY_INTENT_UPDATING) {
         ASTARTE_LOG_INF("Found ghost update intent for ID %d.", intent.target_id);
     } else if (intent.state == ASTARTE_KEY_VALUE_ENTRY_INTENT_DELETING) {
-        ares = resolve_delete_intent(zms_fs, &intent);
+        ares = resolve_delete_intent(backend, &intent);
+    } else if (intent.state == ASTARTE_KEY_VALUE_ENTRY_INTENT_BATCH_INSERTING) {
+        ares = resolve_batch_intent(backend, &intent);
     }
 
     if (ares != ASTARTE_RESULT_OK) {
@@ -95,7 +155,7 @@ astarte_result_t astarte_key_value_entry_intent_resolve(struct zms_fs *zms_fs)
     // This block is divided from the rest as a deleting intent could immediately transition to a
     // shifting one
     if (intent.state == ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING) {
-        ares = resolve_shift_intent(zms_fs, &intent);
+        ares = resolve_shift_intent(backend, &intent);
     }
 
     if (ares != ASTARTE_RESULT_OK) {
@@ -104,7 +164,15 @@ astarte_result_t astarte_key_value_entry_intent_resolve(struct zms_fs *zms_fs)
     }
 
     // Clear the intent block now that we have cleaned up the ZMS state
-    return astarte_key_value_entry_intent_clear(zms_fs);
+    ares = astarte_key_value_entry_intent_clear(backend);
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+    if ((ares == ASTARTE_RESULT_OK) && rebuild_index) {
+        ares = astarte_key_value_entry_index_build(backend);
+    }
+#endif
+
+    return ares;
 }
 
 /************************************************
@@ -112,7 +180,7 @@ astarte_result_t astarte_key_value_entry_intent_resolve(struct zms_fs *zms_fs)
  ***********************************************/
 
 static astarte_result_t resolve_insert_intent(
-    struct zms_fs *zms_fs, struct astarte_key_value_entry_intent *intent)
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent)
 {
     /*
      * ZMS Flash Write Operations Breakdown
@@ -120,29 +188,30 @@ static astarte_result_t resolve_insert_intent(
      * 1. Updating an existing entry (1 writes)
      * When updating an existing key-value pair, the driver does not need to modify the linked
      * list pointers.
-     * - Write 1: zms_write writes the actual updated serialized payload to the target ID.
+     * - Write 1: the backend write stores the updated serialized payload to the target ID.
      *
      * 2. Inserting the first entry (empty list) (2 writes)
-     * When inserting the very first entry into the storage, the driver must update the global
+     * When inserting the very first entry into the storage, the driver must update the list
      * pointers but doesn't have a previous neighbor to update.
-     * - Write 1: zms_write writes the serialized payload.
-     * - Write 2: astarte_key_value_entry_list_write_head_and_tail_ids initializes the global
+     * - Write 1: the backend write stores the serialized payload.
+     * - Write 2: astarte_key_value_entry_list_write_head_and_tail_ids initializes the list
      * head and tail ZMS ID.
      *
      * 3. Inserting a new entry (populated list) (3 writes)
      * When appending a new entry to an existing list, the driver must link the previous tail to
      * the new entry.
-     * - Write 1: zms_write writes the serialized payload.
+     * - Write 1: the backend write stores the serialized payload.
      * - Write 2: astarte_key_value_entry_list_update_next_id overwrites the previous tail's
      * payload to update its next_id pointer.
-     * - Write 3: astarte_key_value_entry_list_write_head_and_tail_ids updates the global head
+     * - Write 3: astarte_key_value_entry_list_write_head_and_tail_ids updates the list head
      * and tail ZMS ID.
      */
 
     astarte_result_t ares = ASTARTE_RESULT_OK;
     uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
     uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-    ares = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
+    ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+        backend, intent->list_id, &head_id, &tail_id);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed reading head and tail IDs: %s.", astarte_result_to_name(ares));
         return ares;
@@ -160,7 +229,7 @@ static astarte_result_t resolve_insert_intent(
     // Revert the dangling next_id pointer of the previous tail
     if (prev_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
         ares = astarte_key_value_entry_list_update_next_id(
-            zms_fs, prev_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+            backend, prev_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Failed to repair previous tail pointer %d", prev_id);
             return ares;
@@ -168,7 +237,7 @@ static astarte_result_t resolve_insert_intent(
     }
 
     // Safely delete the orphaned payload
-    ssize_t del_ret = zms_delete(zms_fs, intent->target_id);
+    ssize_t del_ret = astarte_key_value_backend_delete(backend, intent->target_id);
     if (del_ret < 0) {
         ASTARTE_LOG_ERR("Failed to clean up orphaned entry %d", intent->target_id);
         return ares;
@@ -178,30 +247,30 @@ static astarte_result_t resolve_insert_intent(
     return ares;
 }
 static astarte_result_t resolve_delete_intent(
-    struct zms_fs *zms_fs, struct astarte_key_value_entry_intent *intent)
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent)
 {
     /*
      * ZMS Flash Write Operations Breakdown
      *
      * 1. Deleting from a list with a single element (2 writes)
      * When the entry is both the head and the tail, no neighbor pointers need updating.
-     * - Write 1: astarte_key_value_entry_list_write_head_and_tail_ids clears the global head
+     * - Write 1: astarte_key_value_entry_list_write_head_and_tail_ids clears the list head
      * and tail.
-     * - Write 2: zms_delete removes the serialized payload.
+     * - Write 2: the backend delete removes the serialized payload.
      *
      * 2. Deleting a head of a list with more than one element (3 writes)
-     * The driver must update the global head and clear the next node's previous pointer.
+     * The driver must update the list head and clear the next node's previous pointer.
      * - Write 1: astarte_key_value_entry_list_update_prev_id overwrites the next node to set
      * its prev_id to NULL.
      * - Write 2: astarte_key_value_entry_list_write_head_and_tail_ids updates the head ID.
-     * - Write 3: zms_delete removes the serialized payload.
+     * - Write 3: the backend delete removes the serialized payload.
      *
      * 3. Deleting a tail of a list with more than one element (3 writes)
-     * The driver must update the global tail and clear the previous node's next pointer.
+     * The driver must update the list tail and clear the previous node's next pointer.
      * - Write 1: astarte_key_value_entry_list_update_next_id overwrites the previous node to
      * set its next_id to NULL.
      * - Write 2: astarte_key_value_entry_list_write_head_and_tail_ids updates the tail ID.
-     * - Write 3: zms_delete removes the serialized payload.
+     * - Write 3: the backend delete removes the serialized payload.
      *
      * 4. Deleting a middle entry for a list with more than 2 elements (3 writes)
      * The driver must link the previous node and next node together.
@@ -209,7 +278,7 @@ static astarte_result_t resolve_delete_intent(
      * point to the next node.
      * - Write 2: astarte_key_value_entry_list_update_prev_id overwrites the next node to point
      * to the previous node.
-     * - Write 3: zms_delete removes the serialized payload.
+     * - Write 3: the backend delete removes the serialized payload.
      */
 
     // Check if the target entry has already been successfully deleted from ZMS
@@ -217,7 +286,7 @@ static astarte_result_t resolve_delete_intent(
     struct astarte_key_value_entry_header_fixed check_header = { 0 };
     size_t check_size = 0;
     ares = astarte_key_value_entry_header_read_fixed(
-        zms_fs, intent->target_id, &check_header, &check_size);
+        backend, intent->target_id, &check_header, &check_size);
 
     if (ares == ASTARTE_RESULT_NOT_FOUND) {
         ASTARTE_LOG_INF("Deletion for ID %d was already completed. Skipping to shift intent.",
@@ -230,7 +299,7 @@ static astarte_result_t resolve_delete_intent(
 
         // Repair prev_id's next pointer (if it was no head)
         if (prev_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-            ares = astarte_key_value_entry_list_update_next_id(zms_fs, prev_id, next_id);
+            ares = astarte_key_value_entry_list_update_next_id(backend, prev_id, next_id);
             if (ares != ASTARTE_RESULT_OK) {
                 ASTARTE_LOG_ERR("Previous node %d missing during recovery", prev_id);
                 return ares;
@@ -239,7 +308,7 @@ static astarte_result_t resolve_delete_intent(
 
         // Repair next_id's prev pointer (if it was no tail)
         if (next_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
-            ares = astarte_key_value_entry_list_update_prev_id(zms_fs, next_id, prev_id);
+            ares = astarte_key_value_entry_list_update_prev_id(backend, next_id, prev_id);
             if (ares != ASTARTE_RESULT_OK) {
                 ASTARTE_LOG_ERR("Next node %d missing during recovery", prev_id);
                 return ares;
@@ -249,7 +318,8 @@ static astarte_result_t resolve_delete_intent(
         // Repair Head/Tail if the deleted entry was the head or tail
         uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
         uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-        ares = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
+        ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+            backend, intent->list_id, &head_id, &tail_id);
         if (ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR("Head and tail read failed during recovery");
             return ares;
@@ -264,7 +334,8 @@ static astarte_result_t resolve_delete_intent(
             changed = true;
         }
         if (changed) {
-            ares = astarte_key_value_entry_list_write_head_and_tail_ids(zms_fs, head_id, tail_id);
+            ares = astarte_key_value_entry_list_write_head_and_tail_ids(
+                backend, intent->list_id, head_id, tail_id);
             if (ares != ASTARTE_RESULT_OK) {
                 ASTARTE_LOG_ERR("Head and tail write failed during recovery");
                 return ares;
@@ -272,7 +343,7 @@ static astarte_result_t resolve_delete_intent(
         }
 
         // Safely delete the orphaned payload physically from ZMS
-        ssize_t del_ret = zms_delete(zms_fs, intent->target_id);
+        ssize_t del_ret = astarte_key_value_backend_delete(backend, intent->target_id);
         if (del_ret < 0) {
             ASTARTE_LOG_ERR("Failed deleting orphaned entry");
             return ASTARTE_RESULT_ZMS_ERROR;
@@ -281,13 +352,29 @@ static astarte_result_t resolve_delete_intent(
 
     // Transition to shifting state to heal the linear probing gap
     intent->state = ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING;
-    return astarte_key_value_entry_intent_write(zms_fs, intent->state, intent->target_id,
-        ASTARTE_KEY_VALUE_ENTRY_NULL_ID, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+    return astarte_key_value_entry_intent_write(backend, intent->state, intent->list_id,
+        intent->target_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
 }
 static astarte_result_t resolve_shift_intent(
-    struct zms_fs *zms_fs, struct astarte_key_value_entry_intent *intent)
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent)
 {
-    astarte_result_t ares = ASTARTE_RESULT_OK;
+    // Power could have been lost after an entry was copied to the hole but before its source was
+    // deleted. Its stale copy further in the cluster is removed by completing the move.
+    uint32_t source_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    astarte_result_t ares = find_interrupted_move(backend, intent->target_id, &source_id);
+    if (ares == ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Completing move of entry with ID %d to ID %d", source_id,
+            intent->target_id);
+        ares = astarte_key_value_entry_delete_move(backend, source_id, intent->target_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed completing move: %s.", astarte_result_to_name(ares));
+            return ares;
+        }
+        intent->target_id = source_id;
+    } else if (ares != ASTARTE_RESULT_NOT_FOUND) {
+        return ares;
+    }
+
     // Resolve the true hole ID. If power was lost after a shift but before the intent was
     // updated, the target_id might no longer be a hole.
     // Because linear probing guarantees contiguous entries until the end of a cluster,
@@ -298,7 +385,7 @@ static astarte_result_t resolve_shift_intent(
 
     while (true) {
         ares = astarte_key_value_entry_header_read_fixed(
-            zms_fs, current_hole, &dummy_header, &dummy_size);
+            backend, current_hole, &dummy_header, &dummy_size);
         if (ares == ASTARTE_RESULT_NOT_FOUND) {
             break;
         }
@@ -309,7 +396,7 @@ static astarte_result_t resolve_shift_intent(
 
         current_hole++;
         if (current_hole > ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID) {
-            current_hole = 0;
+            current_hole = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID;
         }
         if (current_hole == intent->target_id) {
             // Failsafe: The hash map is 100% full. This should be impossible during shifting.
@@ -318,6 +405,121 @@ static astarte_result_t resolve_shift_intent(
         }
     }
 
+    // Record the resolved hole, so an interruption of the resumed shift finds it as the target
+    if (current_hole != intent->target_id) {
+        ares = astarte_key_value_entry_intent_write(backend,
+            ASTARTE_KEY_VALUE_ENTRY_INTENT_SHIFTING, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, current_hole,
+            ASTARTE_KEY_VALUE_ENTRY_NULL_ID, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed to update shift intent for hole %d", current_hole);
+            return ares;
+        }
+    }
+
     ASTARTE_LOG_WRN("Resuming incomplete shift for hole ID %d", current_hole);
-    return astarte_key_value_entry_delete_resume_shift(zms_fs, current_hole);
+    return astarte_key_value_entry_delete_resume_shift(backend, current_hole);
+}
+static astarte_result_t resolve_batch_intent(
+    astarte_key_value_backend_t *backend, struct astarte_key_value_entry_intent *intent)
+{
+    /*
+     * ZMS Flash Write Operations Breakdown
+     *
+     * A batch appending N new entries to a list performs N + 2 writes.
+     * - Write 1: astarte_key_value_entry_list_update_next_id links the previous tail to the first
+     * new entry (skipped for an empty list).
+     * - Writes 2 to N + 1: the backend write stores each new entry, already linked to the
+     * following one.
+     * - Write N + 2: astarte_key_value_entry_list_write_head_and_tail_ids commits the batch.
+     * Updates of existing entries are performed in place and are not covered by the intent.
+     */
+
+    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    astarte_result_t ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+        backend, intent->list_id, &head_id, &tail_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed reading head and tail IDs: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+    if (tail_id != intent->affected_id_1) {
+        ASTARTE_LOG_INF("Batch starting at ID %d was already committed. Clearing ghost intent.",
+            intent->target_id);
+        return ASTARTE_RESULT_OK;
+    }
+
+    ASTARTE_LOG_WRN("Rolling back incomplete batch starting at ID %d", intent->target_id);
+    return astarte_key_value_entry_batch_rollback(
+        backend, intent->target_id, intent->affected_id_1);
+}
+
+static astarte_result_t find_interrupted_move(
+    astarte_key_value_backend_t *backend, uint32_t hole_id, uint32_t *source_id)
+{
+    struct astarte_key_value_entry_header header = { 0 };
+    scope_defer(astarte_key_value_entry_header_free)(&header);
+
+    size_t raw_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read(backend, hole_id, &header, &raw_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Failed reading header: %s.",
+            astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Entries are only moved backwards within a cluster, the source precedes the next hole
+    uint32_t curr_id = hole_id;
+    while (true) {
+        curr_id++;
+        if (curr_id > ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID) {
+            curr_id = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID;
+        }
+        if (curr_id == hole_id) {
+            return ASTARTE_RESULT_NOT_FOUND;
+        }
+
+        bool same = false;
+        ares = is_same_entry(backend, curr_id, &header, &same);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        if (same) {
+            *source_id = curr_id;
+            return ASTARTE_RESULT_OK;
+        }
+    }
+}
+
+static astarte_result_t is_same_entry(astarte_key_value_backend_t *backend, uint32_t idx,
+    const struct astarte_key_value_entry_header *header, bool *same)
+{
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+    size_t raw_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Failed reading fixed header: %s.",
+            astarte_result_to_name(ares));
+        return ares;
+    }
+
+    *same = false;
+    if ((fixed_header.fingerprint != header->fixed_header.fingerprint)
+        || (fixed_header.namespace_len != header->fixed_header.namespace_len)
+        || (fixed_header.key_len != header->fixed_header.key_len)) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    struct astarte_key_value_entry_header candidate = { 0 };
+    scope_defer(astarte_key_value_entry_header_free)(&candidate);
+    ares = astarte_key_value_entry_header_read(backend, idx, &candidate, &raw_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed reading header: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    *same = (strcmp(candidate.namespace, header->namespace) == 0)
+        && (strcmp(candidate.key, header->key) == 0);
+    return ASTARTE_RESULT_OK;
 }
@@ -6,10 +6,13 @@
 
 #include "key_value/entry_list.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <zephyr/sys/hash_function.h>
+
 #include "alloc.h"
 #include "key_value/entry.h"
 #include "key_value/entry_header.h"
@@ -17,17 +20,89 @@
 
 ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
 
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+/** @brief Record storing the head and tail IDs of a list, followed by its usage when tracked. */
+struct list_record
+{
+    /** @brief Head ID of the list. */
+    uint32_t head_id;
+    /** @brief Tail ID of the list. */
+    uint32_t tail_id;
+    /** @brief Usage of the list, only present in records of the full size. */
+    struct astarte_key_value_entry_list_usage usage;
+};
+
+/* Size of a record without the usage */
+#define LIST_RECORD_IDS_SIZE offsetof(struct list_record, usage)
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static astarte_result_t check_namespace_match(
+    astarte_key_value_backend_t *backend, uint32_t list_id, const char *namespace);
+static astarte_result_t read_record(astarte_key_value_backend_t *backend, uint32_t list_id,
+    struct list_record *record, bool *has_usage);
+static astarte_result_t write_record(astarte_key_value_backend_t *backend, uint32_t list_id,
+    const struct list_record *record, bool has_usage);
+static astarte_result_t read_pending_value_size(astarte_key_value_backend_t *backend,
+    const struct astarte_key_value_entry_list_usage *usage, size_t *value_size);
+
 /************************************************
  *         Global functions definitions         *
  ***********************************************/
 
+astarte_result_t astarte_key_value_entry_list_find_id(
+    astarte_key_value_backend_t *backend, const char *namespace, bool allocate, uint32_t *list_id)
+{
+    uint32_t start_id = sys_hash32((const void *) namespace, strlen(namespace))
+        % ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES;
+    uint32_t curr_id = start_id;
+
+    do {
+        astarte_result_t ares = check_namespace_match(backend, curr_id, namespace);
+        if (ares == ASTARTE_RESULT_OK) {
+            *list_id = curr_id;
+            return ASTARTE_RESULT_OK;
+        }
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            if (!allocate) {
+                return ares;
+            }
+            // Claim the free list slot by storing the namespace owning it
+            uint32_t zms_id = ASTARTE_KEY_VALUE_ENTRY_LIST_NAMESPACE_BASE_ID + curr_id;
+            ssize_t ret = astarte_key_value_backend_write(
+                backend, zms_id, namespace, strlen(namespace));
+            if (ret < 0) {
+                ASTARTE_LOG_ERR("Error writing namespace for list %d: %d", curr_id, (int) ret);
+                return ASTARTE_RESULT_ZMS_ERROR;
+            }
+            *list_id = curr_id;
+            return ASTARTE_RESULT_OK;
+        }
+        if (ares != ASTARTE_RESULT_MISMATCH) {
+            ASTARTE_LOG_ERR("Error while matching namespace for list %d", curr_id);
+            return ares;
+        }
+        // The slot is owned by another namespace, continue with the next one
+        curr_id = (curr_id + 1) % ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES;
+    } while (curr_id != start_id);
+
+    ASTARTE_LOG_ERR("Maximum number of key-value namespaces reached");
+    return ASTARTE_RESULT_KEY_VALUE_FULL;
+}
+
 astarte_result_t astarte_key_value_entry_list_compute_next_and_prev_ids(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t *next_id, uint32_t *prev_id)
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx, uint32_t *next_id,
+    uint32_t *prev_id)
 {
     struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
     size_t raw_size = 0;
     astarte_result_t ares
-        = astarte_key_value_entry_header_read_fixed(zms_fs, idx, &fixed_header, &raw_size);
+        = astarte_key_value_entry_header_read_fixed(backend, idx, &fixed_header, &raw_size);
     if (ares == ASTARTE_RESULT_OK) {
         *next_id = fixed_header.next_id;
         *prev_id = fixed_header.prev_id;
@@ -35,8 +110,8 @@ astarte_result_t astarte_key_value_entry_list_compute_next_and_prev_ids(
     if (ares == ASTARTE_RESULT_NOT_FOUND) {
         uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
         uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-        astarte_result_t internal_ares
-            = astarte_key_value_entry_list_read_head_and_tail_ids(zms_fs, &head_id, &tail_id);
+        astarte_result_t internal_ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+            backend, list_id, &head_id, &tail_id);
         if (internal_ares != ASTARTE_RESULT_OK) {
             ASTARTE_LOG_ERR(
                 "Failed reading head and tail IDs: %s.", astarte_result_to_name(internal_ares));
@@ -52,42 +127,98 @@ astarte_result_t astarte_key_value_entry_list_compute_next_and_prev_ids(
 }
 
 astarte_result_t astarte_key_value_entry_list_read_head_and_tail_ids(
-    struct zms_fs *zms_fs, uint32_t *head_id, uint32_t *tail_id)
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t *head_id, uint32_t *tail_id)
 {
-    uint32_t ids[2] = { 0 };
-    ssize_t ret = zms_read(zms_fs, ASTARTE_KEY_VALUE_ENTRY_HEAD_AND_TAIL_ID, ids, sizeof(ids));
+    struct list_record record = { 0 };
+    bool has_usage = false;
+    astarte_result_t ares = read_record(backend, list_id, &record, &has_usage);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
+    }
 
-    if (ret == -ENOENT) {
-        *head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
-        *tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    *head_id = record.head_id;
+    *tail_id = record.tail_id;
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_entry_list_write_head_and_tail_ids(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t head_id, uint32_t tail_id)
+{
+    // Read the stored record to keep the usage it contains
+    struct list_record record = { 0 };
+    bool has_usage = false;
+    astarte_result_t ares = read_record(backend, list_id, &record, &has_usage);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
+    }
+
+    record.head_id = head_id;
+    record.tail_id = tail_id;
+    return write_record(backend, list_id, &record, has_usage);
+}
+
+astarte_result_t astarte_key_value_entry_list_write_head_tail_and_usage(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t head_id, uint32_t tail_id,
+    const struct astarte_key_value_entry_list_usage *usage)
+{
+    struct list_record record = { .head_id = head_id, .tail_id = tail_id };
+    if (usage) {
+        record.usage = *usage;
+    }
+    return write_record(backend, list_id, &record, usage != NULL);
+}
+
+astarte_result_t astarte_key_value_entry_list_read_usage(
+    astarte_key_value_backend_t *backend, uint32_t list_id, size_t *bytes)
+{
+    struct list_record record = { 0 };
+    bool has_usage = false;
+    astarte_result_t ares = read_record(backend, list_id, &record, &has_usage);
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        // A list that has never been written is empty
+        *bytes = 0;
         return ASTARTE_RESULT_OK;
     }
-    if (ret != sizeof(ids)) {
-        ASTARTE_LOG_ERR("Error reading head and tail IDs: %d", (int) ret);
-        return ASTARTE_RESULT_ZMS_ERROR;
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    if (!has_usage) {
+        return ASTARTE_RESULT_NOT_FOUND;
     }
 
-    *head_id = ids[0];
-    *tail_id = ids[1];
+    size_t pending_value_size = 0;
+    ares = read_pending_value_size(backend, &record.usage, &pending_value_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    *bytes = record.usage.bytes + pending_value_size;
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_key_value_entry_list_write_head_and_tail_ids(
-    struct zms_fs *zms_fs, uint32_t head_id, uint32_t tail_id)
+astarte_result_t astarte_key_value_entry_list_write_usage(astarte_key_value_backend_t *backend,
+    uint32_t list_id, const struct astarte_key_value_entry_list_usage *usage)
 {
-    uint32_t ids[2] = { head_id, tail_id };
-    ssize_t ret = zms_write(zms_fs, ASTARTE_KEY_VALUE_ENTRY_HEAD_AND_TAIL_ID, ids, sizeof(ids));
-    if (ret < 0) {
-        ASTARTE_LOG_ERR("Error writing head and tail IDs to ZMS, error: %d", (int) ret);
-        return ASTARTE_RESULT_ZMS_ERROR;
+    struct list_record record = { 0 };
+    bool has_usage = false;
+    astarte_result_t ares = read_record(backend, list_id, &record, &has_usage);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
     }
-    return ASTARTE_RESULT_OK;
+
+    // Nothing to remove
+    if (!usage && !has_usage) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    return astarte_key_value_entry_list_write_head_tail_and_usage(
+        backend, list_id, record.head_id, record.tail_id, usage);
 }
 
 astarte_result_t astarte_key_value_entry_list_update_next_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t new_next)
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t new_next)
 {
-    ssize_t raw_entry_size = zms_get_data_length(zms_fs, idx);
+    ssize_t raw_entry_size = astarte_key_value_backend_get_data_length(backend, idx);
     if (raw_entry_size <= 0) {
         ASTARTE_LOG_ERR("Error getting raw entry size: %d", (int) raw_entry_size);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -99,7 +230,7 @@ astarte_result_t astarte_key_value_entry_list_update_next_id(
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
 
-    ssize_t ret = zms_read(zms_fs, idx, raw_entry, raw_entry_size);
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, raw_entry, raw_entry_size);
     if (ret != raw_entry_size) {
         ASTARTE_LOG_ERR("Error getting raw entry: %d", (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -109,7 +240,7 @@ astarte_result_t astarte_key_value_entry_list_update_next_id(
         + ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES;
     memcpy(&raw_entry[next_id_offset], &new_next, sizeof(new_next));
 
-    ret = zms_write(zms_fs, idx, raw_entry, raw_entry_size);
+    ret = astarte_key_value_backend_write(backend, idx, raw_entry, raw_entry_size);
     if (ret < 0) {
         ASTARTE_LOG_ERR("Error writing new raw entry: %d", (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -119,9 +250,9 @@ astarte_result_t astarte_key_value_entry_list_update_next_id(
 }
 
 astarte_result_t astarte_key_value_entry_list_update_prev_id(
-    struct zms_fs *zms_fs, uint32_t idx, uint32_t new_prev)
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t new_prev)
 {
-    ssize_t raw_entry_size = zms_get_data_length(zms_fs, idx);
+    ssize_t raw_entry_size = astarte_key_value_backend_get_data_length(backend, idx);
     if (raw_entry_size <= 0) {
         ASTARTE_LOG_ERR("Error getting raw entry size: %d", (int) raw_entry_size);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -133,7 +264,7 @@ astarte_result_t astarte_key_value_entry_list_update_prev_id(
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
 
-    ssize_t ret = zms_read(zms_fs, idx, raw_entry, raw_entry_size);
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, raw_entry, raw_entry_size);
     if (ret != raw_entry_size) {
         ASTARTE_LOG_ERR("Error getting raw entry: %d", (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -144,7 +275,7 @@ astarte_result_t astarte_key_value_entry_list_update_prev_id(
         + ASTARTE_KEY_VALUE_ENTRY_HEADER_NEXT_ID_BYTES;
     memcpy(&raw_entry[prev_id_offset], &new_prev, sizeof(new_prev));
 
-    ret = zms_write(zms_fs, idx, raw_entry, raw_entry_size);
+    ret = astarte_key_value_backend_write(backend, idx, raw_entry, raw_entry_size);
     if (ret < 0) {
         ASTARTE_LOG_ERR("Error writing new raw entry: %d", (int) ret);
         return ASTARTE_RESULT_ZMS_ERROR;
@@ -152,3 +283,116 @@ astarte_result_t astarte_key_value_entry_list_update_prev_id(
 
     return ASTARTE_RESULT_OK;
 }
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t check_namespace_match(
+    astarte_key_value_backend_t *backend, uint32_t list_id, const char *namespace)
+{
+    uint32_t zms_id = ASTARTE_KEY_VALUE_ENTRY_LIST_NAMESPACE_BASE_ID + list_id;
+    ssize_t stored_len = astarte_key_value_backend_get_data_length(backend, zms_id);
+    if (stored_len == -ENOENT) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+    if (stored_len < 0) {
+        ASTARTE_LOG_ERR(
+            "Error reading namespace length for list %d: %d", list_id, (int) stored_len);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+    if ((size_t) stored_len != strlen(namespace)) {
+        return ASTARTE_RESULT_MISMATCH;
+    }
+
+    scope_var(scoped_char, stored_namespace)(stored_len + 1);
+    if (!stored_namespace) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    ssize_t ret = astarte_key_value_backend_read(backend, zms_id, stored_namespace, stored_len);
+    if (ret != stored_len) {
+        ASTARTE_LOG_ERR("Error reading namespace for list %d: %d", list_id, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    return (strncmp(stored_namespace, namespace, stored_len) == 0) ? ASTARTE_RESULT_OK
+                                                                   : ASTARTE_RESULT_MISMATCH;
+}
+
+static astarte_result_t read_record(astarte_key_value_backend_t *backend, uint32_t list_id,
+    struct list_record *record, bool *has_usage)
+{
+    ssize_t ret = astarte_key_value_backend_read(backend,
+        ASTARTE_KEY_VALUE_ENTRY_LIST_HEAD_AND_TAIL_BASE_ID + list_id, record,
+        sizeof(struct list_record));
+
+    if (ret == -ENOENT) {
+        record->head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        record->tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        *has_usage = false;
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+    if ((ret != LIST_RECORD_IDS_SIZE) && (ret != sizeof(struct list_record))) {
+        ASTARTE_LOG_ERR("Error reading head and tail IDs: %d", (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    *has_usage = (ret == sizeof(struct list_record));
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t write_record(astarte_key_value_backend_t *backend, uint32_t list_id,
+    const struct list_record *record, bool has_usage)
+{
+    size_t record_size = has_usage ? sizeof(struct list_record) : LIST_RECORD_IDS_SIZE;
+    ssize_t ret = astarte_key_value_backend_write(
+        backend, ASTARTE_KEY_VALUE_ENTRY_LIST_HEAD_AND_TAIL_BASE_ID + list_id, record, record_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Error writing head and tail IDs to ZMS, error: %d", (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t read_pending_value_size(astarte_key_value_backend_t *backend,
+    const struct astarte_key_value_entry_list_usage *usage, size_t *value_size)
+{
+    *value_size = 0;
+    if (usage->pending_hash_id == ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    // Shifts could have moved the pending entry since the usage was stored, follow its probe chain
+    uint32_t curr_id = usage->pending_hash_id;
+    do {
+        struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+        size_t raw_size = 0;
+        astarte_result_t ares
+            = astarte_key_value_entry_header_read_fixed(backend, curr_id, &fixed_header, &raw_size);
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            // End of the probe chain, the pending key is not stored
+            return ASTARTE_RESULT_OK;
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed reading fixed header: %s.", astarte_result_to_name(ares));
+            return ares;
+        }
+
+        if (fixed_header.fingerprint == usage->pending_fingerprint) {
+            if (fixed_header.tombstone) {
+                return ASTARTE_RESULT_OK;
+            }
+            // Chunked values are accounted with their whole size
+            return astarte_key_value_entry_read_value_size(backend, curr_id, value_size);
+        }
+
+        curr_id++;
+        if (curr_id > ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID) {
+            curr_id = ASTARTE_KEY_VALUE_ENTRY_MIN_USABLE_ID;
+        }
+    } while (curr_id != usage->pending_hash_id);
+
+    return ASTARTE_RESULT_OK;
+}
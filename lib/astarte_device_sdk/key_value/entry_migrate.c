@@ -0,0 +1,314 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/entry_migrate.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "key_value/entry.h"
+#include "key_value/entry_delete.h"
+#include "key_value/entry_hash.h"
+#include "key_value/entry_header.h"
+#include "key_value/entry_intent.h"
+#include "key_value/entry_list.h"
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+/* Last format version storing entries without the fingerprint in the fixed header */
+#define NO_FINGERPRINT_VERSION_MAJOR 0
+#define NO_FINGERPRINT_VERSION_MINOR 7
+#define NO_FINGERPRINT_VERSION_PATCH 0
+
+/* Last format version where the entries could be stored in the IDs now reserved to the ring */
+#define NO_RING_VERSION_MAJOR 0
+#define NO_RING_VERSION_MINOR 8
+#define NO_RING_VERSION_PATCH 0
+
+/* Size of the fixed header before the fingerprint was added */
+#define NO_FINGERPRINT_FIXED_HEADER_BYTES                                                          \
+    (ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES                                             \
+        - ASTARTE_KEY_VALUE_ENTRY_HEADER_FINGERPRINT_BYTES)
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static astarte_result_t add_fingerprints(astarte_key_value_backend_t *backend);
+static astarte_result_t add_entry_fingerprint(
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t *next_id);
+static astarte_result_t compute_fingerprint(
+    const uint8_t *raw_strings, uint16_t nsp_len, uint16_t key_len, uint32_t *fingerprint);
+static astarte_result_t clear_ring_slots(
+    astarte_key_value_backend_t *backend, const struct astarte_key_value_entry_intent *intent);
+static astarte_result_t relocate_entry(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx);
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_key_value_entry_migrate(
+    astarte_key_value_backend_t *backend, astarte_key_value_version_t stored_version)
+{
+    bool no_fingerprint = (stored_version.major == NO_FINGERPRINT_VERSION_MAJOR)
+        && (stored_version.minor == NO_FINGERPRINT_VERSION_MINOR)
+        && (stored_version.patch == NO_FINGERPRINT_VERSION_PATCH);
+    bool no_ring = (stored_version.major == NO_RING_VERSION_MAJOR)
+        && (stored_version.minor == NO_RING_VERSION_MINOR)
+        && (stored_version.patch == NO_RING_VERSION_PATCH);
+    if (!no_fingerprint && !no_ring) {
+        return ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION;
+    }
+
+    // Interrupted operations are recovered using the current format, they can't be migrated.
+    // The only exception is a relocation interrupted during a previous migration.
+    struct astarte_key_value_entry_intent intent = { 0 };
+    ssize_t ret = astarte_key_value_backend_read(
+        backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent));
+    if (ret == -ENOENT) {
+        intent.state = ASTARTE_KEY_VALUE_ENTRY_INTENT_NONE;
+    } else if ((intent.state != ASTARTE_KEY_VALUE_ENTRY_INTENT_NONE)
+        && (intent.state != ASTARTE_KEY_VALUE_ENTRY_INTENT_RELOCATING)) {
+        ASTARTE_LOG_ERR("Found interrupted operation (state %d), can't migrate.", intent.state);
+        return ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION;
+    }
+
+    if (no_fingerprint) {
+        astarte_result_t ares = add_fingerprints(backend);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+    }
+
+    return clear_ring_slots(backend, &intent);
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t add_fingerprints(astarte_key_value_backend_t *backend)
+{
+    for (uint32_t list_id = 0; list_id < ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES; list_id++) {
+        uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        astarte_result_t ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+            backend, list_id, &head_id, &tail_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+
+        // The position of the next ID is the same in both formats
+        uint32_t curr_id = head_id;
+        while (curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+            ares = add_entry_fingerprint(backend, curr_id, &curr_id);
+            if (ares != ASTARTE_RESULT_OK) {
+                ASTARTE_LOG_ERR("Failed migrating entry in list %d: %s", list_id,
+                    astarte_result_to_name(ares));
+                return ares;
+            }
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t add_entry_fingerprint(
+    astarte_key_value_backend_t *backend, uint32_t idx, uint32_t *next_id)
+{
+    ssize_t raw_entry_size = astarte_key_value_backend_get_data_length(backend, idx);
+    if (raw_entry_size < (ssize_t) NO_FINGERPRINT_FIXED_HEADER_BYTES) {
+        ASTARTE_LOG_ERR("Invalid entry size at ID %d: %d", idx, (int) raw_entry_size);
+        return (raw_entry_size < 0) ? ASTARTE_RESULT_ZMS_ERROR
+                                    : ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+    }
+
+    // Leave room for the fingerprint in case the entry needs to be migrated
+    size_t fingerprint_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_FINGERPRINT_BYTES;
+    scope_var(scoped_uint8, raw_entry)(raw_entry_size + fingerprint_size);
+    if (!raw_entry) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    ssize_t ret = astarte_key_value_backend_read(backend, idx, raw_entry, raw_entry_size);
+    if (ret != raw_entry_size) {
+        ASTARTE_LOG_ERR("Error reading entry at ID %d: %d", idx, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    uint16_t nsp_len = 0;
+    uint16_t key_len = 0;
+    memcpy(&nsp_len, raw_entry, ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES);
+    memcpy(&key_len, raw_entry + ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES,
+        ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES);
+    memcpy(next_id,
+        raw_entry + ASTARTE_KEY_VALUE_ENTRY_HEADER_NAMESPACE_LEN_BYTES
+            + ASTARTE_KEY_VALUE_ENTRY_HEADER_KEY_LEN_BYTES,
+        ASTARTE_KEY_VALUE_ENTRY_HEADER_NEXT_ID_BYTES);
+
+    // An interrupted migration leaves some entries already migrated, recognize them by their
+    // fingerprint matching the strings that follow it
+    size_t strings_size = (size_t) nsp_len + key_len;
+    size_t migrated_header_size = ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES + strings_size;
+    if ((size_t) raw_entry_size >= migrated_header_size) {
+        uint32_t stored = 0;
+        uint32_t computed = 0;
+        memcpy(&stored, raw_entry + NO_FINGERPRINT_FIXED_HEADER_BYTES, fingerprint_size);
+        astarte_result_t ares = compute_fingerprint(
+            raw_entry + ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES, nsp_len, key_len,
+            &computed);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        if (stored == computed) {
+            return ASTARTE_RESULT_OK;
+        }
+    }
+    if ((size_t) raw_entry_size < NO_FINGERPRINT_FIXED_HEADER_BYTES + strings_size) {
+        ASTARTE_LOG_ERR("Incomplete header at ID %d", idx);
+        return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+    }
+
+    // Insert the fingerprint between the fixed header and the strings
+    uint32_t fingerprint = 0;
+    astarte_result_t ares = compute_fingerprint(
+        raw_entry + NO_FINGERPRINT_FIXED_HEADER_BYTES, nsp_len, key_len, &fingerprint);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    memmove(raw_entry + ASTARTE_KEY_VALUE_ENTRY_HEADER_FIXED_HEADER_BYTES,
+        raw_entry + NO_FINGERPRINT_FIXED_HEADER_BYTES,
+        raw_entry_size - NO_FINGERPRINT_FIXED_HEADER_BYTES);
+    memcpy(raw_entry + NO_FINGERPRINT_FIXED_HEADER_BYTES, &fingerprint, fingerprint_size);
+
+    ret = astarte_key_value_backend_write(
+        backend, idx, raw_entry, raw_entry_size + fingerprint_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Error writing migrated entry at ID %d: %d", idx, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t compute_fingerprint(
+    const uint8_t *raw_strings, uint16_t nsp_len, uint16_t key_len, uint32_t *fingerprint)
+{
+    scope_var(scoped_char, namespace)(nsp_len + 1);
+    scope_var(scoped_char, key)(key_len + 1);
+    if (!namespace || !key) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    memcpy(namespace, raw_strings, nsp_len);
+    memcpy(key, raw_strings + nsp_len, key_len);
+
+    *fingerprint = astarte_key_value_entry_hash_fingerprint(namespace, key);
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t clear_ring_slots(
+    astarte_key_value_backend_t *backend, const struct astarte_key_value_entry_intent *intent)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    // Complete the relocation interrupted by a previous migration attempt, the moved entry could
+    // be linked to its new ID already
+    if (intent->state == ASTARTE_KEY_VALUE_ENTRY_INTENT_RELOCATING) {
+        ares = astarte_key_value_entry_delete_move(
+            backend, intent->target_id, intent->affected_id_1);
+        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+            ASTARTE_LOG_ERR("Failed resuming relocation of ID %d: %s", intent->target_id,
+                astarte_result_to_name(ares));
+            return ares;
+        }
+        ares = astarte_key_value_entry_intent_clear(backend);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+    }
+
+    for (uint32_t list_id = 0; list_id < ASTARTE_KEY_VALUE_ENTRY_LIST_MAX_NAMESPACES; list_id++) {
+        uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+        ares = astarte_key_value_entry_list_read_head_and_tail_ids(
+            backend, list_id, &head_id, &tail_id);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+
+        uint32_t curr_id = head_id;
+        while (curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID) {
+            struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+            size_t raw_entry_size = 0;
+            ares = astarte_key_value_entry_header_read_fixed(
+                backend, curr_id, &fixed_header, &raw_entry_size);
+            if (ares != ASTARTE_RESULT_OK) {
+                ASTARTE_LOG_ERR("Failed reading entry in list %d: %s", list_id,
+                    astarte_result_to_name(ares));
+                return ares;
+            }
+
+            // The entry keeps its position in the list, so the next ID is still valid once moved
+            if ((curr_id >= ASTARTE_KEY_VALUE_ENTRY_RING_BASE_ID)
+                && (curr_id < ASTARTE_KEY_VALUE_ENTRY_LIST_NAMESPACE_BASE_ID)) {
+                ares = relocate_entry(backend, list_id, curr_id);
+                if (ares != ASTARTE_RESULT_OK) {
+                    ASTARTE_LOG_ERR("Failed relocating entry in list %d: %s", list_id,
+                        astarte_result_to_name(ares));
+                    return ares;
+                }
+            }
+            curr_id = fixed_header.next_id;
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t relocate_entry(
+    astarte_key_value_backend_t *backend, uint32_t list_id, uint32_t idx)
+{
+    struct astarte_key_value_entry_header header = { 0 };
+    scope_defer(astarte_key_value_entry_header_free)(&header);
+
+    size_t raw_entry_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_entry_header_read(backend, idx, &header, &raw_entry_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // Probing skips the reserved IDs, the allocated ID is where the entry is looked up
+    uint32_t target_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    ares = astarte_key_value_entry_find_or_alloc(
+        backend, header.namespace, header.key, &target_id, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    ares = astarte_key_value_entry_intent_write(backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_RELOCATING,
+        list_id, idx, target_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    ares = astarte_key_value_entry_delete_move(backend, idx, target_id);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    ASTARTE_LOG_INF("Relocated entry from reserved ID %d to ID %d", idx, target_id);
+    return astarte_key_value_entry_intent_clear(backend);
+}
@@ -0,0 +1,246 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "key_value/core.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "key_value/backend.h"
+#include "key_value/entry.h"
+#include "key_value/mutex.h"
+#include "log.h"
+
+ASTARTE_LOG_MODULE_DECLARE(astarte_key_value, CONFIG_ASTARTE_DEVICE_SDK_KEY_VALUE_LOG_LEVEL);
+
+/************************************************
+ *        Defines, constants and typedef        *
+ ***********************************************/
+
+#define SLOT_ID(position)                                                                          \
+    (ASTARTE_KEY_VALUE_ENTRY_RING_BASE_ID + ((position) % ASTARTE_KEY_VALUE_RING_SLOTS))
+
+// Each record starts with its position, telling apart the positions sharing the same slot
+#define POSITION_BYTES sizeof(uint32_t)
+
+ASTARTE_SCOPE_DEFER_DEFINE(astarte_key_value_mutex_unlock);
+
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+/**
+ * @brief Get the size of the record stored in a slot and the position it belongs to.
+ *
+ * @param[in,out] backend The storage backend to use.
+ * @param[in] slot_id ZMS ID of the slot.
+ * @param[out] position Position stored in the slot.
+ * @param[out] record_size Size of the record, including the position.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if the slot is empty,
+ * otherwise an error code.
+ */
+static astarte_result_t read_slot_position(astarte_key_value_backend_t *backend,
+    uint32_t slot_id, uint32_t *position, size_t *record_size);
+
+/************************************************
+ *         Global functions definitions         *
+ ***********************************************/
+
+astarte_result_t astarte_key_value_ring_insert(astarte_key_value_backend_t *backend,
+    uint32_t position, const void *value, size_t value_size)
+{
+    if (!value && (value_size > 0)) {
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    scope_var(scoped_uint8, record)(POSITION_BYTES + value_size);
+    if (!record) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    memcpy(record, &position, POSITION_BYTES);
+    if (value_size > 0) {
+        memcpy(record + POSITION_BYTES, value, value_size);
+    }
+
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    ssize_t ret = astarte_key_value_backend_write(
+        backend, SLOT_ID(position), record, POSITION_BYTES + value_size);
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Failed to insert ring position %u: %d", position, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_ring_find(astarte_key_value_backend_t *backend,
+    uint32_t position, void *value, size_t *value_size)
+{
+    if (!value_size) {
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    uint32_t stored_position = 0;
+    size_t record_size = 0;
+    ares = read_slot_position(backend, SLOT_ID(position), &stored_position, &record_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    // The slot has been reused by a newer position or not yet by this one
+    if (stored_position != position) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    size_t data_size = record_size - POSITION_BYTES;
+    if (!value) {
+        *value_size = data_size;
+        return ASTARTE_RESULT_OK;
+    }
+
+    if (*value_size < data_size) {
+        ASTARTE_LOG_ERR("Buffer too small for ring position %u. Need %zu, got %zu", position,
+            data_size, *value_size);
+        *value_size = data_size;
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    scope_var(scoped_uint8, record)(record_size);
+    if (!record) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    ssize_t ret = astarte_key_value_backend_read(backend, SLOT_ID(position), record, record_size);
+    if (ret != (ssize_t) record_size) {
+        ASTARTE_LOG_ERR("Failed to read ring position %u: %d", position, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    memcpy(value, record + POSITION_BYTES, data_size);
+    *value_size = data_size;
+
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_ring_delete(
+    astarte_key_value_backend_t *backend, uint32_t position, size_t *value_size)
+{
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    uint32_t stored_position = 0;
+    size_t record_size = 0;
+    ares = read_slot_position(backend, SLOT_ID(position), &stored_position, &record_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    if (stored_position != position) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    int ret = astarte_key_value_backend_delete(backend, SLOT_ID(position));
+    if (ret < 0) {
+        ASTARTE_LOG_ERR("Failed to delete ring position %u: %d", position, ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    if (value_size) {
+        *value_size = record_size - POSITION_BYTES;
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+astarte_result_t astarte_key_value_ring_bounds(
+    astarte_key_value_backend_t *backend, astarte_key_value_ring_bounds_t *bounds)
+{
+    if (!bounds) {
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    astarte_result_t ares = astarte_key_value_mutex_lock();
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(astarte_key_value_mutex_unlock)();
+
+    memset(bounds, 0, sizeof(astarte_key_value_ring_bounds_t));
+
+    for (uint32_t slot = 0; slot < ASTARTE_KEY_VALUE_RING_SLOTS; slot++) {
+        uint32_t position = 0;
+        size_t record_size = 0;
+        ares = read_slot_position(
+            backend, ASTARTE_KEY_VALUE_ENTRY_RING_BASE_ID + slot, &position, &record_size);
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            continue;
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        if ((position % ASTARTE_KEY_VALUE_RING_SLOTS) != slot) {
+            ASTARTE_LOG_ERR("Ring slot %u holds the unrelated position %u", slot, position);
+            return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+        }
+
+        // The stored positions span less than the slots, compare them as wrapping distances
+        if (bounds->count == 0) {
+            bounds->first = position;
+            bounds->last = position;
+        } else if ((int32_t) (position - bounds->first) < 0) {
+            bounds->first = position;
+        } else if ((int32_t) (position - bounds->last) > 0) {
+            bounds->last = position;
+        }
+        bounds->count++;
+        bounds->bytes += record_size - POSITION_BYTES;
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t read_slot_position(astarte_key_value_backend_t *backend,
+    uint32_t slot_id, uint32_t *position, size_t *record_size)
+{
+    ssize_t data_len = astarte_key_value_backend_get_data_length(backend, slot_id);
+    if (data_len == -ENOENT) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+    if (data_len < 0) {
+        ASTARTE_LOG_ERR("Failed to get data length for ring slot %u: %d", slot_id, (int) data_len);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+    if (data_len < (ssize_t) POSITION_BYTES) {
+        ASTARTE_LOG_ERR("Incomplete ring record at ID %u", slot_id);
+        return ASTARTE_RESULT_STORAGE_CORRUPTED_ERROR;
+    }
+
+    ssize_t ret = astarte_key_value_backend_read(backend, slot_id, position, POSITION_BYTES);
+    if (ret != (ssize_t) POSITION_BYTES) {
+        ASTARTE_LOG_ERR("Failed to read ring slot %u: %d", slot_id, (int) ret);
+        return ASTARTE_RESULT_ZMS_ERROR;
+    }
+
+    *record_size = (size_t) data_len;
+    return ASTARTE_RESULT_OK;
+}
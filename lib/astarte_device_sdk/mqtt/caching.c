@@ -61,6 +61,7 @@ void astarte_mqtt_caching_init(astarte_mqtt_caching_t *caching)
         .hash_func = sys_hash32,
         .alloc_func = SYS_HASHMAP_DEFAULT_ALLOCATOR,
     };
+    caching->publish_count = 0;
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     caching->storage = storage;
     caching->direction = direction;
@@ -131,6 +132,9 @@ void astarte_mqtt_caching_insert_message(
         astarte_mqtt_caching_map_entry_free(map_entry);
         return;
     }
+    if (message.type == STORAGE_MQTT_PUBLISH_ENTRY) {
+        caching->publish_count++;
+    }
 
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
     astarte_result_t ares
@@ -146,6 +150,11 @@ bool astarte_mqtt_caching_find_message(astarte_mqtt_caching_t *caching, uint16_t
     return sys_hashmap_contains_key(&caching->map, message_id);
 }
 
+size_t astarte_mqtt_caching_count_publishes(astarte_mqtt_caching_t *caching)
+{
+    return caching->publish_count;
+}
+
 void astarte_mqtt_caching_check_message_expiry(
     astarte_mqtt_caching_t *caching, astarte_mqtt_caching_retransmit_cbk_t retransmit_cbk)
 {
@@ -168,6 +177,22 @@ void astarte_mqtt_caching_check_message_expiry(
     }
 }
 
+k_timepoint_t astarte_mqtt_caching_get_next_expiry(astarte_mqtt_caching_t *caching)
+{
+    k_timepoint_t next_expiry = sys_timepoint_calc(K_FOREVER);
+    struct sys_hashmap_iterator iter = { 0 };
+    caching->map.api->iter(&caching->map, &iter);
+    while (sys_hashmap_iterator_has_next(&iter)) {
+        iter.next(&iter);
+        // NOLINTNEXTLINE(performance-no-int-to-ptr) Unavoidable due to the hashmap structure
+        struct mqtt_caching_map_entry *map_entry = UINT_TO_POINTER(iter.value);
+        if (sys_timepoint_cmp(map_entry->end_of_validity, next_expiry) < 0) {
+            next_expiry = map_entry->end_of_validity;
+        }
+    }
+    return next_expiry;
+}
+
 void astarte_mqtt_caching_update_message_expiry(
     astarte_mqtt_caching_t *caching, uint16_t message_id)
 {
@@ -193,6 +218,9 @@ void astarte_mqtt_caching_remove_message(astarte_mqtt_caching_t *caching, uint16
     if (sys_hashmap_remove(&caching->map, message_id, &value)) {
         // NOLINTNEXTLINE(performance-no-int-to-ptr) Unavoidable due to the hashmap structure
         struct mqtt_caching_map_entry *map_entry = UINT_TO_POINTER(value);
+        if (map_entry->message.type == STORAGE_MQTT_PUBLISH_ENTRY) {
+            caching->publish_count--;
+        }
 
         astarte_mqtt_caching_map_entry_free(map_entry);
 #ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE
@@ -237,6 +265,7 @@ void astarte_mqtt_caching_clear_messages(astarte_mqtt_caching_t *caching)
 
     // Clear the internal structures of the map
     sys_hashmap_clear(&caching->map, NULL, NULL);
+    caching->publish_count = 0;
 }
 
 void astarte_mqtt_caching_restore_from_flash(astarte_mqtt_caching_t *caching)
@@ -281,6 +310,9 @@ void astarte_mqtt_caching_restore_from_flash(astarte_mqtt_caching_t *caching)
             free(map_entry);
             continue;
         }
+        if (message.type == STORAGE_MQTT_PUBLISH_ENTRY) {
+            caching->publish_count++;
+        }
         restored_count++;
     }
 
@@ -5,6 +5,7 @@
  */
 #include "mqtt/core.h"
 
+#include "alloc.h"
 #include "mqtt/caching.h"
 #include "mqtt/events.h"
 
@@ -56,6 +57,29 @@ void astarte_mqtt_sys_mutex_unlock_helper(struct sys_mutex *mtx)
     __ASSERT_NO_MSG(mutex_rc == 0);
 }
 
+/************************************************
+ *         Static functions declaration         *
+ ***********************************************/
+
+static k_timepoint_t earliest_timepoint(k_timepoint_t first, k_timepoint_t second);
+/**
+ * @brief Reads the data available on the MQTT client socket.
+ *
+ * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @param[in] poll_fd Poll entry of the client socket.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t input_client(
+    astarte_mqtt_t *astarte_mqtt, const struct zsock_pollfd *poll_fd);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+/**
+ * @brief Passes the received messages to the incoming callback, without locking the client.
+ *
+ * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ */
+static void dispatch_incoming(astarte_mqtt_t *astarte_mqtt);
+#endif
+
 /************************************************
  *       Callbacks declaration/definition       *
  ***********************************************/
@@ -261,12 +285,19 @@ astarte_result_t astarte_mqtt_init(astarte_mqtt_config_t *cfg, astarte_mqtt_t *a
         astarte_mqtt->broker_hostname, cfg->broker_hostname, sizeof(astarte_mqtt->broker_hostname));
     memcpy(astarte_mqtt->broker_port, cfg->broker_port, sizeof(astarte_mqtt->broker_port));
     memcpy(astarte_mqtt->client_id, cfg->client_id, sizeof(astarte_mqtt->client_id));
+    astarte_mqtt->client_cert_tag = cfg->client_cert_tag;
+    astarte_mqtt->in_flight_window = cfg->in_flight_window;
     astarte_mqtt->refresh_client_cert_cbk = cfg->refresh_client_cert_cbk;
     astarte_mqtt->on_delivered_cbk = cfg->on_delivered_cbk;
     astarte_mqtt->on_subscribed_cbk = cfg->on_subscribed_cbk;
     astarte_mqtt->on_connected_cbk = cfg->on_connected_cbk;
     astarte_mqtt->on_disconnected_cbk = cfg->on_disconnected_cbk;
     astarte_mqtt->on_incoming_cbk = cfg->on_incoming_cbk;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    sys_slist_init(&astarte_mqtt->incoming_msgs);
+    k_msgq_init(&astarte_mqtt->events, (char *) astarte_mqtt->events_buffer,
+        sizeof(struct astarte_mqtt_event), ASTARTE_MQTT_EVENTS_SIZE);
+#endif
 
     // Initialize the timepoint to an infinite future date
     astarte_mqtt->connection_timepoint = sys_timepoint_calc(K_FOREVER);
@@ -355,7 +386,7 @@ astarte_result_t astarte_mqtt_connect(astarte_mqtt_t *astarte_mqtt)
 #ifndef CONFIG_ASTARTE_DEVICE_SDK_DEVELOP_USE_NON_TLS_MQTT
         CONFIG_ASTARTE_DEVICE_SDK_MQTTS_CA_CERT_TAG,
 #endif
-        CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG,
+        astarte_mqtt->client_cert_tag,
     };
 
     struct mqtt_sec_config *tls_config = &(astarte_mqtt->client.transport.tls.config);
@@ -429,100 +460,190 @@ astarte_result_t astarte_mqtt_disconnect(astarte_mqtt_t *astarte_mqtt)
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_mqtt_poll(astarte_mqtt_t *astarte_mqtt)
+void astarte_mqtt_poll_prepare(
+    astarte_mqtt_t *astarte_mqtt, struct zsock_pollfd *poll_fd, k_timepoint_t *deadline)
 {
-    int32_t timeout = 0;
-    struct zsock_pollfd socket_fd = { 0 };
-    bool should_poll = false;
-
-    // CRITICAL SECTION 1: State Checks and Keepalive
-    // the mutex automatically unlocks at the end of this block
-    {
-        scope_guard(astarte_mqtt_sys_mutex)(&astarte_mqtt->mutex);
-
-        // If in the connecting phase check that the connection timeout has not elapsed
-        if ((astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTING)
-            && K_TIMEOUT_EQ(sys_timepoint_timeout(astarte_mqtt->connection_timepoint), K_NO_WAIT)) {
-            astarte_mqtt->connection_state = ASTARTE_MQTT_CONNECTION_ERROR;
-            mqtt_disconnect(&astarte_mqtt->client, NULL);
-            ASTARTE_LOG_ERR("Connection attempt has timed out!");
-            return ASTARTE_RESULT_OK; // Guard automatically unlocks here!
-        }
+    *poll_fd = (struct zsock_pollfd){ .fd = -1 };
 
-        // If the device is recovering from an unexpected disconnection and backoff time has elapsed
-        // try to reconnect
-        if ((astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTION_ERROR)
-            && K_TIMEOUT_EQ(
-                sys_timepoint_timeout(astarte_mqtt->reconnection_timepoint), K_NO_WAIT)) {
-
-            // Update reconnection timepoint to the next backoff value
-            uint64_t next_backoff_ms = backoff_get_next_delay(&astarte_mqtt->backoff_ctx);
-            astarte_mqtt->reconnection_timepoint = sys_timepoint_calc(K_MSEC(next_backoff_ms));
-
-            // Attempt reconnection
-            ASTARTE_LOG_INF("Attempting a reconnection");
-            if (astarte_mqtt_connect(astarte_mqtt) != ASTARTE_RESULT_OK) {
-                ASTARTE_LOG_ERR("Failed establishing a new connection!");
-                return ASTARTE_RESULT_OK; // Guard automatically unlocks here!
-            }
+    scope_guard(astarte_mqtt_sys_mutex)(&astarte_mqtt->mutex);
+
+    // If in the connecting phase check that the connection timeout has not elapsed
+    if ((astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTING)
+        && K_TIMEOUT_EQ(sys_timepoint_timeout(astarte_mqtt->connection_timepoint), K_NO_WAIT)) {
+        astarte_mqtt->connection_state = ASTARTE_MQTT_CONNECTION_ERROR;
+        mqtt_disconnect(&astarte_mqtt->client, NULL);
+        ASTARTE_LOG_ERR("Connection attempt has timed out!");
+        *deadline = earliest_timepoint(*deadline, astarte_mqtt->reconnection_timepoint);
+        return; // Guard automatically unlocks here!
+    }
+
+    // If the device is recovering from an unexpected disconnection and backoff time has elapsed
+    // try to reconnect
+    if ((astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTION_ERROR)
+        && K_TIMEOUT_EQ(sys_timepoint_timeout(astarte_mqtt->reconnection_timepoint), K_NO_WAIT)) {
+
+        // Update reconnection timepoint to the next backoff value
+        uint64_t next_backoff_ms = backoff_get_next_delay(&astarte_mqtt->backoff_ctx);
+        astarte_mqtt->reconnection_timepoint = sys_timepoint_calc(K_MSEC(next_backoff_ms));
+
+        // Attempt reconnection
+        ASTARTE_LOG_INF("Attempting a reconnection");
+        if (astarte_mqtt_connect(astarte_mqtt) != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed establishing a new connection!");
+            *deadline = earliest_timepoint(*deadline, astarte_mqtt->reconnection_timepoint);
+            return; // Guard automatically unlocks here!
         }
+    }
 
-        // Only poll if device is connecting, disconnecting or connected
-        if ((astarte_mqtt->connection_state != ASTARTE_MQTT_CONNECTION_ERROR)
-            && (astarte_mqtt->connection_state != ASTARTE_MQTT_DISCONNECTED)) {
-
-            if (astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTED) {
-                astarte_mqtt_caching_retransmit_cbk_t retransmit_out_msg_cbk
-                    = mqtt_caching_retransmit_out_msg_handler;
-                astarte_mqtt_caching_check_message_expiry(
-                    &astarte_mqtt->out_msgs, retransmit_out_msg_cbk);
-                astarte_mqtt_caching_retransmit_cbk_t retransmit_in_msg_cbk
-                    = mqtt_caching_retransmit_in_msg_handler;
-                astarte_mqtt_caching_check_message_expiry(
-                    &astarte_mqtt->in_msgs, retransmit_in_msg_cbk);
-            }
+    // Wake up in time for the next connection timeout or reconnection attempt
+    if (astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTING) {
+        *deadline = earliest_timepoint(*deadline, astarte_mqtt->connection_timepoint);
+    }
+    if (astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTION_ERROR) {
+        *deadline = earliest_timepoint(*deadline, astarte_mqtt->reconnection_timepoint);
+    }
 
-            // Check connection and ensure to periodically ping the broker using mqtt_live
-            int mqtt_rc = mqtt_live(&astarte_mqtt->client);
-            if ((mqtt_rc != 0) && (mqtt_rc != -EAGAIN)) {
-                ASTARTE_LOG_WRN(
-                    "Fail keep alive MQTT connection: %s, %d", strerror(-mqtt_rc), mqtt_rc);
-            }
+    // Only poll if device is connecting, disconnecting or connected
+    if ((astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTION_ERROR)
+        || (astarte_mqtt->connection_state == ASTARTE_MQTT_DISCONNECTED)) {
+        return;
+    }
 
-            // Extract the socket variables we need before we release the lock
-            socket_fd.fd = astarte_mqtt->client.transport.tls.sock;
-            socket_fd.events = ZSOCK_POLLIN;
-            int32_t keepalive = mqtt_keepalive_time_left(&astarte_mqtt->client);
-            timeout = MIN(astarte_mqtt->poll_timeout_ms, keepalive);
-            should_poll = true;
-        }
+    if (astarte_mqtt->connection_state == ASTARTE_MQTT_CONNECTED) {
+        astarte_mqtt_caching_retransmit_cbk_t retransmit_out_msg_cbk
+            = mqtt_caching_retransmit_out_msg_handler;
+        astarte_mqtt_caching_check_message_expiry(&astarte_mqtt->out_msgs, retransmit_out_msg_cbk);
+        astarte_mqtt_caching_retransmit_cbk_t retransmit_in_msg_cbk
+            = mqtt_caching_retransmit_in_msg_handler;
+        astarte_mqtt_caching_check_message_expiry(&astarte_mqtt->in_msgs, retransmit_in_msg_cbk);
+
+        // Wake up in time for the next retransmission
+        *deadline = earliest_timepoint(
+            *deadline, astarte_mqtt_caching_get_next_expiry(&astarte_mqtt->out_msgs));
+        *deadline = earliest_timepoint(
+            *deadline, astarte_mqtt_caching_get_next_expiry(&astarte_mqtt->in_msgs));
     }
 
-    if (!should_poll) {
-        return ASTARTE_RESULT_OK;
+    // Check connection and ensure to periodically ping the broker using mqtt_live
+    int mqtt_rc = mqtt_live(&astarte_mqtt->client);
+    if ((mqtt_rc != 0) && (mqtt_rc != -EAGAIN)) {
+        ASTARTE_LOG_WRN("Fail keep alive MQTT connection: %s, %d", strerror(-mqtt_rc), mqtt_rc);
     }
 
-    // Poll the socket safely without deadlocking other threads
-    int socket_rc = zsock_poll(&socket_fd, 1, timeout);
+    // Extract the socket variables we need before we release the lock
+    poll_fd->fd = astarte_mqtt->client.transport.tls.sock;
+    poll_fd->events = ZSOCK_POLLIN;
+    int keepalive = mqtt_keepalive_time_left(&astarte_mqtt->client);
+    if (keepalive >= 0) {
+        *deadline = earliest_timepoint(*deadline, sys_timepoint_calc(K_MSEC(keepalive)));
+    }
+#ifndef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_EVENT_DRIVEN_WORKER
+    *deadline = earliest_timepoint(
+        *deadline, sys_timepoint_calc(K_MSEC(astarte_mqtt->poll_timeout_ms)));
+#endif
+}
 
-    // CRITICAL SECTION 2: Process MQTT Input
-    {
-        scope_guard(astarte_mqtt_sys_mutex)(&astarte_mqtt->mutex);
+astarte_result_t astarte_mqtt_poll_process(
+    astarte_mqtt_t *astarte_mqtt, const struct zsock_pollfd *poll_fd)
+{
+    if (poll_fd->fd < 0) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    astarte_result_t ares = input_client(astarte_mqtt, poll_fd);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    // Messages read before a failure are still dispatched
+    dispatch_incoming(astarte_mqtt);
+#endif
+    return ares;
+}
 
-        if (socket_rc < 0) {
-            ASTARTE_LOG_ERR("Poll error: %d", errno);
-            astarte_mqtt->connection_state = ASTARTE_MQTT_CONNECTION_ERROR;
-            return ASTARTE_RESULT_SOCKET_ERROR;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+bool astarte_mqtt_dispatch_events(astarte_mqtt_t *astarte_mqtt)
+{
+    bool dispatched = false;
+    struct astarte_mqtt_event event = { 0 };
+    // The queue is thread safe, the callbacks run without locking the client
+    while (k_msgq_get(&astarte_mqtt->events, &event, K_NO_WAIT) == 0) {
+        switch (event.type) {
+            case ASTARTE_MQTT_EVENT_CONNECTED:
+                astarte_mqtt->on_connected_cbk(astarte_mqtt, event.connack);
+                break;
+            case ASTARTE_MQTT_EVENT_DISCONNECTED:
+                astarte_mqtt->on_disconnected_cbk(astarte_mqtt);
+                break;
+            case ASTARTE_MQTT_EVENT_SUBSCRIBED:
+                astarte_mqtt->on_subscribed_cbk(astarte_mqtt, event.message_id, event.return_code);
+                break;
+            case ASTARTE_MQTT_EVENT_DELIVERED:
+                astarte_mqtt->on_delivered_cbk(astarte_mqtt, event.message_id);
+                break;
+            default:
+                ASTARTE_LOG_ERR("Invalid MQTT event type %d", event.type);
+                break;
         }
-        if (socket_rc != 0) {
-            // Process the MQTT response
-            int mqtt_in_rc = mqtt_input(&astarte_mqtt->client);
-            if ((mqtt_in_rc != 0) && (mqtt_in_rc != -ENOTCONN)) {
-                ASTARTE_LOG_ERR("MQTT input failed (%d)", mqtt_in_rc);
-                return ASTARTE_RESULT_MQTT_ERROR;
-            }
+        dispatched = true;
+    }
+    return dispatched;
+}
+
+bool astarte_mqtt_can_receive(astarte_mqtt_t *astarte_mqtt)
+{
+    return k_msgq_num_free_get(&astarte_mqtt->events) >= ASTARTE_MQTT_EVENTS_INPUT_SLOTS;
+}
+#endif
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static k_timepoint_t earliest_timepoint(k_timepoint_t first, k_timepoint_t second)
+{
+    return (sys_timepoint_cmp(first, second) <= 0) ? first : second;
+}
+
+static astarte_result_t input_client(
+    astarte_mqtt_t *astarte_mqtt, const struct zsock_pollfd *poll_fd)
+{
+    scope_guard(astarte_mqtt_sys_mutex)(&astarte_mqtt->mutex);
+
+    if (poll_fd->revents & (ZSOCK_POLLERR | ZSOCK_POLLNVAL | ZSOCK_POLLHUP)) {
+        ASTARTE_LOG_ERR("Socket poll error: 0x%x", poll_fd->revents);
+        astarte_mqtt->connection_state = ASTARTE_MQTT_CONNECTION_ERROR;
+        return ASTARTE_RESULT_SOCKET_ERROR;
+    }
+    if (poll_fd->revents & ZSOCK_POLLIN) {
+        // Process the MQTT response
+        int mqtt_in_rc = mqtt_input(&astarte_mqtt->client);
+        if ((mqtt_in_rc != 0) && (mqtt_in_rc != -ENOTCONN)) {
+            ASTARTE_LOG_ERR("MQTT input failed (%d)", mqtt_in_rc);
+            return ASTARTE_RESULT_MQTT_ERROR;
         }
     }
 
     return ASTARTE_RESULT_OK;
 }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+static void dispatch_incoming(astarte_mqtt_t *astarte_mqtt)
+{
+    while (true) {
+        sys_snode_t *node = NULL;
+        {
+            scope_guard(astarte_mqtt_sys_mutex)(&astarte_mqtt->mutex);
+            node = sys_slist_get(&astarte_mqtt->incoming_msgs);
+        }
+        if (!node) {
+            return;
+        }
+
+        struct astarte_mqtt_incoming_msg *msg
+            = CONTAINER_OF(node, struct astarte_mqtt_incoming_msg, node);
+        if (astarte_mqtt->on_incoming_cbk) {
+            astarte_mqtt->on_incoming_cbk(
+                astarte_mqtt, msg->topic, msg->topic_len, msg->data, msg->data_len);
+        }
+        astarte_free(msg);
+    }
+}
+#endif
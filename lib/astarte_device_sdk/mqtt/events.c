@@ -20,6 +20,25 @@ ASTARTE_LOG_MODULE_DECLARE(astarte_mqtt, CONFIG_ASTARTE_DEVICE_SDK_MQTT_LOG_LEVE
 static int read_publish_payload(astarte_mqtt_t *astarte_mqtt, char *msg_buffer, size_t alloc_size,
     uint32_t message_size, bool discarded);
 static int acknowledge_qos(astarte_mqtt_t *astarte_mqtt, uint16_t message_id, uint8_t qos);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+/**
+ * @brief Queues an event, to be passed to its callback by #astarte_mqtt_dispatch_events.
+ *
+ * @note The reception thread reads a packet only when #astarte_mqtt_can_receive, so a slot is
+ * always available.
+ *
+ * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @param[in] event Event to queue, copied in a preallocated slot.
+ */
+static void queue_event(astarte_mqtt_t *astarte_mqtt, const struct astarte_mqtt_event *event);
+#endif
+/**
+ * @brief Passes a delivered message to the delivered callback.
+ *
+ * @param[inout] astarte_mqtt Handle to the Astarte MQTT client instance.
+ * @param[in] message_id ID of the delivered message.
+ */
+static void notify_delivered(astarte_mqtt_t *astarte_mqtt, uint16_t message_id);
 
 /************************************************
  *       Callbacks declaration/definition       *
@@ -44,7 +63,13 @@ void astarte_mqtt_handle_connack_event(
     }
 
     if (astarte_mqtt->on_connected_cbk) {
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+        struct astarte_mqtt_event event
+            = { .type = ASTARTE_MQTT_EVENT_CONNECTED, .connack = connack };
+        queue_event(astarte_mqtt, &event);
+#else
         astarte_mqtt->on_connected_cbk(astarte_mqtt, connack);
+#endif
     }
 }
 
@@ -64,7 +89,12 @@ void astarte_mqtt_handle_disconnection_event(astarte_mqtt_t *astarte_mqtt)
             break;
     }
     if (astarte_mqtt->on_disconnected_cbk) {
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+        struct astarte_mqtt_event event = { .type = ASTARTE_MQTT_EVENT_DISCONNECTED };
+        queue_event(astarte_mqtt, &event);
+#else
         astarte_mqtt->on_disconnected_cbk(astarte_mqtt);
+#endif
     }
 }
 
@@ -79,11 +109,25 @@ void astarte_mqtt_handle_publish_event(
     // Safety limit to prevent unbounded allocations
     const bool discarded = message_size > CONFIG_ASTARTE_DEVICE_SDK_MQTT_MAX_MSG_SIZE;
     size_t alloc_size = discarded ? CONFIG_ASTARTE_DEVICE_SDK_MQTT_MAX_MSG_SIZE : message_size;
+    size_t topic_len = publish.message.topic.topic.size;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    // Allocated before acknowledging the message, on failure the broker delivers it again
+    scope_var(scoped_char, msg_alloc)(
+        sizeof(struct astarte_mqtt_incoming_msg) + topic_len + 1 + alloc_size);
+    if (!msg_alloc) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return;
+    }
+    // Topic and payload are stored in the same allocation as the list node
+    struct astarte_mqtt_incoming_msg *msg = (struct astarte_mqtt_incoming_msg *) msg_alloc;
+    char *msg_buffer = &msg->topic[topic_len + 1];
+#else
     scope_var(scoped_char, msg_buffer)(alloc_size);
     if (alloc_size != 0 && !msg_buffer) {
         ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
         return;
     }
+#endif
 
     ASTARTE_LOG_DBG("RECEIVED on topic \"%.*s\" [ id: %u qos: %u ] payload: %u / %u B",
         publish.message.topic.topic.size, (const char *) publish.message.topic.topic.utf8,
@@ -100,7 +144,15 @@ void astarte_mqtt_handle_publish_event(
         return;
     }
 
-    size_t topic_len = publish.message.topic.topic.size;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    memcpy(msg->topic, publish.message.topic.topic.utf8, topic_len);
+    msg->topic_len = topic_len;
+    msg->data = msg_buffer;
+    msg->data_len = message_size;
+    sys_slist_append(&astarte_mqtt->incoming_msgs, &msg->node);
+    // Owned by the list of received messages until dispatched
+    msg_alloc = NULL;
+#else
     scope_var(scoped_char, topic)(topic_len + 1);
     if (!topic) {
         ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
@@ -111,6 +163,7 @@ void astarte_mqtt_handle_publish_event(
     if (astarte_mqtt->on_incoming_cbk) {
         astarte_mqtt->on_incoming_cbk(astarte_mqtt, topic, topic_len, msg_buffer, message_size);
     }
+#endif
 }
 
 void astarte_mqtt_handle_pubrel_event(astarte_mqtt_t *astarte_mqtt, struct mqtt_pubrel_param pubrel)
@@ -134,9 +187,7 @@ void astarte_mqtt_handle_puback_event(astarte_mqtt_t *astarte_mqtt, struct mqtt_
 
     astarte_mqtt_caching_remove_message(&astarte_mqtt->out_msgs, message_id);
 
-    if (astarte_mqtt->on_delivered_cbk) {
-        astarte_mqtt->on_delivered_cbk(astarte_mqtt, message_id);
-    }
+    notify_delivered(astarte_mqtt, message_id);
 }
 
 void astarte_mqtt_handle_pubrec_event(astarte_mqtt_t *astarte_mqtt, struct mqtt_pubrec_param pubrec)
@@ -162,9 +213,7 @@ void astarte_mqtt_handle_pubcomp_event(
 
     astarte_mqtt_caching_remove_message(&astarte_mqtt->out_msgs, message_id);
 
-    if (astarte_mqtt->on_delivered_cbk) {
-        astarte_mqtt->on_delivered_cbk(astarte_mqtt, message_id);
-    }
+    notify_delivered(astarte_mqtt, message_id);
 }
 
 void astarte_mqtt_handle_suback_event(astarte_mqtt_t *astarte_mqtt, struct mqtt_suback_param suback)
@@ -181,7 +230,14 @@ void astarte_mqtt_handle_suback_event(astarte_mqtt_t *astarte_mqtt, struct mqtt_
         } else {
             return_code = (enum mqtt_suback_return_code) * suback.return_codes.data;
         }
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+        struct astarte_mqtt_event event = { .type = ASTARTE_MQTT_EVENT_SUBSCRIBED,
+            .message_id = message_id,
+            .return_code = return_code };
+        queue_event(astarte_mqtt, &event);
+#else
         astarte_mqtt->on_subscribed_cbk(astarte_mqtt, message_id, return_code);
+#endif
     }
 }
 
@@ -255,3 +311,28 @@ static int acknowledge_qos(astarte_mqtt_t *astarte_mqtt, uint16_t message_id, ui
 
     return 0;
 }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+static void queue_event(astarte_mqtt_t *astarte_mqtt, const struct astarte_mqtt_event *event)
+{
+    int ret = k_msgq_put(&astarte_mqtt->events, event, K_NO_WAIT);
+    __ASSERT_NO_MSG(ret == 0);
+    if (ret != 0) {
+        ASTARTE_LOG_ERR("No free slot for MQTT event %d", event->type);
+    }
+}
+#endif
+
+static void notify_delivered(astarte_mqtt_t *astarte_mqtt, uint16_t message_id)
+{
+    if (!astarte_mqtt->on_delivered_cbk) {
+        return;
+    }
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_SEPARATE_RX_TX
+    struct astarte_mqtt_event event
+        = { .type = ASTARTE_MQTT_EVENT_DELIVERED, .message_id = message_id };
+    queue_event(astarte_mqtt, &event);
+#else
+    astarte_mqtt->on_delivered_cbk(astarte_mqtt, message_id);
+#endif
+}
@@ -103,6 +103,19 @@ bool astarte_mqtt_has_pending_outgoing(astarte_mqtt_t *astarte_mqtt)
     return !sys_hashmap_is_empty(&astarte_mqtt->out_msgs.map);
 }
 
+bool astarte_mqtt_has_in_flight_capacity(astarte_mqtt_t *astarte_mqtt)
+{
+    // Lock before reading the cache
+    scope_guard(astarte_mqtt_sys_mutex)(&astarte_mqtt->mutex);
+
+    if (astarte_mqtt->in_flight_window == 0) {
+        return true;
+    }
+    // Subscriptions are not paced by the window, PUBREC only refreshes the expiry of its publish
+    return astarte_mqtt_caching_count_publishes(&astarte_mqtt->out_msgs)
+        < astarte_mqtt->in_flight_window;
+}
+
 void astarte_mqtt_clear_all_pending(astarte_mqtt_t *astarte_mqtt)
 {
     // Lock before mutating the hashmaps
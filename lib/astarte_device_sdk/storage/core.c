@@ -8,16 +8,15 @@
 
 #include <string.h>
 
-#include <zephyr/drivers/flash.h>
-#include <zephyr/storage/flash_map.h>
 #include <zephyr/version.h>
 
-#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
-#include <zephyr/kvss/zms.h>
-#else
-#include <zephyr/fs/zms.h>
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_BACKEND_ZMS
+#include <zephyr/drivers/flash.h>
+#include <zephyr/storage/flash_map.h>
 #endif
 
+#include "storage/trans.h"
+
 #include "log.h"
 ASTARTE_LOG_MODULE_REGISTER(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_LOG_LEVEL);
 
@@ -25,6 +24,7 @@ ASTARTE_LOG_MODULE_REGISTER(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_L
  *        Defines, constants and typedef        *
  ***********************************************/
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_BACKEND_ZMS
 #define ZMS_PARTITION astarte_partition
 #if !FIXED_PARTITION_EXISTS(ZMS_PARTITION)
 #error "Permanent storage is enabled but 'astarte_partition' flash partition is missing."
@@ -39,6 +39,7 @@ ASTARTE_LOG_MODULE_REGISTER(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_L
 #define ZMS_PARTITION_OFFSET FIXED_PARTITION_OFFSET(ZMS_PARTITION)
 #define ZMS_PARTITION_SIZE FIXED_PARTITION_SIZE(ZMS_PARTITION)
 #endif
+#endif // CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_BACKEND_ZMS
 
 #define VERSION_NAMESPACE "version_namespace"
 #define SYNCHRONIZATION_NAMESPACE "synchronization_namespace"
@@ -52,6 +53,25 @@ ASTARTE_LOG_MODULE_REGISTER(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_L
  *         Static functions declaration         *
  ***********************************************/
 
+/**
+ * @brief Opens the storage backend selected in the configuration.
+ *
+ * @param[inout] handle Pointer to the storage handle data.
+ * @param[in] instance Index of the device instance owning the storage.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t open_backend(astarte_storage_data_t *handle, size_t instance);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_BACKEND_ZMS
+/**
+ * @brief Computes the area of the flash partition owned by a device instance.
+ *
+ * @details The sectors of the partition are split evenly between the device instances.
+ *
+ * @param[in] instance Index of the device instance owning the area.
+ * @param[out] kv_cfg Configuration struct to mount ZMS on the area.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t get_storage_area(size_t instance, astarte_key_value_cfg_t *kv_cfg);
 /**
  * @brief Erases the flash partition.
  *
@@ -61,78 +81,76 @@ ASTARTE_LOG_MODULE_REGISTER(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_L
  */
 static astarte_result_t erase_storage(
     astarte_storage_data_t *handle, const astarte_key_value_cfg_t *kv_cfg);
+#endif
 
 /************************************************
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_storage_init(astarte_storage_data_t *handle)
+astarte_result_t astarte_storage_init(astarte_storage_data_t *handle, size_t instance)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
 
-    if (!handle) {
+    if (!handle || (instance >= CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES)) {
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
     // Zero out the memory to ensure clean state
     memset(handle, 0, sizeof(astarte_storage_data_t));
 
-    // Open the key value storage flash partition
-    astarte_key_value_cfg_t kv_astarte_storage_cfg = {
-        .flash_device = ZMS_PARTITION_DEVICE,
-        .flash_offset = ZMS_PARTITION_OFFSET,
-        .flash_partition_size = ZMS_PARTITION_SIZE,
-    };
-    ares = astarte_key_value_open(kv_astarte_storage_cfg, &handle->zms_fs);
-    if ((ares == ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION)
-        || (ares == ASTARTE_RESULT_KEY_VALUE_RECOVERY_FAILED)) {
-        ASTARTE_LOG_ERR("key-value is corrupted or of incompatible version.");
-        ares = erase_storage(handle, &kv_astarte_storage_cfg);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Storage erase error: %s.", astarte_result_to_name(ares));
-            return ares;
-        }
-    } else if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error opening cache: %s.", astarte_result_to_name(ares));
+    ares = open_backend(handle, instance);
+    if (ares != ASTARTE_RESULT_OK) {
         return ares;
     }
 
     // Init Synchronization Storage
     ares = astarte_key_value_new(
-        &handle->zms_fs, SYNCHRONIZATION_NAMESPACE, 0, &handle->sync_storage);
+        &handle->backend, SYNCHRONIZATION_NAMESPACE, 0, &handle->sync_storage);
     if (ares != ASTARTE_RESULT_OK) {
+        astarte_key_value_close(&handle->backend);
         return ares;
     }
 
     // Init Introspection Storage
     ares = astarte_key_value_new(
-        &handle->zms_fs, INTROSPECTION_NAMESPACE, 0, &handle->intro_storage);
+        &handle->backend, INTROSPECTION_NAMESPACE, 0, &handle->intro_storage);
     if (ares != ASTARTE_RESULT_OK) {
         astarte_key_value_destroy(&handle->sync_storage);
+        astarte_key_value_close(&handle->backend);
         return ares;
     }
 
     // Init Properties Storage
-    ares = astarte_key_value_new(&handle->zms_fs, PROPERTIES_NAMESPACE,
+    ares = astarte_key_value_new(&handle->backend, PROPERTIES_NAMESPACE,
         CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_PERMANENT_STORAGE_UTILIZATION_BOUND,
         &handle->prop_storage);
     if (ares != ASTARTE_RESULT_OK) {
         astarte_key_value_destroy(&handle->sync_storage);
         astarte_key_value_destroy(&handle->intro_storage);
+        astarte_key_value_close(&handle->backend);
         return ares;
     }
 
     // Init Transmission Storage
-    ares = astarte_key_value_new(&handle->zms_fs, TRANSMISSION_NAMESPACE,
+    ares = astarte_key_value_new(&handle->backend, TRANSMISSION_NAMESPACE,
         CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_PERMANENT_STORAGE_UTILIZATION_BOUND,
         &handle->trans_storage);
     if (ares != ASTARTE_RESULT_OK) {
         astarte_key_value_destroy(&handle->sync_storage);
         astarte_key_value_destroy(&handle->intro_storage);
         astarte_key_value_destroy(&handle->prop_storage);
+        astarte_key_value_close(&handle->backend);
         return ares;
     }
 
+    sys_mutex_init(&handle->trans_mutex);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    sys_mutex_init(&handle->trans_pack.mutex);
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    sys_mutex_init(&handle->trans_read_ahead.mutex);
+#endif
+
     handle->initialized = true;
     return ASTARTE_RESULT_OK;
 }
@@ -143,35 +161,113 @@ void astarte_storage_destroy(astarte_storage_data_t *handle)
         return;
     }
 
+    astarte_storage_transmission_release(handle);
+
     // Destroy individual storage instances
     astarte_key_value_destroy(&handle->sync_storage);
     astarte_key_value_destroy(&handle->intro_storage);
     astarte_key_value_destroy(&handle->prop_storage);
     astarte_key_value_destroy(&handle->trans_storage);
+    astarte_key_value_close(&handle->backend);
     handle->initialized = false;
 }
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+astarte_result_t astarte_storage_compact(astarte_storage_data_t *handle)
+{
+    if (!handle || !handle->initialized) {
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    return astarte_key_value_compact(&handle->backend);
+}
+#endif
+
 /************************************************
  *         Static functions definitions         *
  ***********************************************/
 
+static astarte_result_t open_backend(astarte_storage_data_t *handle, size_t instance)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_BACKEND_RAM
+    // Each instance owns a separate RAM storage
+    ARG_UNUSED(instance);
+    astarte_result_t ares = astarte_key_value_open_ram(
+        CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_RAM_SIZE, &handle->backend);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error opening cache: %s.", astarte_result_to_name(ares));
+    }
+    return ares;
+#else
+    // Open the key value storage on the area of the flash partition owned by the instance
+    astarte_key_value_cfg_t kv_astarte_storage_cfg = { 0 };
+    astarte_result_t ares = get_storage_area(instance, &kv_astarte_storage_cfg);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    ares = astarte_key_value_open(kv_astarte_storage_cfg, &handle->backend);
+    if ((ares == ASTARTE_RESULT_KEY_VALUE_INCOMPATIBLE_VERSION)
+        || (ares == ASTARTE_RESULT_KEY_VALUE_RECOVERY_FAILED)) {
+        ASTARTE_LOG_ERR("key-value is corrupted or of incompatible version.");
+        ares = erase_storage(handle, &kv_astarte_storage_cfg);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Storage erase error: %s.", astarte_result_to_name(ares));
+            return ares;
+        }
+    } else if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error opening cache: %s.", astarte_result_to_name(ares));
+        return ares;
+    }
+    return ASTARTE_RESULT_OK;
+#endif
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_PERMANENT_STORAGE_BACKEND_ZMS
+static astarte_result_t get_storage_area(size_t instance, astarte_key_value_cfg_t *kv_cfg)
+{
+    struct flash_pages_info fp_info = { 0 };
+    int flash_rc
+        = flash_get_page_info_by_offs(ZMS_PARTITION_DEVICE, ZMS_PARTITION_OFFSET, &fp_info);
+    if (flash_rc != 0) {
+        ASTARTE_LOG_ERR("Unable to get flash page info: %d.", flash_rc);
+        return ASTARTE_RESULT_INVALID_CONFIGURATION;
+    }
+
+    // ZMS needs at least two sectors, one of them is kept free for garbage collection
+    size_t area_sectors
+        = (ZMS_PARTITION_SIZE / fp_info.size) / CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES;
+    if (area_sectors < 2) {
+        ASTARTE_LOG_ERR("Partition too small for %d device instances.",
+            CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES);
+        return ASTARTE_RESULT_INVALID_CONFIGURATION;
+    }
+
+    size_t area_size = area_sectors * fp_info.size;
+    kv_cfg->flash_device = ZMS_PARTITION_DEVICE;
+    kv_cfg->flash_offset = (off_t) (ZMS_PARTITION_OFFSET + (instance * area_size));
+    kv_cfg->flash_partition_size = area_size;
+    return ASTARTE_RESULT_OK;
+}
+
 static astarte_result_t erase_storage(
     astarte_storage_data_t *handle, const astarte_key_value_cfg_t *kv_cfg)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
 
-    // Completely wipe the partition if the format might be incompatible
-    int flash_rc = flash_erase(ZMS_PARTITION_DEVICE, ZMS_PARTITION_OFFSET, ZMS_PARTITION_SIZE);
+    // Completely wipe the area if the format might be incompatible, other instances are untouched
+    int flash_rc = flash_erase(
+        kv_cfg->flash_device, kv_cfg->flash_offset, (size_t) kv_cfg->flash_partition_size);
     if (flash_rc != 0) {
         ASTARTE_LOG_ERR("Flash erase failed: %d", flash_rc);
         return ASTARTE_RESULT_INTERNAL_ERROR;
     }
 
     // Remount ZMS after wiping the physical flash partition
-    ares = astarte_key_value_open(*kv_cfg, &handle->zms_fs);
+    ares = astarte_key_value_open(*kv_cfg, &handle->backend);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Error reopening cache after erase: %s.", astarte_result_to_name(ares));
     }
 
     return ares;
 }
+#endif
@@ -107,7 +107,7 @@ astarte_result_t astarte_storage_mqtt_insert(astarte_storage_data_t *handle,
 
     // Insert to ZMS using direct 16-bit key access
     astarte_result_t ares = astarte_key_value_direct_insert(
-        &handle->zms_fs, direction_to_alternate(direction), identifier, buffer, total_size);
+        &handle->backend, direction_to_alternate(direction), identifier, buffer, total_size);
 
     return ares;
 }
@@ -129,7 +129,7 @@ astarte_result_t astarte_storage_mqtt_find_alloc(astarte_storage_data_t *handle,
     // First, query the required buffer size by passing NULL
     size_t value_size = 0;
     ares = astarte_key_value_direct_find(
-        &handle->zms_fs, direction_to_alternate(direction), identifier, NULL, &value_size);
+        &handle->backend, direction_to_alternate(direction), identifier, NULL, &value_size);
     if (ares == ASTARTE_RESULT_NOT_FOUND) {
         return ares;
     }
@@ -146,7 +146,7 @@ astarte_result_t astarte_storage_mqtt_find_alloc(astarte_storage_data_t *handle,
 
     // Read the actual serialized data
     ares = astarte_key_value_direct_find(
-        &handle->zms_fs, direction_to_alternate(direction), identifier, ctx.buffer, &value_size);
+        &handle->backend, direction_to_alternate(direction), identifier, ctx.buffer, &value_size);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Failed in extracting the MQTT message from storage");
         return ares;
@@ -215,7 +215,7 @@ astarte_result_t astarte_storage_mqtt_delete(astarte_storage_data_t *handle,
     }
 
     return astarte_key_value_direct_delete(
-        &handle->zms_fs, direction_to_alternate(direction), identifier);
+        &handle->backend, direction_to_alternate(direction), identifier);
 }
 
 /************************************************
@@ -11,6 +11,10 @@
 
 #include "alloc.h"
 
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+#include <zlib.h>
+#endif
+
 #include "log.h"
 ASTARTE_LOG_MODULE_DECLARE(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_LOG_LEVEL);
 
@@ -21,17 +25,423 @@ ASTARTE_LOG_MODULE_DECLARE(astarte_storage, CONFIG_ASTARTE_DEVICE_SDK_STORAGE_LO
 /** @brief Max size required to store a uint32_t string (10 digits + null terminator) */
 #define MAX_UINT32_STR_LEN 11
 
+/** @brief Timeout for locking the transmission storage. */
+#define TRANS_MUTEX_LOCK_TIMEOUT_MS 5000
+
+/**
+ * @brief Largest message stored in a single ring record.
+ *
+ * @details Larger messages are stored in a key-value entry, in chunks, while the ring holds an
+ * empty record for their position.
+ */
+#define MAX_RING_MSG_SIZE CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_CHUNK_SIZE
+
+/** @brief Key of the transmission queue checkpoint, stored in the synchronization namespace. */
+#define CHECKPOINT_KEY "transmission_checkpoint"
+#define CHECKPOINT_INTERVAL CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_CHECKPOINT_INTERVAL
+
+/** @brief Size of a serialized checkpoint: sequence number, head, tail, ring usage, head offset. */
+#define CHECKPOINT_SIZE (sizeof(uint64_t) + (4 * sizeof(uint32_t)))
+
+/** @brief Size of the fields at the start of each serialized message. */
+#define MSG_STATIC_FIELDS_SIZE                                                                     \
+    (sizeof(int) + (2 * sizeof(uint64_t)) + (2 * sizeof(size_t)) + sizeof(int))
+/** @brief Offset of the sequence number in a serialized message. */
+#define MSG_SEQUENCE_NUMBER_OFFSET (sizeof(int) + sizeof(uint64_t))
+/** @brief Offset of the interface name, path and payload lengths in a serialized message. */
+#define MSG_LENGTHS_OFFSET (MSG_SEQUENCE_NUMBER_OFFSET + sizeof(uint64_t))
+/** @brief Index selecting the last message of a record. */
+#define LAST_PACKED_MSG UINT32_MAX
+
+/** @brief Consecutive ring positions sharing an entry of the expiry index. */
+#define EXPIRY_BUCKET_POSITIONS 32
+#define EXPIRY_BUCKET(position) ((position) / EXPIRY_BUCKET_POSITIONS)
+/** @brief Entries of the expiry index, stored in the synchronization namespace. */
+#define EXPIRY_INDEX_ENTRIES (ASTARTE_KEY_VALUE_RING_SLOTS / EXPIRY_BUCKET_POSITIONS)
+#define EXPIRY_KEY_FORMAT "transmission_expiry_%03u"
+#define EXPIRY_KEY_SIZE sizeof("transmission_expiry_000")
+/** @brief Size of a serialized expiry index entry: bucket and latest expiry. */
+#define EXPIRY_ENTRY_SIZE (sizeof(uint32_t) + sizeof(uint64_t))
+/** @brief Expiry of the messages that never expire, or whose expiry is unknown. */
+#define EXPIRY_NEVER UINT64_MAX
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+#define PACK_TIMEOUT_MS CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACK_TIMEOUT_MS
+#define PACK_MUTEX_LOCK_TIMEOUT_MS 5000
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+#define READ_AHEAD_RECORDS CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD_RECORDS
+#define READ_AHEAD_MUTEX_LOCK_TIMEOUT_MS 5000
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+/**
+ * @brief First field of a compressed ring record.
+ *
+ * @details Raw records start with the QoS of their first message, which is never negative.
+ */
+#define COMPRESSED_RECORD_MARKER (-1)
+/** @brief Size of the header of a compressed record: marker and uncompressed size. */
+#define COMPRESSED_RECORD_HEADER_SIZE (sizeof(int) + sizeof(uint32_t))
+#define COMPRESSION_WINDOW_BITS                                                                    \
+    CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION_WINDOW_BITS
+/** @brief Memory level of the deflate state, records are small and the lowest level suffices. */
+#define COMPRESSION_MEM_LEVEL 1
+/** @brief Largest window of the raw deflate streams, decompresses records of any window size. */
+#define DECOMPRESSION_WINDOW_BITS 15
+#endif
+
+/** @brief Field of a message, serialized as is. */
+struct msg_field
+{
+    /** @brief Content of the field, can be NULL if its size is zero. */
+    const void *data;
+    /** @brief Size of the field. */
+    size_t size;
+};
+
+/** @brief Serialized message being read, either from a ring record or from a key-value entry. */
+struct stored_msg
+{
+    /** @brief Storage handle. */
+    astarte_storage_data_t *handle;
+    /** @brief Content of the ring record, NULL if the message is stored in a key-value entry. */
+    uint8_t *record;
+    /** @brief Size of the ring record. */
+    size_t record_size;
+    /** @brief Start of the message in the record, a record can pack several messages. */
+    const uint8_t *msg;
+    /** @brief Key of the key-value entry, used when the record is NULL. */
+    char key[MAX_UINT32_STR_LEN];
+    /** @brief Size of the serialized message. */
+    size_t total_size;
+    /** @brief True if the message is the last one of its record. */
+    bool last;
+};
+
 /************************************************
  *         Static functions declaration         *
  ***********************************************/
 
-static astarte_result_t extract_string(
-    const uint8_t *buffer, size_t buffer_size, size_t *offset, size_t str_len, char **out_str);
-static astarte_result_t extract_payload(
-    const uint8_t *buffer, size_t buffer_size, size_t *offset, int payload_len, void **out_payload);
+static astarte_result_t trans_lock(astarte_storage_data_t *handle);
+static void trans_unlock(astarte_storage_data_t *handle);
+static astarte_result_t encode_key(uint32_t position, char *key);
+/**
+ * @brief Read the message at the head of the transmission queue.
+ *
+ * @details The transmission storage must be locked by the caller.
+ *
+ * @param[in] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue.
+ * @param[out] msg Message read, to be cleaned up by the caller.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t peek_msg(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes,
+    struct astarte_storage_transmission_msg *msg);
+/**
+ * @brief Remove the message at the head of the transmission queue.
+ *
+ * @details The transmission storage must be locked by the caller.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in,out] indexes Indexes of the transmission queue.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t discard_msg(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes);
+/**
+ * @brief Write the pack to flash if it has timed out or if forced.
+ *
+ * @details The transmission storage must be locked by the caller.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in,out] indexes Indexes of the transmission queue.
+ * @param[in] force Write the pack even if it has not timed out.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t flush_pack(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes, bool force);
+/**
+ * @brief Find the indexes from the stored checkpoint, probing the positions changed after it.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] checkpoint Stored checkpoint.
+ * @param[out] indexes Indexes of the transmission queue.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if the checkpoint does not
+ * match the stored messages, otherwise an error code.
+ */
+static astarte_result_t restore_checkpoint(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_checkpoint_t *checkpoint,
+    astarte_storage_transmission_indexes_t *indexes);
+/**
+ * @brief Find the indexes reading every slot of the ring.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[out] indexes Indexes of the transmission queue.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t scan_ring(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes);
+/**
+ * @brief Find the ring record of a position, linking a message left in the namespace to it.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the message.
+ * @param[out] record_size Size of the ring record, zero for a message stored in the namespace.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if no message is stored at
+ * the position, otherwise an error code.
+ */
+static astarte_result_t find_position(
+    astarte_storage_data_t *handle, uint32_t position, size_t *record_size);
+static astarte_result_t load_checkpoint(
+    astarte_storage_data_t *handle, astarte_storage_transmission_checkpoint_t *checkpoint);
+/**
+ * @brief Store a checkpoint of the current indexes, ring usage and tail sequence number.
+ *
+ * @details The transmission storage must be locked by the caller, for the checkpoint to hold a
+ * head and a tail that are current together.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t store_checkpoint(
+    astarte_storage_data_t *handle, const astarte_storage_transmission_indexes_t *indexes);
+/**
+ * @brief Count a push or a discard, storing the checkpoint when it is due.
+ *
+ * @details The transmission storage must be locked by the caller.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue, already updated.
+ */
+static void refresh_checkpoint(
+    astarte_storage_data_t *handle, const astarte_storage_transmission_indexes_t *indexes);
+static astarte_result_t read_sequence_number(
+    astarte_storage_data_t *handle, uint32_t position, uint64_t *sequence_number);
+static astarte_result_t convert_kv_messages(astarte_storage_data_t *handle);
+/**
+ * @brief Record the expiry of the record written at the tail in the expiry index.
+ *
+ * @details Storing the entry of the previous bucket once the tail enters a new one.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the record, the new tail.
+ * @param[in] expiry Latest expiry of the messages of the record.
+ */
+static void expiry_index_add(astarte_storage_data_t *handle, uint32_t position, uint64_t expiry);
+/**
+ * @brief Get the latest expiry of the messages of a bucket.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue.
+ * @param[in] bucket Expiry bucket.
+ * @param[out] expiry Latest expiry, #EXPIRY_NEVER if unknown.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t expiry_index_get(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes, uint32_t bucket, uint64_t *expiry);
+/**
+ * @brief Delete the record at a position, without reading it.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the record.
+ * @param[out] record_size Size of the ring record deleted, zero if none was in the ring.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t delete_position(
+    astarte_storage_data_t *handle, uint32_t position, size_t *record_size);
+/**
+ * @brief Account a record written to the ring in the transmission quota.
+ *
+ * @details The transmission storage must be locked by the caller.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] record_size Size of the record in flash.
+ */
+static void ring_usage_add(astarte_storage_data_t *handle, size_t record_size);
+/**
+ * @brief Release a record removed from the head of the ring from the transmission quota.
+ *
+ * @details The transmission storage must be locked by the caller. The usage is reset once the ring
+ * is empty, dropping the error left by records deleted after a power loss without their size.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue, with the head already moved on.
+ * @param[in] record_size Size of the record in flash.
+ */
+static void ring_usage_remove(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes, size_t record_size);
+static astarte_result_t drop_unlinked_kv_messages(astarte_storage_data_t *handle);
+/**
+ * @brief Open a stored message for reading.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the record holding the message.
+ * @param[in] index Index of the message in the record, #LAST_PACKED_MSG for the last one.
+ * @param[out] stored Opened message, to be closed with #stored_msg_close.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if no message is stored at
+ * the position, otherwise an error code.
+ */
+static astarte_result_t stored_msg_open(astarte_storage_data_t *handle, uint32_t position,
+    uint32_t index, struct stored_msg *stored);
+static void stored_msg_close(struct stored_msg *stored);
+/**
+ * @brief Read a ring record of the transmission storage, decompressing it if needed.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the record.
+ * @param[out] record Content of the record, to be freed by the caller. NULL if the record is empty,
+ * the message being stored in the namespace.
+ * @param[out] size Size of the content.
+ * @param[out] stored_size Size of the record in flash.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if no record is stored at the
+ * position, otherwise an error code.
+ */
+static astarte_result_t read_record(astarte_storage_data_t *handle, uint32_t position,
+    uint8_t **record, size_t *size, size_t *stored_size);
+/**
+ * @brief Find a message in a record packing serialized messages one after the other.
+ *
+ * @param[in] record Content of the record.
+ * @param[in] record_size Size of the record.
+ * @param[in] index Index of the message in the record, #LAST_PACKED_MSG for the last one.
+ * @param[out] offset Offset of the message in the record.
+ * @param[out] msg_size Size of the serialized message.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t find_packed_msg(const uint8_t *record, size_t record_size, uint32_t index,
+    size_t *offset, size_t *msg_size);
+static void serialize_fields(const struct msg_field *fields, size_t fields_count, uint8_t *buffer);
+/**
+ * @brief Write a ring record, compressing it when enabled and worthwhile.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the record.
+ * @param[in] record Content of the record.
+ * @param[in] record_size Size of the record.
+ * @param[out] stored_size Bytes stored in the ring, smaller than @p record_size if compressed.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t write_ring_record(astarte_storage_data_t *handle, uint32_t position,
+    const uint8_t *record, size_t record_size, size_t *stored_size);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+/**
+ * @brief Compress a record, prefixing it with the compressed record header.
+ *
+ * @param[in] record Content of the record.
+ * @param[in] record_size Size of the record.
+ * @param[out] compressed Compressed record, to be freed by the caller.
+ * @param[out] compressed_size Size of the compressed record.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if the record would not
+ * shrink, otherwise an error code.
+ */
+static astarte_result_t compress_record(const uint8_t *record, size_t record_size,
+    uint8_t **compressed, size_t *compressed_size);
+/**
+ * @brief Replace a compressed record with its uncompressed content.
+ *
+ * @param[in,out] record Compressed record, replaced by the uncompressed one.
+ * @param[in,out] record_size Size of the compressed record, then of the uncompressed one.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t decompress_record(uint8_t **record, size_t *record_size);
+static voidpf compression_alloc(voidpf opaque, uInt items, uInt size);
+static void compression_free(voidpf opaque, voidpf address);
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+static astarte_result_t pack_lock(astarte_storage_transmission_pack_t *pack);
+static void pack_unlock(astarte_storage_transmission_pack_t *pack);
+/**
+ * @brief Append a message to the pack, writing the pack first if the message does not fit.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in,out] indexes Indexes of the transmission queue.
+ * @param[in] fields Fields of the message.
+ * @param[in] fields_count Number of fields.
+ * @param[in] msg_size Size of the serialized message.
+ * @param[in] msg Message being pushed.
+ * @param[in] expiry Expiry of the message, #EXPIRY_NEVER if it never expires.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t push_packed(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, const struct msg_field *fields,
+    size_t fields_count, size_t msg_size, const struct astarte_storage_transmission_msg *msg,
+    uint64_t expiry);
+/**
+ * @brief Write the messages of the pack not yet discarded as a ring record.
+ *
+ * @details The pack must be locked by the caller.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in,out] indexes Indexes of the transmission queue.
+ * @return ASTARTE_RESULT_OK if successful, otherwise an error code.
+ */
+static astarte_result_t write_pack(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes);
+/**
+ * @brief Open the message at the head when it is still in the pack.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue.
+ * @param[out] stored Opened message, holding a copy of the serialized message.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if the head is not in the pack,
+ * otherwise an error code.
+ */
+static astarte_result_t stored_msg_open_packed(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes, struct stored_msg *stored);
+static astarte_result_t discard_packed(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes);
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+static astarte_result_t read_ahead_lock(astarte_storage_transmission_read_ahead_t *read_ahead);
+static void read_ahead_unlock(astarte_storage_transmission_read_ahead_t *read_ahead);
+/**
+ * @brief Read the ring records following the head that are not yet in RAM.
+ *
+ * @details Stops at the first record that can't be kept, such as one of a message stored in the
+ * namespace. Records not read here are read from flash when opened.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] indexes Indexes of the transmission queue.
+ */
+static void read_ahead_fill(
+    astarte_storage_data_t *handle, const astarte_storage_transmission_indexes_t *indexes);
+/**
+ * @brief Open a stored message from the records kept in RAM.
+ *
+ * @param[in,out] handle Pointer to the storage handle.
+ * @param[in] position Position of the record holding the message.
+ * @param[in] index Index of the message in the record, #LAST_PACKED_MSG for the last one.
+ * @param[out] stored Opened message, holding a copy of the serialized message.
+ * @return ASTARTE_RESULT_OK if successful, ASTARTE_RESULT_NOT_FOUND if the record is not in RAM,
+ * otherwise an error code.
+ */
+static astarte_result_t read_ahead_open(astarte_storage_data_t *handle, uint32_t position,
+    uint32_t index, struct stored_msg *stored);
+static void read_ahead_evict(astarte_storage_data_t *handle, uint32_t position);
+#endif
+static astarte_result_t append_field(
+    astarte_key_value_writer_t *writer, const void *field, size_t field_size);
+static astarte_result_t read_field(
+    struct stored_msg *stored, size_t *offset, void *field, size_t field_size);
+static astarte_result_t read_string(
+    struct stored_msg *stored, size_t *offset, size_t str_len, char **out_str);
+static astarte_result_t read_payload(
+    struct stored_msg *stored, size_t *offset, int payload_len, void **out_payload);
 
 ASTARTE_SCOPE_DEFER_DEFINE(
     astarte_storage_transmission_msg_cleanup, struct astarte_storage_transmission_msg *);
+ASTARTE_SCOPE_DEFER_DEFINE(trans_unlock, astarte_storage_data_t *);
+ASTARTE_SCOPE_DEFER_DEFINE(stored_msg_close, struct stored_msg *);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+ASTARTE_SCOPE_DEFER_DEFINE(pack_unlock, astarte_storage_transmission_pack_t *);
+#endif
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+ASTARTE_SCOPE_DEFER_DEFINE(read_ahead_unlock, astarte_storage_transmission_read_ahead_t *);
+#endif
 
 /************************************************
  *         Global functions definitions         *
@@ -40,14 +450,6 @@ ASTARTE_SCOPE_DEFER_DEFINE(
 astarte_result_t astarte_storage_transmission_get_indexes(
     astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
 {
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-    astarte_key_value_iter_t iter = { 0 };
-    uint32_t min_id = UINT32_MAX;
-    uint32_t max_id = 0;
-    uint64_t sum_id = 0;
-    uint32_t element_count = 0;
-    bool found_any = false;
-
     if (!handle || !handle->initialized) {
         ASTARTE_LOG_ERR("Device caching handle is uninitialized or NULL.");
         return ASTARTE_RESULT_INVALID_PARAM;
@@ -58,90 +460,54 @@ astarte_result_t astarte_storage_transmission_get_indexes(
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    // Initialize iterator for the transmission namespace
-    ares = astarte_key_value_iterator_init(&handle->trans_storage, &iter);
-    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
-        ASTARTE_LOG_ERR("Transmission iterator init failed: %s", astarte_result_to_name(ares));
+    astarte_result_t ares = trans_lock(handle);
+    if (ares != ASTARTE_RESULT_OK) {
         return ares;
     }
+    scope_defer(trans_unlock)(handle);
 
-    // Iterate over all the key-value pairs in this namespace
-    while (ares != ASTARTE_RESULT_NOT_FOUND) {
-        char key[MAX_UINT32_STR_LEN] = { 0 };
-        size_t key_size = MAX_UINT32_STR_LEN;
+    // The records kept in RAM could belong to a queue stored before
+    astarte_storage_transmission_release(handle);
 
-        // Fetch key directly into stack buffer
-        ares = astarte_key_value_iterator_get(&iter, key, &key_size);
-        if (ares != ASTARTE_RESULT_OK) {
-            ASTARTE_LOG_ERR("Transmission iterator get error: %s", astarte_result_to_name(ares));
-            return ares;
-        }
+    astarte_storage_transmission_checkpoint_t checkpoint = { 0 };
+    bool scanned = false;
+    ares = load_checkpoint(handle, &checkpoint);
+    if (ares == ASTARTE_RESULT_OK) {
+        ares = restore_checkpoint(handle, &checkpoint, indexes);
+    }
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        ASTARTE_LOG_INF("No valid transmission checkpoint, scanning the stored messages.");
+        ares = scan_ring(handle, indexes);
+        scanned = true;
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
 
-        // Keys are numbers in string representation
-        const int base_ten = 10;
-        uint32_t current_id = (uint32_t) strtoul(key, NULL, base_ten);
+    // The expiry of the messages pushed to the bucket of the tail before the restart is lost
+    bool empty = (indexes->head == (uint32_t) (indexes->tail + 1));
+    handle->trans_expiry_tail = empty ? 0 : EXPIRY_NEVER;
+    handle->trans_expiry_has_cached = false;
 
-        if (current_id < min_id) {
-            min_id = current_id;
-        }
-        if (current_id > max_id) {
-            max_id = current_id;
-        }
-        sum_id += current_id;
-        element_count++;
-        found_any = true;
+    handle->trans_tail_sequence_number = checkpoint.sequence_number;
+    if (!scanned && (checkpoint.head == indexes->head) && (checkpoint.tail == indexes->tail)) {
+        handle->trans_checkpoint = checkpoint;
+        handle->trans_checkpoint_pending = 0;
+        return ASTARTE_RESULT_OK;
+    }
 
-        // Advance to the next element
-        ares = astarte_key_value_iterator_next(&iter);
-        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
-            ASTARTE_LOG_ERR("Iterator next error: %s", astarte_result_to_name(ares));
+    // The sequence number is read again only if the tail is not the one of the checkpoint
+    if (!empty && (scanned || (checkpoint.tail != indexes->tail))) {
+        ares = read_sequence_number(handle, indexes->tail, &handle->trans_tail_sequence_number);
+        if (ares != ASTARTE_RESULT_OK) {
             return ares;
         }
     }
 
-    if (found_any) {
-        if ((uint64_t) max_id - (uint64_t) min_id + 1 == (uint64_t) element_count) {
-            // No wrap around
-            indexes->head = min_id;
-            indexes->tail = max_id;
-        } else {
-            // Wrap around case:
-            // Since the IDs wrapped around UINT32_MAX, the valid elements are split into
-            // two blocks. This means the *missing* elements form a single contiguous
-            // arithmetic sequence between tail and head: from (tail + 1) to (head - 1).
-
-            // Calculate the sum of all possible IDs from 0 to UINT32_MAX.
-            uint64_t sum_total = ((uint64_t) UINT32_MAX * ((uint64_t) UINT32_MAX + 1)) / 2;
-
-            // The sum of the missing block is the total sum minus the sum of present IDs.
-            uint64_t sum_missing = sum_total - sum_id;
-
-            // The number of missing elements (let's call this m).
-            uint64_t missing = (uint64_t) UINT32_MAX + 1 - (uint64_t) element_count;
-
-            // Sum of an arithmetic sequence: Sum = m * (first_val + last_val) / 2
-            // Here, first_val = tail + 1 and last_val = head - 1.
-            // So, (first_val + last_val) = (tail + 1) + (head - 1) = head + tail.
-            // Isolating (head + tail):
-            uint64_t sum_ht = (2 * sum_missing) / missing;
-
-            // The number of missing elements m is also: m = last_val - first_val + 1
-            // k = (head - 1) - (tail + 1) + 1 = head - tail - 1
-            // Isolating (head - tail):
-            uint64_t diff_ht = missing + 1;
-
-            // We now have a system of two linear equations:
-            // sum_ht  = head + tail
-            // diff_ht = head - tail
-            // Solving this system by adding/subtracting the equations yields head and tail:
-            indexes->head = (uint32_t) ((sum_ht + diff_ht) / 2);
-            indexes->tail = (uint32_t) ((sum_ht - diff_ht) / 2);
-        }
-    } else {
-        indexes->head = 1;
-        indexes->tail = 0;
+    ares = store_checkpoint(handle, indexes);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Failed storing transmission checkpoint: %s", astarte_result_to_name(ares));
     }
-
     return ASTARTE_RESULT_OK;
 }
 
@@ -154,48 +520,40 @@ astarte_result_t astarte_storage_transmission_get_last_sequence_number(
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    // Detect if the storage is completely empty
-    if (indexes->head == (uint32_t) (indexes->tail + 1)) {
-        return ASTARTE_RESULT_NOT_FOUND;
-    }
-
-    char key[MAX_UINT32_STR_LEN] = { 0 };
-    // The newest message is always located at `tail`
-    int snprintf_rc = snprintf(key, sizeof(key), "%010u", indexes->tail);
-    if (snprintf_rc != MAX_UINT32_STR_LEN - 1) {
-        ASTARTE_LOG_ERR("Error encoding key into string");
-        return ASTARTE_RESULT_INTERNAL_ERROR;
+    astarte_result_t ares = trans_lock(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
     }
+    scope_defer(trans_unlock)(handle);
 
-    size_t value_size = 0;
-    astarte_result_t ares = astarte_key_value_find(&handle->trans_storage, key, NULL, &value_size);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    // Messages in the pack are newer than the ones in flash
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+    ares = pack_lock(pack);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error finding entry size: %s", astarte_result_to_name(ares));
         return ares;
     }
-
-    scope_var(scoped_uint8, buffer)(value_size);
-    if (!buffer) {
-        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
-        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    bool packed = (pack->count > 0);
+    *sequence_number = pack->sequence_number;
+    pack_unlock(pack);
+    if (packed) {
+        return ASTARTE_RESULT_OK;
     }
+#endif
 
-    ares = astarte_key_value_find(&handle->trans_storage, key, buffer, &value_size);
-    if (ares == ASTARTE_RESULT_OK) {
-        // Calculate exact offset based on the serialization logic in `push`
-        size_t offset = sizeof(int) /* qos */ + sizeof(uint64_t) /* timestamp */;
+    // Detect if the storage is completely empty
+    if (indexes->head == (uint32_t) (indexes->tail + 1)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
 
-        if (offset + sizeof(uint64_t) <= value_size) {
-            memcpy(sequence_number, buffer + offset, sizeof(uint64_t));
-        } else {
-            ASTARTE_LOG_ERR("Corrupted storage: buffer too small for sequence number");
-            ares = ASTARTE_RESULT_INTERNAL_ERROR;
-        }
-    } else {
-        ASTARTE_LOG_ERR("Error finding entry: %s", astarte_result_to_name(ares));
+    // The sequence number of the message at the checkpoint tail is known without reading it
+    if (indexes->tail == handle->trans_checkpoint.tail) {
+        *sequence_number = handle->trans_checkpoint.sequence_number;
+        return ASTARTE_RESULT_OK;
     }
 
-    return ares;
+    // The newest message is always located at `tail`
+    return read_sequence_number(handle, indexes->tail, sequence_number);
 }
 
 astarte_result_t astarte_storage_transmission_push(astarte_storage_data_t *handle,
@@ -211,73 +569,136 @@ astarte_result_t astarte_storage_transmission_push(astarte_storage_data_t *handl
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_result_t ares = trans_lock(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(trans_unlock)(handle);
 
     size_t interface_name_len = strlen(msg->interface_name);
     size_t path_len = strlen(msg->path);
 
-    // Calculate total buffer size required for serialization
-    size_t buffer_size = sizeof(msg->qos) + sizeof(msg->timestamp) + sizeof(msg->sequence_number)
-        + sizeof(interface_name_len) + interface_name_len + sizeof(path_len) + path_len
-        + sizeof(msg->payload_len) + msg->payload_len;
+    // Calculate total size required for serialization
+    size_t buffer_size = MSG_STATIC_FIELDS_SIZE + interface_name_len + path_len + msg->payload_len;
 
-    scope_var(scoped_uint8, buffer)(buffer_size);
-    if (!buffer) {
-        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
-        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    // Each position owns a ring slot, the oldest message must be discarded to reuse its slot
+    uint32_t position = indexes->tail + 1;
+    if ((uint32_t) (position - indexes->head) >= ASTARTE_KEY_VALUE_RING_SLOTS) {
+        ASTARTE_LOG_WRN("Transmission ring is full.");
+        return ASTARTE_RESULT_OUT_OF_SPACE;
     }
 
-    // Serialize static fields
-    size_t offset = 0;
-    memcpy(buffer + offset, &msg->qos, sizeof(msg->qos));
-    offset += sizeof(msg->qos);
-
-    memcpy(buffer + offset, &msg->timestamp, sizeof(msg->timestamp));
-    offset += sizeof(msg->timestamp);
+    // The messages in the ring, in the pack and in the namespace share the quota of the namespace
+    astarte_key_value_t *kv_storage = &handle->trans_storage;
+    size_t ring_usage_bytes = handle->trans_ring_usage_bytes;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    ring_usage_bytes += handle->trans_pack.size;
+#endif
+    if ((kv_storage->max_quota_bytes > 0)
+        && (kv_storage->current_usage_bytes + ring_usage_bytes + buffer_size
+            > kv_storage->max_quota_bytes)) {
+        ASTARTE_LOG_WRN("Transmission storage quota exceeded.");
+        return ASTARTE_RESULT_OUT_OF_SPACE;
+    }
 
-    memcpy(buffer + offset, &msg->sequence_number, sizeof(msg->sequence_number));
-    offset += sizeof(msg->sequence_number);
+    uint64_t expiry = (msg->expiry_timestamp == 0) ? EXPIRY_NEVER : msg->expiry_timestamp;
+
+    const struct msg_field fields[] = {
+        { &msg->qos, sizeof(msg->qos) },
+        { &msg->timestamp, sizeof(msg->timestamp) },
+        { &msg->sequence_number, sizeof(msg->sequence_number) },
+        { &interface_name_len, sizeof(interface_name_len) },
+        { &path_len, sizeof(path_len) },
+        { &msg->payload_len, sizeof(msg->payload_len) },
+        { msg->interface_name, interface_name_len },
+        { msg->path, path_len },
+        { msg->payload, msg->payload_len },
+    };
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    if ((buffer_size <= MAX_RING_MSG_SIZE) && (buffer_size <= sizeof(handle->trans_pack.buffer))) {
+        return push_packed(handle, indexes, fields, ARRAY_SIZE(fields), buffer_size, msg, expiry);
+    }
 
-    memcpy(buffer + offset, &interface_name_len, sizeof(interface_name_len));
-    offset += sizeof(interface_name_len);
+    // Messages stored on their own follow the ones waiting in the pack
+    ares = flush_pack(handle, indexes, true);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error writing packed entries: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+    position = indexes->tail + 1;
+    if ((uint32_t) (position - indexes->head) >= ASTARTE_KEY_VALUE_RING_SLOTS) {
+        ASTARTE_LOG_WRN("Transmission ring is full.");
+        return ASTARTE_RESULT_OUT_OF_SPACE;
+    }
+#endif
+
+    if (buffer_size <= MAX_RING_MSG_SIZE) {
+        // Small messages are stored with a single write
+        scope_var(scoped_uint8, buffer)(buffer_size);
+        if (!buffer) {
+            ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+            return ASTARTE_RESULT_OUT_OF_MEMORY;
+        }
+        serialize_fields(fields, ARRAY_SIZE(fields), buffer);
 
-    memcpy(buffer + offset, &path_len, sizeof(path_len));
-    offset += sizeof(path_len);
+        size_t stored_size = 0;
+        ares = write_ring_record(handle, position, buffer, buffer_size, &stored_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Error inserting entry: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+        ring_usage_add(handle, stored_size);
 
-    memcpy(buffer + offset, &msg->payload_len, sizeof(msg->payload_len));
-    offset += sizeof(msg->payload_len);
+        indexes->tail++;
+        handle->trans_tail_sequence_number = msg->sequence_number;
+        expiry_index_add(handle, indexes->tail, expiry);
+        refresh_checkpoint(handle, indexes);
+        return ASTARTE_RESULT_OK;
+    }
 
-    // Serialize dynamic payload fields
-    if (interface_name_len > 0) {
-        memcpy(buffer + offset, msg->interface_name, interface_name_len);
-        offset += interface_name_len;
+    // Keys are stored as zero-padded 10-digit strings
+    char key[MAX_UINT32_STR_LEN];
+    ares = encode_key(position, key);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
     }
 
-    if (path_len > 0) {
-        memcpy(buffer + offset, msg->path, path_len);
-        offset += path_len;
+    // Serialize the fields straight into the storage, without a copy of the whole message
+    astarte_key_value_writer_t writer = { 0 };
+    ares = astarte_key_value_writer_begin(kv_storage, key, buffer_size, &writer);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error inserting entry: %s", astarte_result_to_name(ares));
+        return ares;
     }
+    scope_defer(astarte_key_value_writer_destroy)(&writer);
 
-    if (msg->payload_len > 0 && msg->payload != NULL) {
-        memcpy(buffer + offset, msg->payload, msg->payload_len);
+    for (size_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        ares = append_field(&writer, fields[i].data, fields[i].size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Error inserting entry: %s", astarte_result_to_name(ares));
+            return ares;
+        }
     }
 
-    // Keys are stored as zero-padded 10-digit strings
-    char key[MAX_UINT32_STR_LEN];
-    int snprintf_rc = snprintf(key, sizeof(key), "%010u", indexes->tail + 1);
-    if (snprintf_rc != MAX_UINT32_STR_LEN - 1) {
-        ASTARTE_LOG_ERR("Error encoding key into string");
-        return ASTARTE_RESULT_INTERNAL_ERROR;
+    ares = astarte_key_value_writer_commit(&writer);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error inserting entry: %s", astarte_result_to_name(ares));
+        return ares;
     }
 
-    // Insert to ZMS
-    ares = astarte_key_value_insert(&handle->trans_storage, key, buffer, buffer_size);
+    // An empty ring record marks the position as stored in the namespace. If it is not written,
+    // the message gets linked to the ring on the next startup.
+    ares = astarte_key_value_ring_insert(handle->trans_storage.backend, position, NULL, 0);
     if (ares != ASTARTE_RESULT_OK) {
         ASTARTE_LOG_ERR("Error inserting entry: %s", astarte_result_to_name(ares));
         return ares;
     }
 
     indexes->tail++;
+    handle->trans_tail_sequence_number = msg->sequence_number;
+    expiry_index_add(handle, indexes->tail, expiry);
+    refresh_checkpoint(handle, indexes);
     return ASTARTE_RESULT_OK;
 }
 
@@ -290,86 +711,43 @@ astarte_result_t astarte_storage_transmission_peek(astarte_storage_data_t *handl
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-
-    char key[MAX_UINT32_STR_LEN] = { 0 };
-    int snprintf_rc = snprintf(key, sizeof(key), "%010u", indexes->head);
-    if (snprintf_rc != MAX_UINT32_STR_LEN - 1) {
-        ASTARTE_LOG_ERR("Error encoding key into string");
-        return ASTARTE_RESULT_INTERNAL_ERROR;
-    }
-
-    // Query the size of the stored message
-    size_t buffer_size = 0;
-    ares = astarte_key_value_find(&handle->trans_storage, key, NULL, &buffer_size);
+    astarte_result_t ares = trans_lock(handle);
     if (ares != ASTARTE_RESULT_OK) {
-        // Could be ASTARTE_RESULT_NOT_FOUND
         return ares;
     }
+    scope_defer(trans_unlock)(handle);
 
-    scope_var(scoped_uint8, buffer)(buffer_size);
-    if (!buffer) {
-        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
-        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    return peek_msg(handle, indexes, msg);
+}
+
+astarte_result_t astarte_storage_transmission_get(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, struct astarte_storage_transmission_msg *msg)
+{
+    if (!handle || !handle->initialized || !indexes || !msg) {
+        ASTARTE_LOG_ERR("NULL parameters provided");
+        return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    // Retrieve the actual data
-    ares = astarte_key_value_find(&handle->trans_storage, key, buffer, &buffer_size);
+    astarte_result_t ares = trans_lock(handle);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error finding entry: %s", astarte_result_to_name(ares));
         return ares;
     }
+    scope_defer(trans_unlock)(handle);
 
     struct astarte_storage_transmission_msg local_msg = { 0 };
     scope_defer(astarte_storage_transmission_msg_cleanup)(&local_msg);
-    size_t offset = 0;
-    size_t interface_name_len = 0;
-    size_t path_len = 0;
-
-    size_t static_fields_size = sizeof(local_msg.qos) + sizeof(local_msg.timestamp)
-        + sizeof(local_msg.sequence_number) + sizeof(interface_name_len) + sizeof(path_len)
-        + sizeof(local_msg.payload_len);
-
-    if (offset + static_fields_size > buffer_size) {
-        ASTARTE_LOG_ERR("Corrupted storage: buffer too small for static fields");
-        return ASTARTE_RESULT_INTERNAL_ERROR;
-    }
-
-    // Safely extract static fields
-    memcpy(&local_msg.qos, buffer + offset, sizeof(local_msg.qos));
-    offset += sizeof(local_msg.qos);
-
-    memcpy(&local_msg.timestamp, buffer + offset, sizeof(local_msg.timestamp));
-    offset += sizeof(local_msg.timestamp);
-
-    memcpy(&local_msg.sequence_number, buffer + offset, sizeof(local_msg.sequence_number));
-    offset += sizeof(local_msg.sequence_number);
-
-    memcpy(&interface_name_len, buffer + offset, sizeof(interface_name_len));
-    offset += sizeof(interface_name_len);
-
-    memcpy(&path_len, buffer + offset, sizeof(path_len));
-    offset += sizeof(path_len);
-
-    memcpy(&local_msg.payload_len, buffer + offset, sizeof(local_msg.payload_len));
-    offset += sizeof(local_msg.payload_len);
-
-    ares = extract_string(
-        buffer, buffer_size, &offset, interface_name_len, &local_msg.interface_name);
-    if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error extracting interface name: %s", astarte_result_to_name(ares));
-        return ares;
-    }
 
-    ares = extract_string(buffer, buffer_size, &offset, path_len, &local_msg.path);
+    // Reuse peek logic to parse and populate the message
+    ares = peek_msg(handle, indexes, &local_msg);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error extracting path: %s", astarte_result_to_name(ares));
+        ASTARTE_LOG_ERR("Error peeking storage: %s", astarte_result_to_name(ares));
         return ares;
     }
 
-    ares = extract_payload(buffer, buffer_size, &offset, local_msg.payload_len, &local_msg.payload);
+    // Delete the message from the persistent store
+    ares = discard_msg(handle, indexes);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error extracting payload: %s", astarte_result_to_name(ares));
+        ASTARTE_LOG_ERR("Failed to delete fetched transmission storage entry");
         return ares;
     }
 
@@ -390,105 +768,1335 @@ astarte_result_t astarte_storage_transmission_peek(astarte_storage_data_t *handl
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_storage_transmission_get(astarte_storage_data_t *handle,
-    astarte_storage_transmission_indexes_t *indexes, struct astarte_storage_transmission_msg *msg)
+astarte_result_t astarte_storage_transmission_discard(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
 {
-    if (!handle || !handle->initialized || !indexes || !msg) {
+    if (!handle || !handle->initialized || !indexes) {
         ASTARTE_LOG_ERR("NULL parameters provided");
         return ASTARTE_RESULT_INVALID_PARAM;
     }
 
-    struct astarte_storage_transmission_msg local_msg = { 0 };
-    scope_defer(astarte_storage_transmission_msg_cleanup)(&local_msg);
-
-    // Reuse peek logic to parse and populate the message
-    astarte_result_t ares = astarte_storage_transmission_peek(handle, indexes, &local_msg);
+    astarte_result_t ares = trans_lock(handle);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Error peeking storage: %s", astarte_result_to_name(ares));
         return ares;
     }
+    scope_defer(trans_unlock)(handle);
 
-    // Delete the message from the persistent store
-    char key[MAX_UINT32_STR_LEN] = { 0 };
-    int snprintf_rc = snprintf(key, sizeof(key), "%010u", indexes->head);
-    if (snprintf_rc != MAX_UINT32_STR_LEN - 1) {
-        ASTARTE_LOG_ERR("Error encoding key into string");
-        return ASTARTE_RESULT_INTERNAL_ERROR;
+    return discard_msg(handle, indexes);
+}
+
+astarte_result_t astarte_storage_transmission_drop_expired(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, uint64_t now_ms, uint32_t *dropped)
+{
+    if (!handle || !handle->initialized || !indexes) {
+        ASTARTE_LOG_ERR("NULL parameters provided");
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    astarte_result_t ares = trans_lock(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(trans_unlock)(handle);
+
+    uint32_t dropped_count = 0;
+    while (indexes->head != (uint32_t) (indexes->tail + 1)) {
+        uint64_t expiry = EXPIRY_NEVER;
+        ares = expiry_index_get(handle, indexes, EXPIRY_BUCKET(indexes->head), &expiry);
+        if ((ares != ASTARTE_RESULT_OK) || (expiry >= now_ms)) {
+            break;
+        }
+
+        // Every message of the bucket has expired, its records are deleted without reading them
+        uint32_t bucket_left = EXPIRY_BUCKET_POSITIONS - (indexes->head % EXPIRY_BUCKET_POSITIONS);
+        uint32_t queued = indexes->tail + 1 - indexes->head;
+        for (uint32_t i = MIN(bucket_left, queued); i > 0; i--) {
+            size_t record_size = 0;
+            ares = delete_position(handle, indexes->head, &record_size);
+            if (ares != ASTARTE_RESULT_OK) {
+                break;
+            }
+            indexes->head++;
+            indexes->head_offset = 0;
+            dropped_count++;
+            ring_usage_remove(handle, indexes, record_size);
+            refresh_checkpoint(handle, indexes);
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            break;
+        }
+    }
+
+    ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_OK, "Failed dropping expired messages: %s",
+        astarte_result_to_name(ares));
+    if (dropped) {
+        *dropped = dropped_count;
+    }
+    return ares;
+}
+
+astarte_result_t astarte_storage_transmission_flush(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, bool force)
+{
+    if (!handle || !handle->initialized || !indexes) {
+        ASTARTE_LOG_ERR("NULL parameters provided");
+        return ASTARTE_RESULT_INVALID_PARAM;
+    }
+
+    astarte_result_t ares = trans_lock(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(trans_unlock)(handle);
+
+    return flush_pack(handle, indexes, force);
+}
+
+k_timepoint_t astarte_storage_transmission_get_flush_deadline(astarte_storage_data_t *handle)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    if (!handle || !handle->initialized) {
+        return sys_timepoint_calc(K_FOREVER);
+    }
+
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+    if (pack_lock(pack) != ASTARTE_RESULT_OK) {
+        return sys_timepoint_calc(K_FOREVER);
+    }
+    k_timepoint_t deadline = (pack->count > 0) ? pack->deadline : sys_timepoint_calc(K_FOREVER);
+    pack_unlock(pack);
+    return deadline;
+#else
+    ARG_UNUSED(handle);
+    return sys_timepoint_calc(K_FOREVER);
+#endif
+}
+
+void astarte_storage_transmission_release(astarte_storage_data_t *handle)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    if (!handle || !handle->initialized) {
+        return;
+    }
+
+    astarte_storage_transmission_read_ahead_t *read_ahead = &handle->trans_read_ahead;
+    if (read_ahead_lock(read_ahead) != ASTARTE_RESULT_OK) {
+        return;
+    }
+    for (size_t i = 0; i < READ_AHEAD_RECORDS; i++) {
+        astarte_free(read_ahead->entries[i].record);
+        read_ahead->entries[i].record = NULL;
+    }
+    read_ahead_unlock(read_ahead);
+#else
+    ARG_UNUSED(handle);
+#endif
+}
+
+void astarte_storage_transmission_msg_cleanup(struct astarte_storage_transmission_msg *msg)
+{
+    if (!msg) {
+        return;
+    }
+    astarte_free(msg->interface_name);
+    msg->interface_name = NULL;
+    astarte_free(msg->path);
+    msg->path = NULL;
+    astarte_free(msg->payload);
+    msg->payload = NULL;
+}
+
+/************************************************
+ *         Static functions definitions         *
+ ***********************************************/
+
+static astarte_result_t trans_lock(astarte_storage_data_t *handle)
+{
+    int mutex_rc = sys_mutex_lock(&handle->trans_mutex, K_MSEC(TRANS_MUTEX_LOCK_TIMEOUT_MS));
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission storage lock failed with %d", mutex_rc);
+    return (mutex_rc != 0) ? ASTARTE_RESULT_MUTEX_LOCK_ERROR : ASTARTE_RESULT_OK;
+}
+
+static void trans_unlock(astarte_storage_data_t *handle)
+{
+    int mutex_rc = sys_mutex_unlock(&handle->trans_mutex);
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission storage unlock failed with %d", mutex_rc);
+}
+
+static astarte_result_t encode_key(uint32_t position, char *key)
+{
+    int snprintf_rc = snprintf(key, MAX_UINT32_STR_LEN, "%010u", position);
+    if (snprintf_rc != MAX_UINT32_STR_LEN - 1) {
+        ASTARTE_LOG_ERR("Error encoding key into string");
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t peek_msg(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes,
+    struct astarte_storage_transmission_msg *msg)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    read_ahead_fill(handle, indexes);
+#endif
+
+    struct stored_msg stored = { 0 };
+    scope_defer(stored_msg_close)(&stored);
+    ares = stored_msg_open(handle, indexes->head, indexes->head_offset, &stored);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        ares = stored_msg_open_packed(handle, indexes, &stored);
+    }
+#endif
+    if (ares != ASTARTE_RESULT_OK) {
+        // Could be ASTARTE_RESULT_NOT_FOUND
+        return ares;
+    }
+
+    struct astarte_storage_transmission_msg local_msg = { 0 };
+    scope_defer(astarte_storage_transmission_msg_cleanup)(&local_msg);
+    size_t interface_name_len = 0;
+    size_t path_len = 0;
+
+    uint8_t static_fields[MSG_STATIC_FIELDS_SIZE];
+
+    // Read the static fields only, each dynamic field is then read into its own allocation
+    if (stored.total_size < sizeof(static_fields)) {
+        ASTARTE_LOG_ERR("Corrupted storage: buffer too small for static fields");
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    size_t offset = 0;
+    ares = read_field(&stored, &offset, static_fields, sizeof(static_fields));
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // Safely extract static fields
+    offset = 0;
+    memcpy(&local_msg.qos, static_fields + offset, sizeof(local_msg.qos));
+    offset += sizeof(local_msg.qos);
+
+    memcpy(&local_msg.timestamp, static_fields + offset, sizeof(local_msg.timestamp));
+    offset += sizeof(local_msg.timestamp);
+
+    memcpy(&local_msg.sequence_number, static_fields + offset, sizeof(local_msg.sequence_number));
+    offset += sizeof(local_msg.sequence_number);
+
+    memcpy(&interface_name_len, static_fields + offset, sizeof(interface_name_len));
+    offset += sizeof(interface_name_len);
+
+    memcpy(&path_len, static_fields + offset, sizeof(path_len));
+    offset += sizeof(path_len);
+
+    memcpy(&local_msg.payload_len, static_fields + offset, sizeof(local_msg.payload_len));
+    offset += sizeof(local_msg.payload_len);
+
+    ares = read_string(&stored, &offset, interface_name_len, &local_msg.interface_name);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error extracting interface name: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    ares = read_string(&stored, &offset, path_len, &local_msg.path);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error extracting path: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    ares = read_payload(&stored, &offset, local_msg.payload_len, &local_msg.payload);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error extracting payload: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Populate msg struct
+    msg->interface_name = local_msg.interface_name;
+    msg->path = local_msg.path;
+    msg->payload = local_msg.payload;
+    msg->payload_len = local_msg.payload_len;
+    msg->qos = local_msg.qos;
+    msg->timestamp = local_msg.timestamp;
+    msg->sequence_number = local_msg.sequence_number;
+
+    // Disarm message cleanup
+    local_msg.interface_name = NULL;
+    local_msg.path = NULL;
+    local_msg.payload = NULL;
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t discard_msg(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
+{
+    struct stored_msg stored = { 0 };
+    scope_defer(stored_msg_close)(&stored);
+    astarte_result_t ares = stored_msg_open(handle, indexes->head, indexes->head_offset, &stored);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    if (ares == ASTARTE_RESULT_NOT_FOUND) {
+        return discard_packed(handle, indexes);
+    }
+#endif
+    if ((ares == ASTARTE_RESULT_OK) && !stored.last) {
+        // The record keeps the messages following the discarded one, only the offset moves on
+        indexes->head_offset++;
+        refresh_checkpoint(handle, indexes);
+        return ASTARTE_RESULT_OK;
+    }
+    if (ares == ASTARTE_RESULT_OK) {
+        ares = astarte_key_value_ring_delete(handle->trans_storage.backend, indexes->head, NULL);
+    }
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND,
+            "Failed to discard transmission storage entry: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    if (!stored.record) {
+        // The ring record is deleted first, a message left in the namespace by a power loss is
+        // linked to the ring again and delivered once more on the next startup
+        char key[MAX_UINT32_STR_LEN] = { 0 };
+        ares = encode_key(indexes->head, key);
+        if (ares == ASTARTE_RESULT_OK) {
+            ares = astarte_key_value_delete(&handle->trans_storage, key);
+        }
+        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+            ASTARTE_LOG_ERR("Failed to discard transmission storage entry: %s",
+                astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    read_ahead_evict(handle, indexes->head);
+#endif
+    indexes->head++;
+    indexes->head_offset = 0;
+    ring_usage_remove(handle, indexes, stored.record ? stored.record_size : 0);
+    refresh_checkpoint(handle, indexes);
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t flush_pack(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes, bool force)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+    astarte_result_t ares = pack_lock(pack);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(pack_unlock)(pack);
+
+    if ((pack->count == 0) || (!force && !sys_timepoint_expired(pack->deadline))) {
+        return ASTARTE_RESULT_OK;
+    }
+    return write_pack(handle, indexes);
+#else
+    ARG_UNUSED(handle);
+    ARG_UNUSED(indexes);
+    ARG_UNUSED(force);
+    return ASTARTE_RESULT_OK;
+#endif
+}
+
+static astarte_result_t restore_checkpoint(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_checkpoint_t *checkpoint,
+    astarte_storage_transmission_indexes_t *indexes)
+{
+    uint32_t head = checkpoint->head;
+    uint32_t tail = checkpoint->tail;
+    size_t usage = checkpoint->ring_usage_bytes;
+
+    // Messages pushed after the checkpoint follow its tail. The head never passes the tail of the
+    // stored checkpoint, so none of them has been discarded.
+    for (uint32_t probed = 0; probed < ASTARTE_KEY_VALUE_RING_SLOTS; probed++) {
+        size_t record_size = 0;
+        astarte_result_t ares = find_position(handle, tail + 1, &record_size);
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            break;
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        usage += record_size;
+        tail++;
+    }
+
+    // Messages discarded after the checkpoint precede the new head. Their size is not known, the
+    // usage is overestimated until the queue is emptied.
+    while (head != (uint32_t) (tail + 1)) {
+        size_t record_size = 0;
+        astarte_result_t ares = find_position(handle, head, &record_size);
+        if (ares == ASTARTE_RESULT_OK) {
+            break;
+        }
+        if (ares != ASTARTE_RESULT_NOT_FOUND) {
+            return ares;
+        }
+        head++;
+    }
+
+    if ((uint32_t) (tail + 1 - head) > ASTARTE_KEY_VALUE_RING_SLOTS) {
+        ASTARTE_LOG_WRN("Transmission checkpoint is out of the ring bounds.");
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    // The offset in the head record is kept while the record is still at the head
+    bool empty = (head == (uint32_t) (tail + 1));
+    indexes->head = head;
+    indexes->tail = tail;
+    indexes->head_offset = (!empty && (head == checkpoint->head)) ? checkpoint->head_offset : 0;
+    handle->trans_ring_usage_bytes = empty ? 0 : usage;
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t scan_ring(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
+{
+    // Messages stored in the key-value namespace by older versions are linked to the ring first
+    astarte_result_t ares = convert_kv_messages(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    ares = drop_unlinked_kv_messages(handle);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    astarte_key_value_ring_bounds_t bounds = { 0 };
+    ares = astarte_key_value_ring_bounds(handle->trans_storage.backend, &bounds);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Transmission ring scan failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    if (bounds.count > 0) {
+        indexes->head = bounds.first;
+        indexes->tail = bounds.last;
+    } else {
+        indexes->head = 1;
+        indexes->tail = 0;
+    }
+    indexes->head_offset = 0;
+    handle->trans_ring_usage_bytes = bounds.bytes;
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t find_position(
+    astarte_storage_data_t *handle, uint32_t position, size_t *record_size)
+{
+    astarte_result_t ares = astarte_key_value_ring_find(
+        handle->trans_storage.backend, position, NULL, record_size);
+    if (ares != ASTARTE_RESULT_NOT_FOUND) {
+        return ares;
+    }
+
+    // A power loss can leave a message in the namespace without its ring record
+    char key[MAX_UINT32_STR_LEN] = { 0 };
+    ares = encode_key(position, key);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    size_t value_size = 0;
+    ares = astarte_key_value_find(&handle->trans_storage, key, NULL, &value_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    ares = astarte_key_value_ring_insert(handle->trans_storage.backend, position, NULL, 0);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Failed linking message %s to the ring: %s", key,
+            astarte_result_to_name(ares));
+        return ares;
+    }
+    *record_size = 0;
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t load_checkpoint(
+    astarte_storage_data_t *handle, astarte_storage_transmission_checkpoint_t *checkpoint)
+{
+    uint8_t raw[CHECKPOINT_SIZE] = { 0 };
+    size_t raw_size = sizeof(raw);
+    astarte_result_t ares
+        = astarte_key_value_find(&handle->sync_storage, CHECKPOINT_KEY, raw, &raw_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND,
+            "Failed reading transmission checkpoint: %s", astarte_result_to_name(ares));
+        // A checkpoint that can't be read is rebuilt from the stored messages
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+    if (raw_size != sizeof(raw)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    size_t offset = 0;
+    memcpy(&checkpoint->sequence_number, raw + offset, sizeof(uint64_t));
+    offset += sizeof(uint64_t);
+    memcpy(&checkpoint->head, raw + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(&checkpoint->tail, raw + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(&checkpoint->ring_usage_bytes, raw + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(&checkpoint->head_offset, raw + offset, sizeof(uint32_t));
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t store_checkpoint(
+    astarte_storage_data_t *handle, const astarte_storage_transmission_indexes_t *indexes)
+{
+    astarte_storage_transmission_checkpoint_t checkpoint = {
+        .head = indexes->head,
+        .tail = indexes->tail,
+        .sequence_number = handle->trans_tail_sequence_number,
+        .ring_usage_bytes = (uint32_t) MIN(handle->trans_ring_usage_bytes, UINT32_MAX),
+        // With no record in flash the offset refers to the pack, lost on a power loss
+        .head_offset = (indexes->head == (uint32_t) (indexes->tail + 1)) ? 0 : indexes->head_offset,
+    };
+
+    uint8_t raw[CHECKPOINT_SIZE] = { 0 };
+    size_t offset = 0;
+    memcpy(raw + offset, &checkpoint.sequence_number, sizeof(uint64_t));
+    offset += sizeof(uint64_t);
+    memcpy(raw + offset, &checkpoint.head, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(raw + offset, &checkpoint.tail, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(raw + offset, &checkpoint.ring_usage_bytes, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(raw + offset, &checkpoint.head_offset, sizeof(uint32_t));
+
+    // Kept even if not stored, it still holds the sequence number of the message at the tail
+    handle->trans_checkpoint = checkpoint;
+
+    astarte_result_t ares
+        = astarte_key_value_insert(&handle->sync_storage, CHECKPOINT_KEY, raw, sizeof(raw));
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    handle->trans_checkpoint_pending = 0;
+    return ASTARTE_RESULT_OK;
+}
+
+static void refresh_checkpoint(
+    astarte_storage_data_t *handle, const astarte_storage_transmission_indexes_t *indexes)
+{
+    // Storing the checkpoint of an empty queue lets the next startup skip any probing. The head
+    // is kept from passing the stored tail, the positions following it are then all in the queue.
+    handle->trans_checkpoint_pending++;
+    bool empty = (indexes->head == (uint32_t) (indexes->tail + 1));
+    bool passed = ((int32_t) (indexes->head - (handle->trans_checkpoint.tail + 1)) > 0);
+    if ((handle->trans_checkpoint_pending < CHECKPOINT_INTERVAL) && !empty && !passed) {
+        return;
+    }
+
+    // A checkpoint not stored is only a longer probing on the next startup
+    astarte_result_t ares = store_checkpoint(handle, indexes);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_WRN("Failed storing transmission checkpoint: %s", astarte_result_to_name(ares));
+    }
+}
+
+static astarte_result_t read_sequence_number(
+    astarte_storage_data_t *handle, uint32_t position, uint64_t *sequence_number)
+{
+    struct stored_msg stored = { 0 };
+    scope_defer(stored_msg_close)(&stored);
+    astarte_result_t ares = stored_msg_open(handle, position, LAST_PACKED_MSG, &stored);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error finding entry: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // Calculate exact offset based on the serialization logic in `push`
+    size_t offset = MSG_SEQUENCE_NUMBER_OFFSET;
+    if (offset + sizeof(uint64_t) > stored.total_size) {
+        ASTARTE_LOG_ERR("Corrupted storage: buffer too small for sequence number");
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+
+    return read_field(&stored, &offset, sequence_number, sizeof(uint64_t));
+}
+
+static astarte_result_t convert_kv_messages(astarte_storage_data_t *handle)
+{
+    astarte_key_value_iter_t iter = { 0 };
+    astarte_result_t ares = astarte_key_value_iterator_init(&handle->trans_storage, &iter);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        ASTARTE_LOG_ERR("Transmission iterator init failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    // The namespace is iterated from the oldest message, newer messages take the shared slots
+    while (ares != ASTARTE_RESULT_NOT_FOUND) {
+        char key[MAX_UINT32_STR_LEN] = { 0 };
+        size_t key_size = MAX_UINT32_STR_LEN;
+        ares = astarte_key_value_iterator_get(&iter, key, &key_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Transmission iterator get error: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+
+        // Keys are numbers in string representation
+        const int base_ten = 10;
+        uint32_t position = (uint32_t) strtoul(key, NULL, base_ten);
+
+        size_t record_size = 0;
+        ares = astarte_key_value_ring_find(
+            handle->trans_storage.backend, position, NULL, &record_size);
+        if (ares == ASTARTE_RESULT_NOT_FOUND) {
+            ares = astarte_key_value_ring_insert(handle->trans_storage.backend, position, NULL, 0);
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed linking message %s to the ring: %s", key,
+                astarte_result_to_name(ares));
+            return ares;
+        }
+
+        ares = astarte_key_value_iterator_next(&iter);
+        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+            ASTARTE_LOG_ERR("Iterator next error: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t drop_unlinked_kv_messages(astarte_storage_data_t *handle)
+{
+    astarte_key_value_iter_t iter = { 0 };
+    astarte_result_t ares = astarte_key_value_iterator_init(&handle->trans_storage, &iter);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        ASTARTE_LOG_ERR("Transmission iterator init failed: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+
+    while (ares != ASTARTE_RESULT_NOT_FOUND) {
+        char key[MAX_UINT32_STR_LEN] = { 0 };
+        size_t key_size = MAX_UINT32_STR_LEN;
+        ares = astarte_key_value_iterator_get(&iter, key, &key_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Transmission iterator get error: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+
+        const int base_ten = 10;
+        uint32_t position = (uint32_t) strtoul(key, NULL, base_ten);
+
+        // Only older queues longer than the ring have messages whose slot has been taken
+        size_t record_size = 0;
+        ares = astarte_key_value_ring_find(
+            handle->trans_storage.backend, position, NULL, &record_size);
+        if ((ares == ASTARTE_RESULT_NOT_FOUND)
+            || ((ares == ASTARTE_RESULT_OK) && (record_size > 0))) {
+            ASTARTE_LOG_WRN("Dropping stored message %s, its ring slot is taken", key);
+            ares = astarte_key_value_iterator_delete(&iter);
+        }
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Failed checking message %s: %s", key, astarte_result_to_name(ares));
+            return ares;
+        }
+
+        ares = astarte_key_value_iterator_next(&iter);
+        if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+            ASTARTE_LOG_ERR("Iterator next error: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
+    return ASTARTE_RESULT_OK;
+}
+
+static void expiry_index_add(astarte_storage_data_t *handle, uint32_t position, uint64_t expiry)
+{
+    if ((position % EXPIRY_BUCKET_POSITIONS) != 0) {
+        handle->trans_expiry_tail = MAX(handle->trans_expiry_tail, expiry);
+        return;
+    }
+
+    // The previous bucket is complete, its entry is stored once
+    uint32_t bucket = EXPIRY_BUCKET((uint32_t) (position - 1));
+    uint8_t raw[EXPIRY_ENTRY_SIZE] = { 0 };
+    memcpy(raw, &bucket, sizeof(uint32_t));
+    memcpy(raw + sizeof(uint32_t), &handle->trans_expiry_tail, sizeof(uint64_t));
+    handle->trans_expiry_tail = expiry;
+
+    char key[EXPIRY_KEY_SIZE] = { 0 };
+    snprintf(key, sizeof(key), EXPIRY_KEY_FORMAT, bucket % EXPIRY_INDEX_ENTRIES);
+    astarte_result_t ares = astarte_key_value_insert(&handle->sync_storage, key, raw, sizeof(raw));
+    if (ares != ASTARTE_RESULT_OK) {
+        // A missing entry only keeps the messages of the bucket from being dropped
+        ASTARTE_LOG_WRN("Failed storing the expiry of bucket %u: %s", bucket,
+            astarte_result_to_name(ares));
+    }
+}
+
+static astarte_result_t expiry_index_get(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes, uint32_t bucket, uint64_t *expiry)
+{
+    if (bucket == EXPIRY_BUCKET(indexes->tail)) {
+        *expiry = handle->trans_expiry_tail;
+        return ASTARTE_RESULT_OK;
+    }
+    if (handle->trans_expiry_has_cached && (handle->trans_expiry_cached_bucket == bucket)) {
+        *expiry = handle->trans_expiry_cached;
+        return ASTARTE_RESULT_OK;
+    }
+
+    char key[EXPIRY_KEY_SIZE] = { 0 };
+    snprintf(key, sizeof(key), EXPIRY_KEY_FORMAT, bucket % EXPIRY_INDEX_ENTRIES);
+    uint8_t raw[EXPIRY_ENTRY_SIZE] = { 0 };
+    size_t raw_size = sizeof(raw);
+    astarte_result_t ares = astarte_key_value_find(&handle->sync_storage, key, raw, &raw_size);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
+    }
+
+    // Entries of other buckets sharing the key are left by previous rounds of the ring
+    uint32_t stored_bucket = 0;
+    memcpy(&stored_bucket, raw, sizeof(uint32_t));
+    *expiry = EXPIRY_NEVER;
+    if ((ares == ASTARTE_RESULT_OK) && (raw_size == sizeof(raw)) && (stored_bucket == bucket)) {
+        memcpy(expiry, raw + sizeof(uint32_t), sizeof(uint64_t));
+    }
+
+    handle->trans_expiry_cached = *expiry;
+    handle->trans_expiry_cached_bucket = bucket;
+    handle->trans_expiry_has_cached = true;
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t delete_position(
+    astarte_storage_data_t *handle, uint32_t position, size_t *record_size)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    read_ahead_evict(handle, position);
+#endif
+
+    *record_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_ring_delete(handle->trans_storage.backend, position, record_size);
+    if ((ares != ASTARTE_RESULT_OK) && (ares != ASTARTE_RESULT_NOT_FOUND)) {
+        return ares;
+    }
+    if ((ares == ASTARTE_RESULT_OK) && (*record_size > 0)) {
+        return ASTARTE_RESULT_OK;
+    }
+
+    // An empty record, or none after a power loss, leaves the message in the namespace
+    char key[MAX_UINT32_STR_LEN] = { 0 };
+    ares = encode_key(position, key);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
     }
     ares = astarte_key_value_delete(&handle->trans_storage, key);
+    return (ares == ASTARTE_RESULT_NOT_FOUND) ? ASTARTE_RESULT_OK : ares;
+}
+
+static void ring_usage_add(astarte_storage_data_t *handle, size_t record_size)
+{
+    handle->trans_ring_usage_bytes += record_size;
+}
+
+static void ring_usage_remove(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes, size_t record_size)
+{
+    handle->trans_ring_usage_bytes -= MIN(record_size, handle->trans_ring_usage_bytes);
+    if (indexes->head == (uint32_t) (indexes->tail + 1)) {
+        handle->trans_ring_usage_bytes = 0;
+    }
+}
+
+static astarte_result_t stored_msg_open(astarte_storage_data_t *handle, uint32_t position,
+    uint32_t index, struct stored_msg *stored)
+{
+    stored->handle = handle;
+
+    astarte_result_t ares = ASTARTE_RESULT_NOT_FOUND;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+    ares = read_ahead_open(handle, position, index, stored);
+    if (ares != ASTARTE_RESULT_NOT_FOUND) {
+        return ares;
+    }
+#endif
+
+    size_t record_size = 0;
+    ares = read_record(handle, position, &stored->record, &record_size, &stored->record_size);
     if (ares != ASTARTE_RESULT_OK) {
-        ASTARTE_LOG_ERR("Failed to delete fetched transmission storage entry");
         return ares;
     }
-    indexes->head++;
 
-    // Populate msg struct
-    msg->interface_name = local_msg.interface_name;
-    msg->path = local_msg.path;
-    msg->payload = local_msg.payload;
-    msg->payload_len = local_msg.payload_len;
-    msg->qos = local_msg.qos;
-    msg->timestamp = local_msg.timestamp;
-    msg->sequence_number = local_msg.sequence_number;
+    if (!stored->record) {
+        // The message is stored in the namespace, it is read one field at a time
+        if ((index != 0) && (index != LAST_PACKED_MSG)) {
+            ASTARTE_LOG_ERR("Corrupted storage: message %u of a single message entry", index);
+            return ASTARTE_RESULT_INTERNAL_ERROR;
+        }
+        stored->last = true;
+        ares = encode_key(position, stored->key);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+        return astarte_key_value_find(
+            &handle->trans_storage, stored->key, NULL, &stored->total_size);
+    }
 
-    // Disarm message cleanup
-    local_msg.interface_name = NULL;
-    local_msg.path = NULL;
-    local_msg.payload = NULL;
+    size_t offset = 0;
+    ares = find_packed_msg(stored->record, record_size, index, &offset, &stored->total_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    stored->msg = stored->record + offset;
+    stored->last = ((offset + stored->total_size) == record_size);
+    return ASTARTE_RESULT_OK;
+}
+
+static void stored_msg_close(struct stored_msg *stored)
+{
+    astarte_free(stored->record);
+    stored->record = NULL;
+}
+
+static astarte_result_t read_record(astarte_storage_data_t *handle, uint32_t position,
+    uint8_t **record, size_t *size, size_t *stored_size)
+{
+    size_t record_size = 0;
+    astarte_result_t ares
+        = astarte_key_value_ring_find(handle->trans_storage.backend, position, NULL, &record_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    *stored_size = record_size;
+    if (record_size == 0) {
+        *record = NULL;
+        *size = 0;
+        return ASTARTE_RESULT_OK;
+    }
+
+    uint8_t *content = astarte_malloc(record_size);
+    if (!content) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    size_t read_size = record_size;
+    ares = astarte_key_value_ring_find(
+        handle->trans_storage.backend, position, content, &read_size);
+    if ((ares == ASTARTE_RESULT_OK) && (read_size != record_size)) {
+        ASTARTE_LOG_ERR("Corrupted storage: record changed while being read");
+        ares = ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+    int marker = 0;
+    if (record_size >= COMPRESSED_RECORD_HEADER_SIZE) {
+        memcpy(&marker, content, sizeof(int));
+    }
+    if ((ares == ASTARTE_RESULT_OK) && (marker == COMPRESSED_RECORD_MARKER)) {
+        ares = decompress_record(&content, &record_size);
+    }
+#endif
+    if (ares != ASTARTE_RESULT_OK) {
+        astarte_free(content);
+        return ares;
+    }
 
+    *record = content;
+    *size = record_size;
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_storage_transmission_discard(
-    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
+static astarte_result_t find_packed_msg(const uint8_t *record, size_t record_size, uint32_t index,
+    size_t *offset, size_t *msg_size)
 {
-    if (!handle || !handle->initialized || !indexes) {
-        ASTARTE_LOG_ERR("NULL parameters provided");
-        return ASTARTE_RESULT_INVALID_PARAM;
+    size_t start = 0;
+    for (uint32_t i = 0; (record_size - start) >= MSG_STATIC_FIELDS_SIZE; i++) {
+        size_t interface_name_len = 0;
+        size_t path_len = 0;
+        int payload_len = 0;
+        const uint8_t *lengths = record + start + MSG_LENGTHS_OFFSET;
+        memcpy(&interface_name_len, lengths, sizeof(size_t));
+        memcpy(&path_len, lengths + sizeof(size_t), sizeof(size_t));
+        memcpy(&payload_len, lengths + (2 * sizeof(size_t)), sizeof(int));
+
+        size_t available = record_size - start - MSG_STATIC_FIELDS_SIZE;
+        if ((payload_len < 0) || (interface_name_len > available)
+            || (path_len > available - interface_name_len)
+            || ((size_t) payload_len > available - interface_name_len - path_len)) {
+            break;
+        }
+
+        size_t size = MSG_STATIC_FIELDS_SIZE + interface_name_len + path_len + payload_len;
+        if ((i == index) || ((index == LAST_PACKED_MSG) && (start + size == record_size))) {
+            *offset = start;
+            *msg_size = size;
+            return ASTARTE_RESULT_OK;
+        }
+        start += size;
     }
 
-    astarte_result_t ares = ASTARTE_RESULT_OK;
-    char key[MAX_UINT32_STR_LEN] = { 0 };
+    ASTARTE_LOG_ERR("Corrupted storage: message %u not found in its record", index);
+    return ASTARTE_RESULT_INTERNAL_ERROR;
+}
 
-    // Keys are stored as zero-padded 10-digit strings
-    int snprintf_rc = snprintf(key, sizeof(key), "%010u", indexes->head);
-    if (snprintf_rc != MAX_UINT32_STR_LEN - 1) {
-        ASTARTE_LOG_ERR("Error encoding key into string");
-        return ASTARTE_RESULT_INTERNAL_ERROR;
+static void serialize_fields(const struct msg_field *fields, size_t fields_count, uint8_t *buffer)
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < fields_count; i++) {
+        if (fields[i].size > 0) {
+            memcpy(buffer + offset, fields[i].data, fields[i].size);
+            offset += fields[i].size;
+        }
     }
+}
 
-    ares = astarte_key_value_delete(&handle->trans_storage, key);
+static astarte_result_t write_ring_record(astarte_storage_data_t *handle, uint32_t position,
+    const uint8_t *record, size_t record_size, size_t *stored_size)
+{
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+    uint8_t *compressed = NULL;
+    size_t compressed_size = 0;
+    astarte_result_t ares = compress_record(record, record_size, &compressed, &compressed_size);
     if (ares == ASTARTE_RESULT_OK) {
-        indexes->head++;
-    } else {
-        ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND,
-            "Failed to discard transmission storage entry: %s", astarte_result_to_name(ares));
+        ares = astarte_key_value_ring_insert(
+            handle->trans_storage.backend, position, compressed, compressed_size);
+        astarte_free(compressed);
+        *stored_size = compressed_size;
+        return ares;
     }
+    // Records that would not shrink are stored raw, as they are when compression fails
+    ASTARTE_LOG_COND_ERR(ares != ASTARTE_RESULT_NOT_FOUND, "Compression failed: %s",
+        astarte_result_to_name(ares));
+#endif
+
+    *stored_size = record_size;
+    return astarte_key_value_ring_insert(
+        handle->trans_storage.backend, position, record, record_size);
+}
 
-    return ares;
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+static astarte_result_t compress_record(const uint8_t *record, size_t record_size,
+    uint8_t **compressed, size_t *compressed_size)
+{
+    if ((record_size <= COMPRESSED_RECORD_HEADER_SIZE) || (record_size > UINT32_MAX)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    // Room for a compressed record strictly smaller than the raw one, larger outputs are useless
+    scope_var(scoped_uint8, buffer)(record_size - 1);
+    if (!buffer) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    z_stream stream = { .zalloc = compression_alloc, .zfree = compression_free };
+    int ret = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -COMPRESSION_WINDOW_BITS,
+        COMPRESSION_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) {
+        ASTARTE_LOG_ERR("Failed initializing the compression: %d", ret);
+        return (ret == Z_MEM_ERROR) ? ASTARTE_RESULT_OUT_OF_MEMORY : ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    stream.next_in = (Bytef *) record;
+    stream.avail_in = (uInt) record_size;
+    stream.next_out = buffer + COMPRESSED_RECORD_HEADER_SIZE;
+    stream.avail_out = (uInt) (record_size - 1 - COMPRESSED_RECORD_HEADER_SIZE);
+    ret = deflate(&stream, Z_FINISH);
+    size_t size = COMPRESSED_RECORD_HEADER_SIZE + stream.total_out;
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+        // The output buffer is full before the end of the stream, the record does not shrink
+        return (ret == Z_OK || ret == Z_BUF_ERROR) ? ASTARTE_RESULT_NOT_FOUND
+                                                   : ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+
+    int marker = COMPRESSED_RECORD_MARKER;
+    uint32_t raw_size = (uint32_t) record_size;
+    memcpy(buffer, &marker, sizeof(int));
+    memcpy(buffer + sizeof(int), &raw_size, sizeof(uint32_t));
+
+    *compressed = buffer;
+    *compressed_size = size;
+    // Ownership is transferred to the caller
+    buffer = NULL;
+    return ASTARTE_RESULT_OK;
 }
 
-void astarte_storage_transmission_msg_cleanup(struct astarte_storage_transmission_msg *msg)
+static astarte_result_t decompress_record(uint8_t **record, size_t *record_size)
 {
-    if (!msg) {
+    uint32_t raw_size = 0;
+    memcpy(&raw_size, *record + sizeof(int), sizeof(uint32_t));
+    if (raw_size < MSG_STATIC_FIELDS_SIZE) {
+        ASTARTE_LOG_ERR("Corrupted storage: compressed record of %u bytes", raw_size);
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+
+    uint8_t *raw = astarte_malloc(raw_size);
+    if (!raw) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+
+    // The whole record is inflated by a single call, no window has to be allocated
+    z_stream stream = { .zalloc = compression_alloc, .zfree = compression_free };
+    int ret = inflateInit2(&stream, -DECOMPRESSION_WINDOW_BITS);
+    if (ret != Z_OK) {
+        ASTARTE_LOG_ERR("Failed initializing the decompression: %d", ret);
+        astarte_free(raw);
+        return (ret == Z_MEM_ERROR) ? ASTARTE_RESULT_OUT_OF_MEMORY : ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    stream.next_in = *record + COMPRESSED_RECORD_HEADER_SIZE;
+    stream.avail_in = (uInt) (*record_size - COMPRESSED_RECORD_HEADER_SIZE);
+    stream.next_out = raw;
+    stream.avail_out = raw_size;
+    ret = inflate(&stream, Z_FINISH);
+    size_t size = stream.total_out;
+    inflateEnd(&stream);
+    if ((ret != Z_STREAM_END) || (size != raw_size)) {
+        ASTARTE_LOG_ERR("Corrupted storage: decompression failed with %d", ret);
+        astarte_free(raw);
+        return (ret == Z_MEM_ERROR) ? ASTARTE_RESULT_OUT_OF_MEMORY : ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+
+    astarte_free(*record);
+    *record = raw;
+    *record_size = raw_size;
+    return ASTARTE_RESULT_OK;
+}
+
+static voidpf compression_alloc(voidpf opaque, uInt items, uInt size)
+{
+    ARG_UNUSED(opaque);
+    return astarte_calloc(items, size);
+}
+
+static void compression_free(voidpf opaque, voidpf address)
+{
+    ARG_UNUSED(opaque);
+    astarte_free(address);
+}
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+static astarte_result_t pack_lock(astarte_storage_transmission_pack_t *pack)
+{
+    int mutex_rc = sys_mutex_lock(&pack->mutex, K_MSEC(PACK_MUTEX_LOCK_TIMEOUT_MS));
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission pack lock failed with %d", mutex_rc);
+    return (mutex_rc != 0) ? ASTARTE_RESULT_MUTEX_LOCK_ERROR : ASTARTE_RESULT_OK;
+}
+
+static void pack_unlock(astarte_storage_transmission_pack_t *pack)
+{
+    int mutex_rc = sys_mutex_unlock(&pack->mutex);
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission pack unlock failed with %d", mutex_rc);
+}
+
+static astarte_result_t push_packed(astarte_storage_data_t *handle,
+    astarte_storage_transmission_indexes_t *indexes, const struct msg_field *fields,
+    size_t fields_count, size_t msg_size, const struct astarte_storage_transmission_msg *msg,
+    uint64_t expiry)
+{
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+    astarte_result_t ares = pack_lock(pack);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(pack_unlock)(pack);
+
+    if (pack->size + msg_size > sizeof(pack->buffer)) {
+        ares = write_pack(handle, indexes);
+        if (ares != ASTARTE_RESULT_OK) {
+            ASTARTE_LOG_ERR("Error writing packed entries: %s", astarte_result_to_name(ares));
+            return ares;
+        }
+    }
+
+    if (pack->count == 0) {
+        pack->deadline = sys_timepoint_calc(K_MSEC(PACK_TIMEOUT_MS));
+        pack->expiry_timestamp = 0;
+    }
+    serialize_fields(fields, fields_count, pack->buffer + pack->size);
+    pack->size += msg_size;
+    pack->count++;
+    pack->sequence_number = msg->sequence_number;
+    pack->expiry_timestamp = MAX(pack->expiry_timestamp, expiry);
+
+    // A pack that can't take any other message is written right away
+    if (sizeof(pack->buffer) - pack->size < MSG_STATIC_FIELDS_SIZE) {
+        ares = write_pack(handle, indexes);
+        if (ares != ASTARTE_RESULT_OK) {
+            // The message is kept in the pack, the write is attempted again by the next push
+            ASTARTE_LOG_WRN("Error writing packed entries: %s", astarte_result_to_name(ares));
+        }
+    }
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t write_pack(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
+{
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+
+    // With no record in flash the head is in the pack, the messages already discarded are skipped
+    bool empty = (indexes->head == (uint32_t) (indexes->tail + 1));
+    uint32_t skipped = empty ? indexes->head_offset : 0;
+    if (skipped >= pack->count) {
+        pack->size = 0;
+        pack->count = 0;
+        indexes->head_offset = 0;
+        return ASTARTE_RESULT_OK;
+    }
+    size_t start = 0;
+    if (skipped > 0) {
+        size_t msg_size = 0;
+        astarte_result_t ares
+            = find_packed_msg(pack->buffer, pack->size, skipped, &start, &msg_size);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
+    }
+
+    uint32_t position = indexes->tail + 1;
+    if ((uint32_t) (position - indexes->head) >= ASTARTE_KEY_VALUE_RING_SLOTS) {
+        ASTARTE_LOG_WRN("Transmission ring is full.");
+        return ASTARTE_RESULT_OUT_OF_SPACE;
+    }
+
+    size_t stored_size = 0;
+    astarte_result_t ares = write_ring_record(
+        handle, position, pack->buffer + start, pack->size - start, &stored_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error inserting entry: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+    ring_usage_add(handle, stored_size);
+
+    indexes->tail++;
+    if (empty) {
+        indexes->head_offset = 0;
+    }
+    handle->trans_tail_sequence_number = pack->sequence_number;
+    expiry_index_add(handle, indexes->tail, pack->expiry_timestamp);
+    pack->size = 0;
+    pack->count = 0;
+    refresh_checkpoint(handle, indexes);
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t stored_msg_open_packed(astarte_storage_data_t *handle,
+    const astarte_storage_transmission_indexes_t *indexes, struct stored_msg *stored)
+{
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+    astarte_result_t ares = pack_lock(pack);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(pack_unlock)(pack);
+
+    if ((indexes->head != (uint32_t) (indexes->tail + 1))
+        || (indexes->head_offset >= pack->count)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    size_t offset = 0;
+    size_t msg_size = 0;
+    ares = find_packed_msg(pack->buffer, pack->size, indexes->head_offset, &offset, &msg_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // The message is copied, the pack can be written by another thread once unlocked
+    stored->handle = handle;
+    stored->record = astarte_malloc(msg_size);
+    if (!stored->record) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    memcpy(stored->record, pack->buffer + offset, msg_size);
+    stored->record_size = msg_size;
+    stored->msg = stored->record;
+    stored->total_size = msg_size;
+    stored->last = ((indexes->head_offset + 1) == pack->count);
+    return ASTARTE_RESULT_OK;
+}
+
+static astarte_result_t discard_packed(
+    astarte_storage_data_t *handle, astarte_storage_transmission_indexes_t *indexes)
+{
+    astarte_storage_transmission_pack_t *pack = &handle->trans_pack;
+    astarte_result_t ares = pack_lock(pack);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(pack_unlock)(pack);
+
+    if ((indexes->head != (uint32_t) (indexes->tail + 1))
+        || (indexes->head_offset >= pack->count)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    // Messages discarded before the pack is written never reach flash
+    indexes->head_offset++;
+    if (indexes->head_offset == pack->count) {
+        pack->size = 0;
+        pack->count = 0;
+        indexes->head_offset = 0;
+    }
+    return ASTARTE_RESULT_OK;
+}
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+static astarte_result_t read_ahead_lock(astarte_storage_transmission_read_ahead_t *read_ahead)
+{
+    int mutex_rc = sys_mutex_lock(&read_ahead->mutex, K_MSEC(READ_AHEAD_MUTEX_LOCK_TIMEOUT_MS));
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission read ahead lock failed with %d", mutex_rc);
+    return (mutex_rc != 0) ? ASTARTE_RESULT_MUTEX_LOCK_ERROR : ASTARTE_RESULT_OK;
+}
+
+static void read_ahead_unlock(astarte_storage_transmission_read_ahead_t *read_ahead)
+{
+    int mutex_rc = sys_mutex_unlock(&read_ahead->mutex);
+    ASTARTE_LOG_COND_ERR(mutex_rc != 0, "Transmission read ahead unlock failed with %d", mutex_rc);
+}
+
+static void read_ahead_fill(
+    astarte_storage_data_t *handle, const astarte_storage_transmission_indexes_t *indexes)
+{
+    astarte_storage_transmission_read_ahead_t *read_ahead = &handle->trans_read_ahead;
+    if (read_ahead_lock(read_ahead) != ASTARTE_RESULT_OK) {
         return;
     }
-    astarte_free(msg->interface_name);
-    msg->interface_name = NULL;
-    astarte_free(msg->path);
-    msg->path = NULL;
-    astarte_free(msg->payload);
-    msg->payload = NULL;
+    scope_defer(read_ahead_unlock)(read_ahead);
+
+    // Messages still in the pack come after the tail, only records in flash are read
+    uint32_t queued = indexes->tail + 1 - indexes->head;
+    for (uint32_t i = 0; i < MIN(queued, READ_AHEAD_RECORDS); i++) {
+        uint32_t position = indexes->head + i;
+        astarte_storage_transmission_read_ahead_entry_t *entry
+            = &read_ahead->entries[position % READ_AHEAD_RECORDS];
+        if (entry->record && (entry->position == position)) {
+            continue;
+        }
+        // Entries are evicted when discarded, a stale one belongs to an older queue
+        astarte_free(entry->record);
+        entry->record = NULL;
+
+        astarte_result_t ares = read_record(
+            handle, position, &entry->record, &entry->size, &entry->stored_size);
+        if ((ares != ASTARTE_RESULT_OK) || !entry->record) {
+            // Messages in the namespace are left out, bounding the RAM to records of a chunk
+            entry->record = NULL;
+            return;
+        }
+        entry->position = position;
+    }
 }
 
-/************************************************
- *         Static functions definitions         *
- ***********************************************/
+static astarte_result_t read_ahead_open(astarte_storage_data_t *handle, uint32_t position,
+    uint32_t index, struct stored_msg *stored)
+{
+    astarte_storage_transmission_read_ahead_t *read_ahead = &handle->trans_read_ahead;
+    astarte_result_t ares = read_ahead_lock(read_ahead);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+    scope_defer(read_ahead_unlock)(read_ahead);
+
+    const astarte_storage_transmission_read_ahead_entry_t *entry
+        = &read_ahead->entries[position % READ_AHEAD_RECORDS];
+    if (!entry->record || (entry->position != position)) {
+        return ASTARTE_RESULT_NOT_FOUND;
+    }
+
+    size_t offset = 0;
+    size_t msg_size = 0;
+    ares = find_packed_msg(entry->record, entry->size, index, &offset, &msg_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        return ares;
+    }
+
+    // The message is copied, the entry can be evicted by another thread once unlocked
+    stored->record = astarte_malloc(msg_size);
+    if (!stored->record) {
+        ASTARTE_LOG_ERR("Out of memory %s: %d", __FILE__, __LINE__);
+        return ASTARTE_RESULT_OUT_OF_MEMORY;
+    }
+    memcpy(stored->record, entry->record + offset, msg_size);
+    stored->record_size = entry->stored_size;
+    stored->msg = stored->record;
+    stored->total_size = msg_size;
+    stored->last = ((offset + msg_size) == entry->size);
+    return ASTARTE_RESULT_OK;
+}
+
+static void read_ahead_evict(astarte_storage_data_t *handle, uint32_t position)
+{
+    astarte_storage_transmission_read_ahead_t *read_ahead = &handle->trans_read_ahead;
+    if (read_ahead_lock(read_ahead) != ASTARTE_RESULT_OK) {
+        return;
+    }
+    astarte_storage_transmission_read_ahead_entry_t *entry
+        = &read_ahead->entries[position % READ_AHEAD_RECORDS];
+    if (entry->position == position) {
+        astarte_free(entry->record);
+        entry->record = NULL;
+    }
+    read_ahead_unlock(read_ahead);
+}
+#endif
+
+static astarte_result_t append_field(
+    astarte_key_value_writer_t *writer, const void *field, size_t field_size)
+{
+    if (field_size == 0) {
+        return ASTARTE_RESULT_OK;
+    }
+    return astarte_key_value_writer_append(writer, field, field_size);
+}
+
+static astarte_result_t read_field(
+    struct stored_msg *stored, size_t *offset, void *field, size_t field_size)
+{
+    if (stored->record) {
+        if ((field_size > stored->total_size) || (*offset > stored->total_size - field_size)) {
+            ASTARTE_LOG_ERR("Corrupted storage: field bounds exceeded");
+            return ASTARTE_RESULT_INTERNAL_ERROR;
+        }
+        memcpy(field, stored->msg + *offset, field_size);
+        *offset += field_size;
+        return ASTARTE_RESULT_OK;
+    }
+
+    size_t read_size = field_size;
+    size_t total_size = 0;
+    astarte_result_t ares = astarte_key_value_read(&stored->handle->trans_storage, stored->key,
+        *offset, field, &read_size, &total_size);
+    if (ares != ASTARTE_RESULT_OK) {
+        ASTARTE_LOG_ERR("Error finding entry: %s", astarte_result_to_name(ares));
+        return ares;
+    }
+    if (read_size != field_size) {
+        ASTARTE_LOG_ERR("Corrupted storage: field changed while being read");
+        return ASTARTE_RESULT_INTERNAL_ERROR;
+    }
+    *offset += field_size;
+    return ASTARTE_RESULT_OK;
+}
 
-static astarte_result_t extract_string(
-    const uint8_t *buffer, size_t buffer_size, size_t *offset, size_t str_len, char **out_str)
+static astarte_result_t read_string(
+    struct stored_msg *stored, size_t *offset, size_t str_len, char **out_str)
 {
-    if (*offset + str_len > buffer_size) {
+    size_t total_size = stored->total_size;
+    if ((str_len > total_size) || (*offset > total_size - str_len)) {
         ASTARTE_LOG_ERR("Corrupted storage: string bounds exceeded");
         return ASTARTE_RESULT_INTERNAL_ERROR;
     }
@@ -500,8 +2108,10 @@ static astarte_result_t extract_string(
     }
 
     if (str_len > 0) {
-        memcpy(*out_str, buffer + *offset, str_len);
-        *offset += str_len;
+        astarte_result_t ares = read_field(stored, offset, *out_str, str_len);
+        if (ares != ASTARTE_RESULT_OK) {
+            return ares;
+        }
     }
 
     (*out_str)[str_len] = '\0';
@@ -509,8 +2119,8 @@ static astarte_result_t extract_string(
     return ASTARTE_RESULT_OK;
 }
 
-static astarte_result_t extract_payload(
-    const uint8_t *buffer, size_t buffer_size, size_t *offset, int payload_len, void **out_payload)
+static astarte_result_t read_payload(
+    struct stored_msg *stored, size_t *offset, int payload_len, void **out_payload)
 {
     if (payload_len < 0) {
         ASTARTE_LOG_ERR("Corrupted storage: payload length is negative");
@@ -522,7 +2132,8 @@ static astarte_result_t extract_payload(
         return ASTARTE_RESULT_OK;
     }
 
-    if (*offset + payload_len > buffer_size) {
+    size_t total_size = stored->total_size;
+    if (((size_t) payload_len > total_size) || (*offset > total_size - payload_len)) {
         ASTARTE_LOG_ERR("Corrupted storage: payload bounds exceeded");
         return ASTARTE_RESULT_INTERNAL_ERROR;
     }
@@ -533,8 +2144,5 @@ static astarte_result_t extract_payload(
         return ASTARTE_RESULT_OUT_OF_MEMORY;
     }
 
-    memcpy(*out_payload, buffer + *offset, payload_len);
-    *offset += payload_len;
-
-    return ASTARTE_RESULT_OK;
+    return read_field(stored, offset, *out_payload, payload_len);
 }
@@ -19,10 +19,11 @@ ASTARTE_LOG_MODULE_REGISTER(
  *         Global functions definitions         *
  ***********************************************/
 
-astarte_result_t astarte_tls_credential_add(astarte_tls_credentials_client_crt_t *client_crt)
+astarte_result_t astarte_tls_credential_add(
+    sec_tag_t sec_tag, astarte_tls_credentials_client_crt_t *client_crt)
 {
-    int tls_rc = tls_credential_add(CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG,
-        TLS_CREDENTIAL_SERVER_CERTIFICATE, client_crt->crt_pem, strlen(client_crt->crt_pem) + 1);
+    int tls_rc = tls_credential_add(sec_tag, TLS_CREDENTIAL_SERVER_CERTIFICATE,
+        client_crt->crt_pem, strlen(client_crt->crt_pem) + 1);
     if (tls_rc != 0) {
         ASTARTE_LOG_ERR("Failed adding client crt to credentials %d.", tls_rc);
         psa_status_t psa_ret = psa_destroy_key(client_crt->privkey);
@@ -35,12 +36,11 @@ astarte_result_t astarte_tls_credential_add(astarte_tls_credentials_client_crt_t
         return ASTARTE_RESULT_TLS_ERROR;
     }
 
-    tls_rc = tls_credential_add(CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG,
-        TLS_CREDENTIAL_PRIVATE_KEY, client_crt->privkey_pem, strlen(client_crt->privkey_pem) + 1);
+    tls_rc = tls_credential_add(sec_tag, TLS_CREDENTIAL_PRIVATE_KEY, client_crt->privkey_pem,
+        strlen(client_crt->privkey_pem) + 1);
     if (tls_rc != 0) {
         ASTARTE_LOG_ERR("Failed adding client private key to credentials %d.", tls_rc);
-        tls_credential_delete(
-            CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG, TLS_CREDENTIAL_SERVER_CERTIFICATE);
+        tls_credential_delete(sec_tag, TLS_CREDENTIAL_SERVER_CERTIFICATE);
         psa_status_t psa_ret = psa_destroy_key(client_crt->privkey);
         if (psa_ret != PSA_SUCCESS) {
             ASTARTE_LOG_ERR("psa_destroy_key returned %d", psa_ret);
@@ -54,17 +54,15 @@ astarte_result_t astarte_tls_credential_add(astarte_tls_credentials_client_crt_t
     return ASTARTE_RESULT_OK;
 }
 
-astarte_result_t astarte_tls_credential_delete(void)
+astarte_result_t astarte_tls_credential_delete(sec_tag_t sec_tag)
 {
-    int tls_rc = tls_credential_delete(
-        CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG, TLS_CREDENTIAL_SERVER_CERTIFICATE);
+    int tls_rc = tls_credential_delete(sec_tag, TLS_CREDENTIAL_SERVER_CERTIFICATE);
     if ((tls_rc != 0) && (tls_rc != -ENOENT)) {
         ASTARTE_LOG_ERR("Failed removing the client certificate from credentials %d.", tls_rc);
         return ASTARTE_RESULT_TLS_ERROR;
     }
 
-    tls_rc = tls_credential_delete(
-        CONFIG_ASTARTE_DEVICE_SDK_CLIENT_CERT_TAG, TLS_CREDENTIAL_PRIVATE_KEY);
+    tls_rc = tls_credential_delete(sec_tag, TLS_CREDENTIAL_PRIVATE_KEY);
     if ((tls_rc != 0) && (tls_rc != -ENOENT)) {
         ASTARTE_LOG_ERR("Failed removing the client private key from credentials %d.", tls_rc);
         return ASTARTE_RESULT_TLS_ERROR;
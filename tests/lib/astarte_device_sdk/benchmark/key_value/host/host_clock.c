@@ -0,0 +1,17 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Built in the context of the native simulator runner, it has access to the host C library
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t benchmark_host_time_us(void)
+{
+    struct timespec now = { 0 };
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000U) + ((uint64_t) now.tv_nsec / 1000U);
+}
@@ -0,0 +1,266 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/drivers/flash.h>
+#include <zephyr/stats/stats.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+
+#include "astarte_device_sdk/result.h"
+
+#include "alloc.h"
+#include "key_value/core.h"
+
+#define ZMS_PARTITION key_value_partition
+#define ZMS_PARTITION_DEVICE PARTITION_DEVICE(ZMS_PARTITION)
+#define ZMS_PARTITION_OFFSET PARTITION_OFFSET(ZMS_PARTITION)
+#define ZMS_PARTITION_SIZE PARTITION_SIZE(ZMS_PARTITION)
+
+#define BENCHMARK_NAMESPACE "bench_ns"
+#define BENCHMARK_KEY_SIZE sizeof("key_00000")
+
+struct astarte_device_sdk_key_value_benchmark_fixture
+{
+    const struct device *flash_device;
+    off_t flash_offset;
+    uint16_t flash_sector_size;
+    uint16_t flash_sector_count;
+    uint64_t flash_partition_size;
+};
+
+/** @brief Counters of the flash simulator accumulated since boot. */
+struct flash_counters
+{
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+    uint32_t erase_calls;
+};
+
+/** @brief Snapshot of the clock and flash counters taken at the start of a phase. */
+struct phase_start
+{
+    uint64_t time_us;
+    struct flash_counters counters;
+};
+
+#ifdef CONFIG_ARCH_POSIX
+// Defined in host/host_clock.c
+uint64_t benchmark_host_time_us(void);
+#endif
+
+static void *astarte_storage_key_value_benchmark_setup(void)
+{
+    struct flash_pages_info fp_info;
+    const struct device *device = ZMS_PARTITION_DEVICE;
+    off_t offset = ZMS_PARTITION_OFFSET;
+    zassert(device_is_ready(device), "Flash device is not ready.");
+    zassert_equal(flash_get_page_info_by_offs(device, offset, &fp_info), 0, "Can't get page info.");
+
+    struct astarte_device_sdk_key_value_benchmark_fixture *fixture
+        = astarte_calloc(1, sizeof(struct astarte_device_sdk_key_value_benchmark_fixture));
+    zassert_not_null(fixture, "Failed allocating test fixture");
+
+    fixture->flash_device = ZMS_PARTITION_DEVICE;
+    fixture->flash_offset = ZMS_PARTITION_OFFSET;
+    fixture->flash_sector_count = ZMS_PARTITION_SIZE / fp_info.size;
+    fixture->flash_sector_size = fp_info.size;
+    fixture->flash_partition_size = ZMS_PARTITION_SIZE;
+
+    return fixture;
+}
+
+static void astarte_storage_key_value_benchmark_before(void *f)
+{
+    struct astarte_device_sdk_key_value_benchmark_fixture *fixture
+        = (struct astarte_device_sdk_key_value_benchmark_fixture *) f;
+
+    struct zms_fs zms_fs = { 0 };
+    zms_fs.flash_device = fixture->flash_device;
+    zms_fs.offset = fixture->flash_offset;
+    zms_fs.sector_size = fixture->flash_sector_size;
+    zms_fs.sector_count = fixture->flash_sector_count;
+
+    zassert_equal(zms_mount(&zms_fs), 0, "ZMS mounting failed.");
+    zassert_equal(zms_clear(&zms_fs), 0, "ZMS clear failed.");
+}
+
+static void astarte_storage_key_value_benchmark_teardown(void *f)
+{
+    struct astarte_device_sdk_key_value_benchmark_fixture *fixture
+        = (struct astarte_device_sdk_key_value_benchmark_fixture *) f;
+
+    astarte_free(fixture);
+}
+
+ZTEST_SUITE(astarte_device_sdk_key_value_benchmark, NULL,
+    astarte_storage_key_value_benchmark_setup, astarte_storage_key_value_benchmark_before, NULL,
+    astarte_storage_key_value_benchmark_teardown);
+
+static uint64_t now_us(void)
+{
+#ifdef CONFIG_ARCH_POSIX
+    return benchmark_host_time_us();
+#else
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+#endif
+}
+
+static int read_flash_counter(struct stats_hdr *hdr, void *arg, const char *name, uint16_t off)
+{
+    struct flash_counters *counters = (struct flash_counters *) arg;
+    uint32_t value = *(uint32_t *) ((uint8_t *) hdr + off);
+
+    if (strcmp(name, "bytes_read") == 0) {
+        counters->bytes_read = value;
+    } else if (strcmp(name, "bytes_written") == 0) {
+        counters->bytes_written = value;
+    } else if (strcmp(name, "flash_erase_calls") == 0) {
+        counters->erase_calls = value;
+    }
+    return 0;
+}
+
+static struct flash_counters read_flash_counters(void)
+{
+    struct flash_counters counters = { 0 };
+    struct stats_hdr *hdr = stats_group_find("flash_sim_stats");
+    zassert_not_null(hdr, "Flash simulator statistics not found");
+    zassert_equal(stats_walk(hdr, read_flash_counter, &counters), 0);
+    return counters;
+}
+
+static struct phase_start phase_begin(void)
+{
+    struct phase_start start = {
+        .counters = read_flash_counters(),
+        .time_us = now_us(),
+    };
+    return start;
+}
+
+static void phase_end(const char *phase, size_t entries, size_t ops, struct phase_start start)
+{
+    uint64_t elapsed_us = now_us() - start.time_us;
+    struct flash_counters end = read_flash_counters();
+    // The counters are 32 bits wide, unsigned subtraction handles a single wrap around
+    uint32_t bytes_read = end.bytes_read - start.counters.bytes_read;
+    uint32_t bytes_written = end.bytes_written - start.counters.bytes_written;
+    uint32_t erases = end.erase_calls - start.counters.erase_calls;
+
+    uint32_t ops_per_sec = (elapsed_us > 0) ? (uint32_t) ((ops * 1000000ULL) / elapsed_us) : 0;
+    TC_PRINT("| %-8s | %7zu | %10u | %12u | %15u | %6u |\n", phase, entries, ops_per_sec,
+        (uint32_t) (bytes_read / ops), (uint32_t) (bytes_written / ops), erases);
+}
+
+static void format_key(char key[BENCHMARK_KEY_SIZE], size_t i)
+{
+    snprintf(key, BENCHMARK_KEY_SIZE, "key_%05zu", i);
+}
+
+static void run_benchmark(
+    struct astarte_device_sdk_key_value_benchmark_fixture *fixture, size_t entries)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    char key[BENCHMARK_KEY_SIZE] = { 0 };
+    uint32_t value = 0;
+    size_t value_size = 0;
+    struct phase_start start = { 0 };
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_new(&backend, BENCHMARK_NAMESPACE, 0, &key_value), ASTARTE_RESULT_OK);
+
+    TC_PRINT("| phase    | entries |    ops/sec | read B/op    | written B/op    | erases |\n");
+
+    start = phase_begin();
+    for (size_t i = 0; i < entries; i++) {
+        format_key(key, i);
+        value = (uint32_t) i;
+        zassert_equal(astarte_key_value_insert(&key_value, key, &value, sizeof(value)),
+            ASTARTE_RESULT_OK, "Insert failed at entry %zu", i);
+    }
+    phase_end("insert", entries, entries, start);
+
+    start = phase_begin();
+    for (size_t i = 0; i < entries; i++) {
+        format_key(key, i);
+        value_size = sizeof(value);
+        zassert_equal(astarte_key_value_find(&key_value, key, &value, &value_size),
+            ASTARTE_RESULT_OK, "Find failed at entry %zu", i);
+        zassert_equal(value, i);
+    }
+    phase_end("find", entries, entries, start);
+
+    start = phase_begin();
+    for (size_t i = 0; i < entries; i++) {
+        format_key(key, i);
+        value = (uint32_t) (i + entries);
+        zassert_equal(astarte_key_value_insert(&key_value, key, &value, sizeof(value)),
+            ASTARTE_RESULT_OK, "Update failed at entry %zu", i);
+    }
+    phase_end("update", entries, entries, start);
+
+    start = phase_begin();
+    astarte_key_value_iter_t iter = { 0 };
+    size_t iterated = 0;
+    astarte_result_t ares = astarte_key_value_iterator_init(&key_value, &iter);
+    while (ares == ASTARTE_RESULT_OK) {
+        size_t key_size = sizeof(key);
+        zassert_equal(astarte_key_value_iterator_get(&iter, key, &key_size), ASTARTE_RESULT_OK);
+        iterated++;
+        ares = astarte_key_value_iterator_next(&iter);
+    }
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND);
+    zassert_equal(iterated, entries, "Iterated %zu entries out of %zu", iterated, entries);
+    phase_end("iterate", entries, entries, start);
+
+    start = phase_begin();
+    for (size_t i = 0; i < entries; i++) {
+        format_key(key, i);
+        zassert_equal(astarte_key_value_delete(&key_value, key), ASTARTE_RESULT_OK,
+            "Delete failed at entry %zu", i);
+    }
+    phase_end("delete", entries, entries, start);
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    start = phase_begin();
+    size_t steps = 0;
+    do {
+        ares = astarte_key_value_compact(&backend);
+        steps++;
+    } while (ares == ASTARTE_RESULT_OK);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Compaction failed");
+    phase_end("compact", entries, steps, start);
+#endif
+
+    astarte_key_value_destroy(&key_value);
+}
+
+ZTEST_F(astarte_device_sdk_key_value_benchmark, test_key_value_benchmark_100)
+{
+    run_benchmark(fixture, 100);
+}
+
+ZTEST_F(astarte_device_sdk_key_value_benchmark, test_key_value_benchmark_1000)
+{
+    run_benchmark(fixture, 1000);
+}
+
+ZTEST_F(astarte_device_sdk_key_value_benchmark, test_key_value_benchmark_10000)
+{
+    run_benchmark(fixture, 10000);
+}
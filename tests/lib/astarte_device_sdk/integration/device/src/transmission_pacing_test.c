@@ -0,0 +1,167 @@
+/*
+ * (C) Copyright 2026, SECO Mind Srl
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "device/transmission_pacing.h"
+#include "mqtt/caching.h"
+#include "mqtt/events.h"
+
+#include "alloc.h"
+
+#define TEST_TOKEN_PERIOD_MS 60000
+
+// Define a fixture for the transmission pacing tests
+struct astarte_transmission_pacing_fixture
+{
+    struct astarte_device_transmission_pacing pacing;
+    astarte_mqtt_t astarte_mqtt;
+    astarte_storage_data_t storage;
+};
+
+static astarte_result_t refresh_client_cert(astarte_mqtt_t *astarte_mqtt)
+{
+    (void) astarte_mqtt;
+    return ASTARTE_RESULT_OK;
+}
+
+static void init_mqtt(struct astarte_transmission_pacing_fixture *fixture, uint32_t window)
+{
+    astarte_mqtt_config_t cfg = {
+        .refresh_client_cert_cbk = refresh_client_cert,
+        .in_flight_window = window,
+        .storage = &fixture->storage,
+    };
+    astarte_result_t ares = astarte_mqtt_init(&cfg, &fixture->astarte_mqtt);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "MQTT init failed: %s", astarte_result_to_name(ares));
+}
+
+// Mimic the caching of a publish or subscription transmitted by the MQTT client
+static void send_packet(struct astarte_transmission_pacing_fixture *fixture, uint16_t message_id,
+    enum astarte_storage_mqtt_message_type type)
+{
+    astarte_storage_mqtt_message_t message
+        = { .type = type, .topic = "test/pacing", .data = NULL, .data_size = 0, .qos = 1 };
+    astarte_mqtt_caching_insert_message(&fixture->astarte_mqtt.out_msgs, message_id, message);
+}
+
+static void *astarte_transmission_pacing_test_setup(void)
+{
+    struct astarte_transmission_pacing_fixture *fixture
+        = astarte_calloc(1, sizeof(struct astarte_transmission_pacing_fixture));
+    zassert_not_null(fixture, "Failed allocating test fixture");
+
+    return fixture;
+}
+
+static void astarte_transmission_pacing_test_before(void *f)
+{
+    struct astarte_transmission_pacing_fixture *fixture
+        = (struct astarte_transmission_pacing_fixture *) f;
+
+    astarte_result_t ares = astarte_storage_init(&fixture->storage, 0);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Storage init failed: %s", astarte_result_to_name(ares));
+}
+
+static void astarte_transmission_pacing_test_after(void *f)
+{
+    struct astarte_transmission_pacing_fixture *fixture
+        = (struct astarte_transmission_pacing_fixture *) f;
+
+    astarte_mqtt_caching_clear_messages(&fixture->astarte_mqtt.out_msgs);
+    astarte_storage_destroy(&fixture->storage);
+}
+
+static void astarte_transmission_pacing_test_teardown(void *f)
+{
+    struct astarte_transmission_pacing_fixture *fixture
+        = (struct astarte_transmission_pacing_fixture *) f;
+    astarte_free(fixture);
+}
+
+ZTEST_SUITE(astarte_transmission_pacing, NULL, astarte_transmission_pacing_test_setup,
+    astarte_transmission_pacing_test_before, astarte_transmission_pacing_test_after,
+    astarte_transmission_pacing_test_teardown);
+
+ZTEST_F(astarte_transmission_pacing, test_transmission_pacing_window_full_until_puback)
+{
+    init_mqtt(fixture, 2);
+    astarte_transmission_pacing_init(&fixture->pacing, 1, TEST_TOKEN_PERIOD_MS);
+    zassert_equal(astarte_transmission_pacing_get_burst(&fixture->pacing, &fixture->astarte_mqtt),
+        3, "A burst should fill the tokens and the window");
+
+    // Subscriptions waiting for a SUBACK do not take a slot of the window
+    send_packet(fixture, 1, STORAGE_MQTT_SUBSCRIPTION_ENTRY);
+
+    // Pipeline QoS 1 publishes up to the window, without consuming tokens
+    for (uint16_t message_id = 2; message_id <= 3; message_id++) {
+        zassert_equal(
+            astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 1), 0,
+            "Publish %u should fit in the window", message_id);
+        send_packet(fixture, message_id, STORAGE_MQTT_PUBLISH_ENTRY);
+        astarte_transmission_pacing_consume(&fixture->pacing, &fixture->astarte_mqtt, 1);
+    }
+    zassert_equal(fixture->pacing.tokens, 1, "Windowed publishes should not consume tokens");
+
+    // The window is full, QoS 1 and 2 publishes wait for an acknowledgement
+    zassert_equal(astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 1),
+        SYS_FOREVER_MS, "QoS 1 publish should wait for the window");
+    zassert_equal(astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 2),
+        SYS_FOREVER_MS, "QoS 2 publish should wait for the window");
+
+    // QoS 0 messages are still paced by the tokens
+    zassert_equal(astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 0),
+        0, "QoS 0 message should be admitted by a token");
+
+    // A PUBACK frees a slot of the window
+    struct mqtt_puback_param puback = { .message_id = 2 };
+    astarte_mqtt_handle_puback_event(&fixture->astarte_mqtt, puback);
+    zassert_equal(astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 1),
+        0, "Publishes should resume after a PUBACK");
+}
+
+ZTEST_F(astarte_transmission_pacing, test_transmission_pacing_qos0_paced_by_tokens)
+{
+    init_mqtt(fixture, 2);
+    astarte_transmission_pacing_init(&fixture->pacing, 2, TEST_TOKEN_PERIOD_MS);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        zassert_equal(
+            astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 0), 0,
+            "QoS 0 message %u should be admitted by a token", i);
+        astarte_transmission_pacing_consume(&fixture->pacing, &fixture->astarte_mqtt, 0);
+    }
+
+    // Out of tokens, QoS 0 messages wait for the next one
+    int32_t delay_ms
+        = astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 0);
+    zassert_true((delay_ms > 0) && (delay_ms <= TEST_TOKEN_PERIOD_MS),
+        "QoS 0 message should wait for a token, delay %d", delay_ms);
+
+    // The window is not affected by the tokens
+    zassert_equal(astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 1),
+        0, "QoS 1 publish should be admitted by the window");
+}
+
+ZTEST_F(astarte_transmission_pacing, test_transmission_pacing_window_disabled)
+{
+    init_mqtt(fixture, 0);
+    astarte_transmission_pacing_init(&fixture->pacing, 1, TEST_TOKEN_PERIOD_MS);
+    zassert_equal(astarte_transmission_pacing_get_burst(&fixture->pacing, &fixture->astarte_mqtt),
+        1, "A burst should be bounded by the tokens");
+
+    // Without a window all the messages are paced by the tokens
+    zassert_equal(astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 1),
+        0, "QoS 1 publish should be admitted by a token");
+    send_packet(fixture, 1, STORAGE_MQTT_PUBLISH_ENTRY);
+    astarte_transmission_pacing_consume(&fixture->pacing, &fixture->astarte_mqtt, 1);
+
+    int32_t delay_ms
+        = astarte_transmission_pacing_admit(&fixture->pacing, &fixture->astarte_mqtt, 1);
+    zassert_true((delay_ms > 0) && (delay_ms != SYS_FOREVER_MS),
+        "QoS 1 publish should wait for a token, delay %d", delay_ms);
+}
@@ -45,10 +45,11 @@ static void astarte_transmission_queue_test_before(void *f)
     sys_clock_settime(SYS_CLOCK_REALTIME, &fake_time);
 
     k_mutex_lock(&fixture->test_mutex, K_FOREVER);
-    ares = astarte_storage_init(&fixture->storage);
+    ares = astarte_storage_init(&fixture->storage, 0);
     zassert_equal(ares, ASTARTE_RESULT_OK, "Storage init failed: %s", astarte_result_to_name(ares));
 
-    ares = astarte_transmission_queue_init(&fixture->queue, &fixture->storage);
+    ares = astarte_transmission_queue_init(
+        &fixture->queue, &fixture->storage, CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE);
 
     zassert_equal(ares, ASTARTE_RESULT_OK, "Queue init failed: %s", astarte_result_to_name(ares));
 }
@@ -86,7 +87,8 @@ ZTEST_F(astarte_transmission_queue, test_transmission_queue_invalid_params)
         .retention = ASTARTE_MAPPING_RETENTION_VOLATILE };
 
     // Test passing NULL to init
-    ares = astarte_transmission_queue_init(NULL, &fixture->storage);
+    ares = astarte_transmission_queue_init(
+        NULL, &fixture->storage, CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE);
     zassert_equal(ares, ASTARTE_RESULT_INVALID_PARAM, "Init with NULL should return INVALID_PARAM");
 
     // Test passing NULL parameters to insert
@@ -168,6 +170,166 @@ ZTEST_F(astarte_transmission_queue, test_transmission_queue_insert_and_peek_vola
     zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Message should have been discarded");
 }
 
+ZTEST_F(astarte_transmission_queue, test_transmission_queue_peek_borrow_volatile)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    struct astarte_device_transmission_queue_msg msg_in
+        = { .interface_name = "org.astarteplatform.test.Volatile",
+              .path = "/test/borrowed",
+              .payload = "borrowed_payload",
+              .payload_len = 16,
+              .qos = 1,
+              .retention = ASTARTE_MAPPING_RETENTION_VOLATILE };
+
+    ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue insert failed: %s", astarte_result_to_name(ares));
+
+    // Borrow the message, its buffers stay in the queue
+    struct astarte_device_transmission_queue_msg msg_out = { 0 };
+    ares = astarte_transmission_queue_peek_borrow(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+    zassert_true(msg_out.borrowed, "Message should have been borrowed");
+    zassert_equal(msg_out.retention, ASTARTE_MAPPING_RETENTION_VOLATILE, "Retention mismatch");
+    zassert_equal(msg_out.payload_len, msg_in.payload_len, "Payload size mismatch");
+    zassert_mem_equal(msg_out.path, msg_in.path, strlen(msg_in.path) + 1, "Path mismatch");
+    zassert_mem_equal(msg_out.payload, msg_in.payload, msg_in.payload_len, "Payload mismatch");
+
+    // Borrowing again hands out the same buffers
+    struct astarte_device_transmission_queue_msg msg_again = { 0 };
+    ares = astarte_transmission_queue_peek_borrow(&fixture->queue, &msg_again);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+    zassert_equal_ptr(msg_again.path, msg_out.path, "Borrowed path should not be copied");
+    zassert_equal_ptr(msg_again.payload, msg_out.payload, "Borrowed payload should not be copied");
+    astarte_transmission_queue_msg_cleanup(&msg_again);
+
+    // Filling the queue evicts its oldest messages, never the borrowed one
+    struct astarte_device_transmission_queue_msg msg_filler = msg_in;
+    msg_filler.path = "/test/filler";
+    for (size_t i = 0; i < CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE + 1; i++) {
+        ares = astarte_transmission_queue_insert(&fixture->queue, &msg_filler);
+        zassert_equal(
+            ares, ASTARTE_RESULT_OK, "Queue insert failed: %s", astarte_result_to_name(ares));
+    }
+    zassert_mem_equal(msg_out.path, msg_in.path, strlen(msg_in.path) + 1, "Path mismatch");
+    zassert_mem_equal(msg_out.payload, msg_in.payload, msg_in.payload_len, "Payload mismatch");
+
+    // The borrowed message is still the head of the queue
+    ares = astarte_transmission_queue_peek(&fixture->queue, &msg_again);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+    zassert_false(msg_again.borrowed, "Message should have been copied");
+    zassert_mem_equal(msg_again.path, msg_in.path, strlen(msg_in.path) + 1, "Path mismatch");
+    astarte_transmission_queue_msg_cleanup(&msg_again);
+
+    astarte_transmission_queue_msg_cleanup(&msg_out);
+    zassert_is_null(msg_out.payload, "Cleanup should reset the borrowed buffers");
+
+    // Discarding frees the borrowed message, the fillers follow
+    ares = astarte_transmission_queue_discard_by_retention(
+        &fixture->queue, ASTARTE_MAPPING_RETENTION_VOLATILE);
+    zassert_equal(
+        ares, ASTARTE_RESULT_OK, "Queue discard failed: %s", astarte_result_to_name(ares));
+    ares = astarte_transmission_queue_peek_borrow(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+    zassert_mem_equal(
+        msg_out.path, msg_filler.path, strlen(msg_filler.path) + 1, "Path mismatch");
+    astarte_transmission_queue_msg_cleanup(&msg_out);
+}
+
+ZTEST_F(astarte_transmission_queue, test_transmission_queue_purge_borrowed_discard)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    struct astarte_device_transmission_queue_msg msg_in
+        = { .interface_name = "org.astarteplatform.test.Discard",
+              .path = "/test/purged",
+              .payload = "purged_payload",
+              .payload_len = 14,
+              .qos = 1,
+              .retention = ASTARTE_MAPPING_RETENTION_DISCARD };
+
+    ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue insert failed: %s", astarte_result_to_name(ares));
+
+    struct astarte_device_transmission_queue_msg msg_out = { 0 };
+    ares = astarte_transmission_queue_peek_borrow(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+    zassert_true(msg_out.borrowed, "Message should have been borrowed");
+
+    // Purging removes the message from the queue but leaves its buffers to the borrower
+    astarte_transmission_queue_purge_discard(&fixture->queue);
+    zassert_mem_equal(msg_out.path, msg_in.path, strlen(msg_in.path) + 1, "Path mismatch");
+    zassert_mem_equal(msg_out.payload, msg_in.payload, msg_in.payload_len, "Payload mismatch");
+
+    struct astarte_device_transmission_queue_msg msg_peek = { 0 };
+    ares = astarte_transmission_queue_peek(&fixture->queue, &msg_peek);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Purged message should not be peeked");
+
+    // The discard of the borrower refers to the purged message, not to a later one
+    ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue insert failed: %s", astarte_result_to_name(ares));
+    ares = astarte_transmission_queue_discard_by_retention(
+        &fixture->queue, ASTARTE_MAPPING_RETENTION_DISCARD);
+    zassert_equal(
+        ares, ASTARTE_RESULT_OK, "Queue discard failed: %s", astarte_result_to_name(ares));
+    astarte_transmission_queue_msg_cleanup(&msg_out);
+
+    ares = astarte_transmission_queue_peek_borrow(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+    zassert_mem_equal(msg_out.path, msg_in.path, strlen(msg_in.path) + 1, "Path mismatch");
+    astarte_transmission_queue_msg_cleanup(&msg_out);
+}
+
+ZTEST_F(astarte_transmission_queue, test_transmission_queue_volatile_payload_sizes)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    // Sizes fitting each slab of the pool and one always allocated on the heap
+    const int payload_lens[] = { 0, 8, 100, 600, 2048 };
+    uint8_t *payload = astarte_malloc(2048);
+    zassert_not_null(payload, "Failed allocating payload");
+    for (size_t i = 0; i < 2048; i++) {
+        payload[i] = (uint8_t) i;
+    }
+
+    // Repeat the cycle, the blocks are given back to their slab on discard
+    for (size_t round = 0; round < 2 * CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE;
+        round++) {
+        for (size_t i = 0; i < ARRAY_SIZE(payload_lens); i++) {
+            struct astarte_device_transmission_queue_msg msg_in
+                = { .interface_name = "org.astarteplatform.test.Volatile",
+                      .path = "/test/sizes",
+                      .payload = payload,
+                      .payload_len = payload_lens[i],
+                      .qos = 1,
+                      .retention = ASTARTE_MAPPING_RETENTION_VOLATILE };
+            ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+            zassert_equal(
+                ares, ASTARTE_RESULT_OK, "Queue insert failed: %s", astarte_result_to_name(ares));
+
+            struct astarte_device_transmission_queue_msg msg_out = { 0 };
+            ares = astarte_transmission_queue_peek(&fixture->queue, &msg_out);
+            zassert_equal(
+                ares, ASTARTE_RESULT_OK, "Queue peek failed: %s", astarte_result_to_name(ares));
+            zassert_equal(msg_out.payload_len, payload_lens[i], "Payload size mismatch");
+            zassert_str_equal(
+                msg_out.interface_name, "org.astarteplatform.test.Volatile", "Interface mismatch");
+            zassert_str_equal(msg_out.path, "/test/sizes", "Path mismatch");
+            if (payload_lens[i] > 0) {
+                zassert_mem_equal(msg_out.payload, payload, payload_lens[i], "Payload mismatch");
+            }
+            astarte_transmission_queue_msg_cleanup(&msg_out);
+
+            ares = astarte_transmission_queue_discard_by_retention(
+                &fixture->queue, ASTARTE_MAPPING_RETENTION_VOLATILE);
+            zassert_equal(
+                ares, ASTARTE_RESULT_OK, "Queue discard failed: %s", astarte_result_to_name(ares));
+        }
+    }
+
+    astarte_free(payload);
+}
+
 ZTEST_F(astarte_transmission_queue, test_transmission_queue_insert_and_peek_storage)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
@@ -215,6 +377,41 @@ ZTEST_F(astarte_transmission_queue, test_transmission_queue_insert_and_peek_stor
     zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Message should have been discarded");
 }
 
+ZTEST_F(astarte_transmission_queue, test_transmission_queue_flush_deadline)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    k_timepoint_t never = sys_timepoint_calc(K_FOREVER);
+
+    struct astarte_device_transmission_queue_msg msg_in
+        = { .interface_name = "org.astarteplatform.test.Stored",
+              .path = "/test/path",
+              .payload = "mock_payload",
+              .payload_len = 12,
+              .qos = 1,
+              .retention = ASTARTE_MAPPING_RETENTION_STORED };
+
+    // Nothing to write on an empty queue
+    k_timepoint_t deadline = astarte_transmission_queue_get_flush_deadline(&fixture->queue);
+    zassert_equal(sys_timepoint_cmp(deadline, never), 0, "Empty queue should never flush");
+
+    ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue insert failed: %s", astarte_result_to_name(ares));
+
+    // Only messages packed in RAM have to be written later on
+    deadline = astarte_transmission_queue_get_flush_deadline(&fixture->queue);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+    zassert_true(sys_timepoint_cmp(deadline, never) < 0, "Packed message should set a deadline");
+#else
+    zassert_equal(sys_timepoint_cmp(deadline, never), 0, "Written message should not flush");
+#endif
+
+    ares = astarte_transmission_queue_flush(&fixture->queue, true);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue flush failed: %s", astarte_result_to_name(ares));
+
+    deadline = astarte_transmission_queue_get_flush_deadline(&fixture->queue);
+    zassert_equal(sys_timepoint_cmp(deadline, never), 0, "Flushed queue should never flush");
+}
+
 ZTEST_F(astarte_transmission_queue, test_transmission_queue_mixed_retention_ordering)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
@@ -310,7 +507,8 @@ ZTEST_F(astarte_transmission_queue, test_transmission_queue_mixed_retention_orde
     sys_clock_settime(SYS_CLOCK_REALTIME, &invalid_time);
 
     // Re-initialize the queue so it registers system_time_valid = false
-    ares = astarte_transmission_queue_init(&fixture->queue, &fixture->storage);
+    ares = astarte_transmission_queue_init(
+        &fixture->queue, &fixture->storage, CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE);
     zassert_equal(ares, ASTARTE_RESULT_OK, "Queue init failed with invalid time");
     zassert_false(
         fixture->queue.system_time_valid, "Queue should have detected invalid system time");
@@ -390,6 +588,138 @@ ZTEST_F(astarte_transmission_queue, test_transmission_queue_mixed_retention_orde
     zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Queue should be completely empty");
 }
 
+ZTEST_F(astarte_transmission_queue, test_transmission_queue_ordering_with_evictions)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    // Alternate lanes for more messages than the runs, evicting most volatile messages
+    const size_t count
+        = fixture->queue.runs_size + CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE;
+    char path[32] = { 0 };
+    for (size_t i = 0; i < count; i++) {
+        struct astarte_device_transmission_queue_msg msg_in
+            = { .interface_name = "org.astarteplatform.test.Ordering",
+                  .path = path,
+                  .payload = "data",
+                  .payload_len = 4,
+                  .qos = 1 };
+
+        snprintf(path, sizeof(path), "/volatile/%zu", i);
+        msg_in.retention = ASTARTE_MAPPING_RETENTION_VOLATILE;
+        ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Insert failed: %s", astarte_result_to_name(ares));
+
+        snprintf(path, sizeof(path), "/stored/%zu", i);
+        msg_in.retention = ASTARTE_MAPPING_RETENTION_STORED;
+        ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Insert failed: %s", astarte_result_to_name(ares));
+    }
+
+    // Each volatile message left is sent before the stored of the same round
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_SPILL
+    // Volatile messages over the capacity have been spilled to the storage instead of evicted
+    const size_t first_volatile = 0;
+#else
+    const size_t first_volatile = count - CONFIG_ASTARTE_DEVICE_SDK_TRANSMISSION_QUEUE_SIZE;
+#endif
+    for (size_t i = 0; i < count; i++) {
+        for (int stored = (i < first_volatile) ? 1 : 0; stored < 2; stored++) {
+            snprintf(path, sizeof(path), stored ? "/stored/%zu" : "/volatile/%zu", i);
+
+            struct astarte_device_transmission_queue_msg msg_out = { 0 };
+            ares = astarte_transmission_queue_peek(&fixture->queue, &msg_out);
+            zassert_equal(ares, ASTARTE_RESULT_OK, "Peek failed: %s", astarte_result_to_name(ares));
+            zassert_str_equal(msg_out.path, path, "Expected %s, got %s", path, msg_out.path);
+            astarte_mapping_retention_t retention = msg_out.retention;
+            astarte_transmission_queue_msg_cleanup(&msg_out);
+
+            ares = astarte_transmission_queue_discard_by_retention(&fixture->queue, retention);
+            zassert_equal(
+                ares, ASTARTE_RESULT_OK, "Discard failed: %s", astarte_result_to_name(ares));
+        }
+    }
+
+    struct astarte_device_transmission_queue_msg msg_out = { 0 };
+    ares = astarte_transmission_queue_peek(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Queue should be empty");
+}
+
+ZTEST_F(astarte_transmission_queue, test_transmission_queue_runtime_capacity)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+
+    astarte_transmission_queue_clear(&fixture->queue);
+    ares = astarte_transmission_queue_init(&fixture->queue, &fixture->storage, 0);
+    zassert_equal(ares, ASTARTE_RESULT_INVALID_PARAM, "Init with no capacity should fail");
+    ares = astarte_transmission_queue_init(&fixture->queue, &fixture->storage, 2);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Queue init failed: %s", astarte_result_to_name(ares));
+
+    const char *paths[] = { "/volatile/0", "/volatile/1", "/volatile/2", "/volatile/3" };
+    for (size_t i = 0; i < ARRAY_SIZE(paths); i++) {
+        struct astarte_device_transmission_queue_msg msg_in
+            = { .interface_name = "org.astarteplatform.test.Capacity",
+                  .path = (char *) paths[i],
+                  .payload = "data",
+                  .payload_len = 4,
+                  .qos = 1,
+                  .retention = ASTARTE_MAPPING_RETENTION_VOLATILE };
+        ares = astarte_transmission_queue_insert(&fixture->queue, &msg_in);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Insert failed: %s", astarte_result_to_name(ares));
+    }
+
+    struct astarte_device_transmission_queue_msg msg_out = { 0 };
+    ares = astarte_transmission_queue_peek(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Peek failed: %s", astarte_result_to_name(ares));
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_SPILL
+    // The messages over the capacity are spilled to the storage
+    zassert_str_equal(msg_out.path, "/volatile/0", "Unexpected head %s", msg_out.path);
+#else
+    // The messages over the capacity evict the oldest ones
+    zassert_str_equal(msg_out.path, "/volatile/2", "Unexpected head %s", msg_out.path);
+#endif
+    astarte_transmission_queue_msg_cleanup(&msg_out);
+    ares = astarte_transmission_queue_discard_by_retention(
+        &fixture->queue, ASTARTE_MAPPING_RETENTION_VOLATILE);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Discard failed: %s", astarte_result_to_name(ares));
+
+    // Room in RAM is used again by the next message, sent after the spilled ones
+    struct astarte_device_transmission_queue_msg msg_last
+        = { .interface_name = "org.astarteplatform.test.Capacity",
+              .path = "/volatile/4",
+              .payload = "data",
+              .payload_len = 4,
+              .qos = 1,
+              .retention = ASTARTE_MAPPING_RETENTION_VOLATILE };
+    ares = astarte_transmission_queue_insert(&fixture->queue, &msg_last);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Insert failed: %s", astarte_result_to_name(ares));
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_QUEUE_SPILL
+    const char *expected_paths[] = { "/volatile/1", "/volatile/2", "/volatile/3", "/volatile/4" };
+    const astarte_mapping_retention_t expected_retentions[] = { ASTARTE_MAPPING_RETENTION_VOLATILE,
+        ASTARTE_MAPPING_RETENTION_STORED, ASTARTE_MAPPING_RETENTION_STORED,
+        ASTARTE_MAPPING_RETENTION_VOLATILE };
+#else
+    const char *expected_paths[] = { "/volatile/3", "/volatile/4" };
+    const astarte_mapping_retention_t expected_retentions[]
+        = { ASTARTE_MAPPING_RETENTION_VOLATILE, ASTARTE_MAPPING_RETENTION_VOLATILE };
+#endif
+    for (size_t i = 0; i < ARRAY_SIZE(expected_paths); i++) {
+        ares = astarte_transmission_queue_peek(&fixture->queue, &msg_out);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Peek failed: %s", astarte_result_to_name(ares));
+        zassert_str_equal(msg_out.path, expected_paths[i], "Expected %s, got %s",
+            expected_paths[i], msg_out.path);
+        zassert_equal(msg_out.retention, expected_retentions[i], "Retention mismatch");
+        astarte_transmission_queue_msg_cleanup(&msg_out);
+
+        ares = astarte_transmission_queue_discard_by_retention(
+            &fixture->queue, expected_retentions[i]);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Discard failed: %s", astarte_result_to_name(ares));
+    }
+
+    ares = astarte_transmission_queue_peek(&fixture->queue, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Queue should be empty");
+}
+
 ZTEST_F(astarte_transmission_queue, test_transmission_queue_purge_discard)
 {
     astarte_result_t ares = ASTARTE_RESULT_OK;
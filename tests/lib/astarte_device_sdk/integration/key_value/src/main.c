@@ -18,7 +18,11 @@
 #include "alloc.h"
 #include "key_value/core.h"
 #include "key_value/entry.h"
+#include "key_value/entry_chunk.h"
 #include "key_value/entry_hash.h"
+#include "key_value/entry_header.h"
+#include "key_value/entry_index.h"
+#include "key_value/entry_intent.h"
 #include "key_value/entry_list.h"
 
 #define ZMS_PARTITION key_value_partition
@@ -105,6 +109,18 @@ ZTEST_SUITE(astarte_device_sdk_key_value, NULL, astarte_storage_key_value_test_s
     astarte_storage_key_value_test_teardown);
 
 // Helper to statically validate that the hardcoded keys actually collide
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+// Helper to physically remove all the tombstones left by deletions
+static void compact_all(astarte_key_value_backend_t *backend)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    do {
+        ares = astarte_key_value_compact(backend);
+    } while (ares == ASTARTE_RESULT_OK);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Compaction failed");
+}
+#endif
+
 static void validate_collision(
     const char *namespace, const char *k1, const char *k2, const char *k3)
 {
@@ -119,7 +135,7 @@ static void validate_collision(
 ZTEST_F(astarte_device_sdk_key_value, test_key_value_hash_collision_probing)
 {
     astarte_key_value_t key_value = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char namespace[] = "collision_ns";
 
     astarte_key_value_cfg_t cfg = {
@@ -128,8 +144,8 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_hash_collision_probing)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    zassert_equal(astarte_key_value_open(cfg, &zms_fs), ASTARTE_RESULT_OK);
-    zassert_equal(astarte_key_value_new(&zms_fs, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
 
     // Hardcoded keys known to collide at Target Hash: 2432505520
     const char *k1 = "key_2533606";
@@ -165,7 +181,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_hash_collision_probing)
 ZTEST_F(astarte_device_sdk_key_value, test_key_value_storage_exhaustion)
 {
     astarte_key_value_t key_value = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
 
     astarte_key_value_cfg_t cfg = {
         .flash_device = fixture->flash_device,
@@ -173,8 +189,8 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_storage_exhaustion)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    zassert_equal(astarte_key_value_open(cfg, &zms_fs), ASTARTE_RESULT_OK);
-    zassert_equal(astarte_key_value_new(&zms_fs, "exhaust_ns", 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, "exhaust_ns", 0, &key_value), ASTARTE_RESULT_OK);
 
     char key[16];
     char val[] = "v";
@@ -200,7 +216,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_storage_exhaustion)
 ZTEST_F(astarte_device_sdk_key_value, test_key_value_linked_list_head_tail)
 {
     astarte_key_value_t key_value = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
 
     astarte_key_value_cfg_t cfg = {
         .flash_device = fixture->flash_device,
@@ -208,41 +224,871 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_linked_list_head_tail)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    zassert_equal(astarte_key_value_open(cfg, &zms_fs), ASTARTE_RESULT_OK);
-    zassert_equal(astarte_key_value_new(&zms_fs, "ll_ns", 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, "ll_ns", 0, &key_value), ASTARTE_RESULT_OK);
 
-    uint32_t head_id, tail_id;
+    uint32_t list_id, head_id, tail_id;
 
     // Initially empty
-    zassert_equal(astarte_key_value_entry_list_read_head_and_tail_ids(&zms_fs, &head_id, &tail_id),
+    zassert_equal(astarte_key_value_entry_list_find_id(&backend, "ll_ns", false, &list_id),
+        ASTARTE_RESULT_NOT_FOUND);
+    zassert_equal(
+        astarte_key_value_entry_list_find_id(&backend, "ll_ns", true, &list_id), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_entry_list_read_head_and_tail_ids(&backend, list_id, &head_id, &tail_id),
         ASTARTE_RESULT_OK);
     zassert_equal(head_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, "Empty head should be NULL");
 
     // Insert 1
     astarte_key_value_insert(&key_value, "k1", "v1", 3);
-    astarte_key_value_entry_list_read_head_and_tail_ids(&zms_fs, &head_id, &tail_id);
+    astarte_key_value_entry_list_read_head_and_tail_ids(&backend, list_id, &head_id, &tail_id);
     zassert_not_equal(head_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID, "Head should be set");
     zassert_equal(head_id, tail_id, "Head and tail should be identical for 1 element");
 
     // Insert 2
     astarte_key_value_insert(&key_value, "k2", "v2", 3);
     uint32_t old_head = head_id;
-    astarte_key_value_entry_list_read_head_and_tail_ids(&zms_fs, &head_id, &tail_id);
+    astarte_key_value_entry_list_read_head_and_tail_ids(&backend, list_id, &head_id, &tail_id);
     zassert_equal(head_id, old_head, "Head should remain the first element");
     zassert_not_equal(head_id, tail_id, "Tail should now be different");
 
     // Delete head
     astarte_key_value_delete(&key_value, "k1");
-    astarte_key_value_entry_list_read_head_and_tail_ids(&zms_fs, &head_id, &tail_id);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    compact_all(&backend);
+#endif
+    astarte_key_value_entry_list_read_head_and_tail_ids(&backend, list_id, &head_id, &tail_id);
     zassert_equal(head_id, tail_id, "After deleting head, 1 element remains (head == tail)");
 
     astarte_key_value_destroy(&key_value);
 }
 
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_linked_list_per_namespace)
+{
+    astarte_key_value_t kv_a = { 0 };
+    astarte_key_value_t kv_b = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const size_t entries_a = 3;
+    const size_t entries_b = 5;
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, "ns_a", 0, &kv_a), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, "ns_b", 0, &kv_b), ASTARTE_RESULT_OK);
+
+    // Interleave the insertions of the two namespaces
+    char key[16] = { 0 };
+    for (size_t i = 0; i < entries_b; i++) {
+        snprintf(key, sizeof(key), "key_%zu", i);
+        if (i < entries_a) {
+            zassert_equal(astarte_key_value_insert(&kv_a, key, "a", 2), ASTARTE_RESULT_OK);
+        }
+        zassert_equal(astarte_key_value_insert(&kv_b, key, "b", 2), ASTARTE_RESULT_OK);
+    }
+
+    uint32_t list_a, list_b;
+    zassert_equal(
+        astarte_key_value_entry_list_find_id(&backend, "ns_a", false, &list_a), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_entry_list_find_id(&backend, "ns_b", false, &list_b), ASTARTE_RESULT_OK);
+    zassert_not_equal(list_a, list_b, "Each namespace should own a separate list");
+
+    // Walking each list should only visit the entries of its namespace
+    size_t count = 0;
+    uint32_t curr_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    while ((astarte_key_value_entry_get_next_id(&backend, list_a, curr_id, &curr_id)
+               == ASTARTE_RESULT_OK)
+        && (curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID)) {
+        count++;
+    }
+    zassert_equal(count, entries_a, "Unexpected number of entries in list A: %zu", count);
+
+    count = 0;
+    curr_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    while ((astarte_key_value_entry_get_next_id(&backend, list_b, curr_id, &curr_id)
+               == ASTARTE_RESULT_OK)
+        && (curr_id != ASTARTE_KEY_VALUE_ENTRY_NULL_ID)) {
+        count++;
+    }
+    zassert_equal(count, entries_b, "Unexpected number of entries in list B: %zu", count);
+
+    astarte_key_value_destroy(&kv_a);
+    astarte_key_value_destroy(&kv_b);
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_RAM_INDEX
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_ram_index)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "collision_ns";
+    const char *k1 = "key_2533606";
+    const char *k2 = "key_2796754";
+    const char *k3 = "key_3381429";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_true(astarte_key_value_entry_index_is_valid(&backend), "Index not built at open");
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+
+    validate_collision(namespace, k1, k2, k3);
+    zassert_equal(astarte_key_value_insert(&key_value, k1, "v1", 3), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, k2, "v2", 3), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, k3, "v3", 3), ASTARTE_RESULT_OK);
+
+    // The colliding keys occupy consecutive IDs, each tracked with its own fingerprint
+    uint32_t base_id = astarte_key_value_entry_hash_generate(namespace, k1);
+    uint32_t fingerprint = 0;
+    zassert_equal(astarte_key_value_entry_index_lookup(&backend, base_id, &fingerprint),
+        ASTARTE_RESULT_OK);
+    zassert_equal(fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, k1));
+    zassert_equal(astarte_key_value_entry_index_lookup(&backend, base_id + 2, &fingerprint),
+        ASTARTE_RESULT_OK);
+    zassert_equal(fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, k3));
+
+    // Deleting the first key shifts back the others, the index must follow them
+    zassert_equal(astarte_key_value_delete(&key_value, k1), ASTARTE_RESULT_OK);
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+    compact_all(&backend);
+#endif
+    zassert_equal(astarte_key_value_entry_index_lookup(&backend, base_id, &fingerprint),
+        ASTARTE_RESULT_OK);
+    zassert_equal(fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, k2));
+    zassert_equal(astarte_key_value_entry_index_lookup(&backend, base_id + 2, &fingerprint),
+        ASTARTE_RESULT_NOT_FOUND);
+
+    char buf[4] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, k3, buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "v3", 3);
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, k1, buf, &sz), ASTARTE_RESULT_NOT_FOUND);
+    astarte_key_value_destroy(&key_value);
+
+    // Opening the storage again rebuilds the same index from flash
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_true(astarte_key_value_entry_index_is_valid(&backend), "Index not rebuilt at open");
+    zassert_equal(astarte_key_value_entry_index_lookup(&backend, base_id + 1, &fingerprint),
+        ASTARTE_RESULT_OK);
+    zassert_equal(fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, k3));
+}
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_KEY_VALUE_TOMBSTONES
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_tombstones)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "tombstone_ns";
+    const char *k1 = "key_2533606";
+    const char *k2 = "key_2796754";
+    const char *k3 = "key_3381429";
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+    size_t raw_size = 0;
+    char buf[4] = { 0 };
+    size_t sz = sizeof(buf);
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+
+    validate_collision(namespace, k1, k2, k3);
+    zassert_equal(astarte_key_value_insert(&key_value, k1, "v1", 3), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, k2, "v2", 3), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, k3, "v3", 3), ASTARTE_RESULT_OK);
+    uint32_t base_id = astarte_key_value_entry_hash_generate(namespace, k1);
+
+    // The deleted key leaves a tombstone, the colliding keys are not shifted back
+    zassert_equal(astarte_key_value_delete(&key_value, k1), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_entry_header_read_fixed(&backend, base_id, &fixed_header, &raw_size),
+        ASTARTE_RESULT_OK);
+    zassert_true(fixed_header.tombstone, "Deleted entry is not a tombstone");
+    zassert_equal(
+        fixed_header.fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, k1));
+    zassert_equal(astarte_key_value_find(&key_value, k1, buf, &sz), ASTARTE_RESULT_NOT_FOUND);
+    zassert_equal(astarte_key_value_delete(&key_value, k1), ASTARTE_RESULT_NOT_FOUND);
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, k3, buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "v3", 3);
+    zassert_equal(
+        astarte_key_value_entry_header_read_fixed(&backend, base_id + 2, &fixed_header, &raw_size),
+        ASTARTE_RESULT_OK);
+
+    // Tombstones are skipped while iterating
+    astarte_key_value_iter_t iter = { 0 };
+    size_t count = 0;
+    astarte_result_t ares = astarte_key_value_iterator_init(&key_value, &iter);
+    while (ares == ASTARTE_RESULT_OK) {
+        zassert_not_equal(iter.current_id, base_id, "Iterator returned a tombstone");
+        count++;
+        ares = astarte_key_value_iterator_next(&iter);
+    }
+    zassert_equal(count, 2, "Unexpected number of entries: %zu", count);
+
+    // Inserting the key again reuses its tombstone
+    zassert_equal(astarte_key_value_insert(&key_value, k1, "v4", 3), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_entry_header_read_fixed(&backend, base_id, &fixed_header, &raw_size),
+        ASTARTE_RESULT_OK);
+    zassert_false(fixed_header.tombstone, "Inserted entry is still a tombstone");
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, k1, buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "v4", 3);
+
+    // The compaction removes the tombstone and shifts back the colliding keys
+    zassert_equal(astarte_key_value_delete(&key_value, k1), ASTARTE_RESULT_OK);
+    compact_all(&backend);
+    zassert_equal(
+        astarte_key_value_entry_header_read_fixed(&backend, base_id, &fixed_header, &raw_size),
+        ASTARTE_RESULT_OK);
+    zassert_false(fixed_header.tombstone, "Tombstone not compacted");
+    zassert_equal(
+        fixed_header.fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, k2));
+    zassert_equal(
+        astarte_key_value_entry_header_read_fixed(&backend, base_id + 2, &fixed_header, &raw_size),
+        ASTARTE_RESULT_NOT_FOUND);
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, k3, buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "v3", 3);
+
+    uint32_t head_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    zassert_equal(astarte_key_value_entry_list_read_head_and_tail_ids(
+                      &backend, key_value.list_id, &head_id, &tail_id),
+        ASTARTE_RESULT_OK);
+    zassert_equal(head_id, base_id, "Head not moved with the shifted entry");
+    zassert_equal(tail_id, base_id + 1, "Tail not moved with the shifted entry");
+
+    astarte_key_value_destroy(&key_value);
+}
+#endif
+
+// Helper to write an entry with the layout used before the fingerprint was added to the header
+static void write_raw_entry(astarte_key_value_backend_t *backend, uint32_t idx,
+    const char *namespace, const char *key, const char *value, uint32_t next_id, uint32_t prev_id,
+    bool fingerprint)
+{
+    uint16_t nsp_len = strlen(namespace);
+    uint16_t key_len = strlen(key);
+    uint32_t fingerprint_val = astarte_key_value_entry_hash_fingerprint(namespace, key);
+    uint8_t raw[64] = { 0 };
+    size_t offset = 0;
+
+    memcpy(raw + offset, &nsp_len, sizeof(nsp_len));
+    offset += sizeof(nsp_len);
+    memcpy(raw + offset, &key_len, sizeof(key_len));
+    offset += sizeof(key_len);
+    memcpy(raw + offset, &next_id, sizeof(next_id));
+    offset += sizeof(next_id);
+    memcpy(raw + offset, &prev_id, sizeof(prev_id));
+    offset += sizeof(prev_id);
+    if (fingerprint) {
+        memcpy(raw + offset, &fingerprint_val, sizeof(fingerprint_val));
+        offset += sizeof(fingerprint_val);
+    }
+    memcpy(raw + offset, namespace, nsp_len);
+    offset += nsp_len;
+    memcpy(raw + offset, key, key_len);
+    offset += key_len;
+    memcpy(raw + offset, value, strlen(value) + 1);
+    offset += strlen(value) + 1;
+
+    zassert_true(astarte_key_value_backend_write(backend, idx, raw, offset) >= 0,
+        "Failed writing raw entry");
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_fingerprint_migration)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "migration_ns";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_backend_zms_open(&backend, fixture->flash_device,
+                      fixture->flash_offset, fixture->flash_partition_size),
+        ASTARTE_RESULT_OK);
+
+    // Build a partition in the previous format, simulating an interrupted migration where the
+    // second entry has already been migrated
+    astarte_key_value_version_t old_version = { .major = 0, .minor = 7, .patch = 0 };
+    zassert_true(astarte_key_value_backend_write(&backend, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID,
+                     &old_version, sizeof(old_version))
+        >= 0);
+    uint32_t list_id = 0;
+    zassert_equal(astarte_key_value_entry_list_find_id(&backend, namespace, true, &list_id),
+        ASTARTE_RESULT_OK);
+    uint32_t id_1 = astarte_key_value_entry_hash_generate(namespace, "key_1");
+    uint32_t id_2 = astarte_key_value_entry_hash_generate(namespace, "key_2");
+    write_raw_entry(&backend, id_1, namespace, "key_1", "val_1", id_2,
+        ASTARTE_KEY_VALUE_ENTRY_NULL_ID, false);
+    write_raw_entry(&backend, id_2, namespace, "key_2", "val_2", ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
+        id_1, true);
+    zassert_equal(
+        astarte_key_value_entry_list_write_head_and_tail_ids(&backend, list_id, id_1, id_2),
+        ASTARTE_RESULT_OK);
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+
+    astarte_key_value_version_t stored_version = { 0 };
+    zassert_equal(astarte_key_value_backend_read(&backend, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID,
+                      &stored_version, sizeof(stored_version)),
+        sizeof(stored_version));
+    zassert_equal(stored_version.minor, ASTARTE_KEY_VALUE_FORMAT_VERSION_MINOR);
+
+    // Both entries carry the fingerprint and can be found
+    struct astarte_key_value_entry_header_fixed fixed_header = { 0 };
+    size_t raw_size = 0;
+    zassert_equal(
+        astarte_key_value_entry_header_read_fixed(&backend, id_1, &fixed_header, &raw_size),
+        ASTARTE_RESULT_OK);
+    zassert_equal(
+        fixed_header.fingerprint, astarte_key_value_entry_hash_fingerprint(namespace, "key_1"));
+
+    char buf[8] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_1", buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "val_1", sizeof("val_1"));
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_2", buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "val_2", sizeof("val_2"));
+
+    astarte_key_value_destroy(&key_value);
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_ring_slots_migration)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "ring_migration_ns";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_backend_zms_open(&backend, fixture->flash_device,
+                      fixture->flash_offset, fixture->flash_partition_size),
+        ASTARTE_RESULT_OK);
+
+    // Build a partition in the previous format, where an entry was stored in an ID now reserved
+    astarte_key_value_version_t old_version = { .major = 0, .minor = 8, .patch = 0 };
+    zassert_true(astarte_key_value_backend_write(&backend, ASTARTE_KEY_VALUE_ENTRY_VERSION_ID,
+                     &old_version, sizeof(old_version))
+        >= 0);
+    uint32_t list_id = 0;
+    zassert_equal(astarte_key_value_entry_list_find_id(&backend, namespace, true, &list_id),
+        ASTARTE_RESULT_OK);
+    uint32_t id_1 = astarte_key_value_entry_hash_generate(namespace, "key_1");
+    uint32_t id_2 = ASTARTE_KEY_VALUE_ENTRY_RING_BASE_ID + 1;
+    write_raw_entry(&backend, id_1, namespace, "key_1", "val_1", id_2,
+        ASTARTE_KEY_VALUE_ENTRY_NULL_ID, true);
+    write_raw_entry(&backend, id_2, namespace, "key_2", "val_2", ASTARTE_KEY_VALUE_ENTRY_NULL_ID,
+        id_1, true);
+    zassert_equal(
+        astarte_key_value_entry_list_write_head_and_tail_ids(&backend, list_id, id_1, id_2),
+        ASTARTE_RESULT_OK);
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+
+    // The entry has been moved out of the ring slots and is still linked in the list
+    zassert_equal(astarte_key_value_backend_get_data_length(&backend, id_2), -ENOENT);
+    uint32_t tail_id = ASTARTE_KEY_VALUE_ENTRY_NULL_ID;
+    zassert_equal(astarte_key_value_entry_get_next_id(&backend, list_id, id_1, &tail_id),
+        ASTARTE_RESULT_OK);
+    zassert_true(tail_id <= ASTARTE_KEY_VALUE_ENTRY_MAX_USABLE_ID);
+
+    char buf[8] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_2", buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "val_2", sizeof("val_2"));
+
+    astarte_key_value_destroy(&key_value);
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_ring)
+{
+    astarte_key_value_backend_t backend = { 0 };
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+
+    astarte_key_value_ring_bounds_t bounds = { 0 };
+    zassert_equal(astarte_key_value_ring_bounds(&backend, &bounds), ASTARTE_RESULT_OK);
+    zassert_equal(bounds.count, 0);
+
+    // Positions wrapping around UINT32_MAX, including an empty record
+    const uint32_t first = UINT32_MAX - 1;
+    zassert_equal(astarte_key_value_ring_insert(&backend, first, "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_ring_insert(&backend, first + 1, NULL, 0), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_ring_insert(&backend, first + 2, "val_3", sizeof("val_3")),
+        ASTARTE_RESULT_OK);
+
+    zassert_equal(astarte_key_value_ring_bounds(&backend, &bounds), ASTARTE_RESULT_OK);
+    zassert_equal(bounds.count, 3);
+    zassert_equal(bounds.first, first);
+    zassert_equal(bounds.last, first + 2);
+    zassert_equal(bounds.bytes, sizeof("val_1") + sizeof("val_3"));
+
+    char buf[8] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_ring_find(&backend, first, buf, &sz), ASTARTE_RESULT_OK);
+    zassert_equal(sz, sizeof("val_1"));
+    zassert_mem_equal(buf, "val_1", sizeof("val_1"));
+    zassert_equal(astarte_key_value_ring_find(&backend, first + 1, NULL, &sz), ASTARTE_RESULT_OK);
+    zassert_equal(sz, 0);
+
+    // A position sharing the slot of a stored one is not found
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_ring_find(&backend, first + ASTARTE_KEY_VALUE_RING_SLOTS, buf,
+                      &sz),
+        ASTARTE_RESULT_NOT_FOUND);
+    zassert_equal(
+        astarte_key_value_ring_delete(&backend, first + ASTARTE_KEY_VALUE_RING_SLOTS, NULL),
+        ASTARTE_RESULT_NOT_FOUND);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        zassert_equal(astarte_key_value_ring_delete(&backend, first + i, NULL), ASTARTE_RESULT_OK);
+    }
+    zassert_equal(astarte_key_value_ring_bounds(&backend, &bounds), ASTARTE_RESULT_OK);
+    zassert_equal(bounds.count, 0);
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_intent_resolved_after_clean)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "intent_ns";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_1", "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+
+    // The store is now known to be clean, simulate an insertion interrupted after the payload write
+    char buf[8] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_1", buf, &sz), ASTARTE_RESULT_OK);
+    uint32_t tail_id = astarte_key_value_entry_hash_generate(namespace, "key_1");
+    uint32_t orphan_id = astarte_key_value_entry_hash_generate(namespace, "key_2");
+    zassert_equal(astarte_key_value_entry_intent_write(&backend,
+                      ASTARTE_KEY_VALUE_ENTRY_INTENT_INSERTING, key_value.list_id, orphan_id,
+                      tail_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID),
+        ASTARTE_RESULT_OK);
+    write_raw_entry(&backend, orphan_id, namespace, "key_2", "val_2",
+        ASTARTE_KEY_VALUE_ENTRY_NULL_ID, tail_id, true);
+
+    // The next read-only operation must roll back the insertion
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_1", buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "val_1", sizeof("val_1"));
+    zassert_equal(astarte_key_value_backend_get_data_length(&backend, orphan_id), -ENOENT,
+        "Orphan entry not removed");
+    struct astarte_key_value_entry_intent intent = { 0 };
+    zassert_equal(
+        astarte_key_value_backend_read(
+            &backend, ASTARTE_KEY_VALUE_ENTRY_INTENT_ID, &intent, sizeof(intent)),
+        sizeof(intent));
+    zassert_equal(intent.state, ASTARTE_KEY_VALUE_ENTRY_INTENT_NONE);
+
+    astarte_key_value_destroy(&key_value);
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_usage_persisted)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "usage_ns";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 100, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_1", "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_2", "val_2", sizeof("val_2")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_1", "long_1", sizeof("long_1")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_delete(&key_value, "key_2"), ASTARTE_RESULT_OK);
+    size_t expected_usage = sizeof("long_1");
+    zassert_equal(key_value.current_usage_bytes, expected_usage);
+    astarte_key_value_destroy(&key_value);
+
+    // The usage is loaded from the list record
+    size_t stored_usage = 0;
+    zassert_equal(astarte_key_value_new(&backend, namespace, 100, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_entry_list_read_usage(&backend, key_value.list_id, &stored_usage),
+        ASTARTE_RESULT_OK);
+    zassert_equal(stored_usage, expected_usage);
+    zassert_equal(key_value.current_usage_bytes, expected_usage);
+
+    // Simulate an update of key_1 interrupted after the usage write, before the entry write
+    struct astarte_key_value_entry_list_usage usage = {
+        .bytes = 0,
+        .pending_hash_id = astarte_key_value_entry_hash_generate(namespace, "key_1"),
+        .pending_fingerprint = astarte_key_value_entry_hash_fingerprint(namespace, "key_1"),
+    };
+    zassert_equal(
+        astarte_key_value_entry_list_write_usage(&backend, key_value.list_id, &usage),
+        ASTARTE_RESULT_OK);
+    astarte_key_value_destroy(&key_value);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 100, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(key_value.current_usage_bytes, expected_usage);
+    astarte_key_value_destroy(&key_value);
+
+    // A namespace without quota drops the stored usage, it would not be kept up to date
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_entry_list_read_usage(&backend, key_value.list_id, &stored_usage),
+        ASTARTE_RESULT_NOT_FOUND);
+    astarte_key_value_destroy(&key_value);
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_batch)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_batch_t batch = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "batch_ns";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_0", "old_0", sizeof("old_0")),
+        ASTARTE_RESULT_OK);
+
+    // Mix new keys, updates, repeated keys and deletions
+    zassert_equal(astarte_key_value_batch_begin(&key_value, &batch), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_1", "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_0", "val_0", sizeof("val_0")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_2", "val_2", sizeof("val_2")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_2", "new_2", sizeof("new_2")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_delete(&batch, "key_1"), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_delete(&batch, "missing"), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_3", "val_3", sizeof("val_3")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_commit(&batch), ASTARTE_RESULT_OK);
+    zassert_is_null(batch.ops, "Batch not released after commit");
+
+    const char *expected_keys[] = { "key_0", "key_2", "key_3" };
+    const char *expected_values[] = { "val_0", "new_2", "val_3" };
+    astarte_key_value_iter_t iter = { 0 };
+    astarte_result_t ares = astarte_key_value_iterator_init(&key_value, &iter);
+    for (size_t i = 0; i < ARRAY_SIZE(expected_keys); i++) {
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Iteration ended early at %zu", i);
+        char key[8] = { 0 };
+        size_t key_size = sizeof(key);
+        zassert_equal(astarte_key_value_iterator_get(&iter, key, &key_size), ASTARTE_RESULT_OK);
+        zassert_str_equal(key, expected_keys[i]);
+        char value[8] = { 0 };
+        size_t value_size = sizeof(value);
+        zassert_equal(
+            astarte_key_value_find(&key_value, key, value, &value_size), ASTARTE_RESULT_OK);
+        zassert_str_equal(value, expected_values[i]);
+        ares = astarte_key_value_iterator_next(&iter);
+    }
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Unexpected extra entries");
+
+    astarte_key_value_destroy(&key_value);
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_batch_rollback)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "batch_ns";
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_1", "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+
+    // Simulate a batch interrupted after writing its first new entry, linked to a second one
+    uint32_t tail_id = astarte_key_value_entry_hash_generate(namespace, "key_1");
+    uint32_t id_2 = astarte_key_value_entry_hash_generate(namespace, "key_2");
+    uint32_t id_3 = astarte_key_value_entry_hash_generate(namespace, "key_3");
+    zassert_equal(astarte_key_value_entry_intent_write(&backend,
+                      ASTARTE_KEY_VALUE_ENTRY_INTENT_BATCH_INSERTING, key_value.list_id, id_2,
+                      tail_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_entry_list_update_next_id(&backend, tail_id, id_2),
+        ASTARTE_RESULT_OK);
+    write_raw_entry(&backend, id_2, namespace, "key_2", "val_2", id_3, tail_id, true);
+
+    // The new entry is rolled back and the list is restored
+    char buf[8] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_2", buf, &sz), ASTARTE_RESULT_NOT_FOUND);
+    zassert_equal(astarte_key_value_backend_get_data_length(&backend, id_2), -ENOENT,
+        "Batch entry not removed");
+    uint32_t next_id = 0;
+    zassert_equal(
+        astarte_key_value_entry_get_next_id(&backend, key_value.list_id, tail_id, &next_id),
+        ASTARTE_RESULT_OK);
+    zassert_equal(next_id, ASTARTE_KEY_VALUE_ENTRY_NULL_ID);
+
+    astarte_key_value_destroy(&key_value);
+}
+
+static void fill_pattern(uint8_t *buffer, size_t size, uint8_t seed)
+{
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = (uint8_t) (seed + (i * 7U));
+    }
+}
+
+static bool chunk_stored(
+    astarte_key_value_t *key_value, const char *key, uint8_t generation, size_t index)
+{
+    char *chunk_key = astarte_key_value_entry_chunk_key(key, generation, index);
+    zassert_not_null(chunk_key);
+    uint32_t chunk_id = 0;
+    astarte_result_t ares = astarte_key_value_entry_find_or_alloc(
+        key_value->backend, key_value->chunk_namespace, chunk_key, &chunk_id, false);
+    astarte_free(chunk_key);
+    zassert_true((ares == ASTARTE_RESULT_OK) || (ares == ASTARTE_RESULT_NOT_FOUND));
+    return ares == ASTARTE_RESULT_OK;
+}
+
+ZTEST_F(astarte_device_sdk_key_value, test_key_value_chunked_values)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_writer_t writer = { 0 };
+    astarte_key_value_batch_t batch = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const size_t chunk_size = ASTARTE_KEY_VALUE_ENTRY_CHUNK_SIZE;
+    const size_t large_size = (2 * chunk_size) + (chunk_size / 2);
+    const size_t exact_size = 2 * chunk_size;
+
+    astarte_key_value_cfg_t cfg = {
+        .flash_device = fixture->flash_device,
+        .flash_offset = fixture->flash_offset,
+        .flash_partition_size = fixture->flash_partition_size,
+    };
+
+    uint8_t *expected = astarte_calloc(large_size, sizeof(uint8_t));
+    uint8_t *buffer = astarte_calloc(large_size, sizeof(uint8_t));
+    zassert_not_null(expected);
+    zassert_not_null(buffer);
+
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, "chunk_ns", 100, &key_value), ASTARTE_RESULT_OK);
+
+    // A large value is stored in chunks and accounted with its whole size
+    fill_pattern(expected, large_size, 1);
+    zassert_equal(astarte_key_value_insert(&key_value, "large", expected, large_size),
+        ASTARTE_RESULT_OK);
+    zassert_true(chunk_stored(&key_value, "large", 0, 1));
+    zassert_false(chunk_stored(&key_value, "large", 0, 2));
+    zassert_equal(key_value.current_usage_bytes, large_size);
+    size_t size = 0;
+    zassert_equal(astarte_key_value_find(&key_value, "large", NULL, &size), ASTARTE_RESULT_OK);
+    zassert_equal(size, large_size);
+    zassert_equal(astarte_key_value_find(&key_value, "large", buffer, &size), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buffer, expected, large_size);
+
+    // Partial reads across a chunk boundary, at the end and past the end of the value
+    size_t total_size = 0;
+    size = 20;
+    zassert_equal(astarte_key_value_read(&key_value, "large", chunk_size - 10, buffer, &size,
+                      &total_size),
+        ASTARTE_RESULT_OK);
+    zassert_equal(size, 20);
+    zassert_equal(total_size, large_size);
+    zassert_mem_equal(buffer, expected + chunk_size - 10, 20);
+    size = 16;
+    zassert_equal(
+        astarte_key_value_read(&key_value, "large", large_size - 5, buffer, &size, NULL),
+        ASTARTE_RESULT_OK);
+    zassert_equal(size, 5);
+    zassert_mem_equal(buffer, expected + large_size - 5, 5);
+    size = 16;
+    zassert_equal(
+        astarte_key_value_read(&key_value, "large", large_size + 1, buffer, &size, NULL),
+        ASTARTE_RESULT_INVALID_PARAM);
+
+    // The old value stays readable until a value written in parts is committed
+    fill_pattern(expected, exact_size, 2);
+    zassert_equal(astarte_key_value_writer_begin(&key_value, "large", exact_size, &writer),
+        ASTARTE_RESULT_OK);
+    for (size_t offset = 0; offset < exact_size; offset += 7) {
+        size_t part_size = MIN(7, exact_size - offset);
+        zassert_equal(astarte_key_value_writer_append(&writer, expected + offset, part_size),
+            ASTARTE_RESULT_OK);
+    }
+    zassert_equal(astarte_key_value_writer_append(&writer, expected, 1),
+        ASTARTE_RESULT_INVALID_PARAM);
+    zassert_equal(astarte_key_value_find(&key_value, "large", NULL, &size), ASTARTE_RESULT_OK);
+    zassert_equal(size, large_size);
+    zassert_equal(astarte_key_value_writer_commit(&writer), ASTARTE_RESULT_OK);
+    zassert_is_null(writer.buffer, "Writer not released after commit");
+    size = large_size;
+    zassert_equal(astarte_key_value_find(&key_value, "large", buffer, &size), ASTARTE_RESULT_OK);
+    zassert_equal(size, exact_size);
+    zassert_mem_equal(buffer, expected, exact_size);
+    zassert_equal(key_value.current_usage_bytes, exact_size);
+    zassert_false(chunk_stored(&key_value, "large", 0, 0), "Old chunks not deleted");
+    zassert_true(chunk_stored(&key_value, "large", 1, 0));
+    zassert_false(chunk_stored(&key_value, "large", 1, 1));
+
+    // A discarded writer removes the chunks it stored
+    zassert_equal(astarte_key_value_writer_begin(&key_value, "large", large_size, &writer),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_writer_append(&writer, buffer, chunk_size + 1),
+        ASTARTE_RESULT_OK);
+    zassert_true(chunk_stored(&key_value, "large", 0, 0));
+    astarte_key_value_writer_destroy(&writer);
+    zassert_false(chunk_stored(&key_value, "large", 0, 0), "Discarded chunks not deleted");
+    size = large_size;
+    zassert_equal(astarte_key_value_find(&key_value, "large", buffer, &size), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buffer, expected, exact_size);
+
+    // Replacing a chunked value with a small one deletes the chunks
+    zassert_equal(astarte_key_value_insert(&key_value, "large", "small", sizeof("small")),
+        ASTARTE_RESULT_OK);
+    zassert_false(chunk_stored(&key_value, "large", 1, 0));
+    size = large_size;
+    zassert_equal(astarte_key_value_find(&key_value, "large", buffer, &size), ASTARTE_RESULT_OK);
+    zassert_equal(size, sizeof("small"));
+    zassert_equal(key_value.current_usage_bytes, sizeof("small"));
+
+    // Batches apply chunked values on their own, in order with the other operations
+    fill_pattern(expected, large_size, 3);
+    zassert_equal(astarte_key_value_batch_begin(&key_value, &batch), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_1", "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "large", expected, large_size),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_insert(&batch, "key_2", "val_2", sizeof("val_2")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_batch_commit(&batch), ASTARTE_RESULT_OK);
+    size = large_size;
+    zassert_equal(astarte_key_value_find(&key_value, "large", buffer, &size), ASTARTE_RESULT_OK);
+    zassert_equal(size, large_size);
+    zassert_mem_equal(buffer, expected, large_size);
+    size = large_size;
+    zassert_equal(astarte_key_value_find(&key_value, "key_2", buffer, &size), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buffer, "val_2", sizeof("val_2"));
+
+    // Deleting a chunked value deletes its chunks
+    zassert_equal(astarte_key_value_delete(&key_value, "large"), ASTARTE_RESULT_OK);
+    zassert_equal(
+        astarte_key_value_find(&key_value, "large", NULL, &size), ASTARTE_RESULT_NOT_FOUND);
+    zassert_false(chunk_stored(&key_value, "large", 0, 0), "Chunks not deleted");
+    zassert_equal(key_value.current_usage_bytes, 2 * sizeof("val_1"));
+
+    astarte_key_value_destroy(&key_value);
+    astarte_free(buffer);
+    astarte_free(expected);
+}
+
+ZTEST(astarte_device_sdk_key_value, test_key_value_ram_backend)
+{
+    astarte_key_value_t key_value = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
+    const char namespace[] = "ram_ns";
+
+    zassert_equal(astarte_key_value_open_ram(4096, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, namespace, 0, &key_value), ASTARTE_RESULT_OK);
+
+    zassert_equal(astarte_key_value_insert(&key_value, "key_1", "val_1", sizeof("val_1")),
+        ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_insert(&key_value, "key_2", "val_2", sizeof("val_2")),
+        ASTARTE_RESULT_OK);
+
+    char buf[8] = { 0 };
+    size_t sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_2", buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "val_2", sizeof("val_2"));
+
+    size_t count = 0;
+    astarte_key_value_iter_t iter = { 0 };
+    astarte_result_t ares = astarte_key_value_iterator_init(&key_value, &iter);
+    while (ares == ASTARTE_RESULT_OK) {
+        count++;
+        ares = astarte_key_value_iterator_next(&iter);
+    }
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND);
+    zassert_equal(count, 2);
+
+    zassert_equal(astarte_key_value_delete(&key_value, "key_1"), ASTARTE_RESULT_OK);
+    sz = sizeof(buf);
+    zassert_equal(
+        astarte_key_value_find(&key_value, "key_1", buf, &sz), ASTARTE_RESULT_NOT_FOUND);
+
+    // A value larger than the whole backend is rejected without affecting the stored ones
+    uint8_t large[4096] = { 0 };
+    zassert_not_equal(
+        astarte_key_value_insert(&key_value, "large", large, sizeof(large)), ASTARTE_RESULT_OK);
+    sz = sizeof(buf);
+    zassert_equal(astarte_key_value_find(&key_value, "key_2", buf, &sz), ASTARTE_RESULT_OK);
+    zassert_mem_equal(buf, "val_2", sizeof("val_2"));
+
+    astarte_key_value_destroy(&key_value);
+    astarte_key_value_close(&backend);
+}
+
 ZTEST_F(astarte_device_sdk_key_value, test_key_value_deletion_shift_back)
 {
     astarte_key_value_t key_value = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char ns[] = "shift_ns";
 
     astarte_key_value_cfg_t cfg = {
@@ -251,8 +1097,8 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_deletion_shift_back)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    zassert_equal(astarte_key_value_open(cfg, &zms_fs), ASTARTE_RESULT_OK);
-    zassert_equal(astarte_key_value_new(&zms_fs, ns, 0, &key_value), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_open(cfg, &backend), ASTARTE_RESULT_OK);
+    zassert_equal(astarte_key_value_new(&backend, ns, 0, &key_value), ASTARTE_RESULT_OK);
 
     // Hardcoded keys known to collide at Target Hash: 2425929905
     const char *k1 = "key_2533606";
@@ -283,7 +1129,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_deletion_shift_back)
 ZTEST_F(astarte_device_sdk_key_value, test_key_value_iterator_safe_deletion)
 {
     astarte_key_value_t key_value = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
 
     astarte_key_value_cfg_t cfg = {
         .flash_device = fixture->flash_device,
@@ -291,8 +1137,8 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_iterator_safe_deletion)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_key_value_open(cfg, &zms_fs);
-    astarte_key_value_new(&zms_fs, "iter_del_ns", 0, &key_value);
+    astarte_key_value_open(cfg, &backend);
+    astarte_key_value_new(&backend, "iter_del_ns", 0, &key_value);
 
     astarte_key_value_insert(&key_value, "A", "1", 2);
     astarte_key_value_insert(&key_value, "B", "2", 2);
@@ -327,7 +1173,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_iterator_safe_deletion)
 ZTEST_F(astarte_device_sdk_key_value, test_key_value_invalid_buffer_sizes)
 {
     astarte_key_value_t key_value = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
 
     astarte_key_value_cfg_t cfg = {
         .flash_device = fixture->flash_device,
@@ -335,8 +1181,8 @@ ZTEST_F(astarte_device_sdk_key_value, test_key_value_invalid_buffer_sizes)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_key_value_open(cfg, &zms_fs);
-    astarte_key_value_new(&zms_fs, "err_ns", 0, &key_value);
+    astarte_key_value_open(cfg, &backend);
+    astarte_key_value_new(&backend, "err_ns", 0, &key_value);
 
     const char *long_val = "this_is_a_long_value";
     astarte_key_value_insert(&key_value, "k1", long_val, strlen(long_val) + 1);
@@ -379,7 +1225,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_store_and_f
 
     // Initialize storage driver
     astarte_key_value_t kv_storage = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char namespace[] = "simple namespace";
 
     astarte_key_value_cfg_t astarte_storage_cfg = {
@@ -388,10 +1234,10 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_store_and_f
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &zms_fs);
+    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &backend);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
-    ret = astarte_key_value_new(&zms_fs, namespace, 0, &kv_storage);
+    ret = astarte_key_value_new(&backend, namespace, 0, &kv_storage);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Insert some key-value pairs
@@ -511,7 +1357,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_read_sizes)
 
     // Initialize storage driver
     astarte_key_value_t kv_storage = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char namespace[] = "simple namespace";
 
     astarte_key_value_cfg_t astarte_storage_cfg = {
@@ -520,10 +1366,10 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_read_sizes)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &zms_fs);
+    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &backend);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
-    ret = astarte_key_value_new(&zms_fs, namespace, 0, &kv_storage);
+    ret = astarte_key_value_new(&backend, namespace, 0, &kv_storage);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Insert some key-value pairs
@@ -582,7 +1428,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_overwrite)
 
     // Initialize storage driver
     astarte_key_value_t kv_storage = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char namespace[] = "simple namespace";
 
     astarte_key_value_cfg_t astarte_storage_cfg = {
@@ -591,10 +1437,10 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_overwrite)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &zms_fs);
+    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &backend);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
-    ret = astarte_key_value_new(&zms_fs, namespace, 0, &kv_storage);
+    ret = astarte_key_value_new(&backend, namespace, 0, &kv_storage);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Insert some key-value pairs
@@ -664,7 +1510,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_iteration)
 
     // Initialize storage driver
     astarte_key_value_t kv_storage = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char namespace[] = "simple namespace";
 
     astarte_key_value_cfg_t astarte_storage_cfg = {
@@ -673,10 +1519,10 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_iteration)
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &zms_fs);
+    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &backend);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
-    ret = astarte_key_value_new(&zms_fs, namespace, 0, &kv_storage);
+    ret = astarte_key_value_new(&backend, namespace, 0, &kv_storage);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Insert some key-value pairs
@@ -758,7 +1604,7 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_iteration_e
 {
     // Initialize storage driver
     astarte_key_value_t kv_storage = { 0 };
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     const char namespace[] = "simple namespace";
 
     astarte_key_value_cfg_t astarte_storage_cfg = {
@@ -767,10 +1613,10 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_iteration_e
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &zms_fs);
+    astarte_result_t ret = astarte_key_value_open(astarte_storage_cfg, &backend);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
-    ret = astarte_key_value_new(&zms_fs, namespace, 0, &kv_storage);
+    ret = astarte_key_value_new(&backend, namespace, 0, &kv_storage);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Iterate over storage
@@ -786,26 +1632,26 @@ ZTEST_F(astarte_device_sdk_key_value, test_astarte_storage_key_value_multiple_na
     astarte_result_t ret = ASTARTE_RESULT_OK;
     size_t value_size = 0U;
 
-    struct zms_fs zms_fs = { 0 };
+    astarte_key_value_backend_t backend = { 0 };
     astarte_key_value_cfg_t astarte_storage_cfg = {
         .flash_device = fixture->flash_device,
         .flash_offset = fixture->flash_offset,
         .flash_partition_size = fixture->flash_partition_size,
     };
 
-    ret = astarte_key_value_open(astarte_storage_cfg, &zms_fs);
+    ret = astarte_key_value_open(astarte_storage_cfg, &backend);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Initialize first storage driver
     astarte_key_value_t kv_astarte_storage_1 = { 0 };
     const char namespace_1[] = "first namespace";
-    ret = astarte_key_value_new(&zms_fs, namespace_1, 0, &kv_astarte_storage_1);
+    ret = astarte_key_value_new(&backend, namespace_1, 0, &kv_astarte_storage_1);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Initialize second storage driver
     astarte_key_value_t kv_astarte_storage_2 = { 0 };
     const char namespace_2[] = "second namespace";
-    ret = astarte_key_value_new(&zms_fs, namespace_2, 0, &kv_astarte_storage_2);
+    ret = astarte_key_value_new(&backend, namespace_2, 0, &kv_astarte_storage_2);
     zassert_equal(ret, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ret));
 
     // Insert some key-value pairs with multiple namespaces
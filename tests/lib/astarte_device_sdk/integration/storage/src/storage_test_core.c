@@ -6,7 +6,17 @@
 
 #include "test_storage_common.h"
 
+#include <zephyr/version.h>
+
+#if KERNEL_VERSION_NUMBER >= ZEPHYR_VERSION(4, 4, 0)
+#include <zephyr/kvss/zms.h>
+#else
+#include <zephyr/fs/zms.h>
+#endif
+
+#include "alloc.h"
 #include "storage/introsp.h"
+#include "storage/mqtt.h"
 #include "storage/sync.h"
 #include "storage/trans.h"
 
@@ -15,9 +25,14 @@ ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_invalid_params)
     astarte_result_t ares = ASTARTE_RESULT_OK;
 
     // Test passing NULL to the initialization function
-    ares = astarte_storage_init(NULL);
+    ares = astarte_storage_init(NULL, 0);
     zassert_equal(ares, ASTARTE_RESULT_INVALID_PARAM, "Init with NULL should return INVALID_PARAM");
 
+    // Test passing an instance without an area of the partition
+    ares = astarte_storage_init(&fixture->caching_handle, CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES);
+    zassert_equal(
+        ares, ASTARTE_RESULT_INVALID_PARAM, "Init out of instances should return INVALID_PARAM");
+
     // Test passing NULL to other subsystem functions
     astarte_storage_transmission_indexes_t indexes = { 0 };
     ares = astarte_storage_transmission_get_indexes(NULL, &indexes);
@@ -100,3 +115,52 @@ ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_store_introspect
         &fixture->caching_handle, intr_3_str, ARRAY_SIZE(intr_3_str));
     zassert_equal(ares, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ares));
 }
+
+ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_instances)
+{
+    if (CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES < 2) {
+        ztest_test_skip();
+    }
+
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_storage_data_t *other = astarte_calloc(1, sizeof(astarte_storage_data_t));
+    zassert_not_null(other, "Failed allocating the storage of the second instance");
+    ares = astarte_storage_init(other, 1);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ares));
+
+    // Namespaced entries of an instance are not visible to the other one
+    ares = astarte_storage_synchronization_set(&fixture->caching_handle, true);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ares));
+    bool sync = false;
+    ares = astarte_storage_synchronization_get(other, &sync);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Res:%s", astarte_result_to_name(ares));
+
+    // Neither are the MQTT session entries, stored by message identifier
+    const uint16_t packet_id = 42;
+    astarte_storage_mqtt_message_t msg_in = {
+        .type = STORAGE_MQTT_PUBLISH_ENTRY,
+        .qos = 1,
+        .topic = "test/astarte/topic",
+        .data_size = 0,
+        .data = NULL,
+    };
+    ares = astarte_storage_mqtt_insert(other, STORAGE_MQTT_MSG_OUTGOING, packet_id, &msg_in);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Res:%s", astarte_result_to_name(ares));
+    astarte_storage_mqtt_message_t msg_out = { 0 };
+    ares = astarte_storage_mqtt_find_alloc(
+        &fixture->caching_handle, STORAGE_MQTT_MSG_OUTGOING, packet_id, &msg_out);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Res:%s", astarte_result_to_name(ares));
+
+    astarte_storage_destroy(other);
+    astarte_free(other);
+
+    // Clear the area of the second instance, the fixture clears the partition as a single ZMS
+    uint16_t area_sectors = fixture->flash_sector_count / CONFIG_ASTARTE_DEVICE_SDK_MAX_DEVICES;
+    struct zms_fs zms_fs;
+    zms_fs.flash_device = fixture->flash_device;
+    zms_fs.offset = fixture->flash_offset + ((off_t) area_sectors * fixture->flash_sector_size);
+    zms_fs.sector_size = fixture->flash_sector_size;
+    zms_fs.sector_count = area_sectors;
+    zassert_equal(zms_mount(&zms_fs), 0, "ZMS mounting failed.");
+    zassert_equal(zms_clear(&zms_fs), 0, "ZMS clear failed.");
+}
@@ -64,7 +64,7 @@ static void astarte_storage_test_before(void *f)
     zassert_equal(zms_mount(&zms_fs), 0, "ZMS mounting failed.");
     zassert_equal(zms_clear(&zms_fs), 0, "ZMS clear failed.");
 
-    astarte_result_t ares = astarte_storage_init(&fixture->caching_handle);
+    astarte_result_t ares = astarte_storage_init(&fixture->caching_handle, 0);
     zassert_equal(ares, ASTARTE_RESULT_OK, "Init failed: %s", astarte_result_to_name(ares));
 }
 
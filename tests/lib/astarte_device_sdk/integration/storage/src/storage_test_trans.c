@@ -53,6 +53,9 @@ ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_invalid_pa
 
 ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_transmission_queue)
 {
+    // Small messages are buffered in RAM, the indexes only move once the pack is written
+    Z_TEST_SKIP_IFDEF(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING);
+
     astarte_result_t ares = ASTARTE_RESULT_OK;
     astarte_storage_transmission_indexes_t indexes = { 0 };
 
@@ -105,6 +108,9 @@ ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_transmission_que
 
 ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_transmission_discard)
 {
+    // Small messages are buffered in RAM, the indexes only move once the pack is written
+    Z_TEST_SKIP_IFDEF(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING);
+
     astarte_result_t ares = ASTARTE_RESULT_OK;
     astarte_storage_transmission_indexes_t indexes = { 0 };
     ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
@@ -211,3 +217,281 @@ ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_index_wrap
     zassert_equal(indexes.tail, expected_tail, "Calculated tail %u does not match expected %u",
         indexes.tail, expected_tail);
 }
+
+ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_checkpoint_restore)
+{
+    // Small messages are buffered in RAM, the indexes only move once the pack is written
+    Z_TEST_SKIP_IFDEF(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING);
+
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_storage_transmission_indexes_t indexes = { 0 };
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed");
+
+    // Push and discard across a few checkpoint intervals, leaving some operations unrecorded
+    const uint64_t pushed
+        = (3 * CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_CHECKPOINT_INTERVAL) + 1;
+    for (uint64_t i = 1; i <= pushed; i++) {
+        struct astarte_storage_transmission_msg msg_push
+            = { .interface_name = "org.astarteplatform.test.Checkpoint",
+                  .path = "/checkpoint",
+                  .payload = "data",
+                  .payload_len = 4,
+                  .qos = 1,
+                  .timestamp = 1000,
+                  .sequence_number = i };
+        ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+    }
+    for (uint64_t i = 0; i < 3; i++) {
+        ares = astarte_storage_transmission_discard(&fixture->caching_handle, &indexes);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Discard failed");
+    }
+
+    // Restart the storage, the indexes are restored from the checkpoint
+    astarte_storage_destroy(&fixture->caching_handle);
+    ares = astarte_storage_init(&fixture->caching_handle, 0);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Init failed: %s", astarte_result_to_name(ares));
+
+    astarte_storage_transmission_indexes_t restored = { 0 };
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &restored);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed after restart");
+    zassert_equal(restored.head, indexes.head, "Restored head %u, expected %u", restored.head,
+        indexes.head);
+    zassert_equal(restored.tail, indexes.tail, "Restored tail %u, expected %u", restored.tail,
+        indexes.tail);
+
+    uint64_t sequence_number = 0;
+    ares = astarte_storage_transmission_get_last_sequence_number(
+        &fixture->caching_handle, &restored, &sequence_number);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get last sequence number failed");
+    zassert_equal(sequence_number, pushed, "Last sequence number should be the one pushed last");
+
+    struct astarte_storage_transmission_msg msg_peek = { 0 };
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &restored, &msg_peek);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Peek failed after restart");
+    zassert_equal(msg_peek.sequence_number, 4, "Head should be the first message not discarded");
+    astarte_storage_transmission_msg_cleanup(&msg_peek);
+}
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACKING
+ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_packing)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_storage_transmission_indexes_t indexes = { 0 };
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed");
+    const uint32_t initial_tail = indexes.tail;
+
+    // Small messages are kept in RAM until the pack is written
+    const uint64_t pushed = 8;
+    struct astarte_storage_transmission_msg msg_push
+        = { .interface_name = "org.astarteplatform.test.Packing",
+              .path = "/packing",
+              .payload = "data",
+              .payload_len = 4,
+              .qos = 1,
+              .timestamp = 1000 };
+    for (uint64_t i = 1; i <= pushed; i++) {
+        msg_push.sequence_number = i;
+        ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+    }
+    zassert_equal(indexes.tail, initial_tail, "Nothing should have been written yet");
+
+    struct astarte_storage_transmission_msg msg_peek = { 0 };
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &indexes, &msg_peek);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Peek from the pack failed");
+    zassert_equal(msg_peek.sequence_number, 1, "Head should be the first message pushed");
+    astarte_storage_transmission_msg_cleanup(&msg_peek);
+
+    // A pack younger than its timeout is only written when forced
+    ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, false);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Flush failed");
+    zassert_equal(indexes.tail, initial_tail, "The pack should not have expired yet");
+    k_msleep(CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_PACK_TIMEOUT_MS + 1);
+    ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, false);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Flush failed");
+    zassert_equal(indexes.tail, initial_tail + 1, "All the messages should share one record");
+
+    // Messages pushed after the last flush are lost on restart
+    msg_push.sequence_number = pushed + 1;
+    ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+
+    astarte_storage_destroy(&fixture->caching_handle);
+    ares = astarte_storage_init(&fixture->caching_handle, 0);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Init failed: %s", astarte_result_to_name(ares));
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed after restart");
+
+    // The messages of the written pack are read back one at a time
+    for (uint64_t i = 1; i <= pushed; i++) {
+        struct astarte_storage_transmission_msg msg_get = { 0 };
+        ares = astarte_storage_transmission_get(&fixture->caching_handle, &indexes, &msg_get);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Get failed");
+        zassert_equal(msg_get.sequence_number, i, "Messages should keep their order");
+        zassert_mem_equal(msg_get.path, msg_push.path, strlen(msg_push.path) + 1, "Path mismatch");
+        astarte_storage_transmission_msg_cleanup(&msg_get);
+    }
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &indexes, &msg_peek);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "The unwritten message should be lost");
+}
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_COMPRESSION
+ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_compression)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_storage_transmission_indexes_t indexes = { 0 };
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed");
+
+    // A repetitive payload, small enough to be stored in a ring record
+    uint8_t payload[256];
+    memset(payload, 'a', sizeof(payload));
+    struct astarte_storage_transmission_msg msg_push
+        = { .interface_name = "org.astarteplatform.test.Compression",
+              .path = "/compression",
+              .payload = payload,
+              .payload_len = sizeof(payload),
+              .qos = 1,
+              .timestamp = 1000,
+              .sequence_number = 1 };
+    size_t usage_before = fixture->caching_handle.trans_ring_usage_bytes;
+    ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+    ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, true);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Flush failed");
+    size_t stored_size = fixture->caching_handle.trans_ring_usage_bytes - usage_before;
+    zassert_true(stored_size < sizeof(payload), "Stored %zu bytes, record not compressed",
+        stored_size);
+
+    // The message is read back as it was pushed
+    struct astarte_storage_transmission_msg msg_get = { 0 };
+    ares = astarte_storage_transmission_get(&fixture->caching_handle, &indexes, &msg_get);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get failed");
+    zassert_equal(msg_get.payload_len, sizeof(payload), "Payload length mismatch");
+    zassert_mem_equal(msg_get.payload, payload, sizeof(payload), "Payload mismatch");
+    zassert_mem_equal(msg_get.path, msg_push.path, strlen(msg_push.path) + 1, "Path mismatch");
+    zassert_equal(fixture->caching_handle.trans_ring_usage_bytes, usage_before,
+        "Discarding should release the compressed size");
+    astarte_storage_transmission_msg_cleanup(&msg_get);
+}
+#endif
+
+#ifdef CONFIG_ASTARTE_DEVICE_SDK_ADVANCED_TRANSMISSION_READ_AHEAD
+ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_read_ahead)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_storage_transmission_indexes_t indexes = { 0 };
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed");
+
+    // Each message is flushed to its own record
+    struct astarte_storage_transmission_msg msg_push
+        = { .interface_name = "org.astarteplatform.test.ReadAhead",
+              .path = "/first",
+              .payload = "data",
+              .payload_len = 4,
+              .qos = 1,
+              .timestamp = 1000,
+              .sequence_number = 1 };
+    ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+    ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, true);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Flush failed");
+    msg_push.path = "/second";
+    msg_push.sequence_number = 2;
+    ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+    ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, true);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Flush failed");
+
+    // Peeking the head reads the following record too
+    struct astarte_storage_transmission_msg msg_get = { 0 };
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &indexes, &msg_get);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Peek failed");
+    zassert_equal(msg_get.sequence_number, 1, "Wrong message at the head");
+    astarte_storage_transmission_msg_cleanup(&msg_get);
+
+    // Once read, the record is served from RAM even if its flash copy is gone
+    ares = astarte_key_value_ring_delete(
+        fixture->caching_handle.trans_storage.backend, indexes.head + 1, NULL);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Ring delete failed");
+    ares = astarte_storage_transmission_discard(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Discard failed");
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &indexes, &msg_get);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Peek of the record read ahead failed");
+    zassert_equal(msg_get.sequence_number, 2, "Wrong message read ahead");
+    zassert_mem_equal(msg_get.path, "/second", sizeof("/second"), "Path mismatch");
+    astarte_storage_transmission_msg_cleanup(&msg_get);
+
+    // Released records are read again from flash
+    astarte_storage_transmission_release(&fixture->caching_handle);
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &indexes, &msg_get);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Released record should be read from flash");
+}
+#endif
+
+ZTEST_F(astarte_device_sdk_storage, test_device_astarte_storage_trans_expiry)
+{
+    astarte_result_t ares = ASTARTE_RESULT_OK;
+    astarte_storage_transmission_indexes_t indexes = { 0 };
+    ares = astarte_storage_transmission_get_indexes(&fixture->caching_handle, &indexes);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Get indexes failed");
+
+    // Each message is flushed to its own record, spanning more than one expiry group
+    const uint32_t expired_count = 64;
+    struct astarte_storage_transmission_msg msg_push
+        = { .interface_name = "org.astarteplatform.test.Expiry",
+              .path = "/expired",
+              .payload = "data",
+              .payload_len = 4,
+              .qos = 0,
+              .timestamp = 1000,
+              .expiry_timestamp = 2000 };
+    for (uint32_t i = 0; i < expired_count; i++) {
+        ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Push %u failed", i);
+        ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, true);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Flush %u failed", i);
+    }
+    msg_push.path = "/kept";
+    msg_push.expiry_timestamp = 0;
+    ares = astarte_storage_transmission_push(&fixture->caching_handle, &indexes, &msg_push);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Push failed");
+    ares = astarte_storage_transmission_flush(&fixture->caching_handle, &indexes, true);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Flush failed");
+
+    // Nothing is dropped before the expiry
+    uint32_t dropped = 0;
+    ares = astarte_storage_transmission_drop_expired(
+        &fixture->caching_handle, &indexes, 2000, &dropped);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Drop expired failed");
+    zassert_equal(dropped, 0, "Dropped %u messages before their expiry", dropped);
+
+    ares = astarte_storage_transmission_drop_expired(
+        &fixture->caching_handle, &indexes, 3000, &dropped);
+    zassert_equal(ares, ASTARTE_RESULT_OK, "Drop expired failed");
+    zassert_true(dropped > 0, "No expired messages dropped");
+
+    // Expired messages sharing a group with the kept one are left in the queue
+    uint32_t remaining = 0;
+    struct astarte_storage_transmission_msg msg_get = { 0 };
+    while (true) {
+        ares = astarte_storage_transmission_get(&fixture->caching_handle, &indexes, &msg_get);
+        zassert_equal(ares, ASTARTE_RESULT_OK, "Get failed, kept message lost");
+        bool kept = (strcmp(msg_get.path, "/kept") == 0);
+        astarte_storage_transmission_msg_cleanup(&msg_get);
+        if (kept) {
+            break;
+        }
+        remaining++;
+    }
+    zassert_equal(dropped + remaining, expired_count, "Dropped %u and got %u expired messages",
+        dropped, remaining);
+
+    ares = astarte_storage_transmission_peek(&fixture->caching_handle, &indexes, &msg_get);
+    zassert_equal(ares, ASTARTE_RESULT_NOT_FOUND, "Queue should be empty");
+}